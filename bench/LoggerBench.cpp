@@ -0,0 +1,431 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: LoggerBench.cpp
+ * Description: Benchmarks of the logging hot path. It measures the cost of a
+ * log statement (formatting the record and handing it over to the sink) for
+ * 1/4/16/64 producer threads and the ConsoleOps and FileOps sinks, along with
+ * the clock, the call site parsing, the log file rotation and the line range
+ * reads of a big log file. The results go out as JSON, to be compared between
+ * the releases.
+ *
+ * Usage: LoggerBench [--quick] [--json <output file>]
+ * The JSON goes to the standard output if no output file is given, the
+ * summary always goes to the standard error. --quick runs fewer iterations.
+ */
+
+#include "Logger.hpp"
+#include "FileOps.hpp"
+#include "ConsoleOps.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <streambuf>
+#include <unistd.h>
+
+using namespace logger;
+
+namespace
+{
+    using BenchClock = std::chrono::steady_clock;
+
+    /**
+     * @brief Keeps the compiler from dropping the results of the measured calls
+     */
+    std::atomic<size_t> resultsChecksum(0);
+
+    inline void keep(const size_t val) noexcept
+    {
+        resultsChecksum.fetch_add(val, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief A stream buffer throwing everything away, for the console sink
+     * to be measured without the terminal
+     */
+    class NullBuffer : public std::streambuf
+    {
+        protected:
+            int overflow(int ch) override                                       { return ch; }
+            std::streamsize xsputn(const char* /*s*/, std::streamsize n) override { return n; }
+    };
+
+    /**
+     * @brief A result, i.e. its name and its fields in the order they are added
+     */
+    class Result
+    {
+        public:
+            explicit Result(const std::string_view name) : m_Name(name) {}
+
+            Result& add(const std::string_view key, const std::string_view val)
+            {
+                m_Fields.emplace_back(key, std::format("\"{}\"", val));
+                return *this;
+            }
+
+            Result& add(const std::string_view key, const double val)
+            {
+                m_Fields.emplace_back(key, std::format("{:.1f}", val));
+                return *this;
+            }
+
+            Result& add(const std::string_view key, const size_t val)
+            {
+                m_Fields.emplace_back(key, std::format("{}", val));
+                return *this;
+            }
+
+            std::string toJson() const
+            {
+                auto json = std::format("{{\"name\": \"{}\"", m_Name);
+                for (const auto& [key, val] : m_Fields)
+                    json += std::format(", \"{}\": {}", key, val);
+                return json + "}";
+            }
+
+            std::string toText() const
+            {
+                auto text = std::format("{:<34}", m_Name);
+                for (const auto& [key, val] : m_Fields)
+                    text += std::format(" {}={}", key, val);
+                return text;
+            }
+
+        private:
+            std::string m_Name;
+            std::vector<std::pair<std::string, std::string>> m_Fields;
+    };
+
+    /**
+     * @brief Add the percentiles of the samples (in ns) to the result
+     */
+    void addPercentiles(Result& result, std::vector<uint64_t>& samples)
+    {
+        if (samples.empty())
+            return;
+        std::sort(samples.begin(), samples.end());
+        auto at = [&samples](const double pct)
+        {
+            auto idx = std::min(samples.size() - 1, static_cast<size_t>(pct * static_cast<double>(samples.size())));
+            return static_cast<double>(samples[idx]);
+        };
+        result.add("p50_ns", at(0.50))
+              .add("p99_ns", at(0.99))
+              .add("p999_ns", at(0.999));
+    }
+
+    inline uint64_t nsSince(const BenchClock::time_point& start) noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - start).count());
+    }
+
+    inline double perSecond(const double cnt, const uint64_t elapsedNs) noexcept
+    {
+        return elapsedNs ? cnt * 1e9 / static_cast<double>(elapsedNs) : 0.0;
+    }
+
+    /**
+     * @brief Log from a number of producer threads into the sink, the way the
+     * LOG_* macros do: the thread's own Logger formats the record, which is
+     * then written to the sink. Every call is timed, and the throughput is
+     * measured till the sink has written all of the records.
+     */
+    Result benchProducers(LoggingOps& ops, const std::string_view sinkName, const size_t threadsCnt, const size_t totalCalls)
+    {
+        static constexpr CallSite site{__FILE__, "void Producer::produce(int)", __LINE__, LOG_TYPE::LOG_INFO, FORWARD_ANGLE};
+        const auto callsPerThread = std::max<size_t>(totalCalls / threadsCnt, 1000);
+        const std::string payload(48, 'x');
+
+        std::vector<std::vector<uint64_t>> samples(threadsCnt);
+        std::vector<size_t> bytes(threadsCnt, 0);
+        std::atomic<size_t> readyCnt(0);
+        std::atomic_bool isStarted(false);
+        std::vector<std::thread> producers;
+        for (size_t idx = 0; idx < threadsCnt; ++idx)
+        {
+            producers.emplace_back([&, idx]()
+            {
+                Logger logger(DEFAULT_TIME_FORMAT);
+                auto& threadSamples = samples[idx];
+                threadSamples.reserve(callsPerThread);
+                readyCnt.fetch_add(1);
+                while (!isStarted.load())
+                    std::this_thread::yield();
+
+                for (size_t cnt = 0; cnt < callsPerThread; ++cnt)
+                {
+                    auto start = BenchClock::now();
+                    logger.setCallSite(site)
+                          .setThreadId(std::this_thread::get_id())
+                          .log("Producer[{}] produces data[{}] {}", idx, cnt, payload);
+                    ops.write(logger.getLogRecord(), site.type());
+                    threadSamples.push_back(nsSince(start));
+                    bytes[idx] += logger.getLogRecord().size() + 1;
+                }
+            });
+        }
+        while (readyCnt.load() != threadsCnt)
+            std::this_thread::yield();
+
+        auto start = BenchClock::now();
+        isStarted.store(true);
+        for (auto& producer : producers)
+            producer.join();
+        ops.flush();
+        auto elapsedNs = nsSince(start);
+
+        std::vector<uint64_t> allSamples;
+        allSamples.reserve(threadsCnt * callsPerThread);
+        for (const auto& threadSamples : samples)
+            allSamples.insert(allSamples.end(), threadSamples.begin(), threadSamples.end());
+        size_t totalBytes = 0;
+        for (const auto cnt : bytes)
+            totalBytes += cnt;
+
+        Result result(std::format("producers/{}", sinkName));
+        result.add("sink", sinkName)
+              .add("threads", threadsCnt)
+              .add("calls", allSamples.size());
+        addPercentiles(result, allSamples);
+        result.add("msgs_per_sec", perSecond(static_cast<double>(allSamples.size()), elapsedNs))
+              .add("bytes_per_sec", perSecond(static_cast<double>(totalBytes), elapsedNs));
+        return result;
+    }
+
+    /**
+     * @brief Time a single call, a number of times
+     */
+    template<typename Call>
+    Result benchCall(const std::string_view name, const size_t callsCnt, Call&& call)
+    {
+        std::vector<uint64_t> samples;
+        samples.reserve(callsCnt);
+        auto begin = BenchClock::now();
+        for (size_t cnt = 0; cnt < callsCnt; ++cnt)
+        {
+            auto start = BenchClock::now();
+            keep(call(cnt));
+            samples.push_back(nsSince(start));
+        }
+        auto elapsedNs = nsSince(begin);
+
+        Result result(name);
+        result.add("calls", callsCnt);
+        addPercentiles(result, samples);
+        result.add("calls_per_sec", perSecond(static_cast<double>(callsCnt), elapsedNs));
+        return result;
+    }
+
+    std::string logLine(const size_t cnt)
+    {
+        return std::format("|20250822_022103| 0x16b8cb000| ProducerConsumer.cpp|   28|INF>  "
+                           "[Producer : produce] Producer[{}] produces data[{}]", cnt % 16, cnt);
+    }
+
+    /**
+     * @brief Write the records into a file of a small max size, so that it
+     * rotates a lot, and into one never rotating. The difference of the
+     * two is the cost of the rotations.
+     */
+    Result benchRotation(const std::filesystem::path& dir, const size_t recordsCnt)
+    {
+        auto writeAll = [&dir, recordsCnt](const std::uintmax_t maxFileSize, const std::string_view name)
+        {
+            auto start = BenchClock::now();
+            {
+                FileOps file(maxFileSize, name, dir.string());
+                for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+                    file.write(logLine(cnt));
+                file.flush();
+            }
+            return nsSince(start);
+        };
+
+        const std::uintmax_t rotatingFileSize = 64 * 1024;
+        auto rotatingNs = writeAll(rotatingFileSize, "rotating");
+        auto plainNs = writeAll(1024 * 1024 * 1024, "plain");
+
+        size_t filesCnt = 0;
+        std::uintmax_t totalBytes = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.is_regular_file() && entry.path().filename().string().starts_with("rotating"))
+            {
+                ++filesCnt;
+                totalBytes += entry.file_size();
+            }
+        }
+        auto rotationsCnt = filesCnt ? filesCnt - 1 : 0;
+        auto extraNs = (rotatingNs > plainNs) ? rotatingNs - plainNs : 0;
+
+        Result result("FileOps/rotation");
+        result.add("records", recordsCnt)
+              .add("max_file_size", static_cast<size_t>(rotatingFileSize))
+              .add("rotations", rotationsCnt)
+              .add("bytes_per_sec", perSecond(static_cast<double>(totalBytes), rotatingNs))
+              .add("bytes_per_sec_without_rotation", perSecond(static_cast<double>(totalBytes), plainNs))
+              .add("ns_per_rotation", rotationsCnt ? static_cast<double>(extraNs) / static_cast<double>(rotationsCnt) : 0.0);
+        return result;
+    }
+
+    /**
+     * @brief Read ranges of lines out of a big log file, the first one building
+     * the line index and the rest of them at random positions
+     */
+    std::vector<Result> benchReadLineRange(const std::filesystem::path& dir, const size_t linesCnt, const size_t readsCnt)
+    {
+        const size_t rangeSize = 100;
+        FileOps file(std::uintmax_t(4) * 1024 * 1024 * 1024, "big", dir.string());
+        for (size_t cnt = 0; cnt < linesCnt; ++cnt)
+            file.write(logLine(cnt));
+        file.flush();
+
+        std::vector<std::string> lines;
+        auto start = BenchClock::now();
+        FileOps::readFileLineRange(file, linesCnt / 2, linesCnt / 2 + rangeSize - 1, lines);
+        auto firstNs = nsSince(start);
+
+        std::mt19937_64 gen(42);
+        std::uniform_int_distribution<size_t> dist(1, linesCnt - rangeSize);
+        auto result = benchCall("FileOps::readFileLineRange", readsCnt, [&](const size_t)
+        {
+            auto startLineNo = dist(gen);
+            lines.clear();
+            FileOps::readFileLineRange(file, startLineNo, startLineNo + rangeSize - 1, lines);
+            return lines.size();
+        });
+        result.add("file_lines", linesCnt)
+              .add("file_bytes", static_cast<size_t>(file.getFileSize()))
+              .add("range_lines", rangeSize);
+
+        Result firstResult("FileOps::readFileLineRange/first");
+        firstResult.add("file_lines", linesCnt)
+                   .add("ns", static_cast<double>(firstNs));
+        return { firstResult, result };
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    bool isQuick = false;
+    std::string jsonFileName;
+    for (int idx = 1; idx < argc; ++idx)
+    {
+        std::string_view arg(argv[idx]);
+        if (arg == "--quick")
+            isQuick = true;
+        else if (arg == "--json" && idx + 1 < argc)
+            jsonFileName = argv[++idx];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--quick] [--json <output file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    const size_t totalCalls = isQuick ? 20000 : 200000;
+    const size_t callsCnt = isQuick ? 20000 : 1000000;
+    const size_t bigFileLines = isQuick ? 200000 : 2000000;
+    auto dir = std::filesystem::temp_directory_path() / std::format("LoggerBench_{}", ::getpid());
+    std::filesystem::create_directories(dir);
+
+    std::vector<Result> results;
+    auto report = [&results](Result result)
+    {
+        std::cerr << result.toText() << std::endl;
+        results.push_back(std::move(result));
+    };
+
+    try
+    {
+        for (const size_t threadsCnt : {1, 4, 16, 64})
+        {
+            // The console sink is measured without the terminal, which would be the bottleneck
+            NullBuffer nullBuffer;
+            auto pCoutBuffer = std::cout.rdbuf(&nullBuffer);
+            std::optional<Result> consoleResult;
+            {
+                ConsoleOps console;
+                consoleResult = benchProducers(console, "ConsoleOps", threadsCnt, totalCalls);
+            }
+            std::cout.rdbuf(pCoutBuffer);
+            report(std::move(*consoleResult));
+
+            FileOps file(std::uintmax_t(4) * 1024 * 1024 * 1024, std::format("producers_{}", threadsCnt), dir.string());
+            report(benchProducers(file, "FileOps", threadsCnt, totalCalls));
+            file.deleteFile();
+        }
+
+        Clock clock(DEFAULT_TIME_FORMAT);
+        report(benchCall("Clock::getLocalTimeStr", callsCnt, [&clock](const size_t)
+        {
+            return clock.getLocalTimeStr().size();
+        }));
+
+        const std::string prettyFunc = "std::vector<int> logger::Handler::handle(const std::string&, int) const";
+        report(benchCall("CallSite::extractClassAndFuncName", callsCnt, [&prettyFunc](const size_t cnt)
+        {
+            CallSite site(__FILE__, prettyFunc, cnt, LOG_TYPE::LOG_INFO, FORWARD_ANGLE);
+            return site.className().size() + site.functionName().size();
+        }));
+
+        report(benchRotation(dir, totalCalls));
+        for (auto& result : benchReadLineRange(dir, bigFileLines, isQuick ? 200 : 2000))
+            report(std::move(result));
+    }
+    catch (const std::exception& excp)
+    {
+        std::cerr << "Benchmark failed: " << excp.what() << std::endl;
+        std::filesystem::remove_all(dir);
+        return 1;
+    }
+    std::filesystem::remove_all(dir);
+
+    std::string json = std::format("{{\n  \"benchmark\": \"LoggerBench\",\n  \"quick\": {},\n  \"hardware_concurrency\": {},\n"
+                                   "  \"timestamp\": \"{}\",\n  \"results\": [\n",
+                                   isQuick, std::thread::hardware_concurrency(), Clock(DEFAULT_TIME_FORMAT).getLocalTimeStr());
+    for (size_t idx = 0; idx < results.size(); ++idx)
+        json += std::format("    {}{}\n", results[idx].toJson(), (idx + 1 < results.size()) ? "," : "");
+    json += "  ]\n}\n";
+
+    if (jsonFileName.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream jsonFile(jsonFileName, std::ios::out | std::ios::trunc);
+        if (!jsonFile)
+        {
+            std::cerr << "Can't open " << jsonFileName << std::endl;
+            return 1;
+        }
+        jsonFile << json;
+    }
+    return resultsChecksum.load() ? 0 : 1;
+}
@@ -10,6 +10,7 @@ FILE_SIZE="10MB"
 LOG_FILE_PATH=""
 LOG_FILE_NAME=""
 LOG_FILE_EXTN=""
+CONSOLE_LOG_LEVEL=""
 
 print_global_help() {
   cat <<EOF
@@ -43,6 +44,9 @@ Optional arguments (case insensitive):
   -LOG_FILE_EXTN=<extension>      (optional)
       Export LOG_FILE_EXTN.
 
+  -CONSOLE_LOG_LEVEL=<dbg|info|imp|warn|err> (optional)
+      With file logging, log to the console as well from this level on.
+
 Help options:
 
   --help, -h                     Show this help message.
@@ -124,6 +128,19 @@ EOF
 -LOG_FILE_EXTN:
 
   Optional file extension to export as LOG_FILE_EXTN.
+EOF
+      ;;
+    CONSOLE_LOG_LEVEL)
+      cat <<EOF
+-CONSOLE_LOG_LEVEL possible values (case insensitive):
+
+  dbg       - Every record goes to the console as well.
+  info      - The info records and the more severe ones.
+  imp       - The important records and the more severe ones.
+  warn      - The warnings and the errors.
+  err       - The errors only.
+
+  Only with -FILE_LOGGING=yes, the file still gets every record.
 EOF
       ;;
     *)
@@ -273,6 +290,15 @@ else
         LOG_FILE_EXTN)
           LOG_FILE_EXTN="$value"
           ;;
+        CONSOLE_LOG_LEVEL)
+          if [[ "$value_lower" =~ ^(dbg|info|imp|warn|err)$ ]]; then
+            CONSOLE_LOG_LEVEL="$value_lower"
+          else
+            echo "Error: Invalid value for CONSOLE_LOG_LEVEL: $value"
+            echo "Use -CONSOLE_LOG_LEVEL --help for valid options."
+            exit 1
+          fi
+          ;;
         *)
           echo "Warning: Unknown argument '$key'. Ignored."
           ;;
@@ -300,6 +326,9 @@ if [[ "$FILE_LOGGING" == "yes" ]]; then
   if [[ -n "$LOG_FILE_EXTN" ]]; then
     export LOG_FILE_EXTN
   fi
+  if [[ -n "$CONSOLE_LOG_LEVEL" ]]; then
+    export CONSOLE_LOG_LEVEL
+  fi
 fi
 
 # Print the final values (for demonstration)
@@ -311,6 +340,7 @@ echo "FILE_SIZE=$FILE_SIZE"
 echo "LOG_FILE_PATH=${LOG_FILE_PATH:-<not set>}"
 echo "LOG_FILE_NAME=${LOG_FILE_NAME:-<not set>}"
 echo "LOG_FILE_EXTN=${LOG_FILE_EXTN:-<not set>}"
+echo "CONSOLE_LOG_LEVEL=${CONSOLE_LOG_LEVEL:-<not set>}"
 
 echo ""
 echo ""
@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file BinaryLog.hpp
+ * @brief Declaration of the BinaryLogWriter and BinaryLogReader classes.
+ *
+ * The binary log format keeps a log file compact: every file name, function
+ * name and format string is written once into the string table of the file,
+ * and a log record only carries the varint IDs referring to it, the varint
+ * time stamp delta and the packed arguments of the message. The records are
+ * the deferred records (see DeferredRecord), i.e. nothing is formatted while
+ * logging at all, the BinaryLogReader renders the very text layout later on.
+ *
+ * File layout:
+ *   [magic "\x7FLGB"][version]
+ *   followed by the records, each of them [record type][payload]:
+ *   SESSION   : -                          Starts over the tables and the time stamps
+ *   STRING    : [id][length][characters]   An entry of the string table
+ *   THREAD    : [index][size][raw thread ID]
+ *   CALL_SITE : [id][file][class][function][marker] (string IDs)[line][log type][is lambda]
+ *   LOG       : [time stamp delta][thread index][call site ID][format string ID]
+ *               [argument count]([ArgType][packed argument])...
+ *   TEXT      : [length][characters]      A record written as text (or data)
+ *   FIELDS    : as LOG, a structured record (see DeferredRecord::encodeFields)
+ *               with the message in place of the format string and the arguments
+ *               being the key-value pairs. Since version 0x02.
+ *
+ * The IDs, lengths and unsigned integers are LEB128 varints, the signed
+ * integers and the time stamp delta (nanoseconds) are zig-zag encoded varints,
+ * the floating point numbers are their raw bytes. The table entries are written
+ * right before the first record referring to them, so the file stays appendable
+ * and every part of it written after a SESSION can be decoded on its own.
+ *
+ * @note The thread IDs and the floating point numbers are stored in the byte
+ * order of the host, a binary log is meant to be decoded on the same platform.
+ */
+
+#ifndef BINARY_LOG_HPP
+#define BINARY_LOG_HPP
+
+#include "RecordRing.hpp"
+#include "CallSite.hpp"
+#include "Logger.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace logger
+{
+    /**
+     * @brief The magic number a binary log file starts with, followed by
+     * the version of the format
+     */
+    inline constexpr std::string_view binaryLogMagic = "\x7FLGB";
+    inline constexpr uint8_t binaryLogVersion = 0x02;
+
+    class BinaryLogWriter
+    {
+        public:
+            BinaryLogWriter() = default;
+            ~BinaryLogWriter() = default;
+            BinaryLogWriter(const BinaryLogWriter& rhs) = delete;
+            BinaryLogWriter(BinaryLogWriter&& rhs) = default;
+            BinaryLogWriter& operator=(const BinaryLogWriter& rhs) = delete;
+            BinaryLogWriter& operator=(BinaryLogWriter&& rhs) = default;
+
+            /**
+             * @brief Append the header of a binary log file, i.e. the magic
+             * number and the version
+             *
+             * @param [out] out The buffer the header is appended to
+             */
+            static void appendFileHeader(std::string& out);
+
+            /**
+             * @brief Forget the tables, the next record starts a new session.
+             * It must be called whenever the records go to another (or a truncated) file.
+             */
+            void reset() noexcept;
+
+            /**
+             * @brief Encode a record of the RecordRing and append it
+             *
+             * @param [in] record The record, either a deferred record or a text record
+             * @param [in] kind The kind of the record
+             * @param [out] out The buffer the encoded record (and the table entries
+             *                  it refers to for the first time) are appended to
+             */
+            void append(const std::string_view record, const RecordKind kind, std::string& out);
+
+        private:
+            uint32_t stringId(const std::string_view str, std::string& out);
+            uint32_t threadIndex(const std::thread::id& tid, std::string& out);
+            uint32_t callSiteId(const CallSite& site, std::string& out);
+
+            bool m_isSessionStarted = false;
+            int64_t m_LastTimeStampNs = 0;
+            std::map<std::string, uint32_t, std::less<>> m_StringIds;
+            std::unordered_map<std::thread::id, uint32_t> m_ThreadIds;
+            std::unordered_map<const CallSite*, uint32_t> m_CallSiteIds;
+    };
+
+    class BinaryLogReader
+    {
+        public:
+            BinaryLogReader() = delete;
+
+            /**
+             * @brief Construct a new Binary Log Reader object
+             *
+             * @param [in] data The content of a binary log file. It is not
+             *                  copied and must outlive the reader.
+             * @note Throws std::runtime_error if the data isn't a binary log.
+             */
+            explicit BinaryLogReader(const std::string_view data);
+
+            ~BinaryLogReader() = default;
+            BinaryLogReader(const BinaryLogReader& rhs) = delete;
+            BinaryLogReader(BinaryLogReader&& rhs) = delete;
+            BinaryLogReader& operator=(const BinaryLogReader& rhs) = delete;
+            BinaryLogReader& operator=(BinaryLogReader&& rhs) = delete;
+
+            /**
+             * @brief Check if the data is (the beginning of) a binary log
+             *
+             * @param [in] data The content of a file
+             * @return true If it starts with the magic number, otherwise
+             * @return false
+             */
+            static bool isBinaryLog(const std::string_view data) noexcept;
+
+            /**
+             * @brief Render a whole binary log into text, exactly as the
+             * text format would have written it (every record followed by a new line)
+             *
+             * @param [in] data The content of a binary log file
+             * @param [out] text The rendered text
+             * @note Throws std::runtime_error if the data is corrupt.
+             */
+            static void decode(const std::string_view data, std::string& text);
+
+            /**
+             * @brief Render the next record of the log
+             *
+             * @param [out] line The rendered record, prefix and message,
+             *                   without the trailing new line
+             * @return true If a record is rendered, otherwise
+             * @return false At the end of the log
+             * @note The zero bytes after the last record (the preallocated space
+             *       of a mapped file, see FileIoMode::MMAP) end the log.
+             * @note Throws std::runtime_error if the data is corrupt. A format
+             *       string not matching its arguments doesn't throw, the line
+             *       carries the format string and the error instead.
+             */
+            bool next(std::string& line);
+
+        private:
+            uint8_t readByte();
+            uint64_t readVarint();
+            int64_t readSignedVarint();
+            std::string_view readBytes(const size_t size);
+            std::string_view stringAt(const uint64_t id) const;
+            void readCallSite();
+            void renderLog(std::string& line, const bool isStructured);
+
+            std::string_view m_Data;
+            size_t m_Pos;
+            int64_t m_LastTimeStampNs;
+            std::vector<std::string_view> m_Strings;
+            std::vector<std::thread::id> m_Threads;
+            std::vector<std::unique_ptr<CallSite>> m_CallSites;
+            std::string m_Msg;
+            Logger m_Renderer;
+    };
+};  // namespace logger
+
+#endif  // BINARY_LOG_HPP
@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file BlockCompression.hpp
+ * @brief Declaration of the BlockCompression class.
+ *
+ * A compressed log file is a sequence of independently compressed blocks, so
+ * it can be written and appended to in a streaming fashion: FileOps compresses
+ * the records of a batch into a block and writes it with a single write. A crash
+ * loses at most the block being written, which the reader detects and ignores.
+ *
+ * File layout:
+ *   [magic "\x7FLGZ"][version]
+ *   followed by the blocks, each of them
+ *   [uint32_t stored size][uint32_t raw size][stored bytes]
+ * The blocks are compressed in the LZ4 block format (built in, no external
+ * library needed). The highest bit of the stored size marks a block stored
+ * as is, which is the case whenever it doesn't get any smaller compressed.
+ * The sizes are little endian, whatever the host is.
+ *
+ * @note It is the LZ4 block format in a framing of our own, not the LZ4 frame
+ *       format, so `lz4 -d` can't read the files. The LogDecoder tool (or
+ *       decompress()) can, and each block is a valid LZ4 block for any LZ4 library.
+ */
+
+#ifndef BLOCK_COMPRESSION_HPP
+#define BLOCK_COMPRESSION_HPP
+
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+namespace logger
+{
+    /**
+     * @brief The magic number a compressed log file starts with, followed by
+     * the version of the format
+     */
+    inline constexpr std::string_view compressedLogMagic = "\x7FLGZ";
+    inline constexpr uint8_t compressedLogVersion = 0x01;
+
+    class BlockCompression
+    {
+        public:
+            BlockCompression() = delete;
+
+            /**
+             * @brief The size of the blocks FileOps aims for. A block covers whole
+             * records only, so a single record longer than it makes a longer block.
+             */
+            static constexpr size_t blockSize = 64 * 1024;
+
+            /**
+             * @brief Append the header of a compressed log file, i.e. the magic
+             * number and the version
+             *
+             * @param [out] out The buffer the header is appended to
+             */
+            static void appendFileHeader(std::string& out);
+
+            /**
+             * @brief Check if the data is (the beginning of) a compressed log
+             *
+             * @param [in] data The content of a file
+             * @return true If it starts with the magic number, otherwise
+             * @return false
+             */
+            static bool isCompressed(const std::string_view data) noexcept;
+
+            /**
+             * @brief Compress the data into a block and append it
+             *
+             * @param [in] raw The data to be compressed
+             * @param [out] out The buffer the block (along with its sizes) is appended to
+             */
+            static void appendBlock(const std::string_view raw, std::string& out);
+
+            /**
+             * @brief Decompress a whole compressed log
+             *
+             * @param [in] data The content of a compressed log file
+             * @param [out] raw The decompressed data
+             * @return true If all the blocks are complete, otherwise
+             * @return false If the last block is truncated (e.g. after a crash),
+             *         the blocks before it are decompressed nevertheless
+             * @note Throws std::runtime_error if the data is corrupt.
+             * @note The zero bytes after the last block (the preallocated space
+             *       of a mapped file, see FileIoMode::MMAP) are ignored.
+             */
+            static bool decompress(const std::string_view data, std::string& raw);
+
+            /**
+             * @brief The size of the file header and of the header of a block
+             */
+            static constexpr size_t fileHeaderSize = 5;
+            static constexpr size_t blockHeaderSize = 2 * sizeof(uint32_t);
+
+            /**
+             * @brief Get the size of a block, for reading a file block by block
+             *
+             * @param [in] header The header of the block, at least blockHeaderSize bytes
+             * @return size_t The size of the whole block along with its header, 0 for
+             *         the zero bytes after the last block (see decompress())
+             */
+            static size_t blockSizeOf(const std::string_view header) noexcept;
+
+            /**
+             * @brief Decompress a single block
+             *
+             * @param [in] block The whole block along with its header, see blockSizeOf()
+             * @param [out] raw The buffer the decompressed data is appended to
+             * @note Throws std::runtime_error if the block is corrupt.
+             */
+            static void decompressBlock(const std::string_view block, std::string& raw);
+
+        private:
+            static void compressLz4(const std::string_view raw, std::string& out);
+            static void decompressLz4(const std::string_view block, const size_t rawSize, std::string& raw);
+
+            using SizeType = uint32_t;
+            static constexpr SizeType m_StoredFlag = 1u << 31;
+    };
+};  // namespace logger
+
+#endif  // BLOCK_COMPRESSION_HPP
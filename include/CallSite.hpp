@@ -0,0 +1,251 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file CallSite.hpp
+ * @brief Declaration of the CallSite class.
+ *
+ * A CallSite describes one LOG_* statement of the code: the base name of the
+ * source file, the class and function names, the line, the log type and the
+ * marker. The LOGGER_MACROS create one static constexpr instance per statement,
+ * so __FILE__ and __PRETTY_FUNCTION__ are parsed by the compiler and a log call
+ * only hands over a reference to the descriptor. All the names are views into
+ * the string literals, hence valid for the whole life time of the program.
+ */
+
+#ifndef CALL_SITE_HPP
+#define CALL_SITE_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace logger
+{
+    enum class LOG_TYPE;
+
+    class CallSite
+    {
+        public:
+            /**
+             * @brief Construct a new Call Site object
+             *
+             * @param [in] file The source file (__FILE__)
+             * @param [in] prettyFunc The decorated function name (__PRETTY_FUNCTION__)
+             * @param [in] line The line in the source file (__LINE__)
+             * @param [in] type The log type of the statement
+             * @param [in] marker The log marker of the statement (e.g. >> for entry)
+             */
+            constexpr CallSite
+            (
+                const std::string_view file,
+                const std::string_view prettyFunc,
+                const size_t line,
+                const LOG_TYPE type,
+                const std::string_view marker
+            ) noexcept
+                : m_FileName(extractBaseName(file))
+                , m_Line(line)
+                , m_Type(type)
+                , m_Marker(marker)
+            {
+                extractClassAndFuncName(prettyFunc);
+            }
+
+            /**
+             * @brief Construct a new Call Site object out of the names already extracted,
+             * e.g. for the call sites read back from a binary log (see BinaryLog)
+             *
+             * @param [in] fileName The base name of the source file
+             * @param [in] className The class name, empty for a free function
+             * @param [in] funcName The function name
+             * @param [in] line The line in the source file
+             * @param [in] type The log type of the statement
+             * @param [in] marker The log marker of the statement
+             * @param [in] isLambda Whether the statement is inside of a lambda
+             */
+            constexpr CallSite
+            (
+                const std::string_view fileName,
+                const std::string_view className,
+                const std::string_view funcName,
+                const size_t line,
+                const LOG_TYPE type,
+                const std::string_view marker,
+                const bool isLambda
+            ) noexcept
+                : m_FileName(fileName)
+                , m_ClassName(className)
+                , m_FuncName(funcName)
+                , m_Line(line)
+                , m_Type(type)
+                , m_Marker(marker)
+                , m_IsLambda(isLambda)
+            {
+            }
+
+            ~CallSite() = default;
+            CallSite(const CallSite& rhs) = delete;
+            CallSite(CallSite&& rhs) = delete;
+            CallSite& operator=(const CallSite& rhs) = delete;
+            CallSite& operator=(CallSite&& rhs) = delete;
+
+            constexpr std::string_view fileName() const noexcept       { return m_FileName;    }
+            constexpr std::string_view className() const noexcept      { return m_ClassName;   }
+            constexpr std::string_view functionName() const noexcept   { return m_FuncName;    }
+            constexpr std::string_view marker() const noexcept         { return m_Marker;      }
+            constexpr size_t line() const noexcept                     { return m_Line;        }
+            constexpr LOG_TYPE type() const noexcept                   { return m_Type;        }
+            /**
+             * @brief Whether the statement is inside of a lambda. The class and
+             * function names are then the ones of the function enclosing the lambda.
+             */
+            constexpr bool isLambda() const noexcept                   { return m_IsLambda;    }
+
+        private:
+            static constexpr auto npos = std::string_view::npos;
+
+            static constexpr std::string_view extractBaseName(const std::string_view file) noexcept
+            {
+                auto pos = file.find_last_of("/\\");
+                return (npos == pos) ? file : file.substr(pos + 1);
+            }
+
+            /**
+             * @brief Find the opening bracket matching the closing one at closePos
+             * @return size_t The position of the opening bracket, npos if unbalanced
+             */
+            static constexpr size_t findOpening(const std::string_view str, const size_t closePos, const char open, const char close) noexcept
+            {
+                size_t depth = 0;
+                for (auto pos = closePos + 1; pos-- > 0;)
+                {
+                    if (close == str[pos])
+                        ++depth;
+                    else if (open == str[pos] && 0 == --depth)
+                        return pos;
+                }
+                return npos;
+            }
+
+            /**
+             * @brief Remove the template arguments at the end of a name, if any
+             * e.g. "std::vector<int>" gives "std::vector"
+             */
+            static constexpr std::string_view stripTemplateArgs(const std::string_view name) noexcept
+            {
+                if (!name.ends_with('>'))
+                    return name;
+                auto pos = findOpening(name, name.size() - 1, '<', '>');
+                return (npos == pos) ? name : name.substr(0, pos);
+            }
+
+            /**
+             * @brief Find the start of the last name in a scope, i.e. the position
+             * after the last "::" or white space not inside of any brackets
+             */
+            static constexpr size_t findLastNameStart(const std::string_view scope) noexcept
+            {
+                size_t depth = 0;
+                for (auto pos = scope.size(); pos-- > 0;)
+                {
+                    auto chr = scope[pos];
+                    if ('>' == chr || ')' == chr)
+                        ++depth;
+                    else if (('<' == chr || '(' == chr) && depth > 0)
+                        --depth;
+                    else if (0 == depth && (' ' == chr || ':' == chr))
+                        return pos + 1;
+                }
+                return 0;
+            }
+
+            /**
+             * @brief Extract the class and function names out of __PRETTY_FUNCTION__
+             *
+             * "static std::unique_ptr<std::string> LoggerTest::funcReturnUniquePtr()" gives
+             * the class name "LoggerTest" and the function name "funcReturnUniquePtr".
+             *
+             * Lambdas come as "Scope::Func()::<lambda(const string&)>" on gcc, and as
+             * "Scope::Func()::(anonymous class)::operator()(const std::string &) const"
+             * or "Scope::Func()::(lambda at ...)::operator()(...) const" on clang,
+             * those give the class name "Scope" and the function name "Func".
+             */
+            constexpr void extractClassAndFuncName(std::string_view func) noexcept
+            {
+                // gcc appends the template arguments as " [with T = ...]"
+                if (func.ends_with(']'))
+                {
+                    auto pos = func.rfind(" [with ");
+                    if (npos != pos)
+                        func = func.substr(0, pos);
+                }
+
+                // Cut off the lambdas, innermost first
+                while (true)
+                {
+                    auto pos = func.rfind("::<lambda(");
+                    if (npos == pos)
+                        pos = func.rfind("::(");
+                    if (npos == pos)
+                        break;
+                    func = func.substr(0, pos);
+                    m_IsLambda = true;
+                }
+
+                // Cut off the parameters and any qualifiers (const, &&, ...) after them
+                auto closePos = func.rfind(')');
+                if (npos != closePos)
+                {
+                    auto openPos = findOpening(func, closePos, '(', ')');
+                    if (npos != openPos)
+                        func = func.substr(0, openPos);
+                }
+
+                // Operators contain the characters the names are separated by
+                auto funcPos = func.rfind("operator");
+                if (npos == funcPos || (funcPos > 0 && ':' != func[funcPos - 1] && ' ' != func[funcPos - 1]))
+                {
+                    func = stripTemplateArgs(func);
+                    funcPos = findLastNameStart(func);
+                }
+                m_FuncName = func.substr(funcPos);
+
+                auto scope = func.substr(0, funcPos);
+                if (!scope.ends_with("::"))
+                    return;     // A free function of the global namespace
+                scope = stripTemplateArgs(scope.substr(0, scope.size() - 2));
+                m_ClassName = scope.substr(findLastNameStart(scope));
+            }
+
+            std::string_view m_FileName;
+            std::string_view m_ClassName;
+            std::string_view m_FuncName;
+            size_t m_Line;
+            LOG_TYPE m_Type;
+            std::string_view m_Marker;
+            bool m_IsLambda = false;
+    };
+};  // namespace logger
+
+#endif  // CALL_SITE_HPP
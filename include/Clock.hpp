@@ -40,6 +40,8 @@
 #ifndef CLOCK_HPP
 #define CLOCK_HPP
 
+#include <array>
+#include <ctime>
 #include <chrono>
 #include <thread>
 #include <atomic>
@@ -139,6 +141,37 @@ namespace logger
              * @return The current local time as a formatted string.
              */
             std::string getLocalTimeStr(const std::string_view format = "") const;
+            /**
+             * @brief Formats the current local time into the caller's buffer.
+             *
+             * The date/time part (class's format) goes through localtime_r
+             * and strftime only once per second and is cached in the object.
+             * Within the same second only the sub-second digits are patched in,
+             * so no allocation or time zone lookup happens on this path.
+             *
+             * @param [out] buffer The buffer the time is written to (NUL terminated)
+             * @param [in] size The size of the buffer in bytes
+             * @param [in] subSecondDigits The number of sub-second digits (max 9)
+             *                             appended as ".fff", 0 for none
+             * @return size_t The number of characters written excluding the NUL,
+             *         0 if the buffer is too small to hold the time string.
+             * @note The cache belongs to the object, so an object must not be used
+             *       by several threads in parallel (Logger keeps one per thread).
+             */
+            size_t formatLocalTime(char* buffer, const size_t size, const unsigned subSecondDigits = 0);
+            /**
+             * @brief Formats the given point of time as local time into the caller's buffer.
+             * The same as above, for a point of time taken earlier on (e.g. by another thread).
+             *
+             * @param [in] timePoint The point of time to be formatted
+             * @param [out] buffer The buffer the time is written to (NUL terminated)
+             * @param [in] size The size of the buffer in bytes
+             * @param [in] subSecondDigits The number of sub-second digits (max 9)
+             * @return size_t The number of characters written excluding the NUL,
+             *         0 if the buffer is too small to hold the time string.
+             */
+            size_t formatLocalTime(const std::chrono::system_clock::time_point& timePoint,
+                                   char* buffer, const size_t size, const unsigned subSecondDigits = 0);
             /**
              * @brief Gets the day of the week.
              * @return The day of the week as a string.
@@ -178,6 +211,18 @@ namespace logger
              * @brief The format for time strings.
              */
             const std::string_view m_strFormat = "%d/%m/%Y %H:%M:%S";
+            /**
+             * @brief The second the cached time string was formatted for.
+             */
+            std::time_t m_cachedSec = -1;
+            /**
+             * @brief The length of the cached time string.
+             */
+            size_t m_cachedLen = 0;
+            /**
+             * @brief The cached time string in the class's format.
+             */
+            std::array<char, 80> m_cachedTime{};
             /**
              * @brief A boolean flag to indicate if the timer is running.
              */
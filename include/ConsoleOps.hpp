@@ -48,8 +48,10 @@ namespace logger
             /**
              * @brief Default constructor for ConsoleOps class
              * Initializes the console operations object.
+             *
+             * @param [in] ringCapacity The number of bytes the ring of the records can hold
              */
-            ConsoleOps();
+            explicit ConsoleOps(const size_t ringCapacity = defaultRingCapacity);
 
             /**
              * @brief Destructor for ConsoleOps class
@@ -92,13 +94,21 @@ namespace logger
             /**
              * @brief Write to the out stream object
              *
-             * @param [in] dataQueue The data queue to be written to the out stream object
+             * @param [in] dataArena The batch of records to be written to the out stream object
              * @param [out] excpPtr The exception pointer to be used for exception handling
              *
              * @note This function is thread safe. It uses mutex and condition variable
              * to ensure that only one thread can write to the outstream object at a time.
+             * @note The batch is coalesced into one buffer and written and flushed once.
              */
-            void writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr& excpPtr) override;
+            void writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& excpPtr) override;
+
+            /**
+             * @brief The records drained for a crash go to the standard output
+             *
+             * @return int STDOUT_FILENO
+             */
+            int emergencyFd() const noexcept override;
 
             std::atomic_bool m_testing;
             std::ostringstream m_testStringStream;
@@ -107,6 +117,11 @@ namespace logger
             std::mutex m_mtx;
             std::condition_variable m_cv;
             std::atomic_bool m_isOpsRunning;
+            /**
+             * @brief The buffer a batch is put together in, to be written
+             * with a single call. It is reused for all the batches.
+             */
+            std::string m_WriteBuffer;
     };
 };  // logger namespace
 
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file CrashHandler.hpp
+ * @brief Declaration of the CrashHandler class.
+ *
+ * CrashHandler catches the signals a crash is made of (SIGSEGV, SIGBUS, SIGFPE,
+ * SIGILL and SIGABRT) and writes the records still queued in the ring of a
+ * LoggingOps object straight to its sink (see LoggingOps::emergencyDrain()),
+ * before letting the signal take its course. Without it the records logged
+ * right before a crash, i.e. the interesting ones, die along with the process.
+ *
+ * It is opt-in, as the program may have handlers of its own:
+ *
+ *     logger::CrashHandler::install(loggingOps);
+ */
+
+#ifndef CRASH_HANDLER_HPP
+#define CRASH_HANDLER_HPP
+
+#include "LoggingOps.hpp"
+
+#include <array>
+#include <atomic>
+#include <csignal>
+
+namespace logger
+{
+    class CrashHandler
+    {
+        public:
+            CrashHandler() = delete;
+
+            /**
+             * @brief The signals handled
+             */
+            static constexpr std::array<int, 5> handledSignals = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+            /**
+             * @brief Install the handler for the crash signals
+             * The handlers in place till now are kept and restored (and thereby
+             * called) once the records are written. The handler runs on an
+             * alternate stack, so that a stack overflow gets handled as well,
+             * as long as it happens on the thread calling this.
+             *
+             * @param [in] ops The object whose records are to be drained. It must
+             *                 outlive the handler, or uninstall() must be called first.
+             * @return true If the handler is installed, otherwise
+             * @return false If sigaction() failed, errno tells why
+             * @note Installing it again just changes the object drained.
+             */
+            static bool install(LoggingOps& ops);
+
+            /**
+             * @brief Restore the handlers in place before install()
+             */
+            static void uninstall() noexcept;
+
+            /**
+             * @brief Check whether the handler is installed
+             */
+            static bool isInstalled() noexcept;
+
+        private:
+            /**
+             * @brief The signal handler, async signal safe as it must be
+             */
+            static void handleSignal(int sig, siginfo_t* pInfo, void* pContext) noexcept;
+
+            /**
+             * @brief Set up the alternate signal stack of the calling thread
+             */
+            static void setUpAltStack() noexcept;
+
+            static constexpr size_t m_AltStackSize = 64 * 1024;
+
+            static std::atomic<LoggingOps*> m_pOps;
+            static std::atomic_flag m_isHandling;
+            static std::array<struct sigaction, handledSignals.size()> m_PrevActions;
+    };
+};  // namespace logger
+
+#endif  // CRASH_HANDLER_HPP
@@ -0,0 +1,452 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file DeferredRecord.hpp
+ * @brief Declaration of the DeferredRecord class.
+ *
+ * A deferred record carries everything needed to format a log message later
+ * on: the call site, the thread ID, the time stamp, the format string and the
+ * raw bytes of the arguments. The calling thread only copies those into the
+ * record, the watcher thread of LoggingOps renders it with the same prefix as
+ * a record formatted by the calling thread (see Logger::setDeferredFormatting).
+ *
+ * Record layout:
+ *   [Header][format string][argument 1]...[argument N]
+ * with arithmetic arguments stored as their raw bytes and the strings as
+ * [uint32_t length][characters]. The header holds a pointer to the format
+ * function instantiated for the very argument types, so formatting doesn't
+ * need to look at any type tags. It holds a pointer to the static ArgType array
+ * of the argument types as well, for the consumers walking through the raw
+ * arguments (see BinaryLog). The deferred records are marked as RecordKind::DEFERRED
+ * in the RecordRing, so they are never mistaken for the text (or data) records.
+ *
+ * A structured record (see encodeFields) has the same layout, with the message
+ * in place of the format string and the fields as the arguments, each of them
+ * a key (a string) followed by its value. It has no format function, which is
+ * what tells it apart, so the encoders (see RecordEncoder) get the typed values
+ * as they were logged instead of having to parse them out of the text.
+ */
+
+#ifndef DEFERRED_RECORD_HPP
+#define DEFERRED_RECORD_HPP
+
+#include <array>
+#include <tuple>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <string_view>
+
+namespace logger
+{
+    class CallSite;
+
+    /**
+     * @brief A key-value field of a structured record, see DeferredRecord::encodeFields.
+     * It only refers to the key and the value, so it must not outlive the log statement.
+     */
+    template<typename T>
+    struct Field
+    {
+        std::string_view m_Key;
+        const T& m_Value;
+    };
+
+    /**
+     * @brief Make a key-value field of a structured record, e.g.
+     * LOG_FIELDS(LOG_INFO, "Request served", logger::kv("status", 200));
+     *
+     * @param [in] key The key, expected to be an identifier (it is not quoted in logfmt)
+     * @param [in] value The value, an arithmetic type or a string
+     * @return Field<T> The field referring to both
+     */
+    template<typename T>
+    constexpr Field<T> kv(const std::string_view key, const T& value) noexcept
+    {
+        return Field<T>{key, value};
+    }
+
+    /**
+     * @brief Enum class for the type of an argument of a deferred record.
+     * The integers are told apart by their size and signedness, so the raw
+     * bytes of every argument can be walked through without its C++ type.
+     *
+     * NONE is for the types which can't be deferred.
+     */
+    enum class ArgType : uint8_t
+    {
+        NONE            = 0x00,
+        BOOL            = 0x01,
+        CHAR            = 0x02,
+        INT8            = 0x03,
+        INT16           = 0x04,
+        INT32           = 0x05,
+        INT64           = 0x06,
+        UINT8           = 0x07,
+        UINT16          = 0x08,
+        UINT32          = 0x09,
+        UINT64          = 0x0A,
+        FLOAT           = 0x0B,
+        DOUBLE          = 0x0C,
+        LONG_DOUBLE     = 0x0D,
+        STRING          = 0x0E
+    };
+
+    class DeferredRecord
+    {
+        public:
+            DeferredRecord() = delete;
+
+            /**
+             * @brief The type an argument is stored as, the char
+             * arrays (string literals) decay to C strings.
+             */
+            template<typename T>
+            using StoredType = std::decay_t<std::remove_cvref_t<T>>;
+
+            template<typename T>
+            static constexpr bool isString = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                                             std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+            /**
+             * @brief Get the ArgType a (stored) type is tagged with
+             *
+             * @tparam T The stored type of the argument
+             * @return ArgType The type tag, ArgType::NONE if it can't be deferred
+             */
+            template<typename T>
+            static constexpr ArgType argTypeOf() noexcept
+            {
+                if constexpr (isString<T>)
+                    return ArgType::STRING;
+                else if constexpr (std::is_same_v<T, bool>)
+                    return ArgType::BOOL;
+                else if constexpr (std::is_same_v<T, char>)
+                    return ArgType::CHAR;
+                else if constexpr (std::is_same_v<T, float>)
+                    return ArgType::FLOAT;
+                else if constexpr (std::is_same_v<T, double>)
+                    return ArgType::DOUBLE;
+                else if constexpr (std::is_same_v<T, long double>)
+                    return ArgType::LONG_DOUBLE;
+                else if constexpr (std::is_same_v<T, wchar_t> || std::is_same_v<T, char8_t> ||
+                                   std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>)
+                    return ArgType::NONE;   // Not formattable into a char string anyway
+                else if constexpr (std::is_integral_v<T>)
+                {
+                    constexpr ArgType intTypes[] = { ArgType::INT8, ArgType::INT16, ArgType::INT32, ArgType::INT64 };
+                    constexpr ArgType uintTypes[] = { ArgType::UINT8, ArgType::UINT16, ArgType::UINT32, ArgType::UINT64 };
+                    constexpr size_t idx = (sizeof(T) == 1) ? 0 : (sizeof(T) == 2) ? 1 : (sizeof(T) == 4) ? 2 : 3;
+                    return std::is_signed_v<T> ? intTypes[idx] : uintTypes[idx];
+                }
+                else
+                    return ArgType::NONE;
+            }
+
+            /**
+             * @brief Whether all the argument types can be stored in a deferred
+             * record, which are the arithmetic types (including bool and char)
+             * and strings (std::string, std::string_view, C strings).
+             */
+            template<typename ...Args>
+            static constexpr bool isDeferrable = ((ArgType::NONE != argTypeOf<StoredType<Args>>()) && ...);
+
+            /**
+             * @brief The fields of a deferred record, as needed by the consumers
+             * other than render(). The views point into the record.
+             */
+            struct Fields
+            {
+                const CallSite* m_pCallSite;
+                std::thread::id m_ThreadId;
+                int64_t m_TimeStampNs;
+                std::string_view m_FormatStr;
+                const ArgType* m_pArgTypes;
+                uint32_t m_ArgsCnt;
+                std::string_view m_Args;
+                bool m_isStructured;            // The format string is the message, the arguments are key-value pairs
+            };
+
+            /**
+             * @brief Encode a log message into a deferred record
+             *
+             * @tparam Args The argument types, must satisfy isDeferrable
+             * @param [out] record The buffer the record is written to, it keeps its memory
+             * @param [in] site The call site of the log statement
+             * @param [in] tid The thread ID of the thread logging the message
+             * @param [in] timeStamp The point of time the message is logged at
+             * @param [in] formatStr The format string, copied into the record
+             * @param [in] args The arguments to be formatted
+             */
+            template<typename ...Args>
+            static void encode
+            (
+                std::string& record,
+                const CallSite& site,
+                const std::thread::id& tid,
+                const std::chrono::system_clock::time_point& timeStamp,
+                const std::string_view formatStr,
+                const Args&... args
+            )
+            {
+                static_assert(isDeferrable<Args...>, "Only the arithmetic types and strings can be deferred");
+
+                Header header{};
+                header.m_FormatFunc = &formatArgs<StoredType<Args>...>;
+                header.m_pArgTypes = argTypes<StoredType<Args>...>.data();
+                header.m_ArgsCnt = static_cast<uint32_t>(sizeof...(Args));
+                header.m_pCallSite = &site;
+                header.m_ThreadId = tid;
+                header.m_TimeStampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(timeStamp.time_since_epoch()).count();
+                header.m_FormatSize = static_cast<uint32_t>(formatStr.size());
+
+                record.resize(sizeof(Header) + formatStr.size() + (encodedSize<StoredType<Args>>(args) + ... + 0));
+                auto pos = record.data();
+                std::memcpy(pos, &header, sizeof(Header));
+                pos += sizeof(Header);
+                std::memcpy(pos, formatStr.data(), formatStr.size());
+                pos += formatStr.size();
+                (encodeArg<StoredType<Args>>(pos, args), ...);
+            }
+
+            /**
+             * @brief Encode a structured log message, i.e. a message and typed
+             * key-value fields, into a deferred record
+             *
+             * @tparam Values The value types, must satisfy isDeferrable
+             * @param [out] record The buffer the record is written to, it keeps its memory
+             * @param [in] site The call site of the log statement
+             * @param [in] tid The thread ID of the thread logging the message
+             * @param [in] timeStamp The point of time the message is logged at
+             * @param [in] msg The message, copied into the record as it is
+             * @param [in] fields The key-value fields, see kv()
+             * @note Rendered as text it is the message followed by the fields in
+             *       logfmt, e.g. Request served path=/index.html status=200
+             */
+            template<typename ...Values>
+            static void encodeFields
+            (
+                std::string& record,
+                const CallSite& site,
+                const std::thread::id& tid,
+                const std::chrono::system_clock::time_point& timeStamp,
+                const std::string_view msg,
+                const Field<Values>&... fields
+            )
+            {
+                static_assert(isDeferrable<Values...>, "Only the arithmetic types and strings can be field values");
+
+                Header header{};
+                header.m_FormatFunc = nullptr;      // Marks the structured record
+                header.m_pArgTypes = fieldTypes<StoredType<Values>...>.data();
+                header.m_ArgsCnt = static_cast<uint32_t>(2 * sizeof...(Values));
+                header.m_pCallSite = &site;
+                header.m_ThreadId = tid;
+                header.m_TimeStampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(timeStamp.time_since_epoch()).count();
+                header.m_FormatSize = static_cast<uint32_t>(msg.size());
+
+                record.resize(sizeof(Header) + msg.size() +
+                              ((encodedSize<std::string_view>(fields.m_Key) + encodedSize<StoredType<Values>>(fields.m_Value)) + ... + 0));
+                auto pos = record.data();
+                std::memcpy(pos, &header, sizeof(Header));
+                pos += sizeof(Header);
+                std::memcpy(pos, msg.data(), msg.size());
+                pos += msg.size();
+                ((encodeArg<std::string_view>(pos, fields.m_Key), encodeArg<StoredType<Values>>(pos, fields.m_Value)), ...);
+            }
+
+            /**
+             * @brief Format the message of a deferred record, without the prefix
+             *
+             * @param [in] record The deferred record
+             * @param [out] msg The message, a structured record's one followed by its fields in logfmt
+             * @note A format error doesn't get lost either, the message then
+             *       carries the format string and the error instead.
+             */
+            static void formatMessage(const std::string_view record, std::string& msg);
+
+            /**
+             * @brief Append an argument as the "{}" replacement field formats it
+             *
+             * @param [in] type The type of the argument
+             * @param [in] bytes The raw bytes of the argument, see nextArg()
+             * @param [out] out The text the argument is appended to
+             */
+            static void appendValue(const ArgType type, const std::string_view bytes, std::string& out);
+
+            /**
+             * @brief Render a deferred record into the final log line
+             *
+             * @param [in] record The deferred record
+             * @param [out] line The rendered log line, prefix and message
+             * @note A format error doesn't get lost either, the line then
+             *       carries the format string and the error instead.
+             */
+            static void render(const std::string_view record, std::string& line);
+
+            /**
+             * @brief Get the fields of a deferred record
+             *
+             * @param [in] record The deferred record
+             * @return Fields The fields, with views into the record
+             */
+            static Fields decode(const std::string_view record) noexcept;
+
+            /**
+             * @brief Get the raw bytes of the next argument and move past it
+             *
+             * @param [in] type The type of the argument
+             * @param [in,out] args The remaining arguments, the argument is removed from
+             * @return std::string_view The raw bytes of an arithmetic argument,
+             *         the characters of a string argument
+             */
+            static std::string_view nextArg(const ArgType type, std::string_view& args) noexcept;
+
+        private:
+            using FormatFunc = void (*)(std::string& msg, const std::string_view formatStr, const char* pArgs);
+
+            struct Header
+            {
+                FormatFunc m_FormatFunc;
+                const CallSite* m_pCallSite;
+                const ArgType* m_pArgTypes;
+                std::thread::id m_ThreadId;
+                int64_t m_TimeStampNs;
+                uint32_t m_FormatSize;
+                uint32_t m_ArgsCnt;
+            };
+            static_assert(std::is_trivially_copyable_v<std::thread::id>, "The thread ID is copied as raw bytes");
+
+            using LengthType = uint32_t;
+
+            /**
+             * @brief The type tags of the argument types, one array per instantiation
+             */
+            template<typename ...Args>
+            static constexpr std::array<ArgType, sizeof...(Args)> argTypes{ argTypeOf<Args>()... };
+
+            /**
+             * @brief The type tags of the key-value pairs of a structured record, one array per instantiation
+             */
+            template<typename ...Values>
+            static constexpr std::array<ArgType, 2 * sizeof...(Values)> fieldTypes = []
+            {
+                std::array<ArgType, 2 * sizeof...(Values)> types{};
+                [[maybe_unused]] size_t idx = 0;
+                ((types[idx++] = ArgType::STRING, types[idx++] = argTypeOf<Values>()), ...);
+                return types;
+            }();
+
+            /**
+             * @brief The type an argument is formatted as, the strings are
+             * views into the record.
+             */
+            template<typename T>
+            using DecodedType = std::conditional_t<isString<T>, std::string_view, T>;
+
+            template<typename Arg>
+            static inline std::string_view asStringView(const Arg& arg) noexcept
+            {
+                if constexpr (std::is_pointer_v<std::decay_t<Arg>>)
+                {
+                    const char* pStr = arg;
+                    return (nullptr == pStr) ? std::string_view() : std::string_view(pStr);
+                }
+                else
+                {
+                    return std::string_view(arg);
+                }
+            }
+
+            template<typename T, typename Arg>
+            static inline size_t encodedSize(const Arg& arg) noexcept
+            {
+                if constexpr (isString<T>)
+                    return sizeof(LengthType) + asStringView(arg).size();
+                else
+                    return sizeof(T);
+            }
+
+            template<typename T, typename Arg>
+            static inline void encodeArg(char*& pos, const Arg& arg) noexcept
+            {
+                if constexpr (isString<T>)
+                {
+                    auto str = asStringView(arg);
+                    auto len = static_cast<LengthType>(str.size());
+                    std::memcpy(pos, &len, sizeof(LengthType));
+                    std::memcpy(pos + sizeof(LengthType), str.data(), str.size());
+                    pos += sizeof(LengthType) + str.size();
+                }
+                else
+                {
+                    T val = arg;
+                    std::memcpy(pos, &val, sizeof(T));
+                    pos += sizeof(T);
+                }
+            }
+
+            template<typename T>
+            static inline DecodedType<T> decodeArg(const char*& pos) noexcept
+            {
+                if constexpr (isString<T>)
+                {
+                    LengthType len = 0;
+                    std::memcpy(&len, pos, sizeof(LengthType));
+                    std::string_view str(pos + sizeof(LengthType), len);
+                    pos += sizeof(LengthType) + len;
+                    return str;
+                }
+                else
+                {
+                    T val{};
+                    std::memcpy(&val, pos, sizeof(T));
+                    pos += sizeof(T);
+                    return val;
+                }
+            }
+
+            /**
+             * @brief Decode the arguments in order and format them.
+             * Instantiated per argument types by encode(), the record keeps the pointer
+             */
+            template<typename ...Args>
+            static void formatArgs(std::string& msg, const std::string_view formatStr, [[maybe_unused]] const char* pArgs)
+            {
+                // The braced initialization evaluates the decodes from left to right
+                std::tuple<DecodedType<Args>...> args{ decodeArg<Args>(pArgs)... };
+                std::apply([&msg, formatStr](auto&... vals)
+                {
+                    std::vformat_to(std::back_inserter(msg), formatStr, std::make_format_args(vals...));
+                }, args);
+            }
+    };
+};  // namespace logger
+
+#endif  // DEFERRED_RECORD_HPP
@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file FanOutOps.hpp
+ * @brief Declaration of the FanOutOps class.
+ *
+ * FanOutOps hands every record over to several sinks at once, e.g. the console
+ * for the warnings and errors along with a file getting everything. Each sink is
+ * a LoggingOps object of its own, i.e. with its own ring, watcher thread, batching
+ * and overflow policy, so a slow sink only fills up its own ring. The records are
+ * formatted once (by the calling thread, or for a deferred record by the watcher
+ * thread of the only sink formatting it) and just copied into the rings.
+ */
+
+#ifndef FAN_OUT_OPS_HPP
+#define FAN_OUT_OPS_HPP
+
+#include "Logger.hpp"
+#include "LoggingOps.hpp"
+
+#include <memory>
+#include <shared_mutex>
+
+namespace logger
+{
+    class FanOutOps : public LoggingOps
+    {
+        public:
+            /**
+             * @brief Construct a new Fan Out Ops object without any sink.
+             * It has no watcher thread of its own, the sinks have theirs.
+             */
+            FanOutOps();
+
+            /**
+             * @brief Destructor for FanOutOps class
+             * The sinks are destroyed (i.e. drained) along with it, unless
+             * they are still shared with somebody else.
+             */
+            virtual ~FanOutOps();
+
+            /**
+             * @brief Deleted copy constructor and move constructor
+             * to prevent copying and moving of FanOutOps objects
+             */
+            FanOutOps(const FanOutOps& rhs) = delete;
+            FanOutOps(FanOutOps&& rhs) = delete;
+            FanOutOps& operator=(const FanOutOps& rhs) = delete;
+            FanOutOps& operator=(FanOutOps&& rhs) = delete;
+
+            /**
+             * @brief Add a sink
+             *
+             * @param [in] sink The sink, e.g. a FileOps or ConsoleOps object
+             * @param [in] level The least severe log type the sink gets. The records
+             *                   written without a log type go to every sink.
+             * @return FanOutOps& The object itself, for chaining
+             * @note The overflow policy of the sink decides what happens once it
+             *       falls behind. With OverflowPolicy::BLOCK its producers wait for
+             *       it, so a sink which must never hold back the others has to be
+             *       given OverflowPolicy::DROP_NEWEST or OVERWRITE_OLDEST.
+             * @note Whether the sink keeps the deferred records (e.g. the binary
+             *       file format) or has a record encoder is looked at here, so
+             *       both have to be set before.
+             */
+            FanOutOps& addSink(const std::shared_ptr<LoggingOps>& sink, const LOG_TYPE level);
+
+            /**
+             * @brief Remove a sink, the records written so far are still written by it
+             *
+             * @param [in] sink The sink to be removed
+             * @return true If the sink was found and removed, otherwise
+             * @return false
+             */
+            bool removeSink(const std::shared_ptr<LoggingOps>& sink);
+
+            /**
+             * @brief Change the least severe log type a sink gets
+             *
+             * @param [in] sink The sink
+             * @param [in] level The least severe log type the sink gets
+             * @return true If the sink was found, otherwise
+             * @return false
+             */
+            bool setSinkLevel(const std::shared_ptr<LoggingOps>& sink, const LOG_TYPE level);
+
+            /**
+             * @brief Get the number of sinks
+             *
+             * @return size_t The number of sinks
+             */
+            size_t getSinksCount() const;
+
+            /**
+             * @brief Flush every sink
+             *
+             * @param [in] level How far the records have to go, see LoggingOps::flush()
+             * @note The sinks are flushed one after the other, each of them
+             *       waits only for its own records.
+             */
+            void flush(const FlushLevel level = FlushLevel::WRITTEN) override;
+
+            /**
+             * @brief Drain the queued records of every sink straight to it, for a crash
+             *
+             * @return size_t The number of records written
+             * @note The sinks are gone through without the lock, see LoggingOps::emergencyDrain()
+             */
+            size_t emergencyDrain() noexcept override;
+
+            /**
+             * @brief Get the Class Id for the object
+             *
+             * @return std::string The class id of the object
+             * @see LoggingOps::getClassId()
+             */
+            inline const std::string getClassId() const override { return "FanOutOps"; }
+
+        protected:
+            /**
+             * @brief Hand the record over to every sink its log type passes
+             *
+             * @param [in] data The record, either plain text or a deferred record
+             * @note A deferred record is kept as is for the sinks keeping the deferred
+             *       records or encoding them, and for a single sink formatting it. If
+             *       more sinks format it, it is formatted here once and they get the text.
+             */
+            void writeDataTo(const std::string_view data) override;
+
+        private:
+            struct Sink
+            {
+                std::shared_ptr<LoggingOps> m_pOps;
+                LOG_TYPE m_Level;
+            };
+
+            /**
+             * @brief Update the flag telling the deferred records are kept,
+             * it is if any of the sinks keeps them. The lock must be held.
+             */
+            void updateKeepsDeferredRecords() noexcept;
+
+            /**
+             * @brief The sinks. The producers only ever take the shared lock,
+             * the exclusive one is for adding or removing a sink.
+             */
+            mutable std::shared_mutex m_SinksMtx;
+            std::vector<Sink> m_Sinks;
+    };
+};  // namespace logger
+
+#endif  // FAN_OUT_OPS_HPP
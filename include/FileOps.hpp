@@ -34,15 +34,87 @@
 #define FILE_OPS_HPP
 
 #include "LoggingOps.hpp"
+#include "BinaryLog.hpp"
+#include "BlockCompression.hpp"
+#include "LineIndex.hpp"
 
+#include <queue>
+#include <functional>
 #include <fstream>
 #include <string>
 #include <filesystem>
 
+#include <sys/uio.h>
+
 namespace logger
 {
     using DataQ = std::queue<std::string>;
 
+    /**
+     * @brief Enum class for the compression of the log file.
+     *
+     * NONE : The records are written as they are.
+     * LZ4  : The records of a batch are compressed into blocks (see BlockCompression)
+     *        while writing. The read functions of FileOps decompress the file by
+     *        themselves, the byte ranges are the ones of the decompressed content.
+     */
+    enum class FileCompression
+    {
+        NONE        = 0x00,
+        LZ4         = 0x01
+    };
+
+    /**
+     * @brief Enum class for the format of the log file.
+     *
+     * TEXT   : The formatted lines, human readable.
+     * BINARY : The compact binary log format (see BinaryLog). The LOG_* statements
+     *          are not formatted at all, the read functions of FileOps and the
+     *          LogDecoder tool render them back to the very same text lines.
+     */
+    enum class FileFormat
+    {
+        TEXT        = 0x01,
+        BINARY      = 0x02
+    };
+
+    /**
+     * @brief Enum class for the way the records get into the log file.
+     *
+     * WRITE : writev() on the file descriptor, one call per batch.
+     * MMAP  : The file is preallocated to the max file size and mapped, the batches
+     *         are copied straight into the mapping, without any system call. The next
+     *         file is created, preallocated and mapped ahead, once the active one is
+     *         half full, so the rotation just swaps it in. The file is truncated to
+     *         its logged size when closed (or rotated).
+     *
+     * @note In MMAP mode the data is only as durable as the page cache, till a flush
+     *       with FlushLevel::DATA_SYNC or FULL_SYNC (msync). A hidden marker file is
+     *       next to the log file for as long as it is mapped. A file left over by
+     *       a process died with it mapped keeps the marker, along with the zero bytes
+     *       of its preallocated space, so it is rotated away (not appended to) when
+     *       it is opened again.
+     */
+    enum class FileIoMode
+    {
+        WRITE       = 0x01,
+        MMAP        = 0x02
+    };
+
+    /**
+     * @brief The policy deciding how many of the rotated log files are kept.
+     * The oldest ones are removed first, by the watcher thread right after a
+     * rotation. A limit of 0 means no limit.
+     *
+     * maxFiles      : The number of rotated files kept, the active one not counted
+     * maxTotalBytes : The size of all the rotated files kept together
+     */
+    struct RetentionPolicy
+    {
+        size_t maxFiles = 0;
+        std::uintmax_t maxTotalBytes = 0;
+    };
+
     class FileOps : public LoggingOps
     {
         public:
@@ -128,6 +200,8 @@ namespace logger
              *       std::vector<std::exception_ptr> m_excpPtrVec
              *       and can be accessed using getAllExceptions() function.
              * @note This function is not thread safe. The caller must ensure thread safety.
+             * @note A compressed file is decompressed first, the range is the one of
+             *       the decompressed content.
              *
              * @param [in] file The FileOps object
              * @param [in] start The start position of the range
@@ -162,6 +236,10 @@ namespace logger
              * @param [out] outBuf The output buffer to store the read lines
              * @note The outBuf will be cleared before reading the lines.
              *       If no lines are read, it will remain empty.
+             * @note A compressed file is decompressed and a binary log file is
+             *       rendered back to the text lines first.
+             * @note A plain text file is read from the nearest line of its line
+             *       index, see LineIndex, instead of from its start.
              * @return true If the read was successful and lines were read,
              *         otherwise
              * @return false
@@ -171,6 +249,32 @@ namespace logger
                                     const size_t endLineNo,
                                     std::vector<std::string>& outBuf);
 
+            /**
+             * @brief Read the lines logged within a range of time
+             * The time of a line is the timestamp of its prefix, the lines without
+             * a prefix of their own (i.e. the rest of a multi line record) go along
+             * with the line before them.
+             *
+             * @note Throws exceptions which is collected in the static
+             *      std::vector<std::exception_ptr> m_excpPtrVec
+             *      and can be accessed using getAllExceptions() function.
+             *
+             * @param [in] file The FileOps object
+             * @param [in] startTime The start of the range (inclusive)
+             * @param [in] endTime The end of the range (inclusive, to the second)
+             * @param [out] outBuf The output buffer to store the read lines, cleared first
+             * @note The timestamps are the ones of DEFAULT_TIME_FORMAT, in local time.
+             * @note A plain text file is read from the nearest line of its line
+             *       index, see LineIndex, instead of from its start.
+             * @return true If the read was successful, even if no line is in the range,
+             *         otherwise
+             * @return false
+             */
+            static bool readFileTimeRange(FileOps& file,
+                                    const std::chrono::system_clock::time_point& startTime,
+                                    const std::chrono::system_clock::time_point& endTime,
+                                    std::vector<std::string>& outBuf);
+
 
             /**
              * @brief Construct a new File Ops object
@@ -189,15 +293,16 @@ namespace logger
              * @param [in] fileName Name of the file (default blank)
              * @param [in] filePath Path where file would be placed eventually (default current path)
              * @param [in] fileExtension Extension of the file like .txt or .log etc. (default .txt)
+             * @param [in] ringCapacity The number of bytes the ring of the records can hold
              * @note The max file size should be greater than
-             * the max line length allowed, which is 4096 bytes
-             * or 4KB, defined as bufferSize to prevent truncation
-             * if you are writing single line length to its full capacity.
+             * the longest line you are writing, as a single line
+             * is never split across the files.
              */
             FileOps(const std::uintmax_t maxFileSize,
                     const std::string_view fileName = "",
                     const std::string_view filePath = "",
-                    const std::string_view fileExtension = "");
+                    const std::string_view fileExtension = "",
+                    const size_t ringCapacity = defaultRingCapacity);
 
             /**
              * @brief Destroy the File Ops object
@@ -263,13 +368,69 @@ namespace logger
              *
              * @param [in] fileSize Maximum size of the file
              * @note The max file size should be greater than
-             * the max line length allowed, which is 4096 bytes
-             * or 4KB, defined as bufferSize to prevent truncation
-             * if you are writing single line length to its full capacity.
+             * the longest line you are writing, as a single line
+             * is never split across the files.
              * @return FileOps& Refrence to the current object
              */
             inline FileOps& setMaxFileSize(const std::uintmax_t fileSize)   { m_MaxFileSize = fileSize; return *this;           }
 
+            /**
+             * @brief Set the format of the log file
+             * The records logged so far are written in the old format first,
+             * and the next record goes to the file in the new one.
+             *
+             * @param [in] format The file format
+             * @note A file should be written in a single format only, so it is
+             * meant to be set before logging to the file (or along with a new file name).
+             * @return FileOps& Refrence to the current object
+             */
+            FileOps& setFileFormat(const FileFormat format);
+
+            /**
+             * @brief Set the compression of the log file
+             * The records logged so far are written the old way first,
+             * and the next record goes to the file compressed (or not).
+             *
+             * @param [in] compression The file compression
+             * @note A file should be written either compressed or not, so it is meant
+             * to be set before logging to the file (or along with a new file name).
+             * With a compression the max file size is checked per block (of about
+             * BlockCompression::blockSize bytes) instead of per record.
+             * @return FileOps& Refrence to the current object
+             */
+            FileOps& setFileCompression(const FileCompression compression);
+
+            /**
+             * @brief Set the way the records get into the log file
+             * The records logged so far are written the old way first,
+             * and the next record goes to the file the new way.
+             *
+             * @param [in] mode The file I/O mode
+             * @note Nothing else may truncate the file while it is mapped.
+             * @return FileOps& Refrence to the current object
+             */
+            FileOps& setFileIoMode(const FileIoMode mode);
+
+            /**
+             * @brief Rotate the log file by time as well, besides by its size
+             *
+             * @param [in] interval The time a file is written to at most, counted from
+             *                      the moment it is opened. 0 (default) turns it off.
+             * @note The rotation happens with the first batch written once the interval
+             *       is over, a file nothing is logged to meanwhile is left as it is.
+             * @return FileOps& Refrence to the current object
+             */
+            FileOps& setRotationInterval(const std::chrono::seconds interval);
+
+            /**
+             * @brief Set how many of the rotated log files are kept
+             *
+             * @param [in] policy The retention policy, see RetentionPolicy
+             * @note Applied with the next batch written, and after every rotation.
+             * @return FileOps& Refrence to the current object
+             */
+            FileOps& setRetentionPolicy(const RetentionPolicy& policy);
+
             /**
              * @brief Get the file name
              *
@@ -300,15 +461,45 @@ namespace logger
              * @return std::uintmax_t The maximum file size
              */
             inline std::uintmax_t getMaxFileSize() const                    { return m_MaxFileSize;                             }
+
+            /**
+             * @brief Get the format of the log file
+             *
+             * @return FileFormat The file format
+             */
+            inline FileFormat getFileFormat() const                         { return m_FileFormat;                              }
+
+            /**
+             * @brief Get the compression of the log file
+             *
+             * @return FileCompression The file compression
+             */
+            inline FileCompression getFileCompression() const               { return m_FileCompression;                         }
+            /**
+             * @brief Get the way the records get into the log file
+             *
+             * @return FileIoMode The file I/O mode
+             */
+            inline FileIoMode getFileIoMode() const                         { return m_FileIoMode;                              }
+            /**
+             * @brief Get the time a log file is written to at most
+             *
+             * @return std::chrono::seconds The rotation interval, 0 if turned off
+             */
+            inline std::chrono::seconds getRotationInterval() const          { return m_RotationInterval;                        }
+            /**
+             * @brief Get how many of the rotated log files are kept
+             *
+             * @return RetentionPolicy The retention policy
+             */
+            RetentionPolicy getRetentionPolicy();
             /**
              * @brief Get the file content
              *
-             * @return DataQ The file content which is a queue of shared pointers
-             *               to strings. The strings are the lines of the file.
-             *               The queue is thread safe and can be accessed by multiple
-             *               threads at the same time.
+             * @return const DataQ& The file content, i.e. the lines of the file as read by readFile()
+             * @note It holds the whole file, a big one is better read with readFile(lineHandler).
              */
-            inline DataQ getFileContent() const                             { return m_FileContent;                             }
+            inline const DataQ& getFileContent() const                      { return m_FileContent;                             }
             /**
              * @brief Checks if the file path is empty or not
              *
@@ -362,6 +553,8 @@ namespace logger
              * @note Before reading it makes sure if there is any data in the data records queue
              * which is yet to be processed. If there is, then it signals the file watcher thread
              * to process the data first before reading the file. Thread safe.
+             * @note A compressed file is decompressed and a binary log file is
+             * rendered back to the text lines.
              *
              * @see keepWatchAndPull
              * @see writeToFile
@@ -370,6 +563,23 @@ namespace logger
              */
             void readFile();
 
+            /**
+             * @brief Read the file line by line, without keeping any of it
+             * The lines are handed over one at a time as views into a buffer of a
+             * bounded size (see LogReader), whatever the size of the file. The writer
+             * may go on appending to the file meanwhile.
+             *
+             * @param [in] lineHandler Called for every line (without its new line), the
+             *                         view is valid only for the call. Returning false
+             *                         stops the read.
+             * @return size_t The number of lines read
+             * @note Before reading it makes sure the records pushed so far are written.
+             * @note Throws std::runtime_error if the file can't be opened or is corrupt.
+             * @note A compressed file is decompressed and a binary log file is
+             * rendered back to the text lines.
+             */
+            size_t readFile(const std::function<bool(const std::string_view)>& lineHandler);
+
             /**
              * @brief Create a File object.
              * Creates a file if it does not exist.
@@ -410,13 +620,40 @@ namespace logger
             /**
              * @brief Write to the out stream object
              *
-             * @param [in] dataQueue The data queue to be written to the out stream object
+             * @param [in] dataArena The batch of records to be written to the out stream object
              * @param [out] excpPtr The exception pointer to be used for exception handling
              *
              * @note This function is thread safe. It uses mutex and condition variable
              * to ensure that only one thread can write to the outstream object at a time.
+             * @note The whole batch goes to the long lived file descriptor of the
+             * active log file with a single writev() (one per IOV_MAX/2 records). The file is only (re)opened when it is not
+             * open yet, i.e. for the first batch and after the file got renamed,
+             * deleted, created or its path changed.
+             * @note The rotation is decided here as well, against the tracked size
+             * of the file. So is the creation of the file if it doesn't exist.
+             */
+            void writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& excpPtr) override;
+
+            /**
+             * @brief Sync the active log file to the storage
+             *
+             * @param [in] level FlushLevel::DATA_SYNC for fdatasync, FlushLevel::FULL_SYNC for fsync
+             * @param [out] excpPtr The exception pointer to be used for exception handling
+             * @note Only the active log file is synced. The files rotated before
+             * are synced right before they are renamed, if a sync level flush
+             * happened on them at all.
              */
-            void writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr& excpPtr) override;
+            void syncOutStreamObject(const FlushLevel level, std::exception_ptr& excpPtr) override;
+
+            /**
+             * @brief Get the file descriptor the records drained for a crash go to
+             *
+             * @return int The descriptor of the active log file, as long as it is a
+             *         plain text file written with write(). The records would corrupt
+             *         a compressed, binary or mapped file, so those go to the standard error,
+             *         as do the ones of a file not opened yet (it is opened by the first batch).
+             */
+            int emergencyFd() const noexcept override;
 
             /**
              * @brief Write data to the out stream object
@@ -439,16 +676,207 @@ namespace logger
              */
             void populateFilePathObj(const StdTupple& fileDetails);
 
+            /**
+             * @brief Open the active log file for appending, if not already open
+             *
+             * @return true If the file descriptor is valid, otherwise
+             * @return false
+             * @note The caller must hold m_FileOpsMutex
+             */
+            bool openOutFile() noexcept;
+
+            /**
+             * @brief Close the file descriptor of the active log file (if open)
+             * The next batch written reopens the file at m_FilePathObj.
+             *
+             * @param [in] isReopened Set if the watcher thread opens the file again
+             *                        right away (i.e. rotating it), so the producers
+             *                        keep taking it as open and never wait for it
+             * @note The caller must hold m_FileOpsMutex
+             */
+            void closeOutFile(const bool isReopened = false) noexcept;
+
+            /**
+             * @brief Rotate the active log file
+             * Renames it with the current time stamp (and a sequence number if
+             * rotated more than once within a second) and opens a new blank one.
+             *
+             * @return true If the file is rotated and the new one is open, otherwise
+             * @return false
+             * @note The caller must hold m_FileOpsMutex
+             */
+            bool rotateOutFile() noexcept;
+
+            /**
+             * @brief Get the path the active log file is renamed to when rotated,
+             * i.e. with the current time stamp (and a sequence number if needed)
+             *
+             * @return std::filesystem::path The path, not taken by any file
+             */
+            std::filesystem::path rotatedFilePath() const;
+
+            /**
+             * @brief Check if the rotation interval of the active log file is over
+             *
+             * @note The caller must hold m_FileOpsMutex
+             */
+            bool isRotationDue() const noexcept;
+
+            /**
+             * @brief Check if the active log file is half way to its rotation,
+             * either by its size or by time, so the next one is to be prepared
+             *
+             * @note The caller must hold m_FileOpsMutex
+             */
+            bool isRotationNear() const noexcept;
+
+            /**
+             * @brief Get the rotated log files beyond the retention policy, the
+             * oldest (by their last write) ones going first
+             *
+             * @return std::vector<std::filesystem::path> The files to be removed
+             * @note The caller must hold m_FileOpsMutex
+             */
+            std::vector<std::filesystem::path> expiredFiles() const;
+
+            /**
+             * @brief Write the collected data to the active log file, either with
+             * writev() or, if it is mapped, by copying it into the mapping
+             *
+             * @param [in] pIoVecs The data to be written
+             * @param [in] ioVecCnt The number of entries in pIoVecs
+             * @return true If all the data is written, otherwise
+             * @return false
+             * @note The caller must hold m_FileOpsMutex
+             */
+            bool writeOut(struct iovec* pIoVecs, const size_t ioVecCnt) noexcept;
+
+            /**
+             * @brief Sync the active log file to the storage, a mapped one
+             * with msync() first
+             *
+             * @param [in] level FlushLevel::DATA_SYNC or FlushLevel::FULL_SYNC
+             * @return int 0 on success, otherwise -1 (with errno set)
+             * @note The caller must hold m_FileOpsMutex
+             */
+            int syncOutFile(const FlushLevel level) noexcept;
+
+            /**
+             * @brief (Re)map the active log file, preallocated to the given size
+             *
+             * @param [in] size The size of the mapping, at least the logged size
+             * @return true If the file is mapped, otherwise
+             * @return false
+             * @note The caller must hold m_FileOpsMutex
+             */
+            bool mapOutFile(const std::uintmax_t size) noexcept;
+
+            /**
+             * @brief Unmap the active log file (if mapped) and truncate
+             * it to the size actually logged
+             *
+             * @note The caller must hold m_FileOpsMutex
+             */
+            void unmapOutFile() noexcept;
+
+            /**
+             * @brief Create the file the active one is replaced with by the next
+             * rotation, preallocated and mapped as well in MMAP mode
+             *
+             * @note The caller must hold m_FileOpsMutex. A failure isn't fatal,
+             * the rotation opens a new file then.
+             */
+            void prepareNextSegment() noexcept;
+
+            /**
+             * @brief Remove the file prepared for the next rotation (if any)
+             *
+             * @note The caller must hold m_FileOpsMutex
+             */
+            void discardNextSegment() noexcept;
+
+            /**
+             * @brief Encode a batch into the binary log format and collect it
+             * for writing, rotating the file whenever it is full
+             *
+             * @param [in] dataArena The batch of records to be written to the file
+             * @param [out] errMsg The error message, if the file can't be rotated
+             * @return true If the batch is collected, otherwise
+             * @return false If a write failed
+             */
+            bool collectBinaryRecords(const RecordArena& dataArena, std::string& errMsg);
+
+            /**
+             * @brief Compress a batch (in the file format) into blocks and collect
+             * them for writing, rotating the file whenever it is full
+             *
+             * @param [in] dataArena The batch of records to be written to the file
+             * @param [out] errMsg The error message, if the file can't be rotated
+             * @return true If the batch is collected, otherwise
+             * @return false If a write failed
+             */
+            bool collectCompressedRecords(const RecordArena& dataArena, std::string& errMsg);
+
             /// Data members for file opening, closing, reading and writing
             std::string m_FileName;
             std::string m_FilePath;
             std::string m_FileExtension;
             DataQ m_FileContent;
             std::filesystem::path m_FilePathObj;
-            std::uintmax_t m_MaxFileSize;
+            std::atomic<std::uintmax_t> m_MaxFileSize;
             std::mutex m_FileOpsMutex;
             std::condition_variable m_FileOpsCv;
             std::atomic_bool m_isFileOpsRunning;
+            /**
+             * @brief The file descriptor of the active log file, owned by the
+             * watcher thread for the life of the file (-1 when not open) and
+             * the iovec array pointing to the records of the batch being written.
+             * The size of the file is tracked by the writes, so the producers
+             * never have to query the file system for it.
+             */
+            int m_OutFd;
+            std::atomic_bool m_isOutFileOpen;
+            FlushLevel m_RotationSyncLevel;
+            std::uintmax_t m_CurrFileSize;
+            std::vector<struct iovec> m_IoVecs;
+            /**
+             * @brief The format and the compression of the file, the writer keeping
+             * the string table of the active binary log file, the buffer a batch is
+             * encoded (or compressed) in and the one a block is collected in
+             */
+            std::atomic<FileFormat> m_FileFormat;
+            std::atomic<FileCompression> m_FileCompression;
+            BinaryLogWriter m_BinaryWriter;
+            std::string m_EncodedBuffer;
+            std::string m_RawBlock;
+            /**
+             * @brief The I/O mode of the file, and in MMAP mode the mapping of the
+             * active log file, its size and the position the next batch is copied
+             * to, along with the file prepared for the next rotation.
+             */
+            std::atomic<FileIoMode> m_FileIoMode;
+            char* m_pMapping;
+            std::uintmax_t m_MappingSize;
+            std::uintmax_t m_MappedPos;
+            int m_NextFd;
+            char* m_pNextMapping;
+            std::uintmax_t m_NextMappingSize;
+            std::filesystem::path m_NextPathObj;
+            std::filesystem::path m_MappedMarkerObj;
+            /**
+             * @brief The rotation by time, i.e. the interval and the moment the active
+             * log file was opened, and the retention policy of the rotated files along
+             * with the flag telling it is to be applied after the batch
+             */
+            std::atomic<std::chrono::seconds> m_RotationInterval;
+            std::chrono::steady_clock::time_point m_FileStartTime;
+            RetentionPolicy m_RetentionPolicy;
+            bool m_isRetentionDue;
+            /**
+             * @brief The sparse index of the lines of the file, built up by the
+             * line and time range reads of a plain text file
+             */
+            LineIndex m_LineIndex;
     };
 };  //logger namespace
 
@@ -34,9 +34,50 @@
 #define LOGGER_MACROS_HPP
 
 #include "LogHelper.hpp"
+#include "LogFilter.hpp"
+#include "TraceSpan.hpp"
 
 namespace logger
 {
+    /**
+     * @brief Macro to define the call site descriptor of a log statement.
+     *
+     * The descriptor is a static constexpr object, one per LOG_* statement,
+     * so the file, class and function names are extracted at compile time
+     * and a log call only passes a reference to it.
+     *
+     * The log statements check it against the runtime log level (see LogFilter)
+     * and their rate limit (see RateLimiter) before any of their arguments are
+     * evaluated. Only LOG_ASSERT, LOG_ASSERT_MSG and LOG_FATAL are never filtered out.
+     *
+     * @param logType The LOG_TYPE enumerator of the statement (e.g. LOG_INFO).
+     * @param marker The log marker of the statement (e.g. FORWARD_ANGLE).
+     */
+    #define LOGGER_CALL_SITE(logType, marker)                                                                   \
+    static constexpr logger::CallSite loggerCallSite(__FILE__, __PRETTY_FUNCTION__, __LINE__,                   \
+                                                     logger::LOG_TYPE::logType, logger::marker)
+
+    /**
+     * @brief Macro to define the call site descriptor of a log statement which
+     * can be filtered out, along with the decision of its log level kept for the
+     * per file overrides (see LogFilter::SiteCache) and its rate limiter (see RateLimiter).
+     *
+     * Both are static objects of the log statement as well, constant initialized,
+     * so they cost no guard.
+     */
+    #define LOGGER_FILTERED_CALL_SITE(logType, marker)                                                          \
+    LOGGER_CALL_SITE(logType, marker);                                                                          \
+    static constinit logger::LogFilter::SiteCache loggerSiteCache;                                              \
+    static constinit logger::RateLimiter loggerRateLimiter
+
+    /**
+     * @brief Macro to check a log statement against the runtime log level and
+     * its rate limit, in this order (see LogFilter and RateLimiter).
+     * It goes along with LOGGER_FILTERED_CALL_SITE.
+     */
+    #define LOGGER_IS_ENABLED()                                                                                 \
+    (logger::LogFilter::isEnabled(loggerCallSite, loggerSiteCache) && logger::passesRateLimit(loggerRateLimiter, loggerCallSite))
+
     /**
      * @brief Macro to log a list or vector of strings with a formatted message.
      *
@@ -47,8 +88,13 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_LIST(LIST_OR_VEC_OF_STRINGS, fmt_str, ...)                                                        \
-    log_list(__FILE__, __PRETTY_FUNCTION__, __LINE__, LIST_OR_VEC_OF_STRINGS, #fmt_str __VA_OPT__(,) __VA_ARGS__)  \
+    #define LOG_LIST(LIST_OR_VEC_OF_STRINGS, fmt_str, ...)                                           \
+    do                                                                                               \
+    {                                                                                                \
+        LOGGER_FILTERED_CALL_SITE(LOG_INFO, FORWARD_ANGLES);                                         \
+        if (LOGGER_IS_ENABLED())                                                                     \
+            log_list(loggerCallSite, LIST_OR_VEC_OF_STRINGS, #fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
     /**
      * @brief Macro to log an entry point message.
@@ -57,8 +103,13 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_ENTRY(fmt_str, ...)                                                                 \
-    log_entry(__FILE__, __PRETTY_FUNCTION__, __LINE__, false, #fmt_str __VA_OPT__(,) __VA_ARGS__);   \
+    #define LOG_ENTRY(fmt_str, ...)                                                  \
+    do                                                                               \
+    {                                                                                \
+        LOGGER_FILTERED_CALL_SITE(LOG_INFO, FORWARD_ANGLES);                         \
+        if (LOGGER_IS_ENABLED())                                                     \
+            log_entry(loggerCallSite, #fmt_str __VA_OPT__(,) __VA_ARGS__);           \
+    } while (0)
 
     /**
      * @brief Macro to log an exit point message.
@@ -67,28 +118,58 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_EXIT(fmt_str, ...)                                                                  \
-    log_exit(__FILE__, __PRETTY_FUNCTION__, __LINE__, false, #fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    #define LOG_EXIT(fmt_str, ...)                                                  \
+    do                                                                              \
+    {                                                                               \
+        LOGGER_FILTERED_CALL_SITE(LOG_INFO, BACKWARD_ANGLES);                       \
+        if (LOGGER_IS_ENABLED())                                                    \
+            log_exit(loggerCallSite, #fmt_str __VA_OPT__(,) __VA_ARGS__);           \
+    } while (0)
 
     /**
-     * @brief Macro to log an entry point message (in DEBUG mode only)
-     * This macro logs a message indicating the entry point of a function or code block.
+     * @brief Macro to time the rest of the scope, e.g. a function, logging a single
+     * record with its duration when the scope is left, in place of LOG_ENTRY and LOG_EXIT.
+     * The spans can be sampled and the short ones left out (see TraceSpan). It is a
+     * declaration, so one per scope, e.g. LOG_SPAN("parse");
+     * It automatically includes the file name, function name, and line number in the log.
+     * @param name The name of the span, a string literal.
+     */
+    #define LOG_SPAN(name)                                                                  \
+        LOGGER_CALL_SITE(LOG_INFO, SPAN_ANGLES);                                            \
+        static constinit thread_local uint32_t loggerSpanSampleCnt = 0;                     \
+        logger::TraceSpan loggerSpan(loggerCallSite, name, loggerSpanSampleCnt)
+
+    /**
+     * @brief Macro to log an entry point message at the debug level
+     * This macro logs a message indicating the entry point of a function or code block,
+     * as a LOG_DBG statement, i.e. only once DBG is on (globally or for the file).
      * It automatically includes the file name, function name, and line number in the log
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_ENTRY_DBG(fmt_str, ...)                                                                 \
-    log_entry(__FILE__, __PRETTY_FUNCTION__, __LINE__, true, #fmt_str __VA_OPT__(,) __VA_ARGS__);   \
+    #define LOG_ENTRY_DBG(fmt_str, ...)                                             \
+    do                                                                              \
+    {                                                                               \
+        LOGGER_FILTERED_CALL_SITE(LOG_DBG, FORWARD_ANGLES);                         \
+        if (LOGGER_IS_ENABLED())                                                    \
+            log_entry(loggerCallSite, #fmt_str __VA_OPT__(,) __VA_ARGS__);          \
+    } while (0)
 
     /**
-     * @brief Macro to log an exit point message (in DEBUG mode only)
-     * This macro logs a message indicating the exit point of a function or code block.
+     * @brief Macro to log an exit point message at the debug level
+     * This macro logs a message indicating the exit point of a function or code block,
+     * as a LOG_DBG statement, i.e. only once DBG is on (globally or for the file).
      * It automatically includes the file name, function name, and line number in the log
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_EXIT_DBG(fmt_str, ...)                                                                  \
-    log_exit(__FILE__, __PRETTY_FUNCTION__, __LINE__, true, #fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    #define LOG_EXIT_DBG(fmt_str, ...)                                             \
+    do                                                                             \
+    {                                                                              \
+        LOGGER_FILTERED_CALL_SITE(LOG_DBG, BACKWARD_ANGLES);                       \
+        if (LOGGER_IS_ENABLED())                                                   \
+            log_exit(loggerCallSite, #fmt_str __VA_OPT__(,) __VA_ARGS__);          \
+    } while (0)
 
     /**
      * @brief Macro to log an informational message.
@@ -97,8 +178,13 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_INFO(fmt_str, ...)                                                         \
-    log_info(__FILE__, __PRETTY_FUNCTION__, __LINE__, fmt_str __VA_OPT__(,) __VA_ARGS__);   \
+    #define LOG_INFO(fmt_str, ...)                                          \
+    do                                                                      \
+    {                                                                       \
+        LOGGER_FILTERED_CALL_SITE(LOG_INFO, FORWARD_ANGLE);                 \
+        if (LOGGER_IS_ENABLED())                                            \
+            log_info(loggerCallSite, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
     /**
      * @brief Macro to log an important detail message.
@@ -107,8 +193,13 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_IMP(fmt_str, ...)                                                          \
-    log_imp(__FILE__, __PRETTY_FUNCTION__, __LINE__, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    #define LOG_IMP(fmt_str, ...)                                          \
+    do                                                                     \
+    {                                                                      \
+        LOGGER_FILTERED_CALL_SITE(LOG_IMP, FORWARD_ANGLE);                 \
+        if (LOGGER_IS_ENABLED())                                           \
+            log_imp(loggerCallSite, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
     /**
      * @brief Macro to log a warning message.
@@ -117,8 +208,13 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_WARN(fmt_str, ...)                                                        \
-    log_warn(__FILE__, __PRETTY_FUNCTION__, __LINE__, fmt_str __VA_OPT__(,) __VA_ARGS__);  \
+    #define LOG_WARN(fmt_str, ...)                                          \
+    do                                                                      \
+    {                                                                       \
+        LOGGER_FILTERED_CALL_SITE(LOG_WARN, FORWARD_ANGLE);                 \
+        if (LOGGER_IS_ENABLED())                                            \
+            log_warn(loggerCallSite, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
     /**
      * @brief Macro to log an error message.
@@ -127,28 +223,36 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_ERR(fmt_str, ...)                                                        \
-    log_err(__FILE__, __PRETTY_FUNCTION__, __LINE__, fmt_str __VA_OPT__(,) __VA_ARGS__);  \
+    #define LOG_ERR(fmt_str, ...)                                          \
+    do                                                                     \
+    {                                                                      \
+        LOGGER_FILTERED_CALL_SITE(LOG_ERR, FORWARD_ANGLE);                 \
+        if (LOGGER_IS_ENABLED())                                           \
+            log_err(loggerCallSite, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
     /**
      * @brief Macro to log a debug message.
      * This macro logs a debug message with the specified format and arguments.
      * It automatically includes the file name, function name, and line number in the log.
-     * Note: This macro is only compiled and executed in debug mode.
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
-     * @note This macro is only compiled and executed in debug mode.
-     *       If the code is compiled in release mode, this macro will not generate any code
-     *       and will not log anything.
-     *       This is useful for debugging purposes, as it allows developers to log debug messages
-     *       without affecting the performance of the release build.
+     * @note It logs only once DBG is on, globally or for the file (see LogFilter), e.g.
+     *       to raise the verbosity of a running release build. The default level is DBG
+     *       for the debug builds and INF otherwise, so a release build only pays for
+     *       the look at the level mask, its arguments are not even evaluated.
      *       It is recommended to use this macro for logging debug messages only,
      *       and not for logging important information or errors.
      *       For logging important information or errors, use the other logging macros like LOG_INFO,
      *       LOG_WARN, LOG_ERR, etc.
      */
-    #define LOG_DBG(fmt_str, ...)                                                        \
-    log_dbg(__FILE__, __PRETTY_FUNCTION__, __LINE__, fmt_str __VA_OPT__(,) __VA_ARGS__);  \
+    #define LOG_DBG(fmt_str, ...)                                          \
+    do                                                                     \
+    {                                                                      \
+        LOGGER_FILTERED_CALL_SITE(LOG_DBG, FORWARD_ANGLE);                 \
+        if (LOGGER_IS_ENABLED())                                           \
+            log_dbg(loggerCallSite, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
     /**
      * @brief Macro to log an assertion failure message.
@@ -160,12 +264,15 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_ASSERT(cond, ...)                                                                          \
-    do                                                                                                      \
-    {                                                                                                        \
-        if (!(cond))                                                                                          \
-            log_assert(__FILE__, __PRETTY_FUNCTION__, __LINE__, #cond, true, #cond __VA_OPT__(,) __VA_ARGS__); \
-    } while (0);                                                                                                \
+    #define LOG_ASSERT(cond, ...)                                                        \
+    do                                                                                   \
+    {                                                                                    \
+        if (!(cond))                                                                     \
+        {                                                                                \
+            LOGGER_CALL_SITE(LOG_ASSERT, FORWARD_ANGLE);                                 \
+            log_assert(loggerCallSite, #cond, true, #cond __VA_OPT__(,) __VA_ARGS__);    \
+        }                                                                                \
+    } while (0)
 
     /**
      * @brief Macro to log an assertion failure message with a custom message.
@@ -176,12 +283,33 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_ASSERT_MSG(cond, fmt_str, ...)                                                               \
-    do                                                                                                        \
-    {                                                                                                          \
-        if (!(cond))                                                                                            \
-            log_assert(__FILE__, __PRETTY_FUNCTION__, __LINE__, #cond, true, fmt_str __VA_OPT__(,) __VA_ARGS__); \
-    } while (0);                                                                                                  \
+    #define LOG_ASSERT_MSG(cond, fmt_str, ...)                                             \
+    do                                                                                     \
+    {                                                                                      \
+        if (!(cond))                                                                       \
+        {                                                                                  \
+            LOGGER_CALL_SITE(LOG_ASSERT, FORWARD_ANGLE);                                   \
+            log_assert(loggerCallSite, #cond, true, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+        }                                                                                  \
+    } while (0)
+
+    /**
+     * @brief Macro to log a structured message, i.e. a message and typed key-value fields.
+     * The fields are encoded as they are by the record encoder of the sink (see
+     * RecordEncoder), or rendered as logfmt after the message without one, e.g.
+     * LOG_FIELDS(LOG_INFO, "Request served", logger::kv("path", path), logger::kv("status", 200));
+     * It automatically includes the file name, function name, and line number in the log.
+     * @param logType The LOG_TYPE enumerator of the statement, LOG_DBG up to LOG_ERR.
+     * @param msg The message, it is not a format string.
+     * @param ... The key-value fields, see logger::kv().
+     */
+    #define LOG_FIELDS(logType, msg, ...)                                   \
+    do                                                                      \
+    {                                                                       \
+        LOGGER_FILTERED_CALL_SITE(logType, FORWARD_ANGLE);                  \
+        if (LOGGER_IS_ENABLED())                                            \
+            log_fields(loggerCallSite, msg __VA_OPT__(,) __VA_ARGS__);      \
+    } while (0)
 
     /**
      * @brief Macro to log a fatal error message and abort the program.
@@ -191,8 +319,12 @@ namespace logger
      * @param fmt_str The format string for the log message.
      * @param ... Additional arguments for formatting the log message.
      */
-    #define LOG_FATAL(fmt_str, ...)                                                        \
-    log_fatal(__FILE__, __PRETTY_FUNCTION__, __LINE__, fmt_str __VA_OPT__(,) __VA_ARGS__);  \
+    #define LOG_FATAL(fmt_str, ...)                                      \
+    do                                                                   \
+    {                                                                    \
+        LOGGER_CALL_SITE(LOG_FATAL, FORWARD_ANGLE);                      \
+        log_fatal(loggerCallSite, fmt_str __VA_OPT__(,) __VA_ARGS__);    \
+    } while (0)
 
 } // namespace logger
 
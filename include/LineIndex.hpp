@@ -0,0 +1,156 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LineIndex.hpp
+ * @brief Declaration of the LineIndex class.
+ *
+ * LineIndex is a sparse index of the lines of a text log file: it remembers the
+ * offset of every stride-th line along with the latest prefix timestamp logged
+ * before it. A line range or a time range read seeks straight to the nearest
+ * indexed line instead of reading the file from its start.
+ *
+ * The index is built on the first read and extended by every later read with
+ * whatever got appended to the file since, so the writer doesn't pay for it.
+ * A file replaced (e.g. rotated) or truncated in between is indexed afresh.
+ *
+ * @note The timestamps are compared as strings, which keeps them in the order
+ *       of time as long as the time format starts with the most significant
+ *       field, as DEFAULT_TIME_FORMAT does.
+ */
+
+#ifndef LINE_INDEX_HPP
+#define LINE_INDEX_HPP
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <istream>
+#include <string_view>
+
+namespace logger
+{
+    class LineIndex
+    {
+        public:
+            /**
+             * @brief The number of lines between two indexed lines
+             */
+            static constexpr size_t defaultStride = 1024;
+
+            /**
+             * @brief An indexed line, i.e. its number (1-based), its offset in the file
+             * and the latest timestamp of the lines before it (empty for the first line)
+             */
+            struct Entry
+            {
+                size_t m_LineNo;
+                std::uintmax_t m_Offset;
+                std::string m_LatestTime;
+            };
+
+            /**
+             * @brief Construct a new Line Index object
+             *
+             * @param [in] stride The number of lines between two indexed lines
+             */
+            explicit LineIndex(const size_t stride = defaultStride);
+
+            /**
+             * @brief Index the lines appended to the file since the last update
+             *
+             * @param [in] in The stream of the file, positioned anywhere
+             * @param [in] size The number of bytes of the file to be indexed, a
+             *                  last line without its new line is left for later
+             * @param [in] fileId The identity of the file (e.g. its inode), the
+             *                    index starts afresh whenever it changes
+             * @note The state of the stream is cleared once done with it.
+             */
+            void update(std::istream& in, const std::uintmax_t size, const std::uintmax_t fileId);
+
+            /**
+             * @brief Forget everything indexed so far
+             */
+            void reset();
+
+            /**
+             * @brief Get the indexed line to start reading from, for a line number
+             *
+             * @param [in] lineNo The line number (1-based) to be read
+             * @return Entry The last indexed line not after it
+             */
+            Entry seekLine(const size_t lineNo) const;
+
+            /**
+             * @brief Get the indexed line to start reading from, for a point of time
+             *
+             * @param [in] fromTime The timestamp the read starts at
+             * @return Entry The last indexed line all the lines before which are older
+             */
+            Entry seekTime(const std::string_view fromTime) const;
+
+            /**
+             * @brief Get the offset a time range read can stop at
+             *
+             * @param [in] toTime The timestamp the read ends at
+             * @return std::uintmax_t The offset of the indexed line a full stride
+             *         after the first line newer than toTime was logged, UINTMAX_MAX
+             *         if there is no such line indexed. The stride left in between
+             *         is for the records logged slightly out of order by the threads.
+             */
+            std::uintmax_t stopOffset(const std::string_view toTime) const;
+
+            /**
+             * @brief Get the number of complete lines indexed so far
+             */
+            size_t getLinesCount() const;
+
+            /**
+             * @brief Get the timestamp of the prefix a log line starts with
+             *
+             * @param [in] line The log line
+             * @return std::string_view The timestamp, empty for a line without the
+             *         prefix (e.g. the continuation of a multi line record)
+             */
+            static std::string_view timeOf(const std::string_view line) noexcept;
+
+        private:
+            /**
+             * @brief Account for a complete line starting with the given bytes, the
+             * lock must be held
+             */
+            void addLine(const std::string_view lineHead, const std::uintmax_t nextOffset);
+
+            const size_t m_Stride;
+            mutable std::mutex m_IndexMtx;
+            std::vector<Entry> m_Entries;
+            std::uintmax_t m_FileId;
+            std::uintmax_t m_IndexedSize;
+            size_t m_LinesCnt;
+            std::string m_LatestTime;
+    };
+};  // namespace logger
+
+#endif  // LINE_INDEX_HPP
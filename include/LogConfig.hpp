@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LogConfig.hpp
+ * @brief Declaration of the LogConfig struct.
+ *
+ * LogConfig holds the settings the LoggingOps object of the LOG_* macros is
+ * built with (see Logger::buildLoggingOpsObject()). They are looked up once at
+ * startup, each one overriding the one before:
+ *
+ * 1. The build time settings of ENV_VARS.hpp (see buildNinstall.sh), if any.
+ * 2. The config file named by the LOGGER_CONFIG_FILE environment variable, made
+ *    of KEY = value lines. The empty lines and the ones starting with # are skipped.
+ * 3. The environment variables, the keys prefixed with LOGGER_, e.g. LOGGER_LOG_LEVEL=warn.
+ *
+ * The keys:
+ *
+ * | Key                  | Value                                                  | Reloaded |
+ * |----------------------|--------------------------------------------------------|----------|
+ * | FILE_LOGGING         | yes or no                                              | No       |
+ * | LOG_FILE_NAME        | The log file name, needed for the file logging         | No       |
+ * | LOG_FILE_PATH        | The directory of the log file                          | No       |
+ * | LOG_FILE_EXTN        | The extension of the log file, e.g. .log               | No       |
+ * | FILE_SIZE            | The max log file size, e.g. 10MB                       | No       |
+ * | ROTATION_INTERVAL    | Rotate the log file this often as well, e.g. 1h        | No       |
+ * | RETENTION_MAX_FILES  | The number of rotated files kept                       | No       |
+ * | RETENTION_MAX_BYTES  | The total size of the rotated files kept, e.g. 1GB     | No       |
+ * | RING_CAPACITY        | The size of the queue (of every sink), e.g. 4MB        | No       |
+ * | STAGING_MODE         | shared, per_cpu or per_numa_node, see StagingMode      | No       |
+ * | WRITER_CPU           | Pin the watcher threads (the writers) to this CPU      | No       |
+ * | RECORD_ENCODING      | text, json or logfmt, see RecordEncoding               | No       |
+ * | NETWORK_SINK         | Ship the records as syslog, e.g. udp://collector:514   | No       |
+ * | LOG_LEVEL            | dbg, info, imp, warn or err                            | Yes      |
+ * | CONSOLE_LOG_LEVEL    | With file logging, the console gets this level on      | Yes      |
+ * | BATCH_MAX_RECORDS    | The records the watcher thread writes at once          | Yes      |
+ * | BATCH_MAX_BYTES      | The bytes the watcher thread writes at once, e.g. 64KB | Yes      |
+ * | BATCH_MAX_LINGER     | The time a batch is waited for, e.g. 5ms               | Yes      |
+ * | STATS_INTERVAL       | Write a stats line this often, e.g. 1m, 0 for none     | Yes      |
+ * | RELOAD_INTERVAL      | Look at the config file for changes this often         | Yes      |
+ * | RATE_LIMIT_RECORDS   | The records per interval of a statement, 0 for all     | Yes      |
+ * | RATE_LIMIT_INTERVAL  | The interval of the rate limit, e.g. 1s                | Yes      |
+ * | SPAN_SAMPLING        | Log every Nth trace span of a statement, 1 for all     | Yes      |
+ * | SPAN_MIN_DURATION    | Leave out the trace spans shorter than it, e.g. 50us   | Yes      |
+ *
+ * The sizes take a K, M or G suffix (KB, MB and GB as well), the durations one
+ * of us, ms, s, m or h (seconds without it).
+ */
+
+#ifndef LOG_CONFIG_HPP
+#define LOG_CONFIG_HPP
+
+#include "Logger.hpp"
+#include "FileOps.hpp"
+#include "RecordEncoder.hpp"
+#include "NetworkOps.hpp"
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+
+namespace logger
+{
+    struct LogConfig
+    {
+        /**
+         * @brief The prefix of the environment variables
+         */
+        static constexpr std::string_view envPrefix = "LOGGER_";
+
+        /**
+         * @brief The environment variable naming the config file
+         */
+        static constexpr std::string_view configFileEnvVar = "LOGGER_CONFIG_FILE";
+
+        // Taken at startup only
+        bool fileLogging = false;
+        std::string fileName;
+        std::string filePath;
+        std::string fileExtn;
+        std::uintmax_t fileSize = 1024 * 1000;  // 1 MB, as it has always been
+        std::chrono::seconds rotationInterval = std::chrono::seconds(0);
+        RetentionPolicy retentionPolicy;
+        size_t ringCapacity = defaultRingCapacity;
+        StagingMode stagingMode = StagingMode::SHARED;
+        std::optional<int> writerCpu;
+        RecordEncoding recordEncoding = RecordEncoding::TEXT;
+        std::optional<NetworkTarget> networkSink;
+
+        // Taken at startup and on every reload. The ones not set are left as
+        // they are, e.g. the log level set by the program itself
+        std::optional<LOG_TYPE> logLevel;
+        std::optional<LOG_TYPE> consoleLogLevel;
+        std::optional<BatchPolicy> batchPolicy;
+        std::optional<std::chrono::seconds> statsInterval;
+        std::optional<uint32_t> rateLimitRecords;
+        std::optional<std::chrono::milliseconds> rateLimitInterval;
+        std::optional<uint32_t> spanSampling;
+        std::optional<std::chrono::microseconds> spanMinDuration;
+        std::chrono::seconds reloadInterval = std::chrono::seconds(0);
+
+        // Where the settings came from
+        std::filesystem::path configFile;
+
+        /**
+         * @brief Get the build time settings, those of ENV_VARS.hpp
+         *
+         * @return LogConfig The build time settings, the defaults for the rest
+         */
+        static LogConfig buildTimeDefaults();
+
+        /**
+         * @brief Get the settings in effect: the build time ones, overridden by
+         * the config file (see configFileEnvVar), overridden by the environment
+         *
+         * @param [out] problems The settings which couldn't be taken, and why
+         * @return LogConfig The settings
+         */
+        static LogConfig load(std::vector<std::string>& problems);
+
+        /**
+         * @brief Take a setting
+         *
+         * @param [in] key The key, e.g. LOG_LEVEL (case insensitive)
+         * @param [in] value The value, e.g. warn
+         * @param [out] problem Why the setting couldn't be taken
+         * @return true If the setting is taken, otherwise
+         * @return false If the key is unknown or the value invalid
+         */
+        bool set(const std::string_view key, const std::string_view value, std::string& problem);
+
+        /**
+         * @brief Take the settings of a config file
+         *
+         * @param [in] file The config file
+         * @param [out] problems The lines which couldn't be taken, and why
+         * @return true If the file could be read, otherwise
+         * @return false
+         */
+        bool readFile(const std::filesystem::path& file, std::vector<std::string>& problems);
+
+        /**
+         * @brief Take the settings of the environment, i.e. the variables
+         * named after the keys prefixed with envPrefix
+         *
+         * @param [out] problems The variables which couldn't be taken, and why
+         */
+        void readEnvironment(std::vector<std::string>& problems);
+
+        /**
+         * @brief Apply the settings which can be changed at any time, i.e. the
+         * log level, the rate limit, the batching policy and the stats interval, to a LoggingOps object
+         *
+         * @param [in] ops The LoggingOps object. For a FanOutOps it is every sink which
+         *                 is to be given, as they do the batching (see Logger::reloadConfig()).
+         */
+        void applyReloadable(LoggingOps& ops) const;
+
+        /**
+         * @brief Parse a log level, e.g. warn or WARN
+         *
+         * @param [in] value The log level
+         * @return std::optional<LOG_TYPE> The log level, empty if it is invalid
+         */
+        static std::optional<LOG_TYPE> parseLogLevel(const std::string_view value) noexcept;
+
+        /**
+         * @brief Parse a size, e.g. 4096, 64KB or 10M
+         *
+         * @param [in] value The size
+         * @return std::optional<std::uintmax_t> The size in bytes, empty if it is invalid
+         *         or doesn't fit into std::uintmax_t
+         */
+        static std::optional<std::uintmax_t> parseSize(const std::string_view value) noexcept;
+
+        /**
+         * @brief Parse a duration, e.g. 5ms, 30s, 10m or 60 (seconds)
+         *
+         * @param [in] value The duration
+         * @return std::optional<std::chrono::microseconds> The duration, empty if it is invalid
+         */
+        static std::optional<std::chrono::microseconds> parseDuration(const std::string_view value) noexcept;
+    };
+};  // namespace logger
+
+#endif  // LOG_CONFIG_HPP
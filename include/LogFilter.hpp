@@ -0,0 +1,250 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LogFilter.hpp
+ * @brief Declaration of the LogFilter class.
+ *
+ * LogFilter holds the runtime log level, i.e. the least severe LOG_TYPE that
+ * still gets logged, and optional overrides of it per source file. The LOG_*
+ * macros ask it before any of their arguments are evaluated, which costs a
+ * single relaxed atomic load as long as no per file override is set. Once
+ * there is one, every log statement keeps its own decision along with the
+ * generation of the levels it was made for (see SiteCache), so it is two relaxed
+ * loads until a level is changed again.
+ *
+ * The severity order is DBG < INF < IMP < WARN < ERR. Assertion failures and
+ * fatal errors terminate the program, so they are never filtered out.
+ */
+
+#ifndef LOG_FILTER_HPP
+#define LOG_FILTER_HPP
+
+#include "Logger.hpp"
+
+#include <map>
+#include <array>
+#include <algorithm>
+#include <shared_mutex>
+
+namespace logger
+{
+    class LogFilter
+    {
+        public:
+            LogFilter() = delete;
+
+            /**
+             * @brief The decision of isEnabled() for one log statement, once any file has
+             * its own log level. It is a static object of every log statement which can
+             * be filtered out, constant initialized (see LOGGER_FILTERED_CALL_SITE).
+             */
+            class SiteCache
+            {
+                public:
+                    constexpr SiteCache() noexcept : m_Entry(0) {}
+
+                    SiteCache(const SiteCache&) = delete;
+                    SiteCache& operator=(const SiteCache&) = delete;
+
+                private:
+                    friend class LogFilter;
+
+                    // The generation of the levels (the upper half) and the decision
+                    std::atomic<uint64_t> m_Entry;
+            };
+
+            /**
+             * @brief The log level in effect when the program starts.
+             * DBG for the debug builds and INF otherwise.
+             */
+#if defined (DEBUG) || defined (__DEBUG__)
+            static constexpr LOG_TYPE defaultLogLevel = LOG_TYPE::LOG_DBG;
+#else
+            static constexpr LOG_TYPE defaultLogLevel = LOG_TYPE::LOG_INFO;
+#endif
+
+            /**
+             * @brief Check whether a log statement is to be logged.
+             *
+             * @param [in] site The call site of the log statement.
+             * @return true If the log type of the call site passes the log
+             *         level of its file (or the global one), otherwise false.
+             * @note It looks the file up under a lock once any file has its own
+             *       log level, the one with a SiteCache is for the hot paths.
+             */
+            static inline bool isEnabled(const CallSite& site) noexcept
+            {
+                auto state = m_LevelMask.load(std::memory_order_relaxed);
+                if (state & m_OverridesFlag) [[unlikely]]
+                    return isEnabledForFile(site.fileName(), site.type());
+                return state & toBit(site.type());
+            }
+
+            /**
+             * @brief Check whether a log statement is to be logged, the decision
+             * kept by the statement is taken as long as no level is changed.
+             *
+             * @param [in] site The call site of the log statement.
+             * @param [in,out] cache The decision kept by the log statement.
+             * @return true If the log type of the call site passes the log
+             *         level of its file (or the global one), otherwise false.
+             */
+            static inline bool isEnabled(const CallSite& site, SiteCache& cache) noexcept
+            {
+                auto state = m_LevelMask.load(std::memory_order_relaxed);
+                if (state & m_OverridesFlag) [[unlikely]]
+                {
+                    auto entry = cache.m_Entry.load(std::memory_order_relaxed);
+                    if ((entry >> 32) == (state >> 32))
+                        return entry & 1;
+                    return cacheForFile(site, cache, state);
+                }
+                return state & toBit(site.type());
+            }
+
+            /**
+             * @brief Check whether a log type passes the global log level.
+             *
+             * @param [in] type The log type to be checked.
+             */
+            static inline bool isEnabled(const LOG_TYPE type) noexcept
+            {
+                return m_LevelMask.load(std::memory_order_relaxed) & toBit(type);
+            }
+
+            /**
+             * @brief Check whether a log type passes a given log level, whatever
+             * the global one is (e.g. for the level of a sink, see FanOutOps).
+             *
+             * @param [in] type The log type to be checked.
+             * @param [in] level The least severe log type to pass.
+             */
+            static constexpr bool passesLevel(const LOG_TYPE type, const LOG_TYPE level) noexcept
+            {
+                return toMask(level) & toBit(type);
+            }
+
+            /**
+             * @brief Set the global log level.
+             *
+             * @param [in] level The least severe log type to be logged.
+             *                   LOG_ASSERT and LOG_FATAL are treated as LOG_ERR.
+             */
+            static void setLogLevel(const LOG_TYPE level) noexcept;
+
+            /**
+             * @brief Get the global log level.
+             */
+            static LOG_TYPE getLogLevel() noexcept;
+
+            /**
+             * @brief Override the global log level for one source file.
+             *
+             * @param [in] fileName The base name of the source file, e.g. "FileOps.cpp".
+             * @param [in] level The least severe log type to be logged from that file.
+             */
+            static void setLogLevel(const std::string_view fileName, const LOG_TYPE level);
+
+            /**
+             * @brief Remove the override of the log level of a source file.
+             *
+             * @param [in] fileName The base name of the source file.
+             */
+            static void clearLogLevel(const std::string_view fileName);
+
+            /**
+             * @brief Remove all the overrides and reset the global log level to defaultLogLevel.
+             */
+            static void reset();
+
+        private:
+            /**
+             * @brief Bit of a log type in the level masks.
+             */
+            static constexpr uint32_t toBit(const LOG_TYPE type) noexcept
+            {
+                auto val = static_cast<uint32_t>(type);
+                return (val < 31) ? (1u << val) : 0;
+            }
+
+            /**
+             * @brief The log types from the least to the most severe.
+             */
+            static constexpr std::array<LOG_TYPE, 5> m_SeverityOrder =
+            {
+                LOG_TYPE::LOG_DBG,
+                LOG_TYPE::LOG_INFO,
+                LOG_TYPE::LOG_IMP,
+                LOG_TYPE::LOG_WARN,
+                LOG_TYPE::LOG_ERR
+            };
+
+            /**
+             * @brief Mask of the log types passing the given level. Assertion
+             * failures and fatal errors are part of every mask, whatever the level.
+             */
+            static constexpr uint32_t toMask(const LOG_TYPE level) noexcept
+            {
+                uint32_t mask = toBit(LOG_TYPE::LOG_ASSERT) | toBit(LOG_TYPE::LOG_FATAL);
+                auto itr = std::find(m_SeverityOrder.begin(), m_SeverityOrder.end(), level);
+                if (itr == m_SeverityOrder.end())
+                    itr = std::prev(m_SeverityOrder.end());     // Not higher than the errors
+                for (; itr != m_SeverityOrder.end(); ++itr)
+                    mask |= toBit(*itr);
+                return mask;
+            }
+
+            /**
+             * @brief Slow path of isEnabled(), when any file has its own log level.
+             */
+            static bool isEnabledForFile(const std::string_view fileName, const LOG_TYPE type) noexcept;
+
+            /**
+             * @brief Slow path of isEnabled() with a SiteCache, the decision is
+             * looked up and kept for the generation read along with the flag.
+             */
+            static bool cacheForFile(const CallSite& site, SiteCache& cache, const uint64_t state) noexcept;
+
+            /**
+             * @brief Store the mask of the global log level along with the next
+             * generation, and the flag if there is any override. The lock must be held.
+             */
+            static void publishMask(const uint32_t mask) noexcept;
+
+            /**
+             * @brief Set in m_LevelMask when there is at least one override.
+             */
+            static constexpr uint64_t m_OverridesFlag = 1u << 31;
+
+            // The generation of the levels (the upper half, bumped by every change
+            // of them) and the mask of the global log level with the flag
+            static std::atomic<uint64_t> m_LevelMask;
+            static std::atomic<LOG_TYPE> m_LogLevel;
+            static std::shared_mutex m_OverridesMtx;
+            static std::map<std::string, uint32_t, std::less<>> m_FileOverrides;
+    };
+};  // namespace logger
+
+#endif  // LOG_FILTER_HPP
@@ -36,6 +36,8 @@
 #define LOGGER_HELPER_HPP
 
 #include "Logger.hpp"
+#include "RateLimiter.hpp"
+#include "DeferredRecord.hpp"
 
 namespace logger
 {
@@ -52,14 +54,28 @@ namespace logger
     struct is_list<std::list<T, Alloc>> : std::true_type{};
 
     /**
-     * @brief The logger object for the application.
+     * @brief The logger object for the calling thread.
      * This object is used to construct log messages
      * and write them to the log stream.
      *
+     * @note Each thread owns its own instance (thread_local), so a log
+     * record is built entirely in the calling thread's Logger state and
+     * no lock is needed while formatting it. Only the finished record is
+     * handed over to the shared LoggingOps object.
+     *
+     * @note inline because otherwise it will cause linker errors
+     * when used in multiple translation units.
+     */
+    inline thread_local Logger loggerObj(DEFAULT_TIME_FORMAT);
+
+    /**
+     * @brief The buffer the calling thread encodes its deferred records in.
+     * It keeps its memory, so encoding a record doesn't allocate after warming up.
+     *
      * @note inline because otherwise it will cause linker errors
      * when used in multiple translation units.
      */
-    inline static Logger loggerObj("%Y%m%d_%H%M%S");
+    inline thread_local std::string deferredRecordBuf;
 
     /**
      * @brief The stream object for logging operations.
@@ -75,16 +91,12 @@ namespace logger
     /**
      * @brief Set the logger properties for the current log message.
      *
-     * This function sets the file name, function name, marker, line number,
-     * thread ID, and log type for the logger object. It is used to prepare
-     * the logger object with necessary context before logging a message.
+     * This function sets the call site (file name, function name, line number,
+     * marker and log type) and the thread ID for the logger object. It is used
+     * to prepare the logger object with necessary context before logging a message.
      *
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] marker A string marker to indicate the type of log (e.g., entry, exit).
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement (see CallSite).
      * @param [in] tid The thread ID of the thread generating the log.
-     * @param [in] logType The type of log (e.g., info, error, debug).
      *
      * @note This function is typically called before logging a message
      * to ensure that the logger object has all the necessary context
@@ -93,21 +105,10 @@ namespace logger
      * @note inline because otherwise it will cause linker errors
      * when used in multiple translation units.
      */
-    inline void setLoggerProperties
-    (   const std::string_view fileName,
-        const std::string_view funcName,
-        const std::string_view marker,
-        const size_t lineNo,
-        const std::thread::id& tid,
-        const LOG_TYPE& logType
-    )
+    inline void setLoggerProperties(const CallSite& site, const std::thread::id& tid)
     {
-        loggerObj.setFileName(fileName)
-                .setFunctionName(funcName)
-                .setLineNo(lineNo)
-                .setThreadId(tid)
-                .setMarker(marker)
-                .setLogType(logType);
+        loggerObj.setCallSite(site)
+                .setThreadId(tid);
     }
 
     /**
@@ -128,13 +129,100 @@ namespace logger
     template<typename ...Args>
     void logMsg(const std::string_view format_str, Args&&... args)
     {
-        static std::mutex raceMtx;
-        // Static objects are atomic in inature only during
-        // the lifetime of the program. Accessing or modifying
-        // them from multiple threads requires external synchronization.
-        std::lock_guard<std::mutex> lock(raceMtx);
+        // With deferred formatting only the raw arguments are copied, and the
+        // watcher thread formats the record (or a binary log keeps it as is). The statements terminating the
+        // program are always formatted right here, so they can't get lost.
+        if constexpr (DeferredRecord::isDeferrable<Args...>)
+        {
+            const auto* pSite = loggerObj.getCallSite();
+            if ((Logger::isDeferredFormatting() || loggingOps.wantsDeferredRecords()) && pSite &&
+                LOG_TYPE::LOG_ASSERT != pSite->type() && LOG_TYPE::LOG_FATAL != pSite->type())
+            {
+                DeferredRecord::encode(deferredRecordBuf,
+                                       *pSite,
+                                       loggerObj.getThreadId(),
+                                       std::chrono::system_clock::now(),
+                                       Logger::stripQuotes(format_str),
+                                       args...);
+                loggingOps.writeDeferred(deferredRecordBuf);
+                return;
+            }
+        }
+
+        // loggerObj is thread local, so the prefix and the message are
+        // formatted without any synchronization with other threads.
+        // The finished record is then handed off to the LoggingOps queue
+        // which is the only part shared between the threads.
         loggerObj.log(format_str, args...);
-        loggingOps << loggerObj.getLogStream().str();
+        const auto* pSite = loggerObj.getCallSite();
+        loggingOps.write(loggerObj.getLogRecord(), pSite ? pSite->type() : LOG_TYPE::LOG_DEFAULT);
+    }
+
+    /**
+     * @brief Log a structured message, i.e. a message and typed key-value fields.
+     *
+     * The record is always deferred, so the encoder of the LoggingOps object (see
+     * RecordEncoder) gets the typed values straight away. Without an encoder it is
+     * rendered as the message followed by the fields in logfmt.
+     *
+     * @tparam Values The value types, arithmetic types or strings.
+     * @param [in] site The call site descriptor of the log statement.
+     * @param [in] msg The message, it is not a format string.
+     * @param [in] fields The key-value fields, see kv().
+     */
+    template<typename ...Values>
+    void log_fields
+    (
+        const CallSite& site,
+        const std::string_view msg,
+        const Field<Values>&... fields
+    )
+    {
+        DeferredRecord::encodeFields(deferredRecordBuf,
+                                     site,
+                                     std::this_thread::get_id(),
+                                     std::chrono::system_clock::now(),
+                                     msg,
+                                     fields...);
+        loggingOps.writeDeferred(deferredRecordBuf);
+    }
+
+    /**
+     * @brief Log the summary of the records a rate limited log statement dropped,
+     * at the call site of the statement itself.
+     *
+     * @param [in] site The call site descriptor of the log statement.
+     * @param [in] suppressedCnt The number of records dropped.
+     *
+     * @note Not inlined, it is off the hot path of the log statements.
+     */
+    [[gnu::noinline]] inline void log_suppressed(const CallSite& site, const uint64_t suppressedCnt)
+    {
+        setLoggerProperties(site, std::this_thread::get_id());
+
+        logMsg("{} more records of this statement were suppressed, at most {} per {} ms",
+               suppressedCnt, RateLimiter::getMaxRecords(), RateLimiter::getInterval().count());
+    }
+
+    /**
+     * @brief Check a log statement against its rate limit (see RateLimiter), and
+     * log the summary of the records it dropped before, if it is let through.
+     *
+     * @param [in] limiter The rate limiter of the log statement.
+     * @param [in] site The call site descriptor of the log statement.
+     * @return true If the record is to be logged, otherwise false.
+     */
+    inline bool passesRateLimit(RateLimiter& limiter, const CallSite& site)
+    {
+        uint64_t suppressedCnt = 0;
+        if (!limiter.allow(suppressedCnt))
+        {
+            limiter.enlist(site);
+            return false;
+        }
+        if (suppressedCnt) [[unlikely]]
+            log_suppressed(site, suppressedCnt);
+        return true;
     }
 
     /**
@@ -146,9 +234,7 @@ namespace logger
      *
      * @tparam List The type of the list or vector to be logged.
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] msgList The list or vector of messages to be logged.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
@@ -156,9 +242,7 @@ namespace logger
     template<typename List, typename ...Args>
     void log_list
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const List& msgList,
         const std::string_view format_str,
         Args&&... args
@@ -167,12 +251,7 @@ namespace logger
         // If and only if, it is either a vector or std::list of strings
         if constexpr (is_list<List>::value || is_vector<List>::value)
         {
-            setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLES,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_INFO);
+            setLoggerProperties(site, std::this_thread::get_id());
 
             logMsg(format_str, args...);
             loggingOps << msgList;
@@ -187,46 +266,21 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
-     * @param [in] debugMode The boolean value to indicate whether the logging will happen in DEBUG mode only
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_entry
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
-        const bool debugMode,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        auto log = false;
-        if (debugMode)
-        {
-#if defined (DEBUG) || (__DEBUG__)
-            log = true;
-#endif
-        }
-        else
-        {
-            log = true;
-        }
-        if (log)
-        {
-            setLoggerProperties(fileName,
-                                funcName,
-                                FORWARD_ANGLES,
-                                lineNo,
-                                std::this_thread::get_id(),
-                                LOG_TYPE::LOG_INFO);
+        setLoggerProperties(site, std::this_thread::get_id());
 
-            logMsg(format_str, args...);
-        }
+        logMsg(format_str, args...);
     }
 
     /**
@@ -237,46 +291,21 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
-     * @param [in] debugMode The boolean value to indicate whether the logging will happen in DEBUG mode only
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_exit
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
-        const bool debugMode,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        auto log = false;
-        if (debugMode)
-        {
-#if defined (DEBUG) || (__DEBUG__)
-            log = true;
-#endif
-        }
-        else
-        {
-            log = true;
-        }
-        if (log)
-        {
-            setLoggerProperties(fileName,
-                                funcName,
-                                BACKWARD_ANGLES,
-                                lineNo,
-                                std::this_thread::get_id(),
-                                LOG_TYPE::LOG_INFO);
+        setLoggerProperties(site, std::this_thread::get_id());
 
-            logMsg(format_str, args...);
-        }
+        logMsg(format_str, args...);
     }
 
     /**
@@ -287,28 +316,19 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_err
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_ERR);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
     }
@@ -321,28 +341,19 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_warn
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_WARN);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
     }
@@ -355,28 +366,19 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_info
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_INFO);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
     }
@@ -389,28 +391,19 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_imp
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_IMP);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
     }
@@ -423,36 +416,24 @@ namespace logger
      * and log type before logging the message.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      *
-     * @note This function is only compiled and executed in debug mode.
-     * It is used to log debug information during development and testing.
-     * In release mode, this function will not be included in the binary.
+     * @note It is in every build, whether it logs is up to the log level in effect
+     * (see LogFilter), which is INF by default apart from the debug builds.
      */
     template<typename ...Args>
     void log_dbg
     (
-        [[maybe_unused]] const std::string_view fileName,
-        [[maybe_unused]] const std::string_view funcName,
-        [[maybe_unused]] const size_t lineNo,
-        [[maybe_unused]] const std::string_view format_str,
-        [[maybe_unused]] Args&&... args
+        const CallSite& site,
+        const std::string_view format_str,
+        Args&&... args
     )
     {
-    #if defined (DEBUG) || (__DEBUG__)
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_DBG);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
-    #endif
     }
 
     /**
@@ -463,9 +444,7 @@ namespace logger
      * and log type before logging the message. If `exitGracefuly` is true, it will exit the program gracefully.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] cond The condition that failed (assertion).
      * @param [in] exitGracefuly Whether to exit gracefully or abort on assertion failure.
      * @param [in] format_str The format string for the log message.
@@ -474,9 +453,7 @@ namespace logger
     template<typename ...Args>
     void log_assert
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const std::string_view cond,
         const bool exitGracefuly,
         const std::string_view format_str,
@@ -487,24 +464,16 @@ namespace logger
             return;
 
         loggerObj.setAssertCondition(cond); // Set the assertion condition
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_ASSERT);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
+        // The records queued so far, the assertion failure included, are written
+        // first. std::exit destroys loggingOps (and the thread local loggerObj) itself.
+        loggingOps.flush(FlushLevel::DATA_SYNC);
         if (exitGracefuly)
-        {
-            loggingOps.~LoggingOps();
-            loggerObj.~Logger();
             std::exit(EXIT_FAILURE);
-        }
         else
-        {
             std::abort();
-        }
     }
 
     /**
@@ -515,30 +484,24 @@ namespace logger
      * and log type before logging the message. After logging, it aborts the program.
      *
      * @tparam Args Variadic template parameters for additional arguments to be formatted into the log message.
-     * @param [in] fileName The name of the file where the log is being generated.
-     * @param [in] funcName The name of the function where the log is being generated.
-     * @param [in] lineNo The line number in the source code where the log is being generated.
+     * @param [in] site The call site descriptor of the log statement.
      * @param [in] format_str The format string for the log message.
      * @param [in] args Additional arguments to be formatted into the log message.
      */
     template<typename ...Args>
     void log_fatal
     (
-        const std::string_view fileName,
-        const std::string_view funcName,
-        const size_t lineNo,
+        const CallSite& site,
         const std::string_view format_str,
         Args&&... args
     )
     {
-        setLoggerProperties(fileName,
-                            funcName,
-                            FORWARD_ANGLE,
-                            lineNo,
-                            std::this_thread::get_id(),
-                            LOG_TYPE::LOG_FATAL);
+        setLoggerProperties(site, std::this_thread::get_id());
 
         logMsg(format_str, args...);
+        // The watcher thread is still there, so it writes the queued records,
+        // the fatal error included, before aborting (see CrashHandler for the crashes)
+        loggingOps.flush(FlushLevel::DATA_SYNC);
         std::abort();
     }
 };  // namespace logger
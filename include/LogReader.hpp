@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LogReader.hpp
+ * @brief Declaration of the LogReader class.
+ *
+ * LogReader hands out the lines of a log file one at a time as string views
+ * into a chunked buffer, so the memory it takes doesn't depend on the size of
+ * the file. A compressed file is decompressed block by block and a binary log
+ * file is rendered record by record, the lines are the same either way.
+ *
+ * A plain text or a compressed log file may be read while it is still being
+ * written to: next() returns false at the end of what is there so far and goes
+ * on with whatever got appended when called again later, like `tail -f` does.
+ * A line (or block) still being written is held back until it is complete.
+ */
+
+#ifndef LOG_READER_HPP
+#define LOG_READER_HPP
+
+#include "BinaryLog.hpp"
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace logger
+{
+    class LogReader
+    {
+        public:
+            /**
+             * @brief The size of the chunks a plain text file is read in. A line
+             * longer than it makes the buffer grow to hold it.
+             */
+            static constexpr size_t chunkSize = 64 * 1024;
+
+            LogReader() = delete;
+
+            /**
+             * @brief Construct a new Log Reader object and open the file
+             *
+             * @param [in] file The log file to be read
+             * @note A binary log file is read as much of it as there is when opened.
+             */
+            explicit LogReader(const std::filesystem::path& file);
+
+            /**
+             * @brief Destructor for LogReader class, closes the file
+             */
+            ~LogReader();
+
+            /**
+             * @brief Deleted copy constructor and move constructor
+             * to prevent copying and moving of LogReader objects
+             */
+            LogReader(const LogReader& rhs) = delete;
+            LogReader(LogReader&& rhs) = delete;
+            LogReader& operator=(const LogReader& rhs) = delete;
+            LogReader& operator=(LogReader&& rhs) = delete;
+
+            /**
+             * @brief Check if the file could be opened
+             */
+            inline bool isOpen() const noexcept                 { return m_Fd >= 0; }
+
+            /**
+             * @brief Read the next line
+             *
+             * @param [out] line The line without its new line. It points into the
+             *                   buffer of the reader, so it is valid until the next call.
+             * @return true If a line is read, otherwise
+             * @return false At the end of the file (so far)
+             * @note The zero bytes after the logged part of a mapped file (see
+             *       FileIoMode::MMAP) are taken as the end of the file so far. It is
+             *       only for a file ending in a zero byte, i.e. in its preallocated
+             *       space, a zero byte is a part of the line in any other file.
+             * @note Throws std::runtime_error if the file is corrupt.
+             */
+            bool next(std::string_view& line);
+
+            /**
+             * @brief Get the number of lines read so far
+             */
+            inline size_t getLinesCount() const noexcept        { return m_LinesCnt; }
+
+        private:
+            enum class Source
+            {
+                UNKNOWN,
+                TEXT,
+                COMPRESSED,
+                BINARY
+            };
+
+            /**
+             * @brief Find out what kind of file it is, once it has anything in it
+             */
+            bool detectSource();
+
+            /**
+             * @brief Get more of the text into the buffer
+             *
+             * @return true If the buffer got anything more, otherwise
+             * @return false
+             */
+            bool fill();
+            bool fillText();
+            bool fillCompressed();
+            bool fillBinary();
+
+            /**
+             * @brief Read from the file until the buffer holds the given number of bytes
+             *
+             * @return true If it does, otherwise
+             * @return false There is no more in the file for now
+             */
+            bool readUpTo(std::string& buffer, const size_t size);
+
+            /**
+             * @brief Give back the bytes read beyond the logged part of a mapped
+             * file, so that they are read afresh once they are written to
+             */
+            void unread(const size_t size);
+
+            /**
+             * @brief Check if the file ends in a zero byte as it is now, i.e. in the
+             * preallocated space of a mapped file (see next())
+             */
+            bool endsInZero() const noexcept;
+
+            int m_Fd;
+            Source m_Source;
+            std::string m_Buffer;
+            size_t m_Pos;
+            size_t m_LinesCnt;
+            /**
+             * @brief The block being read of a compressed file, and for a binary
+             * log file its content, either mapped or decompressed, the reader
+             * rendering it and the record rendered last
+             */
+            std::string m_Block;
+            char* m_pMapping;
+            size_t m_MappingSize;
+            std::string m_Content;
+            std::unique_ptr<BinaryLogReader> m_pBinaryReader;
+            std::string m_Record;
+    };
+};  // namespace logger
+
+#endif  // LOG_READER_HPP
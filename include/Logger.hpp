@@ -36,8 +36,10 @@
 #define LOGGER_HPP
 
 #include "Clock.hpp"
+#include "CallSite.hpp"
 #include "LoggingOps.hpp"
 
+#include <array>
 #include <cassert>
 #include <fmtmsg.h>
 #include <unordered_map>
@@ -60,8 +62,8 @@ namespace logger
         LOG_WARN    = 0x05,
         LOG_IMP     = 0x06,
         LOG_ASSERT  = 0x07,
-        // Any new type/entry should be added above this. Also update the maps
-        // m_stringToEnumMap & m_EnumToStringMap, accordingly in the CPP file.
+        // Any new type/entry should be added above this. Also update the map
+        // m_stringToEnumMap in the CPP file and the array m_LogTypeNames, accordingly.
         LOG_DEFAULT = 0xFF
     };
 
@@ -87,6 +89,7 @@ namespace logger
     inline static constexpr std::string_view FORWARD_ANGLES       = ">>";
     inline static constexpr std::string_view BACKWARD_ANGLE       = ">>";
     inline static constexpr std::string_view BACKWARD_ANGLES      = "<<";
+    inline static constexpr std::string_view SPAN_ANGLES          = "<>";
     inline static constexpr std::string_view LEFT_SQUARE_BRACE    = "[";
     inline static constexpr std::string_view RIGHT_SQUARE_BRACE   = "]";
     inline static constexpr std::string_view LEFT_CURLEY_BRACE    = "{";
@@ -96,6 +99,7 @@ namespace logger
     inline static constexpr std::string_view DOUBLE_QUOTES        = "\"";
     inline static constexpr std::string_view SINGLE_QUOTE         = "'";
     inline static constexpr std::string_view FIELD_SEPARATOR      = VERTICAL_SEP;
+    inline static constexpr std::string_view DEFAULT_TIME_FORMAT  = "%Y%m%d_%H%M%S";
 
     /**
      * @brief Type alias for amps used in logging.
@@ -133,9 +137,32 @@ namespace logger
              *
              * @param [in] type The LOG_TYPE enum value.
              * @return The string representation of the log type.
+             * @see logTypeName()
              */
             static std::string covertLogTypeEnumToString(const LOG_TYPE& type) noexcept;
 
+            /**
+             * @brief Get the name of a LOG_TYPE enum, as it is in the log records.
+             * Unlike covertLogTypeEnumToString() it doesn't copy the name.
+             *
+             * @param [in] type The LOG_TYPE enum value.
+             * @return std::string_view The name of the log type, "DEFAULT" for an unknown one.
+             */
+            static constexpr std::string_view logTypeName(const LOG_TYPE type) noexcept
+            {
+                auto idx = static_cast<size_t>(type);
+                return (idx < m_LogTypeNames.size()) ? m_LogTypeNames[idx] : m_LogTypeNames.front();
+            }
+
+            /**
+             * @brief Get a thread ID as it is in the log records, which is up to the platform.
+             *
+             * @param [in] threadId The thread ID
+             * @return std::string_view The thread ID as it is streamed out, valid till
+             *         the calling thread asks for a few other thread IDs
+             */
+            static std::string_view threadIdStr(const std::thread::id& threadId);
+
             /**
              * @brief Builds and returns a LoggingOps object.
              *
@@ -145,9 +172,62 @@ namespace logger
              * only once and can be reused across multiple Logger instances.
              *
              * @return A reference to the LoggingOps object.
+             * @note What it is made of is up to the settings of LogConfig, i.e. the
+             *       build time ones, the config file and the environment variables.
+             *       The settings which couldn't be taken are in the exceptions of it.
              */
             static LoggingOps& buildLoggingOpsObject() noexcept;
 
+            /**
+             * @brief Reload the settings of LogConfig and apply the ones which can be
+             * changed at any time: the log level, the console log level, the rate limit,
+             * the batching policy, the stats interval and the reload interval. The others (the sink,
+             * the log file, the rotation and the ring capacity) are taken at startup only.
+             *
+             * It is called on its own every RELOAD_INTERVAL once the config file changes.
+             *
+             * @return true If every setting could be taken, otherwise
+             * @return false The problems are in the exceptions of the LoggingOps object
+             */
+            static bool reloadConfig() noexcept;
+
+            /**
+             * @brief Switches the deferred formatting on or off.
+             *
+             * With deferred formatting a log statement only copies its call site,
+             * thread ID, time stamp, format string and arguments into the queue,
+             * and the watcher thread of LoggingOps formats the record (see
+             * DeferredRecord). Statements with arguments other than arithmetic
+             * types and strings, assertion failures and fatal errors are always
+             * formatted by the calling thread.
+             *
+             * @param [in] deferred true to format on the watcher thread, false
+             *                      to format on the calling thread (default).
+             */
+            static inline void setDeferredFormatting(const bool deferred) noexcept
+            {
+                m_isDeferredFormatting.store(deferred, std::memory_order_relaxed);
+            }
+
+            static inline bool isDeferredFormatting() noexcept
+            {
+                return m_isDeferredFormatting.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Strips the double quotes a stringified format
+             * string (#fmt_str of LOG_ENTRY/LOG_EXIT) comes with.
+             *
+             * @param [in] formatStr The format string.
+             * @return std::string_view The format string without the enclosing quotes.
+             */
+            static constexpr std::string_view stripQuotes(const std::string_view formatStr) noexcept
+            {
+                if (formatStr.size() >= 2 && formatStr.front() == DOUBLE_QUOTES.front() && formatStr.back() == DOUBLE_QUOTES.front())
+                    return formatStr.substr(1, formatStr.size() - 2);
+                return formatStr;
+            }
+
             Logger() = delete;
             Logger(const std::string_view timeFormat);
             virtual ~Logger() = default;
@@ -180,26 +260,18 @@ namespace logger
             Logger& setLineNo(const size_t val) noexcept;
 
             /**
-             * @brief Set the Function Name object
-             * This function sets the function name for the logger
-             * @note It is used to identify which function is logging the message.
+             * @brief Set the Call Site object
+             * This function sets the call site descriptor of the log statement,
+             * i.e. its file, class and function names, line, log type and marker.
+             * @note It is used to identify where the log message is coming from.
+             * The names are only referred to, not copied, as the descriptor
+             * lives as long as the program (see CallSite).
              * 
-             * @param [in] val The function name to be set.
+             * @param [in] site The call site of the log statement.
              * @return Logger& Returns a reference to the Logger object
              * to allow for method chaining.
              */
-            Logger& setFunctionName(const std::string_view val) noexcept;
-
-            /**
-             * @brief Set the File Name object
-             * This function sets the file name for the logger
-             * @note It is used to identify which file is logging the message.
-             * 
-             * @param [in] val The file name to be set.
-             * @return Logger& Returns a reference to the Logger object
-             * to allow for method chaining.
-             */
-            Logger& setFileName(const std::string_view val) noexcept;
+            Logger& setCallSite(const CallSite& site) noexcept;
 
             /**
              * @brief Set the Log Marker object
@@ -249,15 +321,30 @@ namespace logger
             Logger& setAssertCondition(const std::string_view cond) noexcept;
 
             /**
-             * @brief Get the Log Stream object
-             * This function returns the log stream
-             * @note It is used to retrieve the log stream where the log messages are written.
-             * 
-             * @return const std::stringstream& The log stream object
-             * @note It is a constant reference to the log stream object.
-             * This allows read-only access to the log stream without modifying it.
+             * @brief Get the Log Record object
+             * This function returns the last log record, i.e. its prefix and message
+             * @note The view is only valid until the next message is logged, as
+             * the buffer is reused for every message.
+             *
+             * @return std::string_view The log record
              */
-            inline const std::stringstream& getLogStream() const noexcept { return m_logStream; }
+            inline std::string_view getLogRecord() const noexcept { return m_logRecord; }
+
+            /**
+             * @brief Get the Call Site and the Thread Id set for the current log message.
+             */
+            inline const CallSite* getCallSite() const noexcept             { return m_pCallSite;   }
+            inline const std::thread::id& getThreadId() const noexcept      { return m_threadID;    }
+
+            /**
+             * @brief Logs an already formatted message.
+             * This function writes the prefix for the given point of time and the
+             * message to the log stream. It is used to render the deferred records.
+             *
+             * @param [in] timeStamp The point of time the message was logged at.
+             * @param [in] msg The formatted message.
+             */
+            void logFormatted(const std::chrono::system_clock::time_point& timeStamp, const std::string_view msg);
 
             /**
              * @brief Logs a message with the specified format and arguments.
@@ -310,36 +397,6 @@ namespace logger
             virtual void constructLogMsgPrefixSecondPart();
 
         private:
-            /**
-             * @brief Extracts the class and function names from the function name.
-             * This function extracts the class name and function name from the
-             * full function name string, which may include a scope resolution operator (::).
-             *
-             * @param [out] className The extracted class name.
-             * @param [out] funcName The extracted function name.
-             * 
-             * @note If pretty function name is in the format "ClassName::FunctionName"
-             * then use ClassName : FunctionName.
-             * If it is not in that format, then just use the function name
-             * as it is, without any class name.
-             * This is useful for logging purposes, to identify which class
-             * and function the log message is coming from.
-             * For example, if the function name is "Logger::log", then
-             * the class name will be "Logger" and the function name will be "log".
-             * If the function name is "log", then the class name will be empty
-             * and the function name will be "log".
-             * If the function name is "Logger::log()", then the class name will be "Logger"
-             * and the function name will be "log".
-             * If the function name is "Logger::log(const std::string&)", then the
-             * class name will be "Logger" and the function name will be "log".
-             * 
-             * In case of lamda functions on clang/gcc
-             * the pretty function name comes as
-             * "auto LoggerTest_testDiffFuncSignatures_Test::TestBody()::(anonymous class)::operator()"
-             * In this case the targeted aim is class : operator()
-             */
-            void extractClassAndFuncName(std::string& className, std::string& funcName) noexcept;
-
             /**
              * @brief Logs a message with the specified format and arguments.
              * This function formats the log message using the provided format string
@@ -353,13 +410,43 @@ namespace logger
              */
             void vlog(const std::string_view formatStr, std::format_args args);
 
+            /**
+             * @brief The capacity the log record buffer starts with. It grows for
+             * a longer message and keeps its memory for the next ones.
+             */
+            static constexpr size_t initialRecordCapacity = 512;
+
+            /**
+             * @brief The names of the log types, indexed by the LOG_TYPE value.
+             * LOG_DEFAULT, as well as any unknown value, maps to the first one.
+             */
+            static constexpr std::array<std::string_view, 8> m_LogTypeNames =
+            {
+                "DEFAULT",  // LOG_DEFAULT
+                "ERR",      // LOG_ERR
+                "INF",      // LOG_INFO
+                "DBG",      // LOG_DBG
+                "FATAL",    // LOG_FATAL
+                "WARN",     // LOG_WARN
+                "IMP",      // LOG_IMP
+                "ASRT"      // LOG_ASSERT
+            };
+
             static const UNORD_STRING_MAP m_stringToEnumMap;
-            static const UNORD_LOG_TYPE_MAP m_EnumToStringMap;
+            static std::atomic_bool m_isDeferredFormatting;
             std::thread::id m_threadID;
+            std::chrono::system_clock::time_point m_timeStamp;
+            const CallSite* m_pCallSite = nullptr;
             Clock m_clock;
             size_t m_lineNo;
-            std::string m_funcName;
-            std::string m_fileName;
+            /**
+             * @brief Names of the call site, views into
+             * the string literals of the CallSite object.
+             */
+            std::string_view m_fileName;
+            std::string_view m_className;
+            std::string_view m_funcName;
+            bool m_isLambda = false;
             /**
              * @brief Log marker
              * Marks what kind of log function
@@ -372,7 +459,10 @@ namespace logger
              */
             std::string m_logMarker = FORWARD_ANGLE.data();
 
-            std::stringstream m_logStream;
+            /**
+             * @brief The buffer the prefix and the message are rendered into
+             */
+            std::string m_logRecord;
             LOG_TYPE m_logType = LOG_TYPE::LOG_INFO;
             std::string m_assertCond;
     };
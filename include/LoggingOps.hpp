@@ -29,21 +29,152 @@
 #ifndef LOGGING_OPS_HPP
 #define LOGGING_OPS_HPP
 
-#include <queue>
+#include <array>
 #include <vector>
 #include <list>
-#include <array>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <exception>
 #include <condition_variable>
 
+#include "RecordRing.hpp"
+
 namespace logger
 {
-    constexpr size_t bufferSize = 4097; //4KB each line length max (+1 for NULL char)
+    enum class LOG_TYPE;
+    class RecordEncoder;
+
+    /**
+     * @brief The default number of bytes the ring between
+     * the producers and the watcher thread can hold.
+     */
+    constexpr size_t defaultRingCapacity = 1024 * 1024;
+
+    /**
+     * @brief The policy deciding when the watcher thread writes a batch.
+     * Whichever of the limits is hit first triggers the write.
+     *
+     * maxRecords : The number of pending records
+     * maxBytes   : The number of pending bytes (in the ring, i.e. with the record headers)
+     * maxLinger  : The time a record may wait at most, counted from the moment
+     *              the watcher thread noticed the first pending record
+     */
+    struct BatchPolicy
+    {
+        size_t maxRecords = 256;
+        size_t maxBytes = 64 * 1024;
+        std::chrono::microseconds maxLinger = std::chrono::milliseconds(5);
+    };
 
-    using BufferQ = std::queue<std::array<char, bufferSize>>;
+    /**
+     * @brief Enum class for the rings the producers push their records to.
+     *
+     * SHARED        : A single ring shared by all the producers.
+     * PER_CPU       : A staging ring per CPU, a producer pushes to the one of the
+     *                 CPU it runs on. So the producers on different CPUs don't
+     *                 contend for the same write position.
+     * PER_NUMA_NODE : A staging ring per NUMA node, a producer pushes to the one
+     *                 of the node it runs on. So the records don't cross the nodes
+     *                 till the watcher thread drains them.
+     *
+     * @note The staging rings are created as the producers first push to them, by
+     *       the very producer, so their memory is local to its node. The watcher
+     *       thread drains them all one after the other, and merges the records
+     *       of a batch by the time they were pushed.
+     * @note Apart from Linux the CPU a thread runs on is not known, the threads are
+     *       then spread over the rings round robin (PER_CPU), or share one (PER_NUMA_NODE).
+     */
+    enum class StagingMode
+    {
+        SHARED          = 0x01,
+        PER_CPU         = 0x02,
+        PER_NUMA_NODE   = 0x03
+    };
+
+    /**
+     * @brief The default number of bytes a staging ring can hold, see StagingMode.
+     */
+    constexpr size_t defaultStagingRingCapacity = 256 * 1024;
+
+    /**
+     * @brief Enum class for how far a flush has to go before it returns.
+     *
+     * WRITTEN   : The records are handed over to the sink (e.g. write() returned).
+     * DATA_SYNC : Additionally the file data is on the storage (fdatasync).
+     * FULL_SYNC : Additionally the file metadata is on the storage as well (fsync).
+     */
+    enum class FlushLevel
+    {
+        WRITTEN     = 0x01,
+        DATA_SYNC   = 0x02,
+        FULL_SYNC   = 0x03
+    };
+
+    /**
+     * @brief Enum class for how binary data is rendered into the records.
+     *
+     * BITS : Every value as its bits, one value per line, as write(uint8_t) does.
+     * HEX  : The values in hex, separated by a space, 32 bytes of them per line.
+     * RAW  : The bytes as they are in memory, not rendered at all. Meant for the
+     *        sinks taking binary data, in a text log they are not readable.
+     */
+    enum class BinaryEncoding
+    {
+        BITS        = 0x01,
+        HEX         = 0x02,
+        RAW         = 0x03
+    };
+
+    /**
+     * @brief A snapshot of the counters of a LoggingOps object, see LoggingOps::getStats().
+     * The counts are since the object was created, the queue ones are as of the snapshot.
+     *
+     * queuedRecords  : The records waiting in the ring
+     * queuedBytes    : Their bytes in the ring, i.e. with the record headers
+     * highWaterBytes : The most bytes the ring held, as seen by the watcher thread before draining it
+     * pushedRecords  : The records the producers pushed, a split record counts once per piece
+     * pushedBytes    : Their bytes
+     * writtenRecords : The records handed over to the sink
+     * writtenBytes   : Their bytes
+     * batches        : The batches the watcher thread wrote
+     * droppedRecords : The records dropped (or overwritten) as the ring was full
+     * blockedTime    : The time the producers waited for space in the ring (OverflowPolicy::BLOCK)
+     * writerBusyTime : The time the watcher thread spent writing the batches
+     * rotations      : The rotations of the log file (FileOps)
+     * exceptions     : The exceptions raised, including the ones not kept
+     */
+    struct LoggingStats
+    {
+        size_t queuedRecords = 0;
+        size_t queuedBytes = 0;
+        size_t highWaterBytes = 0;
+        uint64_t pushedRecords = 0;
+        uint64_t pushedBytes = 0;
+        uint64_t writtenRecords = 0;
+        uint64_t writtenBytes = 0;
+        uint64_t batches = 0;
+        uint64_t droppedRecords = 0;
+        std::chrono::nanoseconds blockedTime = std::chrono::nanoseconds(0);
+        std::chrono::nanoseconds writerBusyTime = std::chrono::nanoseconds(0);
+        uint64_t rotations = 0;
+        uint64_t exceptions = 0;
+
+        inline double averageBatchSize() const noexcept
+        {
+            return batches ? static_cast<double>(writtenRecords) / static_cast<double>(batches) : 0.0;
+        }
+
+        /**
+         * @brief Render the snapshot into a single line, e.g. for the stats line
+         * (see LoggingOps::setStatsInterval())
+         *
+         * @return std::string The stats line
+         */
+        std::string toString() const;
+    };
 
     class LoggingOps
     {
@@ -107,24 +238,188 @@ namespace logger
              * @note This function is thread safe. It uses mutex to ensure that
              * only one thread can add an exception at a time.
              */
-            inline void addRaisedException(const std::exception_ptr& excpPtr) noexcept      { m_excpPtrVec.emplace_back(excpPtr); }
+            void addRaisedException(const std::exception_ptr& excpPtr) noexcept;
+
+            /**
+             * @brief The number of exceptions kept by addRaisedException(), the
+             * ones beyond it are only counted (see LoggingStats::exceptions)
+             */
+            static constexpr size_t maxKeptExceptions = 1024;
+
+            /**
+             * @brief Get a snapshot of the counters
+             * The producers count in a slot of their own, the slots are only
+             * summed up here. So it is cheap for the producers and meant to be
+             * called every now and then, not with every record.
+             *
+             * @return LoggingStats The snapshot
+             * @note The sinks of a FanOutOps have their own counters, the
+             *       FanOutOps itself never queues a record.
+             */
+            LoggingStats getStats() const noexcept;
+
+            /**
+             * @brief Set the interval of the stats line. The watcher thread writes
+             * the stats (see LoggingStats::toString()) to the sink along with the
+             * first batch once the interval is over.
+             *
+             * @param [in] interval The interval, 0 (default) for no stats line
+             */
+            inline void setStatsInterval(const std::chrono::seconds interval) noexcept      { m_StatsIntervalSec.store(interval.count(), std::memory_order_relaxed); }
+
+            /**
+             * @brief Get the interval of the stats line
+             *
+             * @return std::chrono::seconds The interval, 0 for no stats line
+             */
+            inline std::chrono::seconds getStatsInterval() const noexcept                   { return std::chrono::seconds(m_StatsIntervalSec.load(std::memory_order_relaxed)); }
 
             /**
-             * @brief Default constructor for LoggingOps class
-             * Initializes the data records queue, data ready flag,
+             * @brief Get the number of records dropped (or overwritten)
+             * because the data records ring was full
+             *
+             * @return uint64_t The number of dropped records
+             */
+            uint64_t getDroppedRecordsCount() const noexcept;
+
+            /**
+             * @brief Get the policy applied when the data records ring is full
+             *
+             * @return OverflowPolicy The overflow policy
+             */
+            inline OverflowPolicy getOverflowPolicy() const noexcept                        { return m_DataRecords.getPolicy(); }
+
+            /**
+             * @brief Set the policy applied when the data records ring is full
+             *
+             * @param [in] policy The overflow policy
+             * @note It is the policy of the staging rings as well, see setStagingMode()
+             */
+            void setOverflowPolicy(const OverflowPolicy policy) noexcept;
+
+            /**
+             * @brief Set the rings the producers push their records to
+             *
+             * @param [in] mode The staging mode, see StagingMode
+             * @param [in] ringCapacity The number of bytes each of the staging rings can hold
+             * @note It can be changed at any time. The records already pushed are
+             *       drained from whichever ring they are in, and the staging rings
+             *       once created stay along with the object (at most maxStagingRings).
+             * @note The batching limits (see BatchPolicy) apply to each ring on its own.
+             */
+            void setStagingMode(const StagingMode mode, const size_t ringCapacity = defaultStagingRingCapacity) noexcept;
+
+            /**
+             * @brief Get the rings the producers push their records to
+             *
+             * @return StagingMode The staging mode
+             */
+            inline StagingMode getStagingMode() const noexcept                              { return m_StagingMode.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Get the number of staging rings created so far
+             *
+             * @return size_t The number of staging rings, the shared ring not counted
+             */
+            size_t getStagingRingsCount() const noexcept;
+
+            /**
+             * @brief The most staging rings an object has, the CPUs (or nodes)
+             * beyond them share the rings
+             */
+            static constexpr size_t maxStagingRings = 64;
+
+            /**
+             * @brief Pin the watcher thread, i.e. the writer, to a CPU. So that it
+             * stays off the CPUs of the latency critical threads, and near the sink.
+             *
+             * @param [in] cpu The CPU, counted from 0
+             * @return true If the watcher thread is pinned, otherwise
+             * @return false If there is no watcher thread (e.g. FanOutOps, see its
+             *         sinks instead), the CPU is invalid or the platform has no way
+             *         to pin a thread (only Linux has)
+             */
+            bool setWriterAffinity(const int cpu) noexcept;
+
+            /**
+             * @brief Check if the out stream object takes the deferred records as
+             * they are, instead of having them formatted by the watcher thread first
+             * (e.g. FileOps writing the binary log format, see BinaryLog)
+             *
+             * @return true If the deferred records are kept, otherwise
+             * @return false
+             * @note The LOG_* statements defer their records whenever it is true,
+             *       even with Logger::setDeferredFormatting(false).
+             */
+            inline bool keepsDeferredRecords() const noexcept                               { return m_keepsDeferredRecords.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Check if the records are wanted as deferred records, i.e. they are
+             * either kept as they are or encoded by the record encoder (see setRecordEncoder)
+             *
+             * @return true If the deferred records are wanted, otherwise
+             * @return false
+             * @note The LOG_* statements defer their records whenever it is true.
+             */
+            inline bool wantsDeferredRecords() const noexcept                               { return keepsDeferredRecords() || m_hasRecordEncoder.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Set the encoder the watcher thread writes the records with, in
+             * place of the text layout of the Logger (e.g. JsonEncoder, LogfmtEncoder)
+             *
+             * @param [in] encoder The encoder, nullptr for the text layout again
+             * @note It takes effect with the next batch. It has no effect if the
+             *       deferred records are kept as they are (e.g. the binary log format).
+             * @note FanOutOps hands the records over to its sinks, so the encoders
+             *       are set on the sinks, before they are added (see FanOutOps::addSink).
+             */
+            void setRecordEncoder(std::shared_ptr<const RecordEncoder> encoder);
+
+            /**
+             * @brief Get the encoder the watcher thread writes the records with
+             *
+             * @return std::shared_ptr<const RecordEncoder> The encoder, nullptr for the text layout
+             */
+            std::shared_ptr<const RecordEncoder> getRecordEncoder() const;
+
+            /**
+             * @brief Set the batching policy of the watcher thread
+             *
+             * @param [in] policy The batching policy
+             * @note It can be changed at any time, it takes effect with the next
+             * record pushed (limits) or the next wait of the watcher thread (linger).
+             */
+            void setBatchPolicy(const BatchPolicy& policy) noexcept;
+
+            /**
+             * @brief Get the batching policy of the watcher thread
+             *
+             * @return BatchPolicy The batching policy
+             */
+            BatchPolicy getBatchPolicy() const noexcept;
+
+            /**
+             * @brief Constructor for LoggingOps class
+             * Initializes the data records ring, data ready flag,
              * shutdown and exit flag, and starts the watcher thread
              *
+             * @param [in] ringCapacity The number of bytes the ring can hold
+             * @param [in] policy The policy to be applied when the ring is full
+             *
              * @note The watcher thread will keep watch and pull the data
-             * from the data records queue and write it to the file
+             * from the data records ring and write it to the file
              * whenever it is available.
-             * @note This function is thread safe. It uses mutex and condition variable
-             * to ensure that only one thread can keep watch and pull the data at a time.
+             * @note The producers never take a lock to push a record. Only the
+             * wake up of the watcher thread (once per batch) goes through the
+             * mutex and condition variable.
              */
-            LoggingOps();
+            explicit LoggingOps(const size_t ringCapacity = defaultRingCapacity,
+                                const OverflowPolicy policy = OverflowPolicy::BLOCK);
 
             /**
              * @brief Destructor for LoggingOps class
-             * Stops the watcher thread and clears the data records queue.
+             * Stops the watcher thread (if it is still running) once
+             * the data records ring is drained.
              * 
              * @note It also collects and prints any exceptions that occurred
              * during the data operations before the object is destroyed.
@@ -145,11 +440,34 @@ namespace logger
 
             /**
              * @brief flush the data records queue.
-             * It checks the data records queue and if it is not empty then
-             * notifies the watcher thread to write the data to the file/console
-             * immediately.
+             * Notifies the watcher thread to write the data to the file/console
+             * immediately, and waits exactly till every record pushed before
+             * the call is written (or dropped as per the overflow policy).
+             *
+             * @param [in] level How far the records have to go (default FlushLevel::WRITTEN).
+             *                   The sync levels are meant for crash safe checkpoints.
+             * @note A flush with nothing new to be written (or synced) since the
+             * last one returns immediately, without waking the watcher thread.
+             * @note Records pushed by other threads in parallel to the call are not
+             * waited for, unless they had their space reserved before the call.
+             */
+            virtual void flush(const FlushLevel level = FlushLevel::WRITTEN);
+
+            /**
+             * @brief Write the records still queued straight to the sink, for a crash
+             * It is async signal safe, i.e. meant for a signal handler (see CrashHandler):
+             * the records go out with write() to emergencyFd(), nothing is allocated
+             * and no lock is waited for. The watcher thread is not involved at all.
+             *
+             * @return size_t The number of records written
+             * @note The deferred records can't be formatted without allocating, so
+             *       their call site and format string are written instead.
+             * @note The batch the watcher thread is writing at the time is not in
+             *       the ring anymore, it is up to the watcher thread to finish it.
+             * @note The counts of the records the rate limited statements dropped,
+             *       pending their summary, are written last (see RateLimiter::sweep()).
              */
-            void flush();
+            virtual size_t emergencyDrain() noexcept;
 
             /**
              * @brief write the data.
@@ -160,6 +478,25 @@ namespace logger
              */
             void write(const std::string_view data);
 
+            /**
+             * @brief write the data of a log statement.
+             * Same as write(), but along with the log type of the statement, for
+             * the out stream objects picking the records by it (see FanOutOps).
+             *
+             * @param [in] data The data to be written to the file
+             * @param [in] type The log type of the statement
+             */
+            void write(const std::string_view data, const LOG_TYPE type);
+
+            /**
+             * @brief write a deferred record.
+             * Same as write(), but the record is formatted by the watcher
+             * thread right before it is written (see DeferredRecord).
+             *
+             * @param [in] record The deferred record as encoded by DeferredRecord::encode()
+             */
+            void writeDeferred(const std::string_view record);
+
             /**
              * @brief write the data.
              * Writes the data passed to it. The data is  pushed to the
@@ -240,8 +577,9 @@ namespace logger
              * data records queue and then the watcher thread will pick it up.
              *
              * @param [in] binaryStream The binary data stream (uint8_t) to be written to.
-             * @note It internally calls write(const uint8_t data) in a loop
-             * @see write(const uint8_t data)
+             * @note Every value goes to a line of its own, as write(const uint8_t data) writes
+             *       it, though all of them are rendered into a single record.
+             * @see writeBinary()
              */
             void write(const std::vector<uint8_t>& binaryStream);
 
@@ -251,8 +589,9 @@ namespace logger
              * data records queue and then the watcher thread will pick it up.
              *
              * @param [in] binaryStream The binary data stream (uint16_t) to be written to.
-             * @note It internally calls write(const uint16_t data) in a loop
-             * @see write(const uint16_t data)
+             * @note Every value goes to a line of its own, as write(const uint16_t data) writes
+             *       it, though all of them are rendered into a single record.
+             * @see writeBinary()
              */
             void write(const std::vector<uint16_t>& binaryStream);
 
@@ -262,8 +601,9 @@ namespace logger
              * data records queue and then the watcher thread will pick it up.
              *
              * @param [in] binaryStream The binary data stream (uint32_t) to be written to.
-             * @note It internally calls write(const uint32_t data) in a loop
-             * @see write(const uint32_t data)
+             * @note Every value goes to a line of its own, as write(const uint32_t data) writes
+             *       it, though all of them are rendered into a single record.
+             * @see writeBinary()
              */
             void write(const std::vector<uint32_t>& binaryStream);
 
@@ -273,11 +613,31 @@ namespace logger
              * data records queue and then the watcher thread will pick it up.
              *
              * @param [in] binaryStream The binary data stream (uint64_t) to be written to.
-             * @note It internally calls write(const uint64_t data) in a loop
-             * @see write(const uint64_t data)
+             * @note Every value goes to a line of its own, as write(const uint64_t data) writes
+             *       it, though all of them are rendered into a single record.
+             * @see writeBinary()
              */
             void write(const std::vector<uint64_t>& binaryStream);
 
+            /**
+             * @brief Write a binary data stream, e.g. a packet, in bulk.
+             * The values are rendered with lookup tables into a buffer kept by the
+             * calling thread, and make a single record (or a record per
+             * maxBinaryRecordSize bytes of the rendered text, split between the lines).
+             *
+             * @param [in] binaryStream The binary data stream to be written
+             * @param [in] encoding How the data is rendered, see BinaryEncoding
+             */
+            void writeBinary(const std::vector<uint8_t>& binaryStream, const BinaryEncoding encoding = BinaryEncoding::HEX);
+            void writeBinary(const std::vector<uint16_t>& binaryStream, const BinaryEncoding encoding = BinaryEncoding::HEX);
+            void writeBinary(const std::vector<uint32_t>& binaryStream, const BinaryEncoding encoding = BinaryEncoding::HEX);
+            void writeBinary(const std::vector<uint64_t>& binaryStream, const BinaryEncoding encoding = BinaryEncoding::HEX);
+
+            /**
+             * @brief The size of the records writeBinary() renders at most
+             */
+            static constexpr size_t maxBinaryRecordSize = 64 * 1024;
+
             /**
              * @brief Append the data.
              * Appends the outstream object with the data passed to it.
@@ -377,6 +737,8 @@ namespace logger
         protected:
             /**
              * @brief Keep watch and pull the data from the data records queue
+             * It is the body of the watcher thread, which lives as long as the
+             * object and writes every drained batch to the out stream object itself.
              *
              * @note This function is thread safe. It uses mutex and condition variable
              * to ensure that only one thread can keep watch and pull the data at a time.
@@ -387,16 +749,48 @@ namespace logger
              */
             void keepWatchAndPull();
 
+            /**
+             * @brief Stop the watcher thread
+             * Wakes the watcher thread up, lets it drain whatever is left
+             * in the data records ring and joins it.
+             *
+             * @note The derived classes must call it from their destructor,
+             * so that the last batches are still written through their
+             * writeToOutStreamObject while their members are alive.
+             */
+            void stopWatcher();
+
             /**
              * @brief Write to the file
+             * It is always called from the watcher thread.
              *
-             * @param [in] dataQueue The data queue to be written to the file
+             * @param [in] dataArena The batch of records to be written to the file
              * @param [out] excpPtr The exception pointer to be used for exception handling
              *
              * @note This function is thread safe. It uses mutex and condition variable
              * to ensure that only one thread can write to the outstream object at a time.
              */
-            virtual void writeToOutStreamObject(BufferQ&& /*dataQueue*/, std::exception_ptr& /*excpPtr*/) {}
+            virtual void writeToOutStreamObject(const RecordArena& /*dataArena*/, std::exception_ptr& /*excpPtr*/) {}
+
+            /**
+             * @brief Sync the data written so far to the storage
+             * It is called by flush() for the sync levels, once all the
+             * records it waits for are written by the watcher thread.
+             *
+             * @param [in] level Either FlushLevel::DATA_SYNC or FlushLevel::FULL_SYNC
+             * @param [out] excpPtr The exception pointer to be used for exception handling
+             * @note The default implementation does nothing, as not every sink has a storage.
+             */
+            virtual void syncOutStreamObject(const FlushLevel /*level*/, std::exception_ptr& /*excpPtr*/) {}
+
+            /**
+             * @brief Get the file descriptor emergencyDrain() writes the records to
+             * It is called from a signal handler, so it must be async signal safe.
+             *
+             * @return int The file descriptor, -1 to write nothing.
+             *         The default is the standard error.
+             */
+            virtual int emergencyFd() const noexcept;
 
             /**
              * @brief Write data to the out stream object
@@ -407,31 +801,162 @@ namespace logger
              */
             virtual void writeDataTo(const std::string_view data) = 0;
 
+            /**
+             * @brief Get the kind of the record the calling thread is writing
+             * It is meant to be called from writeDataTo().
+             *
+             * @return RecordKind DEFERRED within writeDeferred(), TEXT otherwise
+             */
+            static RecordKind pushedRecordKind() noexcept;
+
+            /**
+             * @brief Get the log type of the record the calling thread is writing
+             * It is meant to be called from writeDataTo().
+             *
+             * @return LOG_TYPE The log type passed to write(data, type),
+             *         LOG_TYPE::LOG_DEFAULT if the record came without one
+             * @note A deferred record carries its log type in its call site
+             *       instead, see DeferredRecord::decode().
+             */
+            static LOG_TYPE pushedRecordType() noexcept;
+
             /**
              * @brief Pops the data to a data buffer
              *
-             * @param [out] data The data to be popped from the data records queue
+             * @param [out] data The arena the records are moved to from the data records ring.
+             *                   It is cleared first, but keeps its memory.
              * @return true If the data was popped successfully, otherwise
              * @return false
              */
-            bool pop(BufferQ& data);
+            bool pop(RecordArena& data);
 
             /**
-             * @brief Push the data to the data records queue
+             * @brief Push the data to the data records ring
              *
-             * @param [in] data The data to be pushed to the data records queue
-             * @note This function is thread safe. It uses mutex and condition variable
-             * to ensure that only one thread can push the data at a time.
+             * @param [in] data The data to be pushed to the data records ring
+             * @note This function is thread safe and lock free. The record is
+             * copied once, length-prefixed, into the space reserved in the ring,
+             * and the configured overflow policy is applied if the ring is full.
+             * @note Only records longer than the half of the ring capacity are split.
+             * A deferred record that long is formatted right away and pushed as text.
              */
             void push(const std::string_view data);
 
-            BufferQ m_DataRecords;
+            /**
+             * @brief Wake up the watcher thread to pull the data records
+             *
+             * @note Only the first caller after the watcher thread went
+             * to sleep takes the mutex, the rest of them return immediately.
+             */
+            void notifyWatcher();
+
+            /**
+             * @brief Publish the ring positions the watcher thread is done with,
+             * i.e. the read positions after the last write, and wake up the threads
+             * waiting in flush() for them
+             */
+            void markWritten();
+
+            /**
+             * @brief Check if any flush() waits for records not yet written
+             *
+             * @return true If a flush is waiting, otherwise
+             * @return false
+             */
+            bool isFlushPending() const noexcept;
+
+            /**
+             * @brief Count a rotation of the log file, see LoggingStats::rotations
+             */
+            inline void countRotation() noexcept                                            { m_RotationsCnt.fetch_add(1, std::memory_order_relaxed); }
+
+            /**
+             * @brief Get the ring the calling thread is to push to, see StagingMode
+             */
+            RecordRing& stagingRing();
+
+            /**
+             * @brief Check if all the rings are empty
+             */
+            bool areRingsEmpty() const noexcept;
+
+            /**
+             * @brief Call the visitor for every ring, the shared one and the
+             * staging ones, along with its index
+             *
+             * @tparam Visit Callable of signature void(size_t, RecordRing&)
+             * @param [in] visit The callable
+             */
+            template<typename Visit>
+            void forEachRing(Visit&& visit) const
+            {
+                const auto ringsCnt = m_RingsCnt.load();
+                for (size_t idx = 0; idx < ringsCnt; ++idx)
+                {
+                    if (auto pRing = m_Rings[idx].load(std::memory_order_acquire); pRing)
+                        visit(idx, *pRing);
+                }
+            }
+
+            /**
+             * @brief The ring shared by the producers, and the staging rings.
+             * m_Rings holds them all, the shared one first, as the producers
+             * and the watcher thread look them up; m_StagingRings owns the staging
+             * ones. m_RingsCnt is one more than the highest index in use.
+             */
+            RecordRing m_DataRecords;
+            std::atomic<StagingMode> m_StagingMode;
+            std::atomic<size_t> m_StagingRingCapacity;
+            std::array<std::atomic<RecordRing*>, maxStagingRings + 1> m_Rings;
+            std::array<std::unique_ptr<RecordRing>, maxStagingRings + 1> m_StagingRings;
+            std::atomic<size_t> m_RingsCnt;
             std::mutex m_DataRecordsMtx;
             std::condition_variable m_DataRecordsCv;
             std::atomic_bool m_dataReady;
             std::atomic_bool m_shutAndExit;
             std::thread m_watcher;
 
+            /**
+             * @brief The batching policy, kept in atomics as the producers
+             * read the limits with every push. And the flag telling the watcher
+             * thread is sleeping without a time out as the ring was empty.
+             */
+            std::atomic<size_t> m_BatchMaxRecords;
+            std::atomic<size_t> m_BatchMaxBytes;
+            std::atomic<int64_t> m_BatchMaxLingerUs;
+            std::atomic_bool m_isWatcherIdle;
+
+            /**
+             * @brief Set by the derived classes writing the deferred records
+             * themselves, the watcher thread then doesn't format them
+             */
+            std::atomic_bool m_keepsDeferredRecords;
+
+            /**
+             * @brief The record encoder, taken by the watcher thread once per batch.
+             * The flag is for the producers, which only need to know there is one.
+             */
+            mutable std::mutex m_RecordEncoderMtx;
+            std::shared_ptr<const RecordEncoder> m_pRecordEncoder;
+            std::atomic_bool m_hasRecordEncoder;
+
+            /**
+             * @brief The flush barrier. The positions are the byte positions of
+             * the rings, which only ever grow, one set per ring (see m_Rings):
+             * the highest position any flush() waits for, the one the watcher
+             * thread is done writing up to and the one synced to the storage up to.
+             */
+            struct RingProgress
+            {
+                std::atomic<uint64_t> m_FlushTarget{0};
+                std::atomic<uint64_t> m_WrittenPos{0};
+                std::atomic<uint64_t> m_SyncedPos{0};
+            };
+            std::mutex m_FlushMtx;
+            std::condition_variable m_FlushCv;
+            bool m_isWatcherStopped;
+            std::array<RingProgress, maxStagingRings + 1> m_RingsProgress;
+
             /**
              * @brief It is a vector of exception pointers
              * which is used to store the exceptions occurred
@@ -454,6 +979,87 @@ namespace logger
              */
             void collectAndPrintExceptions();
 
+            /**
+             * @brief Count a batch written by the watcher thread
+             *
+             * @param [in] dataArena The batch
+             * @param [in] busyTime The time it took to write it
+             */
+            void countBatch(const RecordArena& dataArena, const std::chrono::nanoseconds busyTime) noexcept;
+
+            /**
+             * @brief Write the stats line, if it is enabled and its interval is over.
+             * It is called from the watcher thread after a batch.
+             *
+             * @param [in] dataArena The arena to build the line in
+             */
+            void writeStatsLineIfDue(RecordArena& dataArena);
+
+            /**
+             * @brief Create the staging ring of an index, unless another producer just did
+             *
+             * @param [in] idx The index in m_Rings
+             * @return RecordRing* The staging ring
+             */
+            RecordRing* createStagingRing(const size_t idx);
+
+            /**
+             * @brief Drain the staging rings and merge their records by the
+             * time they were pushed. It is called from the watcher thread.
+             * The records pushed while draining are left for the next batch.
+             *
+             * @param [out] data The arena the records are appended to
+             */
+            void drainStagingRings(RecordArena& data);
+
+            /**
+             * @brief The records drained from each of the staging rings, to be merged.
+             * Only the watcher thread touches them.
+             */
+            struct StagedBatch
+            {
+                RecordArena m_Records;
+                std::vector<uint64_t> m_Stamps;
+            };
+            std::vector<StagedBatch> m_StagedBatches;
+
+            /**
+             * @brief The counters of the producers, a slot of its own cache line per
+             * thread (the threads share the slots only beyond producerSlotsCnt of them)
+             */
+            struct alignas(cacheLineSize) ProducerCounters
+            {
+                std::atomic<uint64_t> m_PushedRecords{0};
+                std::atomic<uint64_t> m_PushedBytes{0};
+                std::atomic<uint64_t> m_BlockedNs{0};
+            };
+            static constexpr size_t producerSlotsCnt = 32;
+
+            /**
+             * @brief Get the counters slot of the calling thread
+             */
+            ProducerCounters& producerCounters() noexcept;
+
+            std::array<ProducerCounters, producerSlotsCnt> m_ProducerCounters;
+
+            /**
+             * @brief The counters of the watcher thread, which is the only one writing them
+             */
+            alignas(cacheLineSize) std::atomic<uint64_t> m_WrittenRecords;
+            std::atomic<uint64_t> m_WrittenBytes;
+            std::atomic<uint64_t> m_BatchesCnt;
+            std::atomic<uint64_t> m_WriterBusyNs;
+            std::atomic<size_t> m_HighWaterBytes;
+            std::atomic<uint64_t> m_RotationsCnt;
+            std::atomic<int64_t> m_StatsIntervalSec;
+            std::chrono::steady_clock::time_point m_LastStatsTime;
+
+            /**
+             * @brief Guards m_excpPtrVec, and the count of the exceptions raised
+             */
+            std::mutex m_ExcpMtx;
+            std::atomic<uint64_t> m_ExceptionsCnt;
+
             /**
              * @brief The name of the file where the exceptions will be logged
              * It is a static constexpr string_view which is used to store the name of the file
@@ -0,0 +1,321 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file NetworkOps.hpp
+ * @brief Declaration of the NetworkOps class.
+ *
+ * NetworkOps ships the records to a remote collector as syslog messages (RFC 5424),
+ * either a datagram per record over UDP (RFC 5426) or octet counted over TCP
+ * (RFC 6587). The records leave the way they do for the other sinks: the watcher
+ * thread drains a batch from the ring and sends the whole of it at once, with a
+ * single sendmmsg() (UDP, Linux) or send() of the coalesced batch (TCP). So the
+ * producers never wait for the network, a slow or gone collector only fills up
+ * the ring (see OverflowPolicy).
+ *
+ * While the collector can't be reached the connection is tried again with an
+ * exponential backoff, and the records go to the spill file meanwhile (if set,
+ * see setSpillFile()), or are counted as lost.
+ */
+
+#ifndef NETWORK_OPS_HPP
+#define NETWORK_OPS_HPP
+
+#include "LoggingOps.hpp"
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <optional>
+#include <string_view>
+
+namespace logger
+{
+    class FileOps;
+
+    /**
+     * @brief Enum class for the protocol NetworkOps ships the records with.
+     *
+     * UDP_SYSLOG : A syslog message per datagram (RFC 5426). A datagram lost on the
+     *              way goes unnoticed, the collector not listening is noticed only
+     *              once the host tells so, i.e. a batch or so later.
+     * TCP_SYSLOG : The syslog messages over a TCP stream, each prefixed with its
+     *              length (octet counting, RFC 6587).
+     */
+    enum class NetworkProtocol
+    {
+        UDP_SYSLOG  = 0x01,
+        TCP_SYSLOG  = 0x02
+    };
+
+    /**
+     * @brief The collector a NetworkOps object ships to, e.g. parsed
+     * from udp://collector:514 or tcp://[::1]:6514
+     */
+    struct NetworkTarget
+    {
+        std::string host;
+        uint16_t port = 514;
+        NetworkProtocol protocol = NetworkProtocol::UDP_SYSLOG;
+
+        /**
+         * @brief Parse a target of the form udp://host:port or tcp://host:port,
+         * an IPv6 address in brackets. The port is 514 if left out.
+         *
+         * @param [in] target The target
+         * @return std::optional<NetworkTarget> The target, std::nullopt if it is not one
+         */
+        static std::optional<NetworkTarget> parse(const std::string_view target);
+    };
+
+    class NetworkOps : public LoggingOps
+    {
+        public:
+            /**
+             * @brief Construct a new Network Ops object
+             * The collector is connected to by the watcher thread, with the first batch.
+             *
+             * @param [in] host The host name or address of the collector
+             * @param [in] port The port of the collector
+             * @param [in] protocol The protocol, see NetworkProtocol
+             * @param [in] ringCapacity The number of bytes the ring of the records can hold
+             */
+            NetworkOps(const std::string& host, const uint16_t port,
+                       const NetworkProtocol protocol = NetworkProtocol::UDP_SYSLOG,
+                       const size_t ringCapacity = defaultRingCapacity);
+
+            /**
+             * @brief Destructor for NetworkOps class
+             * The records still queued are sent (or spilled) before the socket is closed.
+             */
+            virtual ~NetworkOps();
+
+            /**
+             * @brief Deleted copy constructor and move constructor
+             * to prevent copying and moving of NetworkOps objects
+             */
+            NetworkOps(const NetworkOps& rhs) = delete;
+            NetworkOps(NetworkOps&& rhs) = delete;
+            NetworkOps& operator=(const NetworkOps& rhs) = delete;
+            NetworkOps& operator=(NetworkOps&& rhs) = delete;
+
+            /**
+             * @brief Set the file the records go to while the collector can't be reached
+             *
+             * @param [in] spillFile The file, nullptr for none (the records are then lost)
+             * @return NetworkOps& The object itself, for chaining
+             * @note The records are written to it as the syslog messages they would have
+             *       been sent as, a line each, so that they can be shipped later on.
+             *       They are not sent from it once the collector is back.
+             */
+            NetworkOps& setSpillFile(const std::shared_ptr<FileOps>& spillFile);
+
+            /**
+             * @brief Set the time waited before the connection is tried again, it
+             * starts with the least one and doubles with every failed try
+             *
+             * @param [in] minBackoff The time waited after the first failure (default 100ms)
+             * @param [in] maxBackoff The time waited at most (default 30s)
+             * @return NetworkOps& The object itself, for chaining
+             */
+            NetworkOps& setReconnectBackoff(const std::chrono::milliseconds minBackoff, const std::chrono::milliseconds maxBackoff);
+
+            /**
+             * @brief Set the syslog facility of the messages (default 1, user-level)
+             *
+             * @param [in] facility The facility, 0 to 23
+             * @return NetworkOps& The object itself, for chaining
+             */
+            NetworkOps& setSyslogFacility(const uint8_t facility);
+
+            /**
+             * @brief Set the HOSTNAME of the messages (default the name of the host)
+             *
+             * @param [in] hostName The host name, the characters not allowed by
+             *                      RFC 5424 (e.g. spaces) are replaced by '_'
+             * @return NetworkOps& The object itself, for chaining
+             */
+            NetworkOps& setHostName(const std::string_view hostName);
+
+            /**
+             * @brief Set the APP-NAME of the messages (default the name of the program)
+             *
+             * @param [in] appName The name, the characters not allowed by RFC 5424
+             *                     (e.g. spaces) are replaced by '_'
+             * @return NetworkOps& The object itself, for chaining
+             */
+            NetworkOps& setAppName(const std::string_view appName);
+
+            /**
+             * @brief Check if the collector is connected to, i.e. the last batch was sent
+             *
+             * @return true If it is connected to, otherwise
+             * @return false
+             */
+            inline bool isConnected() const noexcept                    { return m_isConnected.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Get the number of records sent, spilled to the spill file and lost so far
+             */
+            inline uint64_t getSentRecordsCount() const noexcept        { return m_SentCnt.load(std::memory_order_relaxed); }
+            inline uint64_t getSpilledRecordsCount() const noexcept     { return m_SpilledCnt.load(std::memory_order_relaxed); }
+            inline uint64_t getLostRecordsCount() const noexcept        { return m_LostCnt.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Get the number of times the collector was connected to
+             */
+            inline uint64_t getConnectsCount() const noexcept           { return m_ConnectsCnt.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief The size of the messages sent over UDP at most, the longer ones are cut
+             */
+            static constexpr size_t maxDatagramSize = 65000;
+
+            /**
+             * @brief The time a connection or a send may take at most, so that
+             * a collector gone silent doesn't hold the watcher thread forever
+             */
+            static constexpr std::chrono::milliseconds ioTimeout = std::chrono::milliseconds(1000);
+
+            /**
+             * @brief Get the Class Id for the object
+             *
+             * @return std::string The class id of the object
+             * @see LoggingOps::getClassId()
+             */
+            inline const std::string getClassId() const override { return "NetworkOps"; }
+
+        protected:
+            /**
+             * @brief Push the record to the ring
+             *
+             * @param [in] data The record, either plain text or a deferred record
+             * @note A text record is prefixed with the syslog severity of its log
+             *       type, a deferred one carries it in its call site.
+             */
+            void writeDataTo(const std::string_view data) override;
+
+            /**
+             * @brief Send a batch of records to the collector
+             *
+             * @param [in] dataArena The batch of records
+             * @param [out] excpPtr The exception pointer to be used for exception handling
+             * @note The records are made syslog messages into a buffer reused for all the
+             *       batches, and sent at once. Those the collector didn't take go to the
+             *       spill file, and the connection is tried again later on.
+             */
+            void writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& excpPtr) override;
+
+        private:
+            /**
+             * @brief A message of the batch in m_SendBuffer: where it starts
+             * (with the TCP length prefix), where its syslog message starts and its end
+             */
+            struct Frame
+            {
+                size_t m_Start;
+                size_t m_MsgStart;
+                size_t m_End;
+            };
+
+            /**
+             * @brief Connect to the collector, unless the backoff is not over yet
+             *
+             * @return true If the socket is connected, otherwise
+             * @return false
+             */
+            bool connectSocket();
+
+            /**
+             * @brief Close the socket, the connection is tried again after the backoff
+             *
+             * @param [in] err The errno of the failure
+             */
+            void closeSocket(const int err) noexcept;
+
+            /**
+             * @brief Send the frames of m_SendBuffer
+             *
+             * @return size_t The number of frames sent (from the first one on)
+             */
+            size_t sendFrames();
+
+            /**
+             * @brief Put the syslog messages of a batch together in m_SendBuffer
+             *
+             * @param [in] dataArena The batch of records
+             */
+            void frameBatch(const RecordArena& dataArena);
+
+            /**
+             * @brief Make a name fit for the HOSTNAME or APP-NAME of a message
+             */
+            static std::string toHeaderField(const std::string_view name, const size_t maxSize);
+
+            const std::string m_Host;
+            const uint16_t m_Port;
+            const NetworkProtocol m_Protocol;
+
+            /**
+             * @brief The settings, copied by the watcher thread to m_BatchSettings once per batch
+             */
+            struct Settings
+            {
+                std::shared_ptr<FileOps> m_pSpillFile;
+                std::chrono::milliseconds m_MinBackoff = std::chrono::milliseconds(100);
+                std::chrono::milliseconds m_MaxBackoff = std::chrono::milliseconds(30000);
+                uint8_t m_Facility = 1;
+                std::string m_HostName;
+                std::string m_AppName;
+            };
+            mutable std::mutex m_SettingsMtx;
+            Settings m_Settings;
+            Settings m_BatchSettings;
+
+            /**
+             * @brief The state of the connection, the watcher thread's own
+             */
+            int m_SocketFd;
+            std::chrono::milliseconds m_Backoff;
+            std::chrono::steady_clock::time_point m_NextConnectTime;
+            bool m_isLossReported;
+            int m_LastErrno;
+
+            /**
+             * @brief The batch as syslog messages, reused for all the batches
+             */
+            std::string m_SendBuffer;
+            std::string m_MsgBuffer;
+            std::vector<Frame> m_Frames;
+
+            std::atomic_bool m_isConnected;
+            std::atomic<uint64_t> m_SentCnt;
+            std::atomic<uint64_t> m_SpilledCnt;
+            std::atomic<uint64_t> m_LostCnt;
+            std::atomic<uint64_t> m_ConnectsCnt;
+    };
+};  // namespace logger
+
+#endif  // NETWORK_OPS_HPP
@@ -0,0 +1,231 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file RateLimiter.hpp
+ * @brief Declaration of the RateLimiter class.
+ *
+ * RateLimiter lets through at most a given number of records per interval from
+ * a single log statement, e.g. a LOG_ERR in a retry loop of a dependency being
+ * down, so that it doesn't flood the log file and keep on rotating it. Every
+ * LOG_* statement which can be filtered out has one of its own (see LOGGER_MACROS.hpp).
+ *
+ * The records beyond the limit are dropped before they are formatted. The first
+ * record let through once the interval is over is preceded by a summary record
+ * telling how many of them were dropped. A statement gone quiet for a whole
+ * interval after that gets its summary from a sweeper thread instead, and the
+ * counts still pending are written at the exit and by LoggingOps::emergencyDrain().
+ * The limit is the same for every log statement, and switched off by default.
+ *
+ * A statement over its limit costs a relaxed load, a look at the steady clock and
+ * a single atomic increment, i.e. neither the queue nor the lock of the
+ * watcher thread is touched. Only the first record it drops ever takes more, to
+ * put the statement on the list of the sweeper (see enlist()).
+ */
+
+#ifndef RATE_LIMITER_HPP
+#define RATE_LIMITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace logger
+{
+    class CallSite;
+
+    class RateLimiter
+    {
+        public:
+            /**
+             * @brief The interval the limit is for by default
+             */
+            static constexpr std::chrono::milliseconds defaultInterval = std::chrono::seconds(1);
+
+            /**
+             * @brief Construct a new Rate Limiter object, for a log statement
+             * It is constant initialized, so a static one in a function costs no guard.
+             */
+            constexpr RateLimiter() noexcept
+                : m_State(0)
+                , m_pSite(nullptr)
+                , m_pNext(nullptr)
+            {}
+
+            RateLimiter(const RateLimiter&) = delete;
+            RateLimiter& operator=(const RateLimiter&) = delete;
+
+            /**
+             * @brief Set the limit of every log statement
+             *
+             * @param [in] maxRecords The number of records let through per interval, 0 for no limit
+             * @param [in] interval The interval, a millisecond at least
+             */
+            static void setLimit(const uint32_t maxRecords, const std::chrono::milliseconds interval = defaultInterval) noexcept;
+
+            /**
+             * @brief Get the number of records let through per interval, 0 for no limit
+             */
+            static inline uint32_t getMaxRecords() noexcept         { return m_MaxRecords.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Get the interval the limit is for
+             */
+            static inline std::chrono::milliseconds getInterval() noexcept
+            {
+                return std::chrono::milliseconds(m_IntervalMs.load(std::memory_order_relaxed));
+            }
+
+            /**
+             * @brief Check whether a record of the log statement is to be let through
+             *
+             * @param [out] suppressedCnt The number of records dropped in the last interval
+             *              the statement was logged in, set by the first record of a new
+             *              interval only (left as it is otherwise). It is for the summary record.
+             * @return true If the record is to be logged, otherwise
+             * @return false If the limit of the interval is hit
+             */
+            inline bool allow(uint64_t& suppressedCnt) noexcept
+            {
+                const auto maxRecords = m_MaxRecords.load(std::memory_order_relaxed);
+                if (!maxRecords)
+                    return true;
+
+                // The first record of an interval starts it over, the window and
+                // the count of the records are swapped in at once. A failed swap
+                // is either another record starting it first or the sweeper taking
+                // the dropped ones of the last interval, hence looked at again.
+                const auto window = currentWindow();
+                auto state = m_State.load(std::memory_order_relaxed);
+                while (windowOf(state) != window)
+                {
+                    if (m_State.compare_exchange_weak(state, pack(window, 1), std::memory_order_relaxed))
+                    {
+                        auto cnt = countOf(state);
+                        suppressedCnt = (cnt > maxRecords) ? cnt - maxRecords : 0;
+                        return true;
+                    }
+                }
+
+                // The count stops at its max rather than carrying over into the window,
+                // a failed swap is looked at again the same way as above.
+                while (true)
+                {
+                    const auto cnt = countOf(state);
+                    if (cnt == UINT32_MAX)
+                        return false;
+                    if (m_State.compare_exchange_weak(state, state + 1, std::memory_order_relaxed))
+                        return cnt < maxRecords;
+                    if (windowOf(state) != window)
+                        return allow(suppressedCnt);
+                }
+            }
+
+            /**
+             * @brief Put the log statement on the list of the sweeper, once it drops a record
+             * The sweeper thread is started by the first one put on the list.
+             *
+             * @param [in] site The call site descriptor of the log statement, for its summary record
+             * @note The rate limiter must be a static object, as the list is never cleared
+             *       (see LOGGER_FILTERED_CALL_SITE). It costs a relaxed load once the
+             *       statement is on the list.
+             */
+            inline void enlist(const CallSite& site) noexcept
+            {
+                if (!m_isListed.test(std::memory_order_relaxed)) [[unlikely]]
+                    enlistOnce(site);
+            }
+
+            /**
+             * @brief Take the counts of the records the listed log statements dropped
+             * and not summed up yet, each one by a single caller only
+             *
+             * @param [in] isFlush Whether the counts of the current interval are taken as
+             *             well, e.g. for the exit. Otherwise it is only the ones of the
+             *             statements quiet for a whole interval after the one they dropped in,
+             *             the others get their summary from their next record.
+             * @param [in] report The callable taking the call site and the count
+             * @return size_t The number of log statements reported
+             * @note It is async signal safe, as long as the report is.
+             */
+            template<typename Report>
+            static size_t sweep(const bool isFlush, Report&& report)
+            {
+                // Nothing is dropped without a limit, the counts are left for it
+                const auto maxRecords = m_MaxRecords.load(std::memory_order_relaxed);
+                if (!maxRecords)
+                    return 0;
+
+                const auto window = currentWindow();
+                size_t cnt = 0;
+                for (auto pLimiter = m_pListHead.load(std::memory_order_acquire); pLimiter; pLimiter = pLimiter->m_pNext)
+                {
+                    // Left with the count at the limit, the rest of the interval still drops
+                    auto state = pLimiter->m_State.load(std::memory_order_relaxed);
+                    while (countOf(state) > maxRecords && (isFlush || windowOf(state) + 1 < window))
+                    {
+                        if (pLimiter->m_State.compare_exchange_weak(state, pack(windowOf(state), maxRecords), std::memory_order_relaxed))
+                        {
+                            report(*pLimiter->m_pSite, static_cast<uint64_t>(countOf(state) - maxRecords));
+                            ++cnt;
+                            break;
+                        }
+                    }
+                }
+                return cnt;
+            }
+
+        private:
+            // The interval it is now, 0 is left for a constructed rate limiter
+            static inline uint32_t currentWindow() noexcept
+            {
+                const auto intervalMs = m_IntervalMs.load(std::memory_order_relaxed);
+                const auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                return static_cast<uint32_t>(static_cast<uint64_t>(nowMs) / intervalMs) + 1;
+            }
+
+            void enlistOnce(const CallSite& site) noexcept;
+
+            static constexpr uint32_t windowOf(const uint64_t state) noexcept   { return static_cast<uint32_t>(state >> 32);         }
+            static constexpr uint32_t countOf(const uint64_t state) noexcept    { return static_cast<uint32_t>(state);               }
+            static constexpr uint64_t pack(const uint32_t window, const uint32_t cnt) noexcept
+            {
+                return (static_cast<uint64_t>(window) << 32) | cnt;
+            }
+
+            // The window of the interval (the upper half) and the records seen in it, up to UINT32_MAX
+            std::atomic<uint64_t> m_State;
+
+            // The list of the sweeper, set once before it is put on it
+            const CallSite* m_pSite;
+            RateLimiter* m_pNext;
+            std::atomic_flag m_isListed;
+
+            static std::atomic<uint32_t> m_MaxRecords;
+            static std::atomic<uint64_t> m_IntervalMs;
+            static std::atomic<RateLimiter*> m_pListHead;
+    };
+};  // namespace logger
+
+#endif  // RATE_LIMITER_HPP
@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file RecordEncoder.hpp
+ * @brief Declaration of the RecordEncoder class and its JSON and logfmt encoders.
+ *
+ * A record encoder turns the records of a batch into the lines written by the
+ * watcher thread, in place of the text layout of the Logger (see
+ * LoggingOps::setRecordEncoder). It gets the deferred records as they are, i.e.
+ * the call site, the time stamp and the typed arguments or key-value fields
+ * (see DeferredRecord::encodeFields), so the fields go straight into the output
+ * instead of being formatted into the text first and parsed out of it again.
+ *
+ *   JSON   : {"ts":"2025-08-22T02:21:03.123456789Z","level":"INF","thread":"140245",
+ *             "file":"Server.cpp","line":42,"function":"Server::serve","msg":"Request served",
+ *             "path":"/index.html","status":200}
+ *   logfmt : ts=2025-08-22T02:21:03.123456789Z level=INF thread=140245 file=Server.cpp
+ *            line=42 function=Server::serve msg="Request served" path=/index.html status=200
+ *
+ * The time stamps are in UTC. A record written as text (or data) only has the
+ * msg field, and a deferred record which isn't structured has its formatted
+ * message as msg. The strings are scanned 8 bytes at a time for the characters
+ * to be escaped, the runs in between are copied as they are.
+ *
+ * @note The keys are written as they are in logfmt, so they are expected to be
+ * identifiers. The strings are not checked to be valid UTF-8.
+ */
+
+#ifndef RECORD_ENCODER_HPP
+#define RECORD_ENCODER_HPP
+
+#include "RecordRing.hpp"
+#include "DeferredRecord.hpp"
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+namespace logger
+{
+    /**
+     * @brief Enum class for the encoding of the records written by the watcher thread.
+     *
+     * TEXT   : The text layout of the Logger, no encoder.
+     * JSON   : A JSON object per line, see JsonEncoder.
+     * LOGFMT : A logfmt line, see LogfmtEncoder.
+     */
+    enum class RecordEncoding
+    {
+        TEXT        = 0x01,
+        JSON        = 0x02,
+        LOGFMT      = 0x03
+    };
+
+    class RecordEncoder
+    {
+        public:
+            RecordEncoder() = default;
+            virtual ~RecordEncoder() = default;
+
+            /**
+             * @brief Create the encoder of an encoding
+             *
+             * @param [in] encoding The encoding
+             * @return std::shared_ptr<const RecordEncoder> The encoder, nullptr for RecordEncoding::TEXT
+             */
+            static std::shared_ptr<const RecordEncoder> create(const RecordEncoding encoding);
+
+            /**
+             * @brief Encode a record into a line, without the trailing new line
+             *
+             * @param [in] record The record as it is in the ring
+             * @param [in] kind The kind of the record
+             * @param [out] line The encoded line, it keeps its memory
+             * @note It is called by the watcher thread only, but the same
+             *       encoder may be shared by the watcher threads of several sinks.
+             */
+            virtual void encode(const std::string_view record, const RecordKind kind, std::string& line) const = 0;
+
+            /**
+             * @brief Get the Class Id for the object
+             *
+             * @return std::string The class id of the object
+             */
+            virtual const std::string getClassId() const = 0;
+
+            /**
+             * @brief Append a string as a JSON string, quoted and escaped
+             *
+             * @param [in] str The string
+             * @param [out] out The text it is appended to
+             */
+            static void appendJsonString(const std::string_view str, std::string& out);
+
+            /**
+             * @brief Append a string as a logfmt value, quoted and escaped only
+             * if it is empty or has a space, '=', '"' or a control character
+             *
+             * @param [in] str The string
+             * @param [out] out The text it is appended to
+             */
+            static void appendLogfmtString(const std::string_view str, std::string& out);
+
+            /**
+             * @brief Append an argument (or a field value) of a deferred record as a logfmt value
+             *
+             * @param [in] type The type of the argument
+             * @param [in] bytes The raw bytes of the argument, see DeferredRecord::nextArg()
+             * @param [out] out The text it is appended to
+             */
+            static void appendLogfmtValue(const ArgType type, const std::string_view bytes, std::string& out);
+
+            /**
+             * @brief Append a time stamp in RFC 3339, UTC with nanoseconds,
+             * e.g. 2025-08-22T02:21:03.123456789Z
+             *
+             * @param [in] timeStampNs The nanoseconds since the epoch
+             * @param [out] out The text it is appended to
+             */
+            static void appendTimeStamp(const int64_t timeStampNs, std::string& out);
+
+        protected:
+            /**
+             * @brief Find the first character to be escaped (a control character,
+             * '"' or '\\'), or with isLogfmt also the ones to be quoted (' ', '=')
+             *
+             * @param [in] str The string
+             * @param [in] isLogfmt Whether to look for the ones to be quoted as well
+             * @return size_t The position of the character, str.size() if there is none
+             */
+            static size_t findSpecial(const std::string_view str, const bool isLogfmt) noexcept;
+
+            /**
+             * @brief Append a string escaped as a JSON string, without the quotes
+             */
+            static void appendEscaped(std::string_view str, std::string& out);
+    };
+
+    class JsonEncoder : public RecordEncoder
+    {
+        public:
+            void encode(const std::string_view record, const RecordKind kind, std::string& line) const override;
+            inline const std::string getClassId() const override { return "JsonEncoder"; }
+    };
+
+    class LogfmtEncoder : public RecordEncoder
+    {
+        public:
+            void encode(const std::string_view record, const RecordKind kind, std::string& line) const override;
+            inline const std::string getClassId() const override { return "LogfmtEncoder"; }
+    };
+};  // namespace logger
+
+#endif  // RECORD_ENCODER_HPP
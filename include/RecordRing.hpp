@@ -0,0 +1,415 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file RecordRing.hpp
+ * @brief Declaration of the RecordRing and RecordArena classes.
+ *
+ * RecordRing is a bounded, lock-free ring of bytes used as the transport between
+ * the threads producing log records and the single watcher thread (see LoggingOps)
+ * consuming them. Every record is stored length-prefixed and takes only as much
+ * space as the message itself (rounded up to 8 bytes). Producers reserve their
+ * space with a single CAS on the write position and publish the record with a
+ * release store on its header, so no mutex is involved on the hot path.
+ *
+ * A ring can stamp its records with the steady clock time they were pushed,
+ * for a consumer merging several rings by time (see StagingMode).
+ *
+ * RecordArena is the contiguous, reusable buffer the consumer drains the ring
+ * into. It keeps its memory between the batches, so after warming up draining
+ * a batch doesn't allocate at all.
+ */
+
+#ifndef RECORD_RING_HPP
+#define RECORD_RING_HPP
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+namespace logger
+{
+    /**
+     * @brief The size of a cache line for the target platforms.
+     * Used to keep the producer and consumer positions on
+     * separate cache lines and avoid false sharing.
+     */
+    inline constexpr size_t cacheLineSize = 64;
+
+    /**
+     * @brief Enum class for the policy applied when the ring is full.
+     *
+     * BLOCK            : The producer waits till the consumer frees enough space.
+     * DROP_NEWEST      : The incoming record is discarded.
+     * OVERWRITE_OLDEST : The oldest records in the ring are discarded to make room. The
+     *                    producer takes the read lock for it, see RecordRing::discardOldest().
+     *
+     * @note Both DROP_NEWEST and OVERWRITE_OLDEST increment the drop counter.
+     */
+    enum class OverflowPolicy
+    {
+        BLOCK               = 0x01,
+        DROP_NEWEST         = 0x02,
+        OVERWRITE_OLDEST    = 0x03
+    };
+
+    /**
+     * @brief Enum class for the kind of a record.
+     *
+     * TEXT     : The record is the final text (or data) to be written.
+     * DEFERRED : The record still has to be formatted (see DeferredRecord).
+     */
+    enum class RecordKind
+    {
+        TEXT        = 0x00,
+        DEFERRED    = 0x01
+    };
+
+    /**
+     * @brief The highest bit of the record lengths marks the deferred records.
+     * Records are never longer than half of the ring, so it is always free.
+     */
+    inline constexpr uint32_t deferredRecordFlag = 1u << 31;
+
+    class RecordArena
+    {
+        public:
+            using LengthType = uint32_t;
+
+            /**
+             * @brief Forward iterator over the records of the arena.
+             * Dereferencing it gives a string_view into the arena memory,
+             * which stays valid till the arena is cleared or appended to.
+             */
+            class const_iterator
+            {
+                public:
+                    using iterator_category = std::forward_iterator_tag;
+                    using value_type        = std::string_view;
+                    using difference_type   = std::ptrdiff_t;
+                    using pointer           = const std::string_view*;
+                    using reference         = std::string_view;
+
+                    const_iterator() = default;
+                    explicit const_iterator(const char* pos) : m_Pos(pos) {}
+
+                    std::string_view operator*() const noexcept;
+                    RecordKind kind() const noexcept;
+                    const_iterator& operator++() noexcept;
+                    const_iterator operator++(int) noexcept     { auto tmp = *this; ++(*this); return tmp; }
+                    bool operator==(const const_iterator& rhs) const noexcept   { return m_Pos == rhs.m_Pos; }
+                    bool operator!=(const const_iterator& rhs) const noexcept   { return m_Pos != rhs.m_Pos; }
+
+                private:
+                    const char* m_Pos = nullptr;
+            };
+
+            RecordArena() = default;
+            ~RecordArena() = default;
+            RecordArena(const RecordArena& rhs) = delete;
+            RecordArena(RecordArena&& rhs) = default;
+            RecordArena& operator=(const RecordArena& rhs) = delete;
+            RecordArena& operator=(RecordArena&& rhs) = default;
+
+            /**
+             * @brief Append a record to the arena
+             *
+             * @param [in] record The record to be appended
+             * @param [in] kind The kind of the record
+             */
+            void append(const std::string_view record, const RecordKind kind = RecordKind::TEXT);
+
+            /**
+             * @brief Remove all the records, but keep the memory for the next batch
+             */
+            inline void clear() noexcept                        { m_Buffer.clear(); m_RecordsCnt = 0;                   }
+            inline bool empty() const noexcept                  { return m_RecordsCnt == 0;                             }
+            inline size_t size() const noexcept                 { return m_RecordsCnt;                                  }
+            inline size_t bytes() const noexcept                { return m_Buffer.size();                               }
+            inline size_t dataBytes() const noexcept            { return m_Buffer.size() - m_RecordsCnt * sizeof(LengthType); }
+            inline const_iterator begin() const noexcept        { return const_iterator(m_Buffer.data());               }
+            inline const_iterator end() const noexcept          { return const_iterator(m_Buffer.data() + m_Buffer.size()); }
+
+        private:
+            std::vector<char> m_Buffer;
+            size_t m_RecordsCnt = 0;
+    };
+
+    class RecordRing
+    {
+        public:
+            /**
+             * @brief Construct a new Record Ring object
+             *
+             * @param [in] capacity The number of bytes in the ring. It is rounded
+             *                      up to the next power of two (minimum 4KB).
+             * @param [in] policy The policy to be applied when the ring is full.
+             * @param [in] isStamped Whether every record is stamped with the time it
+             *                       was pushed, i.e. 8 more bytes in the ring for it.
+             */
+            explicit RecordRing(const size_t capacity, const OverflowPolicy policy = OverflowPolicy::BLOCK,
+                                const bool isStamped = false);
+
+            ~RecordRing() = default;
+            RecordRing(const RecordRing& rhs) = delete;
+            RecordRing(RecordRing&& rhs) = delete;
+            RecordRing& operator=(const RecordRing& rhs) = delete;
+            RecordRing& operator=(RecordRing&& rhs) = delete;
+
+            /**
+             * @brief Try to push a record without applying any overflow policy.
+             *
+             * @param [in] record The record to be pushed. Must not be longer than maxRecordSize()
+             * @param [in] kind The kind of the record, handed over to the arena by drain()
+             * @return true If the space was reserved and the record published, otherwise
+             * @return false If there isn't enough free space in the ring
+             */
+            bool tryPush(const std::string_view record, const RecordKind kind = RecordKind::TEXT);
+
+            /**
+             * @brief Push a record applying the overflow policy if the ring is full.
+             *
+             * @tparam Backoff Callable of signature void(), invoked every time
+             *                 a producer has to wait under OverflowPolicy::BLOCK
+             * @param [in] record The record to be pushed. Must not be longer than maxRecordSize()
+             * @param [in] backoff The callable to be invoked while waiting
+             * @param [in] kind The kind of the record
+             * @return true If the record made it to the ring, otherwise
+             * @return false If the record was dropped (OverflowPolicy::DROP_NEWEST)
+             */
+            template<typename Backoff>
+            bool push(const std::string_view record, Backoff&& backoff, const RecordKind kind = RecordKind::TEXT)
+            {
+                while (!tryPush(record, kind))
+                {
+                    switch (m_Policy.load(std::memory_order_relaxed))
+                    {
+                        case OverflowPolicy::DROP_NEWEST:
+                            m_DroppedCnt.fetch_add(1, std::memory_order_relaxed);
+                            return false;
+                        case OverflowPolicy::OVERWRITE_OLDEST:
+                            if (!discardOldest())
+                                std::this_thread::yield();
+                            break;
+                        case OverflowPolicy::BLOCK:
+                        default:
+                            backoff();
+                            break;
+                    }
+                }
+                return true;
+            }
+
+            inline bool push(const std::string_view record)     { return push(record, [](){ std::this_thread::yield(); }); }
+
+            /**
+             * @brief Move all the records published so far to the arena
+             *
+             * @param [out] arena The arena the records are appended to
+             * @return size_t The number of records drained
+             * @note Only one consumer thread is supposed to drain the ring
+             */
+            size_t drain(RecordArena& arena);
+
+            /**
+             * @brief Move the records published so far to the arena, along with their stamps,
+             * up to the first one stamped after a given time
+             *
+             * @param [out] arena The arena the records are appended to
+             * @param [out] stamps The stamps (steady clock nanoseconds) of the records
+             *                     appended, in the same order. Zero if the ring isn't stamped.
+             * @param [in] maxStamp The records from the first one stamped after it on
+             *                      are left in the ring, for the next drain
+             * @return size_t The number of records drained
+             * @note Only one consumer thread is supposed to drain the ring
+             */
+            size_t drain(RecordArena& arena, std::vector<uint64_t>& stamps, const uint64_t maxStamp);
+
+            /**
+             * @brief Get the stamp of a record pushed right now, see drain()
+             */
+            static uint64_t stampNow() noexcept;
+
+            /**
+             * @brief Drain the records for a crash, handing them over to the visitor
+             * one by one instead of to an arena. It is async signal safe: nothing is
+             * allocated, and the read lock is only spun for a bounded number of
+             * times, as the crashing thread may be the very one holding it.
+             *
+             * @tparam Visit Callable of signature void(std::string_view, RecordKind)
+             * @param [in] visit The callable to be invoked for every record
+             * @return size_t The number of records drained
+             * @note Without the lock the records are only read, not released, so
+             *       the consumer may still write some of them once more.
+             */
+            template<typename Visit>
+            size_t emergencyDrain(Visit&& visit) noexcept
+            {
+                auto isLocked = false;
+                for (size_t spin = 0; !isLocked && spin < m_EmergencySpinsCnt; ++spin)
+                    isLocked = !m_ReadLock.test_and_set(std::memory_order_acquire);
+
+                size_t cnt = 0;
+                auto pos = m_ReadPos.load(std::memory_order_acquire);
+                while (true)
+                {
+                    auto pHeader = headerAt(pos);
+                    auto slotSize = publishedSlotSize(pHeader);
+                    if (slotSize == 0)
+                        break;
+
+                    auto isPadding = slotSize & m_PaddingFlag;
+                    slotSize &= ~m_PaddingFlag;
+                    if (!isPadding)
+                    {
+                        auto dataSize = pHeader->m_DataSize;
+                        visit(std::string_view(reinterpret_cast<char*>(pHeader) + m_PayloadOffset, dataSize & ~deferredRecordFlag),
+                              (dataSize & deferredRecordFlag) ? RecordKind::DEFERRED : RecordKind::TEXT);
+                        ++cnt;
+                    }
+                    pos += slotSize;
+                    if (isLocked)
+                    {
+                        if (!isPadding)
+                            m_ReleasedCnt.store(m_ReleasedCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        release(pHeader, slotSize, pos);
+                    }
+                    else if (pos - m_ReadPos.load(std::memory_order_acquire) >= m_Capacity)
+                    {
+                        break;  // Gone round the whole ring without releasing anything
+                    }
+                }
+
+                if (isLocked)
+                    m_ReadLock.clear(std::memory_order_release);
+                return cnt;
+            }
+
+            /**
+             * @brief Discard the oldest record from the ring.
+             *
+             * @return true If a record was discarded, otherwise
+             * @return false If the ring is empty or the oldest record is still being written
+             * @note It is the one place a producer takes the read lock, as it moves the read
+             *       position along with the consumer. The consumer holds it for a single
+             *       record at a time, so a producer finding the ring full under
+             *       OverflowPolicy::OVERWRITE_OLDEST waits for one record being copied
+             *       out at most, not for a whole batch. Pushing to a ring with room
+             *       left never takes it.
+             */
+            bool discardOldest();
+
+            /**
+             * @brief Get the number of bytes reserved by the producers and not yet drained
+             *
+             * @return size_t The number of bytes. It is only a snapshot
+             *         as producers and consumer might be active in parallel.
+             */
+            size_t pendingBytes() const noexcept;
+
+            /**
+             * @brief Get the number of records pushed and not yet drained (or discarded)
+             *
+             * @return size_t The number of records. It is only a snapshot
+             *         as producers and consumer might be active in parallel.
+             */
+            size_t pendingRecords() const noexcept;
+
+            /**
+             * @brief Get the write and read positions of the ring.
+             * The positions are in bytes and only ever grow, so they serve as
+             * sequence numbers: every record pushed before a call of writePosition()
+             * is below it, and drained (or discarded) once readPosition() reaches it.
+             */
+            inline uint64_t writePosition() const noexcept      { return m_WritePos.load(std::memory_order_acquire);        }
+            inline uint64_t readPosition() const noexcept       { return m_ReadPos.load(std::memory_order_acquire);         }
+
+            inline size_t capacity() const noexcept             { return m_Capacity;                                        }
+            inline size_t maxRecordSize() const noexcept        { return m_Capacity / 2 - m_PayloadOffset;                  }
+            inline bool isStamped() const noexcept              { return m_PayloadOffset != sizeof(RecordHeader);           }
+            inline uint64_t droppedCount() const noexcept       { return m_DroppedCnt.load(std::memory_order_relaxed);      }
+            inline OverflowPolicy getPolicy() const noexcept    { return m_Policy.load(std::memory_order_relaxed);          }
+            inline void setPolicy(const OverflowPolicy policy)  { m_Policy.store(policy, std::memory_order_relaxed);        }
+            inline bool empty() const noexcept                  { return pendingBytes() == 0;                               }
+
+        private:
+            /**
+             * @brief Header in front of every record in the ring.
+             * m_SlotSize is zero till the record is published. It holds the
+             * total size of the slot (header + data, multiple of 8) and the
+             * lowest bit marks a padding slot that fills the ring till its end.
+             * The highest bit of m_DataSize is the deferredRecordFlag.
+             * In a stamped ring the stamp (uint64_t) follows it, then the data.
+             */
+            struct RecordHeader
+            {
+                uint32_t m_SlotSize;
+                uint32_t m_DataSize;
+            };
+
+            static constexpr uint32_t m_PaddingFlag = 0x01;
+            static constexpr size_t m_EmergencySpinsCnt = 1024 * 1024;
+
+            inline RecordHeader* headerAt(const uint64_t pos) noexcept
+            {
+                return reinterpret_cast<RecordHeader*>(m_Buffer.get() + (pos & m_Mask));
+            }
+
+            void publish(RecordHeader* pHeader, const uint32_t slotSize) noexcept;
+            uint32_t publishedSlotSize(RecordHeader* pHeader) const noexcept;
+            void release(RecordHeader* pHeader, const uint32_t slotSize, const uint64_t nextPos) noexcept;
+            void lockRead() noexcept;
+
+            template<typename Append>
+            size_t drainTo(Append&& append);
+
+            const size_t m_Capacity;
+            const size_t m_Mask;
+            const size_t m_PayloadOffset;
+            std::unique_ptr<char[]> m_Buffer;
+            std::atomic<OverflowPolicy> m_Policy;
+            std::atomic<uint64_t> m_DroppedCnt;
+            /**
+             * @brief Serializes the consumer and the producers discarding
+             * the oldest records (OverflowPolicy::OVERWRITE_OLDEST) as both
+             * of them move the read position. It is taken per record, a
+             * spin lock is enough for that.
+             */
+            std::atomic_flag m_ReadLock;
+            /**
+             * @brief The positions and the counters of the records,
+             * grouped by the side (producers/consumer) writing them.
+             */
+            alignas(cacheLineSize) std::atomic<uint64_t> m_WritePos;
+            std::atomic<uint64_t> m_PushedCnt;
+            alignas(cacheLineSize) std::atomic<uint64_t> m_ReadPos;
+            std::atomic<uint64_t> m_ReleasedCnt;
+    };
+};  // namespace logger
+
+#endif  // RECORD_RING_HPP
@@ -0,0 +1,156 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file TraceSpan.hpp
+ * @brief Declaration of the TraceSpan class.
+ *
+ * A trace span times a scope, e.g. a function, and logs a single structured
+ * record with its duration when the scope is left (see LOG_SPAN):
+ *
+ *   |...| Server.cpp|   42|INF<> [Server : serve] parse duration_ns=18342
+ *
+ * Entering the scope costs a relaxed load (the log level), a thread local count
+ * (the sampling) and a look at the steady clock, leaving it another look at the
+ * clock. Nothing is logged for the spans not sampled (only every Nth span of a
+ * statement is, per thread) or shorter than the minimum duration, and the clock
+ * isn't even looked at for the ones not sampled. Both are the same for every
+ * span, and switched off by default, i.e. every span is logged.
+ *
+ * @note With the sampling every record carries the sample_every field as well,
+ * so that the counts can be scaled back.
+ */
+
+#ifndef TRACE_SPAN_HPP
+#define TRACE_SPAN_HPP
+
+#include "LogFilter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace logger
+{
+    class TraceSpan
+    {
+        public:
+            /**
+             * @brief Start a span. It is timed only if its log type is enabled and it is sampled.
+             *
+             * @param [in] site The call site descriptor of the span
+             * @param [in] name The name of the span, it must outlive the span (e.g. a literal)
+             * @param [in,out] sampleCnt The count of the spans of the statement on the calling thread
+             */
+            inline TraceSpan(const CallSite& site, const std::string_view name, uint32_t& sampleCnt) noexcept
+                : m_pSite(&site)
+                , m_Name(name)
+                , m_StartNs(0)
+                , m_isTimed(LogFilter::isEnabled(site) && isSampled(sampleCnt))
+            {
+                if (m_isTimed)
+                    m_StartNs = nowNs();
+            }
+
+            /**
+             * @brief End the span, its record is logged if it lasted the minimum duration
+             */
+            inline ~TraceSpan()
+            {
+                if (m_isTimed) [[unlikely]]
+                    finish();
+            }
+
+            TraceSpan(const TraceSpan&) = delete;
+            TraceSpan(TraceSpan&&) = delete;
+            TraceSpan& operator=(const TraceSpan&) = delete;
+            TraceSpan& operator=(TraceSpan&&) = delete;
+
+            /**
+             * @brief Check whether the span is timed, i.e. it is going to be logged
+             * unless it is shorter than the minimum duration
+             */
+            inline bool isTimed() const noexcept                            { return m_isTimed; }
+
+            /**
+             * @brief Set the sampling of every span
+             *
+             * @param [in] everyNth Only every Nth span of a statement is timed (per thread), 0 or 1 for all
+             */
+            static void setSampling(const uint32_t everyNth) noexcept;
+
+            /**
+             * @brief Get the sampling of every span, 1 if every span is timed
+             */
+            static inline uint32_t getSampling() noexcept                   { return m_SampleEvery.load(std::memory_order_relaxed); }
+
+            /**
+             * @brief Set the duration a span has to last at least to be logged
+             *
+             * @param [in] minDuration The minimum duration, 0 for all
+             */
+            static void setMinDuration(const std::chrono::nanoseconds minDuration) noexcept;
+
+            /**
+             * @brief Get the duration a span has to last at least to be logged
+             */
+            static inline std::chrono::nanoseconds getMinDuration() noexcept
+            {
+                return std::chrono::nanoseconds(m_MinDurationNs.load(std::memory_order_relaxed));
+            }
+
+        private:
+            static inline int64_t nowNs() noexcept
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            static inline bool isSampled(uint32_t& sampleCnt) noexcept
+            {
+                const auto everyNth = m_SampleEvery.load(std::memory_order_relaxed);
+                if (everyNth <= 1 || ++sampleCnt >= everyNth)
+                {
+                    sampleCnt = 0;
+                    return true;
+                }
+                return false;
+            }
+
+            /**
+             * @brief Log the record of a timed span, off the path of the spans not timed
+             */
+            void finish() noexcept;
+
+            const CallSite* m_pSite;
+            std::string_view m_Name;
+            int64_t m_StartNs;
+            bool m_isTimed;
+
+            static std::atomic<uint32_t> m_SampleEvery;
+            static std::atomic<int64_t> m_MinDurationNs;
+    };
+};  // namespace logger
+
+#endif  // TRACE_SPAN_HPP
@@ -69,6 +69,7 @@ def main():
     log_file_path = os.getenv('LOG_FILE_PATH', '')
     log_file_name = os.getenv('LOG_FILE_NAME', '')
     log_file_extn = os.getenv('LOG_FILE_EXTN', '')
+    console_log_level = os.getenv('CONSOLE_LOG_LEVEL', '').lower()
 
     lines = [MIT_LICENSE, "\n#ifndef ENV_VARS_HPP\n", "#define ENV_VARS_HPP\n\n"]
 
@@ -94,6 +95,12 @@ def main():
             ext = '.' + ext
         lines.append(f'#define LOG_FILE_EXTN {quote_string(ext)}\n')
 
+    log_levels = {'dbg': 'LOG_DBG', 'info': 'LOG_INFO', 'imp': 'LOG_IMP', 'warn': 'LOG_WARN', 'err': 'LOG_ERR'}
+    if console_log_level in log_levels:
+        lines.append(f'#define CONSOLE_LOG_LEVEL LOG_TYPE::{log_levels[console_log_level]}\n')
+    elif console_log_level:
+        print(f"Warning: Invalid CONSOLE_LOG_LEVEL '{console_log_level}'. Skipping CONSOLE_LOG_LEVEL define.")
+
     lines.append("\n#endif // ENV_VARS_HPP\n")
 
     # Create include directory if it doesn't exist
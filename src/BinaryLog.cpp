@@ -0,0 +1,538 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: BinaryLog.cpp
+ * Description: Implementation of the BinaryLogWriter and BinaryLogReader classes.
+ * See BinaryLog.hpp for class definition and documentation.
+ */
+
+#include "BinaryLog.hpp"
+#include "DeferredRecord.hpp"
+#include "RecordEncoder.hpp"
+
+#include <chrono>
+#include <variant>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+using namespace logger;
+
+/**
+ * @brief The types of the records of a binary log (see BinaryLog.hpp)
+ */
+enum class BinaryRecordType : uint8_t
+{
+    PADDING     = 0x00,     // The preallocated space of a mapped file, see FileIoMode::MMAP
+    SESSION     = 0x01,
+    STRING      = 0x02,
+    THREAD      = 0x03,
+    CALL_SITE   = 0x04,
+    LOG         = 0x05,
+    TEXT        = 0x06,
+    FIELDS      = 0x07      // Since version 0x02
+};
+
+/**
+ * @brief The value of a decoded argument, the integers are
+ * widened as they format the same regardless of their size
+ */
+using DecodedArg = std::variant<bool, char, int64_t, uint64_t, float, double, long double, std::string_view>;
+
+static_assert(sizeof(bool) == 1, "A bool is packed as a single byte");
+
+static inline void putType(std::string& out, const BinaryRecordType type)
+{
+    out.push_back(static_cast<char>(type));
+}
+
+static void putVarint(std::string& out, uint64_t val)
+{
+    while (val >= 0x80)
+    {
+        out.push_back(static_cast<char>((val & 0x7F) | 0x80));
+        val >>= 7;
+    }
+    out.push_back(static_cast<char>(val));
+}
+
+static inline void putSignedVarint(std::string& out, const int64_t val)
+{
+    // Zig-zag, so that the small negative numbers stay short as well
+    putVarint(out, (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63));
+}
+
+static inline void putString(std::string& out, const std::string_view str)
+{
+    putVarint(out, str.size());
+    out.append(str);
+}
+
+template<typename T>
+static inline T load(const std::string_view bytes) noexcept
+{
+    T val{};
+    std::memcpy(&val, bytes.data(), std::min(sizeof(T), bytes.size()));
+    return val;
+}
+
+static void packArg(const ArgType type, const std::string_view bytes, std::string& out)
+{
+    switch (type)
+    {
+        case ArgType::INT16:    putSignedVarint(out, load<int16_t>(bytes));     break;
+        case ArgType::INT32:    putSignedVarint(out, load<int32_t>(bytes));     break;
+        case ArgType::INT64:    putSignedVarint(out, load<int64_t>(bytes));     break;
+        case ArgType::UINT16:   putVarint(out, load<uint16_t>(bytes));          break;
+        case ArgType::UINT32:   putVarint(out, load<uint32_t>(bytes));          break;
+        case ArgType::UINT64:   putVarint(out, load<uint64_t>(bytes));          break;
+        case ArgType::STRING:   putString(out, bytes);                          break;
+        default:                out.append(bytes);                              break;  // The single bytes and the floating points
+    }
+}
+
+/**
+ * @brief Format a message out of a format string and the decoded arguments.
+ * The arguments are only known at run time, so every replacement field is
+ * formatted on its own with the format spec it comes with.
+ *
+ * @note The dynamic width and precision (nested replacement fields) are not supported.
+ */
+static void formatDynamic(std::string& msg, const std::string_view formatStr, const std::vector<DecodedArg>& args)
+{
+    constexpr auto npos = std::string_view::npos;
+    std::string fieldFormat;
+    size_t nextArgIdx = 0;
+    bool isManualIndexing = false;
+    bool isAutoIndexing = false;
+    size_t pos = 0;
+    while (pos < formatStr.size())
+    {
+        auto chr = formatStr[pos];
+        if ('{' != chr && '}' != chr)
+        {
+            auto nextPos = formatStr.find_first_of("{}", pos);
+            msg.append(formatStr.substr(pos, nextPos - pos));
+            pos = (npos == nextPos) ? formatStr.size() : nextPos;
+            continue;
+        }
+        if (pos + 1 < formatStr.size() && chr == formatStr[pos + 1])
+        {
+            msg.push_back(chr);     // Escaped brace
+            pos += 2;
+            continue;
+        }
+        if ('}' == chr)
+            throw std::runtime_error("unmatched '}' in format string");
+
+        auto closePos = formatStr.find('}', pos);
+        if (npos == closePos)
+            throw std::runtime_error("unmatched '{' in format string");
+        auto field = formatStr.substr(pos + 1, closePos - pos - 1);
+        if (npos != field.find('{'))
+            throw std::runtime_error("nested replacement fields are not supported");
+
+        auto specPos = field.find(':');
+        auto argId = field.substr(0, specPos);
+        size_t argIdx = 0;
+        if (argId.empty())
+        {
+            isAutoIndexing = true;
+            argIdx = nextArgIdx++;
+        }
+        else
+        {
+            isManualIndexing = true;
+            auto result = std::from_chars(argId.data(), argId.data() + argId.size(), argIdx);
+            if (result.ec != std::errc() || result.ptr != argId.data() + argId.size())
+                throw std::runtime_error("invalid argument index in format string");
+        }
+        if (isAutoIndexing && isManualIndexing)
+            throw std::runtime_error("cannot switch between automatic and manual argument indexing");
+        if (argIdx >= args.size())
+            throw std::runtime_error("argument index out of range");
+
+        fieldFormat.assign("{");
+        if (npos != specPos)
+            fieldFormat.append(field.substr(specPos));
+        fieldFormat.push_back('}');
+        std::visit([&msg, &fieldFormat](const auto& val)
+        {
+            std::vformat_to(std::back_inserter(msg), fieldFormat, std::make_format_args(val));
+        }, args[argIdx]);
+        pos = closePos + 1;
+    }
+}
+
+/**
+ * @brief Append the fields of a structured record in logfmt, the way
+ * DeferredRecord::formatMessage() does for the live records.
+ *
+ * @param [out] msg The message the fields are appended to
+ * @param [in] args The decoded key-value pairs
+ */
+static void appendFields(std::string& msg, const std::vector<DecodedArg>& args)
+{
+    for (size_t idx = 0; idx + 1 < args.size(); idx += 2)
+    {
+        const auto* pKey = std::get_if<std::string_view>(&args[idx]);
+        if (nullptr == pKey)
+            throw std::runtime_error("Field without a key in binary log");
+        msg.push_back(' ');
+        msg.append(*pKey).push_back('=');
+        std::visit([&msg](const auto& val)
+        {
+            using T = std::decay_t<decltype(val)>;
+            if constexpr (std::is_same_v<T, std::string_view>)
+                RecordEncoder::appendLogfmtString(val, msg);
+            else if constexpr (std::is_same_v<T, char>)
+                RecordEncoder::appendLogfmtString(std::string_view(&val, 1), msg);
+            else
+                std::format_to(std::back_inserter(msg), "{}", val);
+        }, args[idx + 1]);
+    }
+}
+
+/*static*/void BinaryLogWriter::appendFileHeader(std::string& out)
+{
+    out.append(binaryLogMagic);
+    out.push_back(static_cast<char>(binaryLogVersion));
+}
+
+void BinaryLogWriter::reset() noexcept
+{
+    m_isSessionStarted = false;
+    m_LastTimeStampNs = 0;
+    m_StringIds.clear();
+    m_ThreadIds.clear();
+    m_CallSiteIds.clear();
+}
+
+uint32_t BinaryLogWriter::stringId(const std::string_view str, std::string& out)
+{
+    auto itr = m_StringIds.find(str);
+    if (itr != m_StringIds.end())
+        return itr->second;
+
+    auto id = static_cast<uint32_t>(m_StringIds.size());
+    m_StringIds.emplace(std::string(str), id);
+    putType(out, BinaryRecordType::STRING);
+    putVarint(out, id);
+    putString(out, str);
+    return id;
+}
+
+uint32_t BinaryLogWriter::threadIndex(const std::thread::id& tid, std::string& out)
+{
+    auto itr = m_ThreadIds.find(tid);
+    if (itr != m_ThreadIds.end())
+        return itr->second;
+
+    auto idx = static_cast<uint32_t>(m_ThreadIds.size());
+    m_ThreadIds.emplace(tid, idx);
+    putType(out, BinaryRecordType::THREAD);
+    putVarint(out, idx);
+    out.push_back(static_cast<char>(sizeof(std::thread::id)));
+    out.append(reinterpret_cast<const char*>(&tid), sizeof(std::thread::id));
+    return idx;
+}
+
+uint32_t BinaryLogWriter::callSiteId(const CallSite& site, std::string& out)
+{
+    auto itr = m_CallSiteIds.find(&site);
+    if (itr != m_CallSiteIds.end())
+        return itr->second;
+
+    // The strings go to the table first, a call site only refers to them
+    auto fileId = stringId(site.fileName(), out);
+    auto classId = stringId(site.className(), out);
+    auto funcId = stringId(site.functionName(), out);
+    auto markerId = stringId(site.marker(), out);
+
+    auto id = static_cast<uint32_t>(m_CallSiteIds.size());
+    m_CallSiteIds.emplace(&site, id);
+    putType(out, BinaryRecordType::CALL_SITE);
+    putVarint(out, id);
+    putVarint(out, fileId);
+    putVarint(out, classId);
+    putVarint(out, funcId);
+    putVarint(out, markerId);
+    putVarint(out, site.line());
+    out.push_back(static_cast<char>(site.type()));
+    out.push_back(site.isLambda() ? 1 : 0);
+    return id;
+}
+
+void BinaryLogWriter::append(const std::string_view record, const RecordKind kind, std::string& out)
+{
+    if (!m_isSessionStarted)
+    {
+        putType(out, BinaryRecordType::SESSION);
+        m_isSessionStarted = true;
+    }
+
+    if (RecordKind::TEXT == kind)
+    {
+        putType(out, BinaryRecordType::TEXT);
+        putString(out, record);
+        return;
+    }
+
+    auto fields = DeferredRecord::decode(record);
+    auto siteId = callSiteId(*fields.m_pCallSite, out);
+    auto formatId = stringId(fields.m_FormatStr, out);
+    auto threadIdx = threadIndex(fields.m_ThreadId, out);
+
+    putType(out, fields.m_isStructured ? BinaryRecordType::FIELDS : BinaryRecordType::LOG);
+    putSignedVarint(out, fields.m_TimeStampNs - m_LastTimeStampNs);
+    m_LastTimeStampNs = fields.m_TimeStampNs;
+    putVarint(out, threadIdx);
+    putVarint(out, siteId);
+    putVarint(out, formatId);
+    putVarint(out, fields.m_ArgsCnt);
+    auto args = fields.m_Args;
+    for (uint32_t idx = 0; idx < fields.m_ArgsCnt; ++idx)
+    {
+        auto type = fields.m_pArgTypes[idx];
+        auto bytes = DeferredRecord::nextArg(type, args);
+        out.push_back(static_cast<char>(type));
+        packArg(type, bytes, out);
+    }
+}
+
+BinaryLogReader::BinaryLogReader(const std::string_view data)
+    : m_Data(data)
+    , m_Pos(0)
+    , m_LastTimeStampNs(0)
+    , m_Strings()
+    , m_Threads()
+    , m_CallSites()
+    , m_Msg()
+    , m_Renderer(DEFAULT_TIME_FORMAT)
+{
+    if (!isBinaryLog(data))
+        throw std::runtime_error("Not a binary log");
+    m_Pos = binaryLogMagic.size();
+    // A newer version only adds record types, the older files are read as they are
+    auto version = readByte();
+    if (0 == version || version > binaryLogVersion)
+        throw std::runtime_error("Unsupported binary log version");
+}
+
+/*static*/bool BinaryLogReader::isBinaryLog(const std::string_view data) noexcept
+{
+    return data.starts_with(binaryLogMagic);
+}
+
+/*static*/void BinaryLogReader::decode(const std::string_view data, std::string& text)
+{
+    BinaryLogReader reader(data);
+    std::string line;
+    text.clear();
+    while (reader.next(line))
+        text.append(line).push_back('\n');
+}
+
+std::string_view BinaryLogReader::readBytes(const size_t size)
+{
+    if (size > m_Data.size() - m_Pos)
+        throw std::runtime_error("Truncated binary log");
+    auto bytes = m_Data.substr(m_Pos, size);
+    m_Pos += size;
+    return bytes;
+}
+
+uint8_t BinaryLogReader::readByte()
+{
+    return static_cast<uint8_t>(readBytes(1).front());
+}
+
+uint64_t BinaryLogReader::readVarint()
+{
+    uint64_t val = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        auto byte = readByte();
+        val |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return val;
+    }
+    throw std::runtime_error("Corrupt varint in binary log");
+}
+
+int64_t BinaryLogReader::readSignedVarint()
+{
+    auto val = readVarint();
+    return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+}
+
+std::string_view BinaryLogReader::stringAt(const uint64_t id) const
+{
+    if (id >= m_Strings.size())
+        throw std::runtime_error("Unknown string ID in binary log");
+    return m_Strings[id];
+}
+
+/**
+ * @brief Store an entry of a table, the IDs are handed out in sequence
+ */
+template<typename Table, typename Entry>
+static void storeEntry(Table& table, const uint64_t id, Entry&& entry)
+{
+    if (id > table.size())
+        throw std::runtime_error("Table IDs out of sequence in binary log");
+    if (id == table.size())
+        table.emplace_back(std::forward<Entry>(entry));
+    else
+        table[id] = std::forward<Entry>(entry);
+}
+
+void BinaryLogReader::readCallSite()
+{
+    auto id = readVarint();
+    auto fileName = stringAt(readVarint());
+    auto className = stringAt(readVarint());
+    auto funcName = stringAt(readVarint());
+    auto marker = stringAt(readVarint());
+    auto line = readVarint();
+    auto type = static_cast<LOG_TYPE>(readByte());
+    auto isLambda = readByte() != 0;
+    storeEntry(m_CallSites, id, std::make_unique<CallSite>(fileName, className, funcName, line, type, marker, isLambda));
+}
+
+void BinaryLogReader::renderLog(std::string& line, const bool isStructured)
+{
+    m_LastTimeStampNs += readSignedVarint();
+    auto threadIdx = readVarint();
+    auto siteId = readVarint();
+    auto formatStr = stringAt(readVarint());
+    auto argsCnt = readVarint();
+    if (threadIdx >= m_Threads.size() || siteId >= m_CallSites.size())
+        throw std::runtime_error("Unknown thread or call site in binary log");
+    if (argsCnt > m_Data.size() - m_Pos)
+        throw std::runtime_error("Truncated binary log");
+
+    std::vector<DecodedArg> args;
+    args.reserve(argsCnt);
+    for (uint64_t idx = 0; idx < argsCnt; ++idx)
+    {
+        switch (static_cast<ArgType>(readByte()))
+        {
+            case ArgType::BOOL:         args.emplace_back(readByte() != 0);                                         break;
+            case ArgType::CHAR:         args.emplace_back(static_cast<char>(readByte()));                           break;
+            case ArgType::INT8:         args.emplace_back(static_cast<int64_t>(static_cast<int8_t>(readByte())));   break;
+            case ArgType::UINT8:        args.emplace_back(static_cast<uint64_t>(readByte()));                       break;
+            case ArgType::INT16:
+            case ArgType::INT32:
+            case ArgType::INT64:        args.emplace_back(readSignedVarint());                                      break;
+            case ArgType::UINT16:
+            case ArgType::UINT32:
+            case ArgType::UINT64:       args.emplace_back(readVarint());                                            break;
+            case ArgType::FLOAT:        args.emplace_back(load<float>(readBytes(sizeof(float))));                   break;
+            case ArgType::DOUBLE:       args.emplace_back(load<double>(readBytes(sizeof(double))));                 break;
+            case ArgType::LONG_DOUBLE:  args.emplace_back(load<long double>(readBytes(sizeof(long double))));       break;
+            case ArgType::STRING:       args.emplace_back(readBytes(readVarint()));                                 break;
+            default:
+                throw std::runtime_error("Unknown argument type in binary log");
+        }
+    }
+
+    m_Msg.clear();
+    if (isStructured)
+    {
+        m_Msg.assign(formatStr);
+        appendFields(m_Msg, args);
+    }
+    else
+    {
+        try
+        {
+            formatDynamic(m_Msg, formatStr, args);
+        }
+        catch (const std::exception& excp)
+        {
+            m_Msg.assign(formatStr).append(" [FORMAT ERROR: ").append(excp.what()).append("]");
+        }
+    }
+
+    auto timeStamp = std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                            std::chrono::nanoseconds(m_LastTimeStampNs)));
+    m_Renderer.setCallSite(*m_CallSites[siteId])
+              .setThreadId(m_Threads[threadIdx])
+              .logFormatted(timeStamp, m_Msg);
+    line.assign(m_Renderer.getLogRecord());
+}
+
+bool BinaryLogReader::next(std::string& line)
+{
+    while (m_Pos < m_Data.size())
+    {
+        switch (static_cast<BinaryRecordType>(readByte()))
+        {
+            case BinaryRecordType::SESSION:
+                m_LastTimeStampNs = 0;
+                m_Strings.clear();
+                m_Threads.clear();
+                m_CallSites.clear();
+                break;
+            case BinaryRecordType::STRING:
+            {
+                auto id = readVarint();
+                storeEntry(m_Strings, id, readBytes(readVarint()));
+                break;
+            }
+            case BinaryRecordType::THREAD:
+            {
+                auto idx = readVarint();
+                auto bytes = readBytes(readByte());
+                std::thread::id tid;
+                if (bytes.size() == sizeof(std::thread::id))
+                    std::memcpy(static_cast<void*>(&tid), bytes.data(), sizeof(std::thread::id));
+                storeEntry(m_Threads, idx, tid);
+                break;
+            }
+            case BinaryRecordType::CALL_SITE:
+                readCallSite();
+                break;
+            case BinaryRecordType::LOG:
+                renderLog(line, false);
+                return true;
+            case BinaryRecordType::FIELDS:
+                renderLog(line, true);
+                return true;
+            case BinaryRecordType::TEXT:
+                line.assign(readBytes(readVarint()));
+                return true;
+            case BinaryRecordType::PADDING:
+                // Nothing is logged beyond, the file was mapped when its process died
+                m_Pos = m_Data.size();
+                return false;
+            default:
+                throw std::runtime_error("Unknown record type in binary log");
+        }
+    }
+    return false;
+}
@@ -0,0 +1,266 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: BlockCompression.cpp
+ * Description: Implementation of the BlockCompression class.
+ * See BlockCompression.hpp for class definition and documentation.
+ */
+
+#include "BlockCompression.hpp"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+using namespace logger;
+
+// The constants of the LZ4 block format
+static constexpr size_t minMatch = 4;
+static constexpr size_t lastLiterals = 5;   // The last bytes of a block are always literals
+static constexpr size_t matchFindLimit = 12; // The last match starts at least this far before the end
+static constexpr size_t maxOffset = 65535;
+static constexpr unsigned hashLog = 12;
+
+static inline uint32_t read32(const char* pos) noexcept
+{
+    uint32_t val = 0;
+    std::memcpy(&val, pos, sizeof(uint32_t));
+    return val;
+}
+
+/**
+ * @brief Write and read a size of the file layout, little endian whatever the host is
+ */
+static inline void putSize(char* pos, const uint32_t val) noexcept
+{
+    for (size_t idx = 0; idx < sizeof(uint32_t); ++idx)
+        pos[idx] = static_cast<char>((val >> (8 * idx)) & 0xFF);
+}
+
+static inline uint32_t getSize(const char* pos) noexcept
+{
+    uint32_t val = 0;
+    for (size_t idx = 0; idx < sizeof(uint32_t); ++idx)
+        val |= static_cast<uint32_t>(static_cast<uint8_t>(pos[idx])) << (8 * idx);
+    return val;
+}
+
+static inline uint32_t hashOf(const uint32_t seq) noexcept
+{
+    return (seq * 2654435761u) >> (32 - hashLog);
+}
+
+/**
+ * @brief Append a length in the LZ4 way, the 4 bits of the token
+ * followed by as many bytes as needed (255 meaning more to come)
+ */
+static inline void putLengthExtension(std::string& out, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        out.push_back(static_cast<char>(255));
+    out.push_back(static_cast<char>(len));
+}
+
+static void putSequence(std::string& out, const std::string_view literals, const size_t offset, const size_t matchLen)
+{
+    auto litLen = literals.size();
+    auto token = static_cast<uint8_t>((litLen >= 15 ? 15 : litLen) << 4);
+    if (matchLen)
+        token |= static_cast<uint8_t>((matchLen - minMatch) >= 15 ? 15 : (matchLen - minMatch));
+    out.push_back(static_cast<char>(token));
+    if (litLen >= 15)
+        putLengthExtension(out, litLen - 15);
+    out.append(literals);
+    if (!matchLen)
+        return;     // The last literals come without a match
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>(offset >> 8));
+    if ((matchLen - minMatch) >= 15)
+        putLengthExtension(out, matchLen - minMatch - 15);
+}
+
+/*static*/void BlockCompression::compressLz4(const std::string_view raw, std::string& out)
+{
+    const auto size = raw.size();
+    const auto* src = raw.data();
+    size_t anchor = 0;
+    if (size > matchFindLimit)
+    {
+        // Greedy matching with a single position per hash, it is fast
+        // and log lines repeat a lot, so it compresses them well enough
+        std::array<uint32_t, 1u << hashLog> table;
+        table.fill(UINT32_MAX);
+        const auto matchLimit = size - lastLiterals;
+        size_t pos = 0;
+        while (pos + matchFindLimit <= size)
+        {
+            auto seq = read32(src + pos);
+            auto hash = hashOf(seq);
+            auto ref = table[hash];
+            table[hash] = static_cast<uint32_t>(pos);
+            if (UINT32_MAX == ref || pos - ref > maxOffset || read32(src + ref) != seq)
+            {
+                ++pos;
+                continue;
+            }
+
+            auto matchLen = minMatch;
+            while (pos + matchLen < matchLimit && src[ref + matchLen] == src[pos + matchLen])
+                ++matchLen;
+            putSequence(out, raw.substr(anchor, pos - anchor), pos - ref, matchLen);
+            pos += matchLen;
+            anchor = pos;
+        }
+    }
+    putSequence(out, raw.substr(anchor), 0, 0);
+}
+
+/*static*/void BlockCompression::decompressLz4(const std::string_view block, const size_t rawSize, std::string& raw)
+{
+    auto corrupt = []() { return std::runtime_error("Corrupt block in compressed log"); };
+    const auto start = raw.size();
+    size_t pos = 0;
+    auto readLength = [&block, &pos, &corrupt](size_t len)
+    {
+        if (len != 15)
+            return len;
+        uint8_t byte = 0;
+        do
+        {
+            if (pos >= block.size())
+                throw corrupt();
+            byte = static_cast<uint8_t>(block[pos++]);
+            len += byte;
+        } while (byte == 255);
+        return len;
+    };
+
+    while (pos < block.size())
+    {
+        auto token = static_cast<uint8_t>(block[pos++]);
+        auto litLen = readLength(token >> 4);
+        if (litLen > block.size() - pos || raw.size() - start + litLen > rawSize)
+            throw corrupt();
+        raw.append(block.substr(pos, litLen));
+        pos += litLen;
+        if (pos == block.size())
+            break;  // The last literals
+
+        if (block.size() - pos < 2)
+            throw corrupt();
+        auto offset = static_cast<size_t>(static_cast<uint8_t>(block[pos])) |
+                      (static_cast<size_t>(static_cast<uint8_t>(block[pos + 1])) << 8);
+        pos += 2;
+        auto matchLen = readLength(token & 0x0F) + minMatch;
+        auto produced = raw.size() - start;
+        if (0 == offset || offset > produced || produced + matchLen > rawSize)
+            throw corrupt();
+        // The match may overlap with the bytes it produces, so byte by byte
+        auto from = raw.size() - offset;
+        for (size_t idx = 0; idx < matchLen; ++idx)
+            raw.push_back(raw[from + idx]);
+    }
+    if (raw.size() - start != rawSize)
+        throw corrupt();
+}
+
+static_assert(BlockCompression::fileHeaderSize == compressedLogMagic.size() + sizeof(compressedLogVersion));
+
+/*static*/void BlockCompression::appendFileHeader(std::string& out)
+{
+    out.append(compressedLogMagic);
+    out.push_back(static_cast<char>(compressedLogVersion));
+}
+
+/*static*/bool BlockCompression::isCompressed(const std::string_view data) noexcept
+{
+    return data.starts_with(compressedLogMagic);
+}
+
+/*static*/void BlockCompression::appendBlock(const std::string_view raw, std::string& out)
+{
+    if (raw.empty())
+        return;
+
+    auto headerPos = out.size();
+    out.resize(headerPos + 2 * sizeof(SizeType));
+    compressLz4(raw, out);
+    auto storedSize = static_cast<SizeType>(out.size() - headerPos - 2 * sizeof(SizeType));
+    if (storedSize >= raw.size())
+    {
+        // Not worth it, so the block is stored as is
+        out.resize(headerPos + 2 * sizeof(SizeType));
+        out.append(raw);
+        storedSize = static_cast<SizeType>(raw.size()) | m_StoredFlag;
+    }
+    putSize(out.data() + headerPos, storedSize);
+    putSize(out.data() + headerPos + sizeof(SizeType), static_cast<SizeType>(raw.size()));
+}
+
+/*static*/bool BlockCompression::decompress(const std::string_view data, std::string& raw)
+{
+    if (!isCompressed(data) || data.size() <= compressedLogMagic.size())
+        throw std::runtime_error("Not a compressed log");
+    if (static_cast<uint8_t>(data[compressedLogMagic.size()]) != compressedLogVersion)
+        throw std::runtime_error("Unsupported compressed log version");
+
+    raw.clear();
+    size_t pos = fileHeaderSize;
+    while (pos < data.size())
+    {
+        if (data.size() - pos < blockHeaderSize)
+            return data.find_first_not_of('\0', pos) == std::string_view::npos;
+        auto blockSize = blockSizeOf(data.substr(pos));
+        if (0 == blockSize)
+            break;  // No block is empty, it is the preallocated space of a mapped file
+        if (data.size() - pos < blockSize)
+            return false;   // The block being written when the process died
+        decompressBlock(data.substr(pos, blockSize), raw);
+        pos += blockSize;
+    }
+    return true;
+}
+
+/*static*/size_t BlockCompression::blockSizeOf(const std::string_view header) noexcept
+{
+    if (header.size() < blockHeaderSize)
+        return 0;
+    auto storedSize = getSize(header.data());
+    auto rawSize = getSize(header.data() + sizeof(SizeType));
+    if (0 == storedSize && 0 == rawSize)
+        return 0;
+    return blockHeaderSize + (storedSize & ~m_StoredFlag);
+}
+
+/*static*/void BlockCompression::decompressBlock(const std::string_view block, std::string& raw)
+{
+    if (block.size() < blockHeaderSize || blockSizeOf(block) != block.size())
+        throw std::runtime_error("Corrupt block in compressed log");
+    auto storedSize = getSize(block.data());
+    auto rawSize = getSize(block.data() + sizeof(SizeType));
+    auto stored = block.substr(blockHeaderSize);
+    if (storedSize & m_StoredFlag)
+        raw.append(stored);
+    else
+        decompressLz4(stored, rawSize, raw);
+}
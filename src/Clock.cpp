@@ -31,6 +31,8 @@
 
 #include "Clock.hpp"
 
+#include <cstring>
+#include <algorithm>
 #include <iomanip>
 
 using namespace logger;
@@ -109,14 +111,56 @@ std::string Clock::getGmtTimeStr(const std::string_view format) const
 std::string Clock::getLocalTimeStr(const std::string_view format) const
 {
     auto nowTimeT = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    auto localTimeT = std::localtime(&nowTimeT);
+    std::tm localTimeT{};
+    localtime_r(&nowTimeT, &localTimeT);
     std::array<char, 80> buffer;
     std::strftime(buffer.data(), sizeof(buffer), 
                     (format.empty() ? m_strFormat.data() : format.data()), 
-                    localTimeT);
+                    &localTimeT);
     return std::string(buffer.data());
 }
 
+size_t Clock::formatLocalTime(char* buffer, const size_t size, const unsigned subSecondDigits)
+{
+    return formatLocalTime(std::chrono::system_clock::now(), buffer, size, subSecondDigits);
+}
+
+size_t Clock::formatLocalTime(const std::chrono::system_clock::time_point& timePoint,
+                              char* buffer, const size_t size, const unsigned subSecondDigits)
+{
+    static constexpr unsigned maxSubSecondDigits = 9;
+
+    auto sinceEpoch = timePoint.time_since_epoch();
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+    auto nowTimeT = static_cast<std::time_t>(secs.count());
+    if (nowTimeT != m_cachedSec)
+    {
+        std::tm localTimeT{};
+        localtime_r(&nowTimeT, &localTimeT);
+        m_cachedLen = std::strftime(m_cachedTime.data(), m_cachedTime.size(), m_strFormat.data(), &localTimeT);
+        m_cachedSec = nowTimeT;
+    }
+
+    auto digits = std::min(subSecondDigits, maxSubSecondDigits);
+    auto len = m_cachedLen + (digits ? digits + 1 : 0);
+    if (len >= size)
+        return 0;
+
+    std::memcpy(buffer, m_cachedTime.data(), m_cachedLen);
+    if (digits)
+    {
+        auto fraction = std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch - secs).count();
+        for (auto i = digits; i < maxSubSecondDigits; ++i)
+            fraction /= 10;
+
+        buffer[m_cachedLen] = '.';
+        for (auto pos = len - 1; pos > m_cachedLen; --pos, fraction /= 10)
+            buffer[pos] = static_cast<char>('0' + fraction % 10);
+    }
+    buffer[len] = '\0';
+    return len;
+}
+
 std::string Clock::getDayOfWeek() const
 {
     auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
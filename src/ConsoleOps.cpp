@@ -34,13 +34,16 @@
 #include <iostream>
 #include <functional>
 
+#include <unistd.h>
+
 using namespace logger;
 
-ConsoleOps::ConsoleOps()
-    : LoggingOps()
+ConsoleOps::ConsoleOps(const size_t ringCapacity)
+    : LoggingOps(ringCapacity)
     , m_testing(false)
     , m_testStringStream()
     , m_isOpsRunning(false)
+    , m_WriteBuffer()
 {
     //Spawn a thread to keep watch and pull the data from the data records queue
     //and write it to the file whenever it is available
@@ -50,6 +53,8 @@ ConsoleOps::ConsoleOps()
 
 ConsoleOps::~ConsoleOps()
 {
+    // Write whatever is left while the members are still alive
+    stopWatcher();
 }
 
 void ConsoleOps::writeDataTo(const std::string_view data)
@@ -61,9 +66,9 @@ void ConsoleOps::writeDataTo(const std::string_view data)
     }
 }
 
-void ConsoleOps::writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr& excpPtr)
+void ConsoleOps::writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& excpPtr)
 {
-    if (dataQueue.empty())
+    if (dataArena.empty())
         return;
 
     try
@@ -73,33 +78,35 @@ void ConsoleOps::writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr&
         m_cv.wait(consoleLock, [this]{ return !m_isOpsRunning; });
         m_isOpsRunning = true;
 
+        // Coalesce the whole batch into one buffer, so
+        // that it goes out with a single write and flush
+        m_WriteBuffer.clear();
+        m_WriteBuffer.reserve(dataArena.bytes());
+        for (const auto data : dataArena)
+        {
+            m_WriteBuffer.append(data);
+            m_WriteBuffer.push_back('\n');
+        }
+
         std::ostream& outStream = std::cout;
-        if (outStream.good())
+        if (m_testing && m_testStringStream.good()) // If testing mode is ON, write to the test string stream
         {
-            while (!dataQueue.empty())
+            m_testStringStream.write(m_WriteBuffer.data(), static_cast<std::streamsize>(m_WriteBuffer.size()));
+            if (!m_testStringStream.good()) // If writing to the test string stream fails, set the error message
             {
-                auto data = dataQueue.front();
-                dataQueue.pop();
-                if (m_testing && m_testStringStream.good()) // If testing mode is ON, write to the test string stream
-                {
-                    m_testStringStream << data.data() << std::endl;
-                    if (!m_testStringStream.good()) // If writing to the test string stream fails, set the error message
-                    {
-                        std::ostringstream osstr;
-                        osstr << "WRITING_ERROR : [";
-                        osstr << std::this_thread::get_id();
-                        osstr << "]: to test stringstream for data" << "[" << data.data() << "]";
-                        if (osstr.good())
-                            errMsg = osstr.str();
-                    }
-                }
-                else
-                {
-                    outStream << data.data() << std::endl;
-                    outStream.flush();
-                }
+                std::ostringstream osstr;
+                osstr << "WRITING_ERROR : [";
+                osstr << std::this_thread::get_id();
+                osstr << "]: to test stringstream for data" << "[" << *dataArena.begin() << "]";
+                if (osstr.good())
+                    errMsg = osstr.str();
             }
         }
+        else if (outStream.good())
+        {
+            outStream.write(m_WriteBuffer.data(), static_cast<std::streamsize>(m_WriteBuffer.size()));
+            outStream.flush();
+        }
         else
         {
             std::ostringstream osstr;
@@ -121,3 +128,7 @@ void ConsoleOps::writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr&
     }
 }
 
+int ConsoleOps::emergencyFd() const noexcept
+{
+    return STDOUT_FILENO;
+}
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: CrashHandler.cpp
+ * Description: Implementation of the CrashHandler class.
+ * See CrashHandler.hpp for class definition and documentation.
+ */
+
+#include "CrashHandler.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <charconv>
+
+#include <unistd.h>
+
+using namespace logger;
+
+/*static*/constinit std::atomic<LoggingOps*> CrashHandler::m_pOps(nullptr);
+/*static*/constinit std::atomic_flag CrashHandler::m_isHandling;
+/*static*/std::array<struct sigaction, CrashHandler::handledSignals.size()> CrashHandler::m_PrevActions;
+
+/*static*/bool CrashHandler::install(LoggingOps& ops)
+{
+    if (m_pOps.exchange(&ops, std::memory_order_acq_rel))
+        return true;    // Already installed, the previous handlers are kept
+
+    setUpAltStack();
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &CrashHandler::handleSignal;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+    for (size_t idx = 0; idx < handledSignals.size(); ++idx)
+    {
+        if (sigaction(handledSignals[idx], &action, &m_PrevActions[idx]) != 0)
+        {
+            auto errNo = errno;
+            // Put back the ones installed so far
+            while (idx-- > 0)
+                sigaction(handledSignals[idx], &m_PrevActions[idx], nullptr);
+            m_pOps.store(nullptr, std::memory_order_release);
+            errno = errNo;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*static*/void CrashHandler::uninstall() noexcept
+{
+    if (!m_pOps.exchange(nullptr, std::memory_order_acq_rel))
+        return;
+    for (size_t idx = 0; idx < handledSignals.size(); ++idx)
+        sigaction(handledSignals[idx], &m_PrevActions[idx], nullptr);
+}
+
+/*static*/bool CrashHandler::isInstalled() noexcept
+{
+    return m_pOps.load(std::memory_order_acquire) != nullptr;
+}
+
+/*static*/void CrashHandler::setUpAltStack() noexcept
+{
+    // A stack overflow leaves no stack for the handler to run on
+    alignas(16) static char altStack[m_AltStackSize];
+    stack_t current;
+    if (sigaltstack(nullptr, &current) == 0 && !(current.ss_flags & SS_DISABLE))
+        return;     // The program has one already
+
+    stack_t altStackInfo;
+    altStackInfo.ss_sp = altStack;
+    altStackInfo.ss_size = sizeof(altStack);
+    altStackInfo.ss_flags = 0;
+    sigaltstack(&altStackInfo, nullptr);
+}
+
+/*static*/void CrashHandler::handleSignal(int sig, siginfo_t* /*pInfo*/, void* /*pContext*/) noexcept
+{
+    auto errNo = errno;
+    // A crash while draining, or a second thread crashing, must not drain it again
+    if (!m_isHandling.test_and_set(std::memory_order_acq_rel))
+    {
+        std::array<char, 64> msg;
+        static constexpr std::string_view prefix = "Caught signal ";
+        static constexpr std::string_view suffix = ", writing the queued log records\n";
+        auto pEnd = std::copy(prefix.begin(), prefix.end(), msg.data());
+        pEnd = std::to_chars(pEnd, msg.data() + msg.size() - suffix.size(), sig).ptr;
+        pEnd = std::copy(suffix.begin(), suffix.end(), pEnd);
+        [[maybe_unused]] auto written = ::write(STDERR_FILENO, msg.data(), static_cast<size_t>(pEnd - msg.data()));
+
+        if (auto pOps = m_pOps.load(std::memory_order_acquire))
+            pOps->emergencyDrain();
+    }
+
+    // Back to the previous handler (the default one, most of the time) and raise it
+    // once more so that it takes its course: core dump, exit status and all
+    for (size_t idx = 0; idx < handledSignals.size(); ++idx)
+    {
+        if (handledSignals[idx] == sig)
+            sigaction(sig, &m_PrevActions[idx], nullptr);
+    }
+    errno = errNo;
+    raise(sig);
+}
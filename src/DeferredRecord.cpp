@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: DeferredRecord.cpp
+ * Description: Implementation of the DeferredRecord class.
+ * See DeferredRecord.hpp for class definition and documentation.
+ */
+
+#include "DeferredRecord.hpp"
+#include "RecordEncoder.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+
+using namespace logger;
+
+template<typename T>
+static inline T load(const std::string_view bytes) noexcept
+{
+    T val{};
+    std::memcpy(&val, bytes.data(), std::min(sizeof(T), bytes.size()));
+    return val;
+}
+
+template<typename T>
+static inline void appendFormatted(const T val, std::string& out)
+{
+    std::format_to(std::back_inserter(out), "{}", val);
+}
+
+/*static*/void DeferredRecord::appendValue(const ArgType type, const std::string_view bytes, std::string& out)
+{
+    switch (type)
+    {
+        case ArgType::BOOL:         out.append(load<bool>(bytes) ? "true" : "false");   break;
+        case ArgType::CHAR:         out.append(bytes.substr(0, 1));                     break;
+        case ArgType::INT8:         appendFormatted(load<int8_t>(bytes), out);          break;
+        case ArgType::INT16:        appendFormatted(load<int16_t>(bytes), out);         break;
+        case ArgType::INT32:        appendFormatted(load<int32_t>(bytes), out);         break;
+        case ArgType::INT64:        appendFormatted(load<int64_t>(bytes), out);         break;
+        case ArgType::UINT8:        appendFormatted(load<uint8_t>(bytes), out);         break;
+        case ArgType::UINT16:       appendFormatted(load<uint16_t>(bytes), out);        break;
+        case ArgType::UINT32:       appendFormatted(load<uint32_t>(bytes), out);        break;
+        case ArgType::UINT64:       appendFormatted(load<uint64_t>(bytes), out);        break;
+        case ArgType::FLOAT:        appendFormatted(load<float>(bytes), out);           break;
+        case ArgType::DOUBLE:       appendFormatted(load<double>(bytes), out);          break;
+        case ArgType::LONG_DOUBLE:  appendFormatted(load<long double>(bytes), out);     break;
+        case ArgType::STRING:       out.append(bytes);                                  break;
+        case ArgType::NONE:
+        default:
+            break;
+    }
+}
+
+/*static*/void DeferredRecord::formatMessage(const std::string_view record, std::string& msg)
+{
+    Header header;
+    std::memcpy(&header, record.data(), sizeof(Header));
+    auto formatStr = record.substr(sizeof(Header), header.m_FormatSize);
+    if (nullptr == header.m_FormatFunc)
+    {
+        // A structured record, the fields follow the message in logfmt
+        msg.assign(formatStr);
+        auto args = record.substr(sizeof(Header) + header.m_FormatSize);
+        for (uint32_t idx = 0; idx + 1 < header.m_ArgsCnt; idx += 2)
+        {
+            msg.push_back(' ');
+            msg.append(nextArg(header.m_pArgTypes[idx], args)).push_back('=');
+            auto type = header.m_pArgTypes[idx + 1];
+            RecordEncoder::appendLogfmtValue(type, nextArg(type, args), msg);
+        }
+        return;
+    }
+
+    msg.clear();
+    try
+    {
+        header.m_FormatFunc(msg, formatStr, record.data() + sizeof(Header) + header.m_FormatSize);
+    }
+    catch (const std::exception& excp)
+    {
+        msg.assign(formatStr).append(" [FORMAT ERROR: ").append(excp.what()).append("]");
+    }
+}
+
+/*static*/void DeferredRecord::render(const std::string_view record, std::string& line)
+{
+    // Only the watcher thread renders, with a logger object of its own,
+    // so the prefix is exactly the one of the calling threads' records
+    thread_local Logger renderer(DEFAULT_TIME_FORMAT);
+    thread_local std::string msg;
+
+    Header header;
+    std::memcpy(&header, record.data(), sizeof(Header));
+    formatMessage(record, msg);
+
+    auto timeStamp = std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                            std::chrono::nanoseconds(header.m_TimeStampNs)));
+    renderer.setCallSite(*header.m_pCallSite)
+            .setThreadId(header.m_ThreadId)
+            .logFormatted(timeStamp, msg);
+    line.assign(renderer.getLogRecord());
+}
+
+/*static*/DeferredRecord::Fields DeferredRecord::decode(const std::string_view record) noexcept
+{
+    Header header;
+    std::memcpy(&header, record.data(), sizeof(Header));
+
+    Fields fields;
+    fields.m_pCallSite = header.m_pCallSite;
+    fields.m_ThreadId = header.m_ThreadId;
+    fields.m_TimeStampNs = header.m_TimeStampNs;
+    fields.m_FormatStr = record.substr(sizeof(Header), header.m_FormatSize);
+    fields.m_pArgTypes = header.m_pArgTypes;
+    fields.m_ArgsCnt = header.m_ArgsCnt;
+    fields.m_Args = record.substr(sizeof(Header) + header.m_FormatSize);
+    fields.m_isStructured = (nullptr == header.m_FormatFunc);
+    return fields;
+}
+
+/*static*/std::string_view DeferredRecord::nextArg(const ArgType type, std::string_view& args) noexcept
+{
+    size_t offset = 0;
+    size_t size = 0;
+    switch (type)
+    {
+        case ArgType::BOOL:         size = sizeof(bool);        break;
+        case ArgType::CHAR:
+        case ArgType::INT8:
+        case ArgType::UINT8:        size = 1;                   break;
+        case ArgType::INT16:
+        case ArgType::UINT16:       size = 2;                   break;
+        case ArgType::INT32:
+        case ArgType::UINT32:       size = 4;                   break;
+        case ArgType::INT64:
+        case ArgType::UINT64:       size = 8;                   break;
+        case ArgType::FLOAT:        size = sizeof(float);       break;
+        case ArgType::DOUBLE:       size = sizeof(double);      break;
+        case ArgType::LONG_DOUBLE:  size = sizeof(long double); break;
+        case ArgType::STRING:
+        {
+            LengthType len = 0;
+            std::memcpy(&len, args.data(), sizeof(LengthType));
+            offset = sizeof(LengthType);
+            size = len;
+            break;
+        }
+        case ArgType::NONE:
+        default:
+            break;
+    }
+    auto bytes = args.substr(offset, size);
+    args.remove_prefix(std::min(args.size(), offset + size));
+    return bytes;
+}
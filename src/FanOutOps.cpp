@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: FanOutOps.cpp
+ * Description: Implementation of the FanOutOps class.
+ * See FanOutOps.hpp for class definition and documentation.
+ */
+
+#include "FanOutOps.hpp"
+#include "LogFilter.hpp"
+#include "DeferredRecord.hpp"
+
+#include <algorithm>
+
+using namespace logger;
+
+// The records go straight to the rings of the sinks, its own one is never used
+static constexpr size_t unusedRingCapacity = 64;
+
+FanOutOps::FanOutOps()
+    : LoggingOps(unusedRingCapacity)
+    , m_SinksMtx()
+    , m_Sinks()
+{
+}
+
+FanOutOps::~FanOutOps()
+{
+    stopWatcher();
+}
+
+FanOutOps& FanOutOps::addSink(const std::shared_ptr<LoggingOps>& sink, const LOG_TYPE level)
+{
+    if (!sink || sink.get() == this)
+        return *this;
+
+    std::unique_lock<std::shared_mutex> sinksLock(m_SinksMtx);
+    m_Sinks.push_back({sink, level});
+    updateKeepsDeferredRecords();
+    return *this;
+}
+
+bool FanOutOps::removeSink(const std::shared_ptr<LoggingOps>& sink)
+{
+    std::unique_lock<std::shared_mutex> sinksLock(m_SinksMtx);
+    auto itr = std::find_if(m_Sinks.begin(), m_Sinks.end(), [&sink](const Sink& entry){ return entry.m_pOps == sink; });
+    if (itr == m_Sinks.end())
+        return false;
+    m_Sinks.erase(itr);
+    updateKeepsDeferredRecords();
+    return true;
+}
+
+bool FanOutOps::setSinkLevel(const std::shared_ptr<LoggingOps>& sink, const LOG_TYPE level)
+{
+    std::unique_lock<std::shared_mutex> sinksLock(m_SinksMtx);
+    auto itr = std::find_if(m_Sinks.begin(), m_Sinks.end(), [&sink](const Sink& entry){ return entry.m_pOps == sink; });
+    if (itr == m_Sinks.end())
+        return false;
+    itr->m_Level = level;
+    return true;
+}
+
+size_t FanOutOps::getSinksCount() const
+{
+    std::shared_lock<std::shared_mutex> sinksLock(m_SinksMtx);
+    return m_Sinks.size();
+}
+
+void FanOutOps::updateKeepsDeferredRecords() noexcept
+{
+    // A sink with a record encoder wants the deferred records as well, so they
+    // are deferred for it. The others get them formatted, see writeDataTo()
+    auto keeps = std::any_of(m_Sinks.begin(), m_Sinks.end(), [](const Sink& entry){ return entry.m_pOps->wantsDeferredRecords(); });
+    m_keepsDeferredRecords.store(keeps, std::memory_order_relaxed);
+}
+
+void FanOutOps::flush(const FlushLevel level)
+{
+    // The sinks are flushed without the lock, a flush may take a while
+    std::vector<std::shared_ptr<LoggingOps>> sinks;
+    {
+        std::shared_lock<std::shared_mutex> sinksLock(m_SinksMtx);
+        sinks.reserve(m_Sinks.size());
+        for (const auto& entry : m_Sinks)
+            sinks.push_back(entry.m_pOps);
+    }
+    for (const auto& sink : sinks)
+        sink->flush(level);
+}
+
+size_t FanOutOps::emergencyDrain() noexcept
+{
+    // A lock is not async signal safe, a sink being added or removed
+    // right at the time of the crash is just bad luck
+    size_t cnt = 0;
+    for (const auto& entry : m_Sinks)
+        cnt += entry.m_pOps->emergencyDrain();
+    return cnt;
+}
+
+void FanOutOps::writeDataTo(const std::string_view data)
+{
+    if (data.empty())
+        return;
+
+    const auto isDeferred = RecordKind::DEFERRED == pushedRecordKind();
+    const auto type = isDeferred ? DeferredRecord::decode(data).m_pCallSite->type() : pushedRecordType();
+    auto passes = [type](const Sink& entry)
+    {
+        return LOG_TYPE::LOG_DEFAULT == type || LogFilter::passesLevel(type, entry.m_Level);
+    };
+
+    std::shared_lock<std::shared_mutex> sinksLock(m_SinksMtx);
+    if (!isDeferred)
+    {
+        for (const auto& entry : m_Sinks)
+        {
+            if (passes(entry))
+                entry.m_pOps->write(data, type);
+        }
+        return;
+    }
+
+    // A deferred record is formatted by the watcher thread of the sink,
+    // which is fine as long as there is a single sink formatting it.
+    // The sinks encoding it (see RecordEncoder) need it as it is
+    size_t formattingSinksCnt = 0;
+    for (const auto& entry : m_Sinks)
+    {
+        if (passes(entry) && !entry.m_pOps->wantsDeferredRecords())
+            ++formattingSinksCnt;
+    }
+    thread_local std::string line;
+    const auto formatHere = formattingSinksCnt > 1;
+    if (formatHere)
+        DeferredRecord::render(data, line);
+
+    for (const auto& entry : m_Sinks)
+    {
+        if (!passes(entry))
+            continue;
+        if (formatHere && !entry.m_pOps->wantsDeferredRecords())
+            entry.m_pOps->write(line, type);
+        else
+            entry.m_pOps->writeDeferred(data);
+    }
+}
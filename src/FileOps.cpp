@@ -26,11 +26,27 @@
  * SOFTWARE.
  */
 #include "FileOps.hpp"
+#include "LogReader.hpp"
 #include "Clock.hpp"
 
+#include <array>
 #include <tuple>
 #include <memory>
+#include <utility>
+#include <sstream>
 #include <functional>
+#include <cerrno>
+#include <cstring>
+#include <cctype>
+#include <vector>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace logger;
 
@@ -38,6 +54,170 @@ using namespace logger;
 static constexpr std::string_view nullString = "";
 static constexpr std::string_view DEFAULT_FILE_EXTN = ".txt";
 
+static constexpr char newLine = '\n';
+#ifdef IOV_MAX
+static constexpr size_t maxIoVecCnt = IOV_MAX;
+#else
+static constexpr size_t maxIoVecCnt = 1024;
+#endif
+
+static int syncFile(const int fd, const FlushLevel level) noexcept
+{
+#if defined(__APPLE__)
+    (void)level;
+    return ::fsync(fd);     // No fdatasync on macOS
+#else
+    return (level == FlushLevel::FULL_SYNC) ? ::fsync(fd) : ::fdatasync(fd);
+#endif
+}
+
+static bool writeAll(const int fd, struct iovec* pIoVecs, size_t ioVecCnt) noexcept
+{
+    while (ioVecCnt > 0)
+    {
+        auto written = ::writev(fd, pIoVecs, static_cast<int>(std::min(ioVecCnt, maxIoVecCnt)));
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        // Skip whatever is written completely and
+        // adjust the one written partially (if any)
+        auto remaining = static_cast<size_t>(written);
+        while (ioVecCnt > 0 && remaining >= pIoVecs->iov_len)
+        {
+            remaining -= pIoVecs->iov_len;
+            ++pIoVecs;
+            --ioVecCnt;
+        }
+        if (ioVecCnt > 0)
+        {
+            pIoVecs->iov_base = static_cast<char*>(pIoVecs->iov_base) + remaining;
+            pIoVecs->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Make the file the given size, with the blocks allocated already where
+ * it is supported, so that the writes into its mapping can't run out of space
+ */
+static bool preallocateFile(const int fd, const std::uintmax_t size) noexcept
+{
+#if defined(__linux__)
+    if (::posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0)
+        return true;
+#endif
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+
+/**
+ * @brief Read the rest of the stream, but not more than maxBytes
+ */
+static std::string readContent(std::ifstream& fileStream, const std::uintmax_t maxBytes)
+{
+    if (UINTMAX_MAX == maxBytes)
+        return std::string((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
+
+    std::string data(maxBytes, '\0');
+    fileStream.read(data.data(), static_cast<std::streamsize>(maxBytes));
+    data.resize(static_cast<size_t>(fileStream.gcount()));
+    return data;
+}
+
+/**
+ * @brief Read the magic number a file starts with (if any) and rewind
+ */
+static std::string_view peekMagic(std::ifstream& fileStream, std::array<char, 4>& magic)
+{
+    static_assert(binaryLogMagic.size() == 4 && compressedLogMagic.size() == 4);
+    fileStream.read(magic.data(), magic.size());
+    auto readCnt = static_cast<size_t>(fileStream.gcount());
+    fileStream.clear();
+    fileStream.seekg(0, std::ios::beg);
+    return std::string_view(magic.data(), readCnt);
+}
+
+/**
+ * @brief Read the whole content of a compressed log file, decompressed
+ *
+ * @param [in] file The file to be read
+ * @param [out] content The decompressed content
+ * @param [in] maxBytes The number of bytes logged to the file, if it is still mapped
+ * @return true If the file is a compressed log, otherwise
+ * @return false The file is not compressed (or can't be opened), the content is left untouched
+ */
+static bool readDecompressed(const std::filesystem::path& file, std::string& content, const std::uintmax_t maxBytes = UINTMAX_MAX)
+{
+    std::ifstream fileStream(file, std::ios::binary);
+    std::array<char, 4> magic{};
+    if (!fileStream.is_open() || !BlockCompression::isCompressed(peekMagic(fileStream, magic)))
+        return false;
+
+    auto data = readContent(fileStream, maxBytes);
+    // A truncated last block is the one being written when the process
+    // died, whatever made it to the file before is still readable
+    BlockCompression::decompress(data, content);
+    return true;
+}
+
+/**
+ * @brief Open a file for reading its lines. A compressed file is decompressed
+ * and a binary log file is rendered back to the text first, so the lines are
+ * the same either way.
+ *
+ * @param [in] file The file to be read
+ * @param [in] maxBytes The number of bytes logged to the file, if it is still mapped
+ * @param [out] pIsPlainText Set if the file is plain text, i.e. the offsets in the
+ *                           stream are the ones in the file (optional)
+ * @return std::unique_ptr<std::istream> The stream, nullptr if the file can't be opened
+ * @note A plain text file is read straight from the file rather than copied, so it is
+ *       up to the caller not to read past maxBytes (the preallocated space of a mapped file).
+ */
+static std::unique_ptr<std::istream> openTextStream(const std::filesystem::path& file,
+                                                    const std::uintmax_t maxBytes = UINTMAX_MAX,
+                                                    bool* pIsPlainText = nullptr)
+{
+    std::string data;
+    if (pIsPlainText)
+        *pIsPlainText = false;
+    if (!readDecompressed(file, data, maxBytes))
+    {
+        auto pFileStream = std::make_unique<std::ifstream>(file, std::ios::binary);
+        if (!pFileStream->is_open())
+            return nullptr;
+
+        std::array<char, 4> magic{};
+        auto isBinary = BinaryLogReader::isBinaryLog(peekMagic(*pFileStream, magic));
+        if (pIsPlainText)
+            *pIsPlainText = !isBinary;
+        if (!isBinary)
+            return pFileStream;
+        // The preallocated space of a mapped file is left out
+        data = readContent(*pFileStream, maxBytes);
+    }
+
+    if (!BinaryLogReader::isBinaryLog(data))
+        return std::make_unique<std::istringstream>(std::move(data));
+    std::string text;
+    BinaryLogReader::decode(data, text);
+    return std::make_unique<std::istringstream>(std::move(text));
+}
+
+/**
+ * @brief Get the identity of a file, so that the line index notices the file
+ * being replaced (e.g. by a rotation) even if it has grown past the indexed size
+ */
+static std::uintmax_t fileIdOf(const std::filesystem::path& file) noexcept
+{
+    struct stat fileStat{};
+    if (::stat(file.c_str(), &fileStat) != 0)
+        return 0;
+    return static_cast<std::uintmax_t>(fileStat.st_ino);
+}
+
 /*static*/ bool FileOps::isFileEmpty(const std::filesystem::path& file) noexcept
 {
     if (fileExists(file))
@@ -103,7 +283,11 @@ static constexpr std::string_view DEFAULT_FILE_EXTN = ".txt";
         if (file.isEmpty())
             throw std::runtime_error("File " + file.getFilePathObj().string() + " empty to read");
 
-        std::streampos fileSize = file.getFileSize();
+        // The range of a compressed file is the one of its decompressed content
+        std::string content;
+        auto loggedSize = file.getFileSize();
+        auto isCompressed = readDecompressed(file.getFilePathObj(), content, loggedSize);
+        std::streampos fileSize = static_cast<std::streamoff>(isCompressed ? content.size() : loggedSize);
         if (start > fileSize || end > fileSize || start > end)
         {
             if (start > fileSize)
@@ -114,6 +298,12 @@ static constexpr std::string_view DEFAULT_FILE_EXTN = ".txt";
                 throw std::runtime_error("Out of bound: Start pos is greater than end pos");
         }
 
+        if (isCompressed)
+        {
+            outBuff.assign(content.begin() + static_cast<std::streamoff>(start), content.begin() + static_cast<std::streamoff>(end));
+            return true;
+        }
+
         std::ifstream ifile(file.getFilePathObj(), std::ios::binary);
         if (!ifile)
             throw std::runtime_error("File " + file.getFilePathObj().string() + " can't be opened for reading");
@@ -150,26 +340,104 @@ static constexpr std::string_view DEFAULT_FILE_EXTN = ".txt";
         if (startLineNo > endLineNo)
             throw std::runtime_error("Out of bound: Start pos is greater than end pos");
 
-        std::ifstream ifile(file.getFilePathObj(), std::ios::binary);
-        if (!ifile)
+        auto isPlainText = false;
+        auto loggedSize = file.getFileSize();
+        auto pInStream = openTextStream(file.getFilePathObj(), loggedSize, &isPlainText);
+        if (!pInStream)
             throw std::runtime_error("File " + file.getFilePathObj().string() + " can't be opened for reading");
 
+        auto& ifile = *pInStream;
+        size_t readLineCnt = 0;
+        std::uintmax_t readPos = 0;
+        std::uintmax_t stopPos = UINTMAX_MAX;
+        if (isPlainText)
+        {
+            // Start at the nearest indexed line rather than at the start of the file,
+            // and stop at the records logged so far
+            file.m_LineIndex.update(ifile, loggedSize, fileIdOf(file.getFilePathObj()));
+            auto entry = file.m_LineIndex.seekLine(startLineNo);
+            ifile.seekg(static_cast<std::streamoff>(entry.m_Offset), std::ios::beg);
+            readLineCnt = entry.m_LineNo - 1;
+            readPos = entry.m_Offset;
+            stopPos = loggedSize;
+        }
+
         outBuf.clear();
         std::string readLine;
-        size_t readLineCnt = 0;
-        while (std::getline(ifile, readLine))
+        while (readLineCnt < endLineNo && readPos < stopPos && std::getline(ifile, readLine))
         {
+            readPos += readLine.size() + 1;
             ++readLineCnt;
             if (readLineCnt >= startLineNo)
-            {
-                if (readLineCnt <= endLineNo)
-                    outBuf.emplace_back(readLine);
-            }
+                outBuf.emplace_back(readLine);
             readLine.clear();
-            if (readLineCnt > endLineNo)
-                break;
         }
-        if (!ifile)
+        // Out of the lines logged, whether or not the file goes on
+        if (!ifile || readLineCnt < endLineNo)
+            throw std::runtime_error("File " + file.getFilePathObj().string() + " can't be read even after opening");
+
+        return true;
+    }
+    catch(...)
+    {
+        auto excpPtr = std::current_exception();
+        file.addRaisedException(excpPtr);
+    }
+    return false;
+}
+
+/*static*/ bool FileOps::readFileTimeRange(FileOps& file,
+                                        const std::chrono::system_clock::time_point& startTime,
+                                        const std::chrono::system_clock::time_point& endTime,
+                                        std::vector<std::string>& outBuf)
+{
+    try
+    {
+        if (file.isEmpty())
+            throw std::runtime_error("File " + file.getFilePathObj().string() + " empty to read");
+
+        if (startTime > endTime)
+            throw std::runtime_error("Out of bound: Start time is later than end time");
+
+        // The timestamps of the prefix are compared as strings
+        Clock clock(DEFAULT_TIME_FORMAT);
+        std::array<char, 96> startTimeStr;
+        std::array<char, 96> endTimeStr;
+        std::string_view fromTime(startTimeStr.data(), clock.formatLocalTime(startTime, startTimeStr.data(), startTimeStr.size()));
+        std::string_view toTime(endTimeStr.data(), clock.formatLocalTime(endTime, endTimeStr.data(), endTimeStr.size()));
+
+        auto isPlainText = false;
+        auto loggedSize = file.getFileSize();
+        auto pInStream = openTextStream(file.getFilePathObj(), loggedSize, &isPlainText);
+        if (!pInStream)
+            throw std::runtime_error("File " + file.getFilePathObj().string() + " can't be opened for reading");
+
+        auto& ifile = *pInStream;
+        std::uintmax_t readPos = 0;
+        std::uintmax_t stopPos = UINTMAX_MAX;
+        if (isPlainText)
+        {
+            file.m_LineIndex.update(ifile, loggedSize, fileIdOf(file.getFilePathObj()));
+            readPos = file.m_LineIndex.seekTime(fromTime).m_Offset;
+            stopPos = std::min<std::uintmax_t>(file.m_LineIndex.stopOffset(toTime), loggedSize);
+            ifile.seekg(static_cast<std::streamoff>(readPos), std::ios::beg);
+        }
+
+        // The lines without a prefix of their own belong to the record before them
+        outBuf.clear();
+        std::string readLine;
+        auto isInRange = false;
+        while (readPos < stopPos && std::getline(ifile, readLine))
+        {
+            readPos += readLine.size() + 1;
+            auto lineTime = LineIndex::timeOf(readLine);
+            if (!lineTime.empty())
+                isInRange = (lineTime >= fromTime) && (lineTime.substr(0, toTime.size()) <= toTime);
+            if (isInRange)
+                outBuf.emplace_back(readLine);
+            readLine.clear();
+        }
+        if (ifile.bad())
             throw std::runtime_error("File " + file.getFilePathObj().string() + " can't be read even after opening");
 
         return true;
@@ -255,6 +523,8 @@ void FileOps::populateFilePathObj(const StdTupple& fileDetails)
         }
         //Finally create the file path object
         m_FilePathObj = std::filesystem::path(m_FilePath + m_FileName);
+        //The next batch has to go to the new file
+        closeOutFile();
     }
     //All done, now we can set the flag to false
     //and notify any waiting threads
@@ -265,14 +535,39 @@ void FileOps::populateFilePathObj(const StdTupple& fileDetails)
 FileOps::FileOps(const std::uintmax_t maxFileSize,
                  const std::string_view fileName, 
                  const std::string_view filePath, 
-                 const std::string_view fileExtension)
-    : LoggingOps()
+                 const std::string_view fileExtension,
+                 const size_t ringCapacity)
+    : LoggingOps(ringCapacity)
     , m_FileName(fileName)
     , m_FilePath(filePath)
     , m_FileExtension(fileExtension)
     , m_FileContent(DataQ())
     , m_MaxFileSize(maxFileSize)
     , m_isFileOpsRunning(false)
+    , m_OutFd(-1)
+    , m_isOutFileOpen(false)
+    , m_RotationSyncLevel(FlushLevel::WRITTEN)
+    , m_CurrFileSize(0)
+    , m_IoVecs()
+    , m_FileFormat(FileFormat::TEXT)
+    , m_FileCompression(FileCompression::NONE)
+    , m_BinaryWriter()
+    , m_EncodedBuffer()
+    , m_RawBlock()
+    , m_FileIoMode(FileIoMode::WRITE)
+    , m_pMapping(nullptr)
+    , m_MappingSize(0)
+    , m_MappedPos(0)
+    , m_NextFd(-1)
+    , m_pNextMapping(nullptr)
+    , m_NextMappingSize(0)
+    , m_NextPathObj()
+    , m_MappedMarkerObj()
+    , m_RotationInterval(std::chrono::seconds(0))
+    , m_FileStartTime(std::chrono::steady_clock::now())
+    , m_RetentionPolicy()
+    , m_isRetentionDue(false)
+    , m_LineIndex()
 {
     auto fileDetails = std::make_tuple(m_FileName, m_FilePath, m_FileExtension);
     // Initialize the file path object
@@ -285,6 +580,426 @@ FileOps::FileOps(const std::uintmax_t maxFileSize,
 
 FileOps::~FileOps()
 {
+    // Write whatever is left while the members are still alive
+    stopWatcher();
+    closeOutFile();
+}
+
+bool FileOps::openOutFile() noexcept
+{
+    if (m_OutFd < 0)
+    {
+        auto isMapped = (FileIoMode::MMAP == m_FileIoMode);
+        auto flags = isMapped ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC);
+        m_OutFd = ::open(m_FilePathObj.c_str(), flags, 0644);
+        if (m_OutFd < 0)
+            return false;
+
+        // The only stat for the life of the descriptor, from here on
+        // the size is tracked with the bytes written
+        struct stat fileStat;
+        m_CurrFileSize = (::fstat(m_OutFd, &fileStat) == 0) ? static_cast<std::uintmax_t>(fileStat.st_size) : 0;
+        // Appending to a binary log starts a session of its own
+        m_BinaryWriter.reset();
+        m_FileStartTime = std::chrono::steady_clock::now();
+        if (isMapped)
+        {
+            // The marker is there for as long as the file is mapped, the file still
+            // has it if a process died with it mapped. So the file has the preallocated
+            // space left, where its log ends isn't known for sure, and it is rotated
+            // away instead of being appended to. A zero byte at its end can't tell
+            // it, a binary record may well end with one.
+            auto markerPath = m_FilePathObj.parent_path() / ("." + m_FilePathObj.filename().string() + ".mapped");
+            std::error_code ec;
+            if (m_CurrFileSize > 0 && std::filesystem::exists(markerPath, ec))
+            {
+                ::close(m_OutFd);
+                m_OutFd = -1;
+                std::filesystem::rename(m_FilePathObj, rotatedFilePath(), ec);
+                return ec ? false : openOutFile();
+            }
+            // Without it a crash goes unnoticed, which isn't worth failing the log for
+            auto markerFd = ::open(markerPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (markerFd >= 0)
+            {
+                ::close(markerFd);
+                m_MappedMarkerObj = markerPath;
+            }
+            m_MappedPos = m_CurrFileSize;
+            if (!mapOutFile(std::max<std::uintmax_t>(m_CurrFileSize, m_MaxFileSize)))
+            {
+                closeOutFile();
+                return false;
+            }
+        }
+        m_isOutFileOpen.store(true, std::memory_order_release);
+    }
+    return true;
+}
+
+void FileOps::closeOutFile(const bool isReopened) noexcept
+{
+    unmapOutFile();
+    discardNextSegment();
+    if (m_OutFd >= 0)
+    {
+        ::close(m_OutFd);
+        m_OutFd = -1;
+    }
+    // Gone once the file is cut down to its logged size, see openOutFile()
+    if (!m_MappedMarkerObj.empty())
+    {
+        std::error_code ec;
+        std::filesystem::remove(m_MappedMarkerObj, ec);
+        m_MappedMarkerObj.clear();
+    }
+    m_CurrFileSize = 0;
+    if (!isReopened)
+        m_isOutFileOpen.store(false, std::memory_order_release);
+}
+
+std::filesystem::path FileOps::rotatedFilePath() const
+{
+    Clock clock;
+    auto currentTimeStr = clock.getLocalTimeStr("%d%m%Y_%H%M%S");
+    auto baseFileName = m_FileName.substr(0, m_FileName.find(m_FileExtension)) + "_" + currentTimeStr;
+    auto newPath = m_FilePathObj.parent_path() / (baseFileName + m_FileExtension);
+    // More than one rotation within the same second must not
+    // overwrite the file rotated before, so number them instead
+    for (size_t seqNo = 1; std::filesystem::exists(newPath); ++seqNo)
+        newPath = m_FilePathObj.parent_path() / (baseFileName + "_" + std::to_string(seqNo) + m_FileExtension);
+    return newPath;
+}
+
+bool FileOps::rotateOutFile() noexcept
+{
+    try
+    {
+        auto newPath = rotatedFilePath();
+        // Once asked for a crash safe flush, the rotated file is synced as well
+        if (m_RotationSyncLevel != FlushLevel::WRITTEN && m_OutFd >= 0)
+            syncOutFile(m_RotationSyncLevel);
+
+        std::error_code ec;
+        if (m_NextFd >= 0)
+        {
+            // The next file is ready and mapped, so it is just swapped in
+            unmapOutFile();
+            ::close(m_OutFd);
+            m_OutFd = -1;
+            std::filesystem::rename(m_FilePathObj, newPath, ec);
+            if (!ec)
+                std::filesystem::rename(m_NextPathObj, m_FilePathObj, ec);
+            if (ec)
+            {
+                closeOutFile();
+                return false;
+            }
+            m_OutFd = std::exchange(m_NextFd, -1);
+            m_pMapping = std::exchange(m_pNextMapping, nullptr);
+            m_MappingSize = std::exchange(m_NextMappingSize, 0);
+            m_MappedPos = 0;
+            m_CurrFileSize = 0;
+            m_BinaryWriter.reset();
+            m_FileStartTime = std::chrono::steady_clock::now();
+            m_isRetentionDue = true;
+            countRotation();
+            return true;
+        }
+
+        closeOutFile(true);
+        std::filesystem::rename(m_FilePathObj, newPath, ec);
+        if (ec || !openOutFile())
+        {
+            m_isOutFileOpen.store(false, std::memory_order_release);
+            return false;
+        }
+        m_isRetentionDue = true;
+        countRotation();
+    }
+    catch(...)
+    {
+        closeOutFile();
+        return false;
+    }
+    return true;
+}
+
+bool FileOps::isRotationDue() const noexcept
+{
+    auto interval = m_RotationInterval.load(std::memory_order_relaxed);
+    return interval.count() > 0 && m_CurrFileSize > 0 &&
+           (std::chrono::steady_clock::now() - m_FileStartTime) >= interval;
+}
+
+bool FileOps::isRotationNear() const noexcept
+{
+    if (m_CurrFileSize * 2 >= m_MaxFileSize)
+        return true;
+    auto interval = m_RotationInterval.load(std::memory_order_relaxed);
+    return interval.count() > 0 && (std::chrono::steady_clock::now() - m_FileStartTime) * 2 >= interval;
+}
+
+/**
+ * @brief Check if a file name is the one of a rotated file, i.e. exactly what
+ * rotatedFilePath() makes of it: <base>_DDMMYYYY_HHMMSS[_N]<extension>
+ *
+ * @param [in] name The file name
+ * @param [in] prefix The base name of the active log file along with the '_'
+ * @param [in] extension The extension of the log files
+ */
+static bool isRotatedFileName(std::string_view name, const std::string_view prefix, const std::string_view extension) noexcept
+{
+    if (!name.starts_with(prefix) || !name.ends_with(extension))
+        return false;
+    name = name.substr(prefix.size(), name.size() - prefix.size() - extension.size());
+
+    auto isDigits = [](const std::string_view part)
+    {
+        return !part.empty() && std::all_of(part.begin(), part.end(), [](const char ch){ return std::isdigit(static_cast<unsigned char>(ch)); });
+    };
+    constexpr std::string_view timeFormat = "DDMMYYYY_HHMMSS";
+    if (name.size() < timeFormat.size() || name[8] != '_' || !isDigits(name.substr(0, 8)) || !isDigits(name.substr(9, 6)))
+        return false;
+    // Followed by the number of a rotation within the same second, if any
+    auto seqNo = name.substr(timeFormat.size());
+    return seqNo.empty() || (seqNo.front() == '_' && isDigits(seqNo.substr(1)));
+}
+
+std::vector<std::filesystem::path> FileOps::expiredFiles() const
+{
+    std::vector<std::filesystem::path> expired;
+    if (0 == m_RetentionPolicy.maxFiles && 0 == m_RetentionPolicy.maxTotalBytes)
+        return expired;
+
+    // The rotated files are named after the active one, see rotatedFilePath()
+    struct RotatedFile
+    {
+        std::filesystem::path m_Path;
+        std::uintmax_t m_Size;
+        std::filesystem::file_time_type m_WriteTime;
+    };
+    std::vector<RotatedFile> rotatedFiles;
+    auto prefix = m_FileName.substr(0, m_FileName.find(m_FileExtension)) + "_";
+    auto dirPath = m_FilePathObj.parent_path().empty() ? std::filesystem::path(".") : m_FilePathObj.parent_path();
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dirPath, ec))
+    {
+        auto name = entry.path().filename().string();
+        if (!isRotatedFileName(name, prefix, m_FileExtension) || !entry.is_regular_file(ec))
+            continue;
+        rotatedFiles.push_back({ entry.path(), entry.file_size(ec), entry.last_write_time(ec) });
+    }
+
+    // The newest ones are kept till either of the limits is hit
+    std::sort(rotatedFiles.begin(), rotatedFiles.end(),
+              [](const RotatedFile& lhs, const RotatedFile& rhs){ return lhs.m_WriteTime > rhs.m_WriteTime; });
+    std::uintmax_t keptBytes = 0;
+    auto isOver = false;
+    for (size_t idx = 0; idx < rotatedFiles.size(); ++idx)
+    {
+        keptBytes += rotatedFiles[idx].m_Size;
+        isOver = isOver || (m_RetentionPolicy.maxFiles && idx >= m_RetentionPolicy.maxFiles) ||
+                 (m_RetentionPolicy.maxTotalBytes && keptBytes > m_RetentionPolicy.maxTotalBytes);
+        if (isOver)
+            expired.push_back(rotatedFiles[idx].m_Path);
+    }
+    return expired;
+}
+
+bool FileOps::writeOut(struct iovec* pIoVecs, const size_t ioVecCnt) noexcept
+{
+    if (!m_pMapping)
+    {
+        if (!writeAll(m_OutFd, pIoVecs, ioVecCnt))
+            return false;
+        // The next file is created ahead, so that the rotation is just a pair of renames
+        if (m_NextFd < 0 && isRotationNear())
+            prepareNextSegment();
+        return true;
+    }
+
+    std::uintmax_t bytes = 0;
+    for (size_t idx = 0; idx < ioVecCnt; ++idx)
+        bytes += pIoVecs[idx].iov_len;
+    // Only a record longer than the max file size (it is never split) gets here
+    if (m_MappedPos + bytes > m_MappingSize && !mapOutFile(m_MappedPos + bytes))
+        return false;
+
+    for (size_t idx = 0; idx < ioVecCnt; ++idx)
+    {
+        std::memcpy(m_pMapping + m_MappedPos, pIoVecs[idx].iov_base, pIoVecs[idx].iov_len);
+        m_MappedPos += pIoVecs[idx].iov_len;
+    }
+    // Half full, the next file is prepared now, so that the rotation doesn't wait for it
+    if (m_NextFd < 0 && (m_MappedPos * 2 >= m_MappingSize || isRotationNear()))
+        prepareNextSegment();
+    return true;
+}
+
+int FileOps::syncOutFile(const FlushLevel level) noexcept
+{
+    if (m_OutFd < 0)
+        return 0;
+    if (m_pMapping && m_MappedPos > 0 && ::msync(m_pMapping, static_cast<size_t>(m_MappedPos), MS_SYNC) != 0)
+        return -1;
+    // msync() takes care of the data, the metadata still needs fsync()
+    if (m_pMapping && FlushLevel::DATA_SYNC == level)
+        return 0;
+    return syncFile(m_OutFd, level);
+}
+
+bool FileOps::mapOutFile(const std::uintmax_t size) noexcept
+{
+    if (m_pMapping)
+    {
+        ::munmap(m_pMapping, static_cast<size_t>(m_MappingSize));
+        m_pMapping = nullptr;
+        m_MappingSize = 0;
+    }
+    auto mappingSize = std::max<std::uintmax_t>(size, 1);
+    if (!preallocateFile(m_OutFd, mappingSize))
+        return false;
+    auto* pMapping = ::mmap(nullptr, static_cast<size_t>(mappingSize), PROT_READ | PROT_WRITE, MAP_SHARED, m_OutFd, 0);
+    if (MAP_FAILED == pMapping)
+        return false;
+    m_pMapping = static_cast<char*>(pMapping);
+    m_MappingSize = mappingSize;
+    return true;
+}
+
+void FileOps::unmapOutFile() noexcept
+{
+    if (!m_pMapping)
+        return;
+    ::munmap(m_pMapping, static_cast<size_t>(m_MappingSize));
+    m_pMapping = nullptr;
+    m_MappingSize = 0;
+    // Whatever isn't logged of the preallocated space goes
+    if (m_OutFd >= 0)
+        (void)::ftruncate(m_OutFd, static_cast<off_t>(m_MappedPos));
+    m_MappedPos = 0;
+}
+
+void FileOps::prepareNextSegment() noexcept
+{
+    try
+    {
+        // A hidden file next to the active one, so the rotation is a rename
+        m_NextPathObj = m_FilePathObj.parent_path() / ("." + m_FilePathObj.filename().string() + ".next");
+        auto isMapped = (nullptr != m_pMapping);
+        auto flags = isMapped ? (O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC) : (O_WRONLY | O_APPEND | O_CREAT | O_TRUNC | O_CLOEXEC);
+        m_NextFd = ::open(m_NextPathObj.c_str(), flags, 0644);
+        if (m_NextFd < 0 || !isMapped)
+            return;
+        m_NextMappingSize = std::max<std::uintmax_t>(m_MaxFileSize, 1);
+        void* pMapping = MAP_FAILED;
+        if (preallocateFile(m_NextFd, m_NextMappingSize))
+            pMapping = ::mmap(nullptr, static_cast<size_t>(m_NextMappingSize), PROT_READ | PROT_WRITE, MAP_SHARED, m_NextFd, 0);
+        if (MAP_FAILED == pMapping)
+        {
+            discardNextSegment();
+            return;
+        }
+        m_pNextMapping = static_cast<char*>(pMapping);
+    }
+    catch(...)
+    {
+        discardNextSegment();
+    }
+}
+
+void FileOps::discardNextSegment() noexcept
+{
+    if (m_pNextMapping)
+    {
+        ::munmap(m_pNextMapping, static_cast<size_t>(m_NextMappingSize));
+        m_pNextMapping = nullptr;
+    }
+    m_NextMappingSize = 0;
+    if (m_NextFd >= 0)
+    {
+        ::close(m_NextFd);
+        m_NextFd = -1;
+        std::error_code ec;
+        std::filesystem::remove(m_NextPathObj, ec);
+    }
+}
+
+FileOps& FileOps::setFileFormat(const FileFormat format)
+{
+    if (format == m_FileFormat)
+        return *this;
+
+    // Whatever is logged so far goes out in the old format
+    flush();
+    std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+    m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+    m_FileFormat = format;
+    m_keepsDeferredRecords = (FileFormat::BINARY == format);
+    closeOutFile();
+    fileLock.unlock();
+    m_FileOpsCv.notify_all();
+    return *this;
+}
+
+FileOps& FileOps::setFileCompression(const FileCompression compression)
+{
+    if (compression == m_FileCompression)
+        return *this;
+
+    // Whatever is logged so far goes out the old way
+    flush();
+    std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+    m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+    m_FileCompression = compression;
+    closeOutFile();
+    fileLock.unlock();
+    m_FileOpsCv.notify_all();
+    return *this;
+}
+
+FileOps& FileOps::setFileIoMode(const FileIoMode mode)
+{
+    if (mode == m_FileIoMode)
+        return *this;
+
+    // Whatever is logged so far goes out the old way
+    flush();
+    std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+    m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+    m_FileIoMode = mode;
+    closeOutFile();
+    fileLock.unlock();
+    m_FileOpsCv.notify_all();
+    return *this;
+}
+
+FileOps& FileOps::setRotationInterval(const std::chrono::seconds interval)
+{
+    m_RotationInterval.store(std::max(interval, std::chrono::seconds(0)), std::memory_order_relaxed);
+    return *this;
+}
+
+FileOps& FileOps::setRetentionPolicy(const RetentionPolicy& policy)
+{
+    std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+    m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+    m_RetentionPolicy = policy;
+    m_isRetentionDue = true;
+    fileLock.unlock();
+    m_FileOpsCv.notify_all();
+    return *this;
+}
+
+RetentionPolicy FileOps::getRetentionPolicy()
+{
+    std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+    m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+    auto policy = m_RetentionPolicy;
+    fileLock.unlock();
+    m_FileOpsCv.notify_all();
+    return policy;
 }
 
 FileOps& FileOps::setFileName(const std::string_view fileName)
@@ -323,7 +1038,8 @@ std::uintmax_t FileOps::getFileSize()
         std::scoped_lock<std::mutex> fileLock(m_FileOpsMutex);
         m_isFileOpsRunning = true;
         std::error_code ec;
-        fileSize = std::filesystem::file_size(m_FilePathObj, ec);
+        // A mapped file is preallocated, its size is the one logged so far
+        fileSize = m_pMapping ? m_MappedPos : std::filesystem::file_size(m_FilePathObj, ec);
         m_isFileOpsRunning = false;
         if (ec)
         {
@@ -344,6 +1060,8 @@ bool FileOps::createFile()
     {
         std::scoped_lock<std::mutex> lock(m_FileOpsMutex);
         m_isFileOpsRunning = true;
+        // The file didn't exist, so an open descriptor belongs to a removed file
+        closeOutFile();
         std::ofstream file(m_FilePathObj);
         if (file.is_open())
         {
@@ -364,6 +1082,7 @@ bool FileOps::deleteFile()
         std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
         m_FileOpsCv.wait(fileLock, [this] { return !m_isFileOpsRunning; });
         m_isFileOpsRunning = true;
+        closeOutFile();
         retVal = std::filesystem::remove(m_FilePathObj);
         m_isFileOpsRunning = false;
         fileLock.unlock();
@@ -386,6 +1105,7 @@ bool FileOps::renameFile(const std::string_view newFileName)
         m_isFileOpsRunning = true;
 
         std::filesystem::path newPath = m_FilePathObj.parent_path() / newFileName;
+        closeOutFile();
         std::filesystem::rename(m_FilePathObj, newPath);
         m_isFileOpsRunning = false;
         lock.unlock();
@@ -412,22 +1132,21 @@ void FileOps::readFile()
 
     if (std::filesystem::exists(m_FilePathObj))
     {
-        std::ifstream file(m_FilePathObj, std::ios::binary);
-        if (file.is_open())
+        LogReader reader(m_FilePathObj);
+        std::string_view line;
+        try
         {
-            std::string line;
-            while (std::getline(file, line))
-            {
+            if (!reader.isOpen())
+                throw std::runtime_error("Failed to open file: " + m_FilePathObj.string());
+            while (reader.next(line))
                 m_FileContent.emplace(line);
-                line.clear();
-            }
         }
-        else
+        catch(...)
         {
             m_isFileOpsRunning = false;
             fileLock.unlock();
             m_FileOpsCv.notify_all();
-            throw std::runtime_error("Failed to open file: " + m_FilePathObj.string());
+            throw;
         }
     }
     m_isFileOpsRunning = false;
@@ -435,6 +1154,28 @@ void FileOps::readFile()
     m_FileOpsCv.notify_all();
 }
 
+size_t FileOps::readFile(const std::function<bool(const std::string_view)>& lineHandler)
+{
+    if (m_FilePathObj.empty())
+        throw std::runtime_error("File path is empty");
+
+    flush();
+    if (!std::filesystem::exists(m_FilePathObj))
+        return 0;
+
+    // No lock is held while reading, the handler may well use the object
+    LogReader reader(m_FilePathObj);
+    if (!reader.isOpen())
+        throw std::runtime_error("Failed to open file: " + m_FilePathObj.string());
+    std::string_view line;
+    while (reader.next(line))
+    {
+        if (!lineHandler(line))
+            break;
+    }
+    return reader.getLinesCount();
+}
+
 bool FileOps::clearFile()
 {
     auto retVal = false;
@@ -444,10 +1185,17 @@ bool FileOps::clearFile()
 
     if (fileExists())
     {
+        // A mapping must never outlive the size of its file
+        if (m_pMapping)
+            closeOutFile();
+        m_LineIndex.reset();
         std::ofstream file(m_FilePathObj, std::ios::out | std::ios::trunc);
         if (file.is_open())
         {
             file.close();
+            // The descriptor (if open) is in append mode, so it is
+            // still good, only the tracked size has to start over
+            m_CurrFileSize = 0;
             retVal = true;
         }
     }
@@ -459,65 +1207,244 @@ bool FileOps::clearFile()
 
 void FileOps::writeDataTo(const std::string_view data)
 {
+    if (data.empty())
+        return;
+
+    // The producer only queues the record. The size of the file and the
+    // rotation are taken care of by the watcher thread while writing.
+    // The file is opened (created) right away only if it isn't open yet,
+    // which is checked with a single atomic load, not with a stat.
+    if (!m_isOutFileOpen.load(std::memory_order_acquire))
+    {
+        std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+        m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+        auto success = openOutFile();
+        fileLock.unlock();
+        if (!success)
+            addRaisedException(std::make_exception_ptr(std::runtime_error("File neither exists nor can be created")));
+    }
+    push(data);
+}
+
+void FileOps::writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& excpPtr)
+{
+    if (dataArena.empty())
+        return;
+
     try
     {
-        if (data.empty())
-            return;
+        std::string errMsg;
+        std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
+        m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
+        m_isFileOpsRunning = true;
 
-        if (!fileExists())
+        // The records are not copied once more, the iovec array points
+        // straight into the arena, each of them followed by a new line
+        m_IoVecs.clear();
+        m_IoVecs.reserve(dataArena.size() * 2);
+        auto success = openOutFile();
+        // Once its interval is over, the file is rotated before anything more is written to it
+        if (success && isRotationDue() && !rotateOutFile())
         {
-            if (createFile())
-                push(data);
-            else
-                throw std::runtime_error("File neither exists nor can be created");
+            errMsg = "Rotation interval is over but the file can not be renamed";
+            success = false;
         }
-        else
+        auto isCompressed = (FileCompression::NONE != m_FileCompression);
+        if (success && isCompressed)
+            success = collectCompressedRecords(dataArena, errMsg);
+        else if (success && FileFormat::BINARY == m_FileFormat)
+            success = collectBinaryRecords(dataArena, errMsg);
+        for (const auto data : dataArena)
         {
-            /**
-             * First check if the current log file
-             * size and the data size to be written
-             * exceeds the max file size limit set
-             * by the user. If so then rename the
-             * existing file with the current time
-             * stamp and create a new blank file
-             * for further logging/writting. Throw
-             * exception for any runtime error case.
-             */
-            flush(); //Flush the data whatever in the queue waiting to be written
-            // Now get the file size
-            auto currFileSize = getFileSize();
-            if ((currFileSize + data.size()) >= m_MaxFileSize)
+            if (!success || isCompressed || FileFormat::BINARY == m_FileFormat)
+                break;
+
+            // If the record would take the file beyond the max file size
+            // then write out whatever is collected so far and rotate the file.
+            // A record is never split, so an empty file takes it regardless.
+            auto recordSize = data.size() + sizeof(newLine);
+            if (m_CurrFileSize > 0 && (m_CurrFileSize + recordSize) > m_MaxFileSize)
             {
-                Clock clock;
-                auto currentTimeStr = clock.getLocalTimeStr("%d%m%Y_%H%M%S");
-                auto currentFileName = getFileName();
-                auto currentFileExtension = getFileExtension();
-                auto newFileName = currentFileName.substr(0, currentFileName.find(currentFileExtension))
-                                     + "_" + currentTimeStr + currentFileExtension;
-                if (renameFile(newFileName))
+                success = writeOut(m_IoVecs.data(), m_IoVecs.size());
+                m_IoVecs.clear();
+                if (success && !rotateOutFile())
                 {
-                    setFileName(currentFileName);
-                    createFile();
-                }
-                else
-                {
-                    throw std::runtime_error("File limit exceeds but can not be renamed");
+                    errMsg = "File limit exceeds but can not be renamed";
+                    break;
                 }
+                if (!success)
+                    break;
             }
-            push(data);
+            m_IoVecs.push_back({ const_cast<char*>(data.data()), data.size() });
+            m_IoVecs.push_back({ const_cast<char*>(&newLine), sizeof(newLine) });
+            m_CurrFileSize += recordSize;
         }
+
+        if (errMsg.empty() && (!success || !writeOut(m_IoVecs.data(), m_IoVecs.size())))
+        {
+            std::ostringstream osstr;
+            osstr << "WRITING_ERROR : [";
+            osstr << std::this_thread::get_id();
+            osstr << "]: File [" << m_FilePathObj.string();
+            osstr << "] can not be written with log data (" << std::strerror(errno) << "): ";
+            osstr << *dataArena.begin() << "\n";
+            errMsg = osstr.str();
+            closeOutFile();
+        }
+        std::vector<std::filesystem::path> expiredPaths;
+        if (m_isRetentionDue)
+        {
+            expiredPaths = expiredFiles();
+            m_isRetentionDue = false;
+        }
+        m_isFileOpsRunning = false;
+        fileLock.unlock();
+        m_FileOpsCv.notify_all();
+
+        // Removing a big file may take a while, nobody waits for it though
+        for (const auto& path : expiredPaths)
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+
+        if (!errMsg.empty())
+            throw std::runtime_error(errMsg);
     }
     catch(...)
     {
-        m_excpPtrVec.emplace_back(std::current_exception());
+        excpPtr = std::current_exception();
     }
 }
 
-void FileOps::writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr& excpPtr)
+bool FileOps::collectBinaryRecords(const RecordArena& dataArena, std::string& errMsg)
 {
-    if (dataQueue.empty())
-        return;
+    auto writeBuffer = [this]()
+    {
+        struct iovec ioVec = { m_EncodedBuffer.data(), m_EncodedBuffer.size() };
+        return writeOut(&ioVec, 1);
+    };
+    auto startFile = [this]()
+    {
+        // A new (or truncated) file, so the tables start over as well
+        if (0 == m_CurrFileSize)
+        {
+            m_BinaryWriter.reset();
+            BinaryLogWriter::appendFileHeader(m_EncodedBuffer);
+            m_CurrFileSize += m_EncodedBuffer.size();
+        }
+    };
+
+    m_EncodedBuffer.clear();
+    startFile();
+    for (auto itr = dataArena.begin(); itr != dataArena.end(); ++itr)
+    {
+        auto start = m_EncodedBuffer.size();
+        m_BinaryWriter.append(*itr, itr.kind(), m_EncodedBuffer);
+        auto recordSize = m_EncodedBuffer.size() - start;
+        // Same as for the text, a record is never split across the files.
+        // It is encoded once more for the new file, as its tables start over.
+        if (m_CurrFileSize > 0 && (m_CurrFileSize + recordSize) > m_MaxFileSize)
+        {
+            m_EncodedBuffer.resize(start);
+            if (!writeBuffer())
+                return false;
+            m_EncodedBuffer.clear();
+            if (!rotateOutFile())
+            {
+                errMsg = "File limit exceeds but can not be renamed";
+                return false;
+            }
+            startFile();
+            start = m_EncodedBuffer.size();
+            m_BinaryWriter.append(*itr, itr.kind(), m_EncodedBuffer);
+            recordSize = m_EncodedBuffer.size() - start;
+        }
+        m_CurrFileSize += recordSize;
+    }
+    m_IoVecs.push_back({ m_EncodedBuffer.data(), m_EncodedBuffer.size() });
+    return true;
+}
+
+bool FileOps::collectCompressedRecords(const RecordArena& dataArena, std::string& errMsg)
+{
+    constexpr auto headerSize = compressedLogMagic.size() + sizeof(compressedLogVersion);
+    auto isBinary = (FileFormat::BINARY == m_FileFormat);
+    auto appendRaw = [this, isBinary](const RecordArena::const_iterator& itr)
+    {
+        if (isBinary)
+            m_BinaryWriter.append(*itr, itr.kind(), m_RawBlock);
+        else
+            m_RawBlock.append(*itr).push_back(newLine);
+    };
+    auto startFile = [this, isBinary]()
+    {
+        // A new (or truncated) file, the first block starts the binary log as well
+        if (0 == m_CurrFileSize)
+        {
+            BlockCompression::appendFileHeader(m_EncodedBuffer);
+            m_CurrFileSize += m_EncodedBuffer.size();
+            if (isBinary)
+            {
+                m_BinaryWriter.reset();
+                BinaryLogWriter::appendFileHeader(m_RawBlock);
+            }
+        }
+    };
+    // Compress the records collected so far (first till last) into a block. If the
+    // block would take the file beyond the max file size, then write out whatever is
+    // collected so far and rotate the file. The records are collected once more for
+    // the new file then, as a binary log starts over with its tables.
+    auto appendBlock = [&](const RecordArena::const_iterator& first, const RecordArena::const_iterator& last)
+    {
+        auto blockStart = m_EncodedBuffer.size();
+        BlockCompression::appendBlock(m_RawBlock, m_EncodedBuffer);
+        auto blockSize = m_EncodedBuffer.size() - blockStart;
+        if (m_CurrFileSize > headerSize && (m_CurrFileSize + blockSize) > m_MaxFileSize)
+        {
+            m_EncodedBuffer.resize(blockStart);
+            struct iovec ioVec = { m_EncodedBuffer.data(), m_EncodedBuffer.size() };
+            if (!writeOut(&ioVec, 1))
+                return false;
+            m_EncodedBuffer.clear();
+            if (!rotateOutFile())
+            {
+                errMsg = "File limit exceeds but can not be renamed";
+                return false;
+            }
+            m_RawBlock.clear();
+            startFile();
+            for (auto itr = first; itr != last; ++itr)
+                appendRaw(itr);
+            blockStart = m_EncodedBuffer.size();
+            BlockCompression::appendBlock(m_RawBlock, m_EncodedBuffer);
+            blockSize = m_EncodedBuffer.size() - blockStart;
+        }
+        m_CurrFileSize += blockSize;
+        m_RawBlock.clear();
+        return true;
+    };
+
+    m_EncodedBuffer.clear();
+    m_RawBlock.clear();
+    startFile();
+    auto blockBegin = dataArena.begin();
+    for (auto itr = dataArena.begin(); itr != dataArena.end();)
+    {
+        appendRaw(itr++);
+        if (m_RawBlock.size() >= BlockCompression::blockSize || itr == dataArena.end())
+        {
+            if (!appendBlock(blockBegin, itr))
+                return false;
+            blockBegin = itr;
+        }
+    }
+    m_IoVecs.push_back({ m_EncodedBuffer.data(), m_EncodedBuffer.size() });
+    return true;
+}
 
+void FileOps::syncOutStreamObject(const FlushLevel level, std::exception_ptr& excpPtr)
+{
     try
     {
         std::string errMsg;
@@ -525,27 +1452,15 @@ void FileOps::writeToOutStreamObject(BufferQ&& dataQueue, std::exception_ptr& ex
         m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
         m_isFileOpsRunning = true;
 
-        std::ofstream file(m_FilePathObj, std::ios::out | std::ios::app | std::ios::binary);
-        std::array<char, bufferSize> data;
-        if (file.is_open())
-        {
-            while (!dataQueue.empty())
-            {
-                data.fill('\0');
-                data = dataQueue.front();
-                dataQueue.pop();
-                file << data.data() << std::endl;
-                file.flush();
-            }
-            file.close();
-        }
-        else
+        if (level > m_RotationSyncLevel)
+            m_RotationSyncLevel = level;
+        if (syncOutFile(level) != 0)
         {
             std::ostringstream osstr;
-            osstr << "WRITING_ERROR : [";
+            osstr << "SYNC_ERROR : [";
             osstr << std::this_thread::get_id();
             osstr << "]: File [" << m_FilePathObj.string();
-            osstr << "] can not be opened to write log data: " << data.data() << "\n";
+            osstr << "] can not be synced (" << std::strerror(errno) << ")\n";
             errMsg = osstr.str();
         }
         m_isFileOpsRunning = false;
@@ -567,9 +1482,22 @@ bool FileOps::isEmpty()
     std::unique_lock<std::mutex> fileLock(m_FileOpsMutex);
     m_FileOpsCv.wait(fileLock, [this]{ return !m_isFileOpsRunning; });
     m_isFileOpsRunning = true;
+    if (m_pMapping)
+    {
+        auto retVal = (0 == m_MappedPos);
+        m_isFileOpsRunning = false;
+        fileLock.unlock();
+        m_FileOpsCv.notify_one();
+        return retVal;
+    }
     std::ifstream file(m_FilePathObj.string(), std::ios::ate | std::ios::binary);
     if (!file)
+    {
+        m_isFileOpsRunning = false;
+        fileLock.unlock();
+        m_FileOpsCv.notify_one();
         return false;
+    }
 
     auto retVal = file.tellg();
     file.close();
@@ -579,3 +1507,14 @@ bool FileOps::isEmpty()
     return retVal == 0;
 }
 
+int FileOps::emergencyFd() const noexcept
+{
+    if (FileIoMode::WRITE == m_FileIoMode.load(std::memory_order_relaxed) &&
+        FileFormat::TEXT == m_FileFormat.load(std::memory_order_relaxed) &&
+        FileCompression::NONE == m_FileCompression.load(std::memory_order_relaxed) &&
+        m_OutFd >= 0)
+    {
+        return m_OutFd;
+    }
+    return STDERR_FILENO;
+}
@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: LineIndex.cpp
+ * Description: Implementation of the LineIndex class.
+ * See LineIndex.hpp for class definition and documentation.
+ */
+
+#include "LineIndex.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+
+using namespace logger;
+
+// The timestamp is at the very start of a line, so the rest of it is never looked at
+static constexpr size_t maxLineHeadSize = 48;
+
+// The size of the chunks the new part of the file is read in
+static constexpr size_t readChunkSize = 64 * 1024;
+
+LineIndex::LineIndex(const size_t stride)
+    : m_Stride(std::max<size_t>(stride, 1))
+    , m_IndexMtx()
+    , m_Entries()
+    , m_FileId(0)
+    , m_IndexedSize(0)
+    , m_LinesCnt(0)
+    , m_LatestTime()
+{
+    m_Entries.push_back({1, 0, std::string()});
+}
+
+void LineIndex::reset()
+{
+    std::scoped_lock<std::mutex> lock(m_IndexMtx);
+    m_Entries.assign(1, {1, 0, std::string()});
+    m_IndexedSize = 0;
+    m_LinesCnt = 0;
+    m_LatestTime.clear();
+}
+
+void LineIndex::update(std::istream& in, const std::uintmax_t size, const std::uintmax_t fileId)
+{
+    std::unique_lock<std::mutex> lock(m_IndexMtx);
+    if (fileId != m_FileId || size < m_IndexedSize)
+    {
+        lock.unlock();
+        reset();
+        lock.lock();
+        m_FileId = fileId;
+    }
+    if (size <= m_IndexedSize)
+        return;
+
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(m_IndexedSize), std::ios::beg);
+    std::vector<char> chunk(readChunkSize);
+    std::string lineHead;
+    auto pos = m_IndexedSize;
+    while (pos < size && in)
+    {
+        auto toRead = static_cast<std::streamsize>(std::min<std::uintmax_t>(chunk.size(), size - pos));
+        in.read(chunk.data(), toRead);
+        auto readCnt = static_cast<size_t>(in.gcount());
+        if (0 == readCnt)
+            break;
+
+        const char* pBegin = chunk.data();
+        const char* pEnd = pBegin + readCnt;
+        while (pBegin < pEnd)
+        {
+            auto pNewLine = static_cast<const char*>(std::memchr(pBegin, '\n', static_cast<size_t>(pEnd - pBegin)));
+            auto pStop = pNewLine ? pNewLine : pEnd;
+            if (lineHead.size() < maxLineHeadSize)
+                lineHead.append(pBegin, std::min(static_cast<size_t>(pStop - pBegin), maxLineHeadSize - lineHead.size()));
+            if (!pNewLine)
+                break;
+            addLine(lineHead, pos + static_cast<std::uintmax_t>(pNewLine - chunk.data()) + 1);
+            lineHead.clear();
+            pBegin = pNewLine + 1;
+        }
+        pos += readCnt;
+    }
+    in.clear();
+}
+
+void LineIndex::addLine(const std::string_view lineHead, const std::uintmax_t nextOffset)
+{
+    ++m_LinesCnt;
+    m_IndexedSize = nextOffset;
+    auto lineTime = timeOf(lineHead);
+    if (lineTime > m_LatestTime)
+        m_LatestTime.assign(lineTime);
+    if (0 == m_LinesCnt % m_Stride)
+        m_Entries.push_back({m_LinesCnt + 1, nextOffset, m_LatestTime});
+}
+
+LineIndex::Entry LineIndex::seekLine(const size_t lineNo) const
+{
+    std::scoped_lock<std::mutex> lock(m_IndexMtx);
+    auto itr = std::upper_bound(m_Entries.begin(), m_Entries.end(), lineNo,
+                                [](const size_t no, const Entry& entry){ return no < entry.m_LineNo; });
+    return (itr == m_Entries.begin()) ? m_Entries.front() : *std::prev(itr);
+}
+
+LineIndex::Entry LineIndex::seekTime(const std::string_view fromTime) const
+{
+    std::scoped_lock<std::mutex> lock(m_IndexMtx);
+    // The latest timestamps never decrease along the entries
+    auto itr = std::partition_point(m_Entries.begin(), m_Entries.end(),
+                                    [fromTime](const Entry& entry){ return entry.m_LatestTime < fromTime; });
+    return (itr == m_Entries.begin()) ? m_Entries.front() : *std::prev(itr);
+}
+
+std::uintmax_t LineIndex::stopOffset(const std::string_view toTime) const
+{
+    std::scoped_lock<std::mutex> lock(m_IndexMtx);
+    auto itr = std::partition_point(m_Entries.begin(), m_Entries.end(),
+                                    [toTime](const Entry& entry){ return entry.m_LatestTime <= toTime; });
+    if (itr == m_Entries.end() || std::next(itr) == m_Entries.end())
+        return UINTMAX_MAX;
+    return std::next(itr)->m_Offset;
+}
+
+size_t LineIndex::getLinesCount() const
+{
+    std::scoped_lock<std::mutex> lock(m_IndexMtx);
+    return m_LinesCnt;
+}
+
+/*static*/ std::string_view LineIndex::timeOf(const std::string_view line) noexcept
+{
+    // |20250822_022103| 0x16b8cb000| ProducerConsumer.cpp|   28|INF>  ...
+    if (line.size() < 3 || '|' != line[0] || line[1] < '0' || line[1] > '9')
+        return std::string_view();
+    auto endPos = line.find('|', 1);
+    if (std::string_view::npos == endPos)
+        return std::string_view();
+    return line.substr(1, endPos - 1);
+}
@@ -0,0 +1,399 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: LogConfig.cpp
+ * Description: Implementation of the LogConfig struct.
+ * See LogConfig.hpp for struct definition and documentation.
+ */
+
+#include "LogConfig.hpp"
+#include "LogFilter.hpp"
+#include "RateLimiter.hpp"
+#include "TraceSpan.hpp"
+#include "ENV_VARS.hpp"
+
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <charconv>
+#include <algorithm>
+
+using namespace logger;
+
+static std::string_view trim(std::string_view value) noexcept
+{
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front())))
+        value.remove_prefix(1);
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back())))
+        value.remove_suffix(1);
+    return value;
+}
+
+static std::string toUpper(const std::string_view value)
+{
+    std::string upper(value);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char ch){ return static_cast<char>(std::toupper(ch)); });
+    return upper;
+}
+
+/**
+ * @brief Split a value into its number and its (upper case) unit, e.g. 64kb into 64 and KB
+ */
+static std::optional<std::pair<std::uintmax_t, std::string>> splitUnit(const std::string_view value) noexcept
+{
+    std::uintmax_t num = 0;
+    auto [pEnd, ec] = std::from_chars(value.data(), value.data() + value.size(), num);
+    if (ec != std::errc() || pEnd == value.data())
+        return std::nullopt;
+    return std::make_pair(num, toUpper(trim(std::string_view(pEnd, static_cast<size_t>(value.data() + value.size() - pEnd)))));
+}
+
+static std::optional<bool> parseYesNo(const std::string_view value) noexcept
+{
+    auto upper = toUpper(value);
+    if (upper == "YES" || upper == "TRUE" || upper == "1" || upper == "ON")
+        return true;
+    if (upper == "NO" || upper == "FALSE" || upper == "0" || upper == "OFF")
+        return false;
+    return std::nullopt;
+}
+
+/*static*/std::optional<LOG_TYPE> LogConfig::parseLogLevel(const std::string_view value) noexcept
+{
+    // Both the names of buildNinstall.sh and the ones in the log records
+    static constexpr std::array<std::pair<std::string_view, LOG_TYPE>, 9> levels =
+    {{
+        { "DBG",    LOG_TYPE::LOG_DBG   },
+        { "DEBUG",  LOG_TYPE::LOG_DBG   },
+        { "INFO",   LOG_TYPE::LOG_INFO  },
+        { "INF",    LOG_TYPE::LOG_INFO  },
+        { "IMP",    LOG_TYPE::LOG_IMP   },
+        { "WARN",   LOG_TYPE::LOG_WARN  },
+        { "WARNING", LOG_TYPE::LOG_WARN },
+        { "ERR",    LOG_TYPE::LOG_ERR   },
+        { "ERROR",  LOG_TYPE::LOG_ERR   }
+    }};
+    auto upper = toUpper(value);
+    auto itr = std::find_if(levels.begin(), levels.end(), [&upper](const auto& level){ return level.first == upper; });
+    if (itr == levels.end())
+        return std::nullopt;
+    return itr->second;
+}
+
+/*static*/std::optional<std::uintmax_t> LogConfig::parseSize(const std::string_view value) noexcept
+{
+    auto split = splitUnit(value);
+    if (!split)
+        return std::nullopt;
+
+    auto [num, unit] = *split;
+    if (!unit.empty() && unit.back() == 'B')
+        unit.pop_back();
+    std::uintmax_t multiplier = 0;
+    if (unit.empty())
+        multiplier = 1;
+    else if (unit == "K")
+        multiplier = 1024;
+    else if (unit == "M")
+        multiplier = 1024 * 1024;
+    else if (unit == "G")
+        multiplier = 1024 * 1024 * 1024;
+    // Too big a size would wrap around to a small one
+    if (!multiplier || num > UINTMAX_MAX / multiplier)
+        return std::nullopt;
+    return num * multiplier;
+}
+
+/*static*/std::optional<std::chrono::microseconds> LogConfig::parseDuration(const std::string_view value) noexcept
+{
+    auto split = splitUnit(value);
+    if (!split)
+        return std::nullopt;
+
+    const auto& [num, unit] = *split;
+    std::chrono::microseconds multiplier{0};
+    if (unit == "US")
+        multiplier = std::chrono::microseconds(1);
+    else if (unit == "MS")
+        multiplier = std::chrono::milliseconds(1);
+    else if (unit.empty() || unit == "S")
+        multiplier = std::chrono::seconds(1);
+    else if (unit == "M")
+        multiplier = std::chrono::minutes(1);
+    else if (unit == "H")
+        multiplier = std::chrono::hours(1);
+    // Too long a duration would wrap around to a short or a negative one
+    const auto maxCount = static_cast<std::uintmax_t>(std::chrono::microseconds::max().count());
+    if (!multiplier.count() || num > maxCount / static_cast<std::uintmax_t>(multiplier.count()))
+        return std::nullopt;
+    return static_cast<int64_t>(num) * multiplier;
+}
+
+/*static*/LogConfig LogConfig::buildTimeDefaults()
+{
+    LogConfig config;
+#if defined(FILE_LOGGING)
+    config.fileLogging = true;
+#endif  // FILE_LOGGING
+#ifdef LOG_FILE_NAME
+    config.fileName = LOG_FILE_NAME;
+#endif  // LOG_FILE_NAME
+#ifdef FILE_SIZE
+    config.fileSize = FILE_SIZE;
+#endif  // FILE_SIZE
+#ifdef LOG_FILE_EXTN
+    config.fileExtn = LOG_FILE_EXTN;
+#endif  // LOG_FILE_EXTN
+#ifdef LOG_FILE_PATH
+    config.filePath = LOG_FILE_PATH;
+#endif  // LOG_FILE_PATH
+#ifdef CONSOLE_LOG_LEVEL
+    config.consoleLogLevel = CONSOLE_LOG_LEVEL;
+#endif  // CONSOLE_LOG_LEVEL
+    return config;
+}
+
+/*static*/LogConfig LogConfig::load(std::vector<std::string>& problems)
+{
+    auto config = buildTimeDefaults();
+    if (auto pConfigFile = std::getenv(configFileEnvVar.data()); pConfigFile && *pConfigFile)
+    {
+        if (!config.readFile(pConfigFile, problems))
+            problems.push_back(std::format("Couldn't read the config file {}", pConfigFile));
+    }
+    config.readEnvironment(problems);
+    return config;
+}
+
+bool LogConfig::set(const std::string_view key, const std::string_view value, std::string& problem)
+{
+    auto upperKey = toUpper(trim(key));
+    auto val = trim(value);
+    if (val.size() >= 2 && val.front() == '"' && val.back() == '"')
+        val = val.substr(1, val.size() - 2);
+
+    auto invalid = [&](const std::string_view expected)
+    {
+        problem = std::format("Invalid value '{}' for {}, {} expected", val, upperKey, expected);
+        return false;
+    };
+    auto batch = [this]() -> BatchPolicy&
+    {
+        if (!batchPolicy)
+            batchPolicy.emplace();
+        return *batchPolicy;
+    };
+
+    if (upperKey == "FILE_LOGGING")
+    {
+        auto yes = parseYesNo(val);
+        if (!yes)
+            return invalid("yes or no");
+        fileLogging = *yes;
+    }
+    else if (upperKey == "LOG_FILE_NAME")
+    {
+        fileName = val;
+    }
+    else if (upperKey == "LOG_FILE_PATH")
+    {
+        filePath = val;
+    }
+    else if (upperKey == "LOG_FILE_EXTN")
+    {
+        fileExtn = val;
+        if (!fileExtn.empty() && fileExtn.front() != '.')
+            fileExtn.insert(fileExtn.begin(), '.');
+    }
+    else if (upperKey == "FILE_SIZE" || upperKey == "RETENTION_MAX_BYTES" || upperKey == "RING_CAPACITY" || upperKey == "BATCH_MAX_BYTES")
+    {
+        auto size = parseSize(val);
+        if (!size)
+            return invalid("a size");
+        if (upperKey == "FILE_SIZE")
+            fileSize = *size;
+        else if (upperKey == "RETENTION_MAX_BYTES")
+            retentionPolicy.maxTotalBytes = *size;
+        else if (upperKey == "RING_CAPACITY")
+            ringCapacity = static_cast<size_t>(*size);
+        else
+            batch().maxBytes = static_cast<size_t>(*size);
+    }
+    else if (upperKey == "RETENTION_MAX_FILES" || upperKey == "BATCH_MAX_RECORDS" || upperKey == "RATE_LIMIT_RECORDS" ||
+             upperKey == "SPAN_SAMPLING")
+    {
+        size_t cnt = 0;
+        auto [pEnd, ec] = std::from_chars(val.data(), val.data() + val.size(), cnt);
+        if (ec != std::errc() || pEnd != val.data() + val.size())
+            return invalid("a number");
+        if (upperKey == "RETENTION_MAX_FILES")
+            retentionPolicy.maxFiles = cnt;
+        else if (upperKey == "RATE_LIMIT_RECORDS")
+            rateLimitRecords = static_cast<uint32_t>(std::min<size_t>(cnt, UINT32_MAX));
+        else if (upperKey == "SPAN_SAMPLING")
+            spanSampling = static_cast<uint32_t>(std::min<size_t>(cnt, UINT32_MAX));
+        else
+            batch().maxRecords = cnt;
+    }
+    else if (upperKey == "ROTATION_INTERVAL" || upperKey == "BATCH_MAX_LINGER" || upperKey == "STATS_INTERVAL" ||
+             upperKey == "RELOAD_INTERVAL" || upperKey == "RATE_LIMIT_INTERVAL" || upperKey == "SPAN_MIN_DURATION")
+    {
+        auto duration = parseDuration(val);
+        if (!duration)
+            return invalid("a duration");
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(*duration);
+        // These are kept in seconds, a shorter one would be taken as switched off
+        auto isInSeconds = (upperKey == "ROTATION_INTERVAL" || upperKey == "STATS_INTERVAL" || upperKey == "RELOAD_INTERVAL");
+        if (isInSeconds && duration->count() > 0 && secs.count() == 0)
+            return invalid("at least 1s");
+        if (upperKey == "ROTATION_INTERVAL")
+            rotationInterval = secs;
+        else if (upperKey == "BATCH_MAX_LINGER")
+            batch().maxLinger = *duration;
+        else if (upperKey == "STATS_INTERVAL")
+            statsInterval = secs;
+        else if (upperKey == "RATE_LIMIT_INTERVAL")
+            rateLimitInterval = std::chrono::duration_cast<std::chrono::milliseconds>(*duration);
+        else if (upperKey == "SPAN_MIN_DURATION")
+            spanMinDuration = *duration;
+        else
+            reloadInterval = secs;
+    }
+    else if (upperKey == "STAGING_MODE")
+    {
+        auto mode = toUpper(val);
+        if (mode == "SHARED")
+            stagingMode = StagingMode::SHARED;
+        else if (mode == "PER_CPU")
+            stagingMode = StagingMode::PER_CPU;
+        else if (mode == "PER_NUMA_NODE")
+            stagingMode = StagingMode::PER_NUMA_NODE;
+        else
+            return invalid("shared, per_cpu or per_numa_node");
+    }
+    else if (upperKey == "RECORD_ENCODING")
+    {
+        auto encoding = toUpper(val);
+        if (encoding == "TEXT")
+            recordEncoding = RecordEncoding::TEXT;
+        else if (encoding == "JSON")
+            recordEncoding = RecordEncoding::JSON;
+        else if (encoding == "LOGFMT")
+            recordEncoding = RecordEncoding::LOGFMT;
+        else
+            return invalid("text, json or logfmt");
+    }
+    else if (upperKey == "NETWORK_SINK")
+    {
+        auto target = NetworkTarget::parse(val);
+        if (!target)
+            return invalid("udp://host:port or tcp://host:port");
+        networkSink = std::move(target);
+    }
+    else if (upperKey == "WRITER_CPU")
+    {
+        int cpu = 0;
+        auto [pEnd, ec] = std::from_chars(val.data(), val.data() + val.size(), cpu);
+        if (ec != std::errc() || pEnd != val.data() + val.size() || cpu < 0)
+            return invalid("a CPU number");
+        writerCpu = cpu;
+    }
+    else if (upperKey == "LOG_LEVEL" || upperKey == "CONSOLE_LOG_LEVEL")
+    {
+        auto level = parseLogLevel(val);
+        if (!level)
+            return invalid("dbg, info, imp, warn or err");
+        (upperKey == "LOG_LEVEL" ? logLevel : consoleLogLevel) = *level;
+    }
+    else
+    {
+        problem = std::format("Unknown setting {}", upperKey);
+        return false;
+    }
+    return true;
+}
+
+bool LogConfig::readFile(const std::filesystem::path& file, std::vector<std::string>& problems)
+{
+    std::ifstream inFile(file);
+    if (!inFile.is_open())
+        return false;
+
+    configFile = file;
+    size_t lineNo = 0;
+    std::string problem;
+    for (std::string line; std::getline(inFile, line);)
+    {
+        ++lineNo;
+        auto content = trim(line);
+        if (content.empty() || content.front() == '#')
+            continue;
+
+        auto sepPos = content.find('=');
+        if (sepPos == std::string_view::npos)
+            problems.push_back(std::format("{}:{}: KEY = value expected", file.string(), lineNo));
+        else if (!set(content.substr(0, sepPos), content.substr(sepPos + 1), problem))
+            problems.push_back(std::format("{}:{}: {}", file.string(), lineNo, problem));
+    }
+    return true;
+}
+
+void LogConfig::readEnvironment(std::vector<std::string>& problems)
+{
+    static constexpr std::array<std::string_view, 24> keys =
+    {
+        "FILE_LOGGING", "LOG_FILE_NAME", "LOG_FILE_PATH", "LOG_FILE_EXTN", "FILE_SIZE",
+        "ROTATION_INTERVAL", "RETENTION_MAX_FILES", "RETENTION_MAX_BYTES", "RING_CAPACITY",
+        "STAGING_MODE", "WRITER_CPU", "RECORD_ENCODING", "NETWORK_SINK",
+        "LOG_LEVEL", "CONSOLE_LOG_LEVEL", "BATCH_MAX_RECORDS", "BATCH_MAX_BYTES",
+        "BATCH_MAX_LINGER", "STATS_INTERVAL", "RELOAD_INTERVAL", "RATE_LIMIT_RECORDS", "RATE_LIMIT_INTERVAL",
+        "SPAN_SAMPLING", "SPAN_MIN_DURATION"
+    };
+    std::string problem;
+    for (const auto key : keys)
+    {
+        auto envVar = std::string(envPrefix).append(key);
+        if (auto pValue = std::getenv(envVar.c_str()); pValue)
+        {
+            if (!set(key, pValue, problem))
+                problems.push_back(std::format("{}: {}", envVar, problem));
+        }
+    }
+}
+
+void LogConfig::applyReloadable(LoggingOps& ops) const
+{
+    if (logLevel)
+        LogFilter::setLogLevel(*logLevel);
+    if (rateLimitRecords || rateLimitInterval)
+        RateLimiter::setLimit(rateLimitRecords.value_or(RateLimiter::getMaxRecords()), rateLimitInterval.value_or(RateLimiter::getInterval()));
+    if (spanSampling)
+        TraceSpan::setSampling(*spanSampling);
+    if (spanMinDuration)
+        TraceSpan::setMinDuration(*spanMinDuration);
+    if (batchPolicy)
+        ops.setBatchPolicy(*batchPolicy);
+    if (statsInterval)
+        ops.setStatsInterval(*statsInterval);
+}
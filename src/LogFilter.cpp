@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: LogFilter.cpp
+ * Description: Implementation of the LogFilter class.
+ * See LogFilter.hpp for class definition and documentation.
+ */
+
+#include "LogFilter.hpp"
+
+#include <mutex>
+
+using namespace logger;
+
+// Constant initialized, so that logging from other static objects sees them
+/*static*/constinit std::atomic<uint64_t> LogFilter::m_LevelMask(LogFilter::toMask(LogFilter::defaultLogLevel));
+/*static*/constinit std::atomic<LOG_TYPE> LogFilter::m_LogLevel(LogFilter::defaultLogLevel);
+/*static*/std::shared_mutex LogFilter::m_OverridesMtx;
+/*static*/std::map<std::string, uint32_t, std::less<>> LogFilter::m_FileOverrides;
+
+/*static*/void LogFilter::setLogLevel(const LOG_TYPE level) noexcept
+{
+    std::unique_lock<std::shared_mutex> lock(m_OverridesMtx);
+    m_LogLevel.store(level, std::memory_order_relaxed);
+    publishMask(toMask(level));
+}
+
+/*static*/LOG_TYPE LogFilter::getLogLevel() noexcept
+{
+    return m_LogLevel.load(std::memory_order_relaxed);
+}
+
+/*static*/void LogFilter::setLogLevel(const std::string_view fileName, const LOG_TYPE level)
+{
+    std::unique_lock<std::shared_mutex> lock(m_OverridesMtx);
+    m_FileOverrides.insert_or_assign(std::string(fileName), toMask(level));
+    publishMask(toMask(m_LogLevel.load(std::memory_order_relaxed)));
+}
+
+/*static*/void LogFilter::clearLogLevel(const std::string_view fileName)
+{
+    std::unique_lock<std::shared_mutex> lock(m_OverridesMtx);
+    auto itr = m_FileOverrides.find(fileName);
+    if (itr != m_FileOverrides.end())
+        m_FileOverrides.erase(itr);
+    publishMask(toMask(m_LogLevel.load(std::memory_order_relaxed)));
+}
+
+/*static*/void LogFilter::reset()
+{
+    std::unique_lock<std::shared_mutex> lock(m_OverridesMtx);
+    m_FileOverrides.clear();
+    m_LogLevel.store(defaultLogLevel, std::memory_order_relaxed);
+    publishMask(toMask(defaultLogLevel));
+}
+
+/*static*/bool LogFilter::isEnabledForFile(const std::string_view fileName, const LOG_TYPE type) noexcept
+{
+    std::shared_lock<std::shared_mutex> lock(m_OverridesMtx);
+    auto itr = m_FileOverrides.find(fileName);
+    auto mask = (itr != m_FileOverrides.end()) ? itr->second : m_LevelMask.load(std::memory_order_relaxed);
+    return mask & toBit(type);
+}
+
+/*static*/bool LogFilter::cacheForFile(const CallSite& site, SiteCache& cache, const uint64_t state) noexcept
+{
+    // A level changed meanwhile bumps the generation once more, so the
+    // decision kept for the one read here is made again by the next call
+    auto isEnabled = isEnabledForFile(site.fileName(), site.type());
+    cache.m_Entry.store((state & ~uint64_t(UINT32_MAX)) | (isEnabled ? 1 : 0), std::memory_order_relaxed);
+    return isEnabled;
+}
+
+/*static*/void LogFilter::publishMask(const uint32_t mask) noexcept
+{
+    // The generation 0 is left for a constructed SiteCache
+    auto generation = static_cast<uint32_t>(m_LevelMask.load(std::memory_order_relaxed) >> 32) + 1;
+    if (!generation)
+        generation = 1;
+    m_LevelMask.store((static_cast<uint64_t>(generation) << 32) | mask | (m_FileOverrides.empty() ? 0 : m_OverridesFlag),
+                      std::memory_order_relaxed);
+}
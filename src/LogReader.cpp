@@ -0,0 +1,267 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: LogReader.cpp
+ * Description: Implementation of the LogReader class.
+ * See LogReader.hpp for class definition and documentation.
+ */
+
+#include "LogReader.hpp"
+#include "BlockCompression.hpp"
+
+#include <array>
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace logger;
+
+LogReader::LogReader(const std::filesystem::path& file)
+    : m_Fd(::open(file.c_str(), O_RDONLY | O_CLOEXEC))
+    , m_Source(Source::UNKNOWN)
+    , m_Buffer()
+    , m_Pos(0)
+    , m_LinesCnt(0)
+    , m_Block()
+    , m_pMapping(nullptr)
+    , m_MappingSize(0)
+    , m_Content()
+    , m_pBinaryReader()
+    , m_Record()
+{
+}
+
+LogReader::~LogReader()
+{
+    m_pBinaryReader.reset();
+    if (m_pMapping)
+        ::munmap(m_pMapping, m_MappingSize);
+    if (m_Fd >= 0)
+        ::close(m_Fd);
+}
+
+bool LogReader::next(std::string_view& line)
+{
+    if (m_Fd < 0)
+        return false;
+    if (Source::UNKNOWN == m_Source && !detectSource())
+        return false;
+
+    while (true)
+    {
+        const char* pBegin = m_Buffer.data() + m_Pos;
+        const auto size = m_Buffer.size() - m_Pos;
+        auto pNewLine = static_cast<const char*>(std::memchr(pBegin, '\n', size));
+        if (Source::TEXT == m_Source)
+        {
+            // The preallocated space of a mapped file, nothing is logged beyond
+            auto pZero = static_cast<const char*>(std::memchr(pBegin, '\0', pNewLine ? static_cast<size_t>(pNewLine - pBegin) : size));
+            if (pZero && endsInZero())
+            {
+                auto keptSize = static_cast<size_t>(pZero - m_Buffer.data());
+                unread(m_Buffer.size() - keptSize);
+                m_Buffer.resize(keptSize);
+                return false;
+            }
+        }
+        if (pNewLine)
+        {
+            line = std::string_view(pBegin, static_cast<size_t>(pNewLine - pBegin));
+            m_Pos += line.size() + 1;
+            ++m_LinesCnt;
+            return true;
+        }
+        if (!fill())
+            return false;
+    }
+}
+
+bool LogReader::detectSource()
+{
+    std::array<char, 4> magic{};
+    ssize_t readCnt = 0;
+    do
+    {
+        readCnt = ::pread(m_Fd, magic.data(), magic.size(), 0);
+    } while (readCnt < 0 && EINTR == errno);
+    // Nothing logged yet, or just the preallocated space of a mapped file
+    if (readCnt <= 0 || '\0' == magic[0])
+        return false;
+
+    std::string_view head(magic.data(), static_cast<size_t>(readCnt));
+    if (head.size() < magic.size() && (compressedLogMagic.starts_with(head) || binaryLogMagic.starts_with(head)))
+        return false;
+
+    if (BinaryLogReader::isBinaryLog(head))
+    {
+        struct stat fileStat{};
+        if (::fstat(m_Fd, &fileStat) != 0)
+            throw std::runtime_error(std::string("Can't get the size of the binary log: ") + std::strerror(errno));
+        auto size = static_cast<size_t>(fileStat.st_size);
+        auto pMapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, m_Fd, 0);
+        if (MAP_FAILED == pMapping)
+            throw std::runtime_error(std::string("Can't map the binary log: ") + std::strerror(errno));
+        m_pMapping = static_cast<char*>(pMapping);
+        m_MappingSize = size;
+        m_pBinaryReader = std::make_unique<BinaryLogReader>(std::string_view(m_pMapping, m_MappingSize));
+        m_Source = Source::BINARY;
+        return true;
+    }
+
+    if (BlockCompression::isCompressed(head))
+    {
+        auto restart = [this]()
+        {
+            ::lseek(m_Fd, 0, SEEK_SET);
+            m_Block.clear();
+            m_Buffer.clear();
+            return false;
+        };
+        if (!readUpTo(m_Block, BlockCompression::fileHeaderSize))
+            return restart();
+        if (static_cast<uint8_t>(m_Block[compressedLogMagic.size()]) != compressedLogVersion)
+            throw std::runtime_error("Unsupported compressed log version");
+        m_Block.clear();
+        // The first block tells whether it is a compressed binary log
+        m_Source = Source::COMPRESSED;
+        if (!fillCompressed())
+        {
+            m_Source = Source::UNKNOWN;
+            return restart();
+        }
+        if (BinaryLogReader::isBinaryLog(m_Buffer))
+        {
+            // Its records refer to the strings logged before, so it is kept whole
+            while (fillCompressed())
+                ;
+            m_Content.swap(m_Buffer);
+            m_Buffer.clear();
+            m_pBinaryReader = std::make_unique<BinaryLogReader>(m_Content);
+            m_Source = Source::BINARY;
+        }
+        return true;
+    }
+
+    m_Source = Source::TEXT;
+    return true;
+}
+
+bool LogReader::fill()
+{
+    // Whatever was handed out already isn't needed anymore
+    if (m_Pos)
+    {
+        m_Buffer.erase(0, m_Pos);
+        m_Pos = 0;
+    }
+
+    switch (m_Source)
+    {
+        case Source::TEXT:
+            return fillText();
+        case Source::COMPRESSED:
+            return fillCompressed();
+        case Source::BINARY:
+            return fillBinary();
+        default:
+            return false;
+    }
+}
+
+bool LogReader::fillText()
+{
+    auto size = m_Buffer.size();
+    return readUpTo(m_Buffer, size + chunkSize) || m_Buffer.size() > size;
+}
+
+bool LogReader::fillCompressed()
+{
+    if (!readUpTo(m_Block, BlockCompression::blockHeaderSize))
+        return false;
+    auto blockSize = BlockCompression::blockSizeOf(m_Block);
+    if (0 == blockSize)
+    {
+        // The preallocated space of a mapped file, nothing is logged beyond
+        unread(m_Block.size());
+        m_Block.clear();
+        return false;
+    }
+    if (!readUpTo(m_Block, blockSize))
+        return false;
+    BlockCompression::decompressBlock(m_Block, m_Buffer);
+    m_Block.clear();
+    return true;
+}
+
+bool LogReader::fillBinary()
+{
+    if (!m_pBinaryReader->next(m_Record))
+        return false;
+    m_Buffer.append(m_Record).push_back('\n');
+    return true;
+}
+
+bool LogReader::readUpTo(std::string& buffer, const size_t size)
+{
+    while (buffer.size() < size)
+    {
+        auto oldSize = buffer.size();
+        buffer.resize(size);
+        ssize_t readCnt = 0;
+        do
+        {
+            readCnt = ::read(m_Fd, buffer.data() + oldSize, size - oldSize);
+        } while (readCnt < 0 && EINTR == errno);
+        buffer.resize(oldSize + static_cast<size_t>(std::max<ssize_t>(readCnt, 0)));
+        if (readCnt <= 0)
+            return false;
+    }
+    return true;
+}
+
+void LogReader::unread(const size_t size)
+{
+    if (size)
+        ::lseek(m_Fd, -static_cast<off_t>(size), SEEK_CUR);
+}
+
+bool LogReader::endsInZero() const noexcept
+{
+    struct stat fileStat{};
+    if (::fstat(m_Fd, &fileStat) != 0 || fileStat.st_size <= 0)
+        return false;
+
+    char lastByte = 1;
+    ssize_t readCnt = 0;
+    do
+    {
+        readCnt = ::pread(m_Fd, &lastByte, 1, fileStat.st_size - 1);
+    } while (readCnt < 0 && EINTR == errno);
+    return 1 == readCnt && '\0' == lastByte;
+}
@@ -1,14 +1,44 @@
 #include "Logger.hpp"
 #include "FileOps.hpp"
 #include "ConsoleOps.hpp"
-
-#include "ENV_VARS.hpp"
-
-#include <iomanip>
-#include <regex>
+#include "FanOutOps.hpp"
+#include "NetworkOps.hpp"
+#include "LogConfig.hpp"
+
+#include <mutex>
+#include <thread>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <condition_variable>
 
 using namespace logger;
 
+/*static*/std::string_view Logger::threadIdStr(const std::thread::id& threadId)
+{
+    // It is streamed out once per thread ID only, a few of them are kept by
+    // every thread. The watcher thread renders the records of all of them.
+    struct Entry
+    {
+        std::thread::id m_ThreadId;
+        std::array<char, 48> m_Str;
+        size_t m_Size = 0;
+    };
+    thread_local std::array<Entry, 16> cache;
+    auto& entry = cache[std::hash<std::thread::id>{}(threadId) % cache.size()];
+    if (!entry.m_Size || entry.m_ThreadId != threadId)
+    {
+        std::ostringstream oss;
+        oss << threadId;
+        auto str = oss.str();
+        entry.m_Size = std::min(str.size(), entry.m_Str.size());
+        std::copy_n(str.data(), entry.m_Size, entry.m_Str.data());
+        entry.m_ThreadId = threadId;
+    }
+    return std::string_view(entry.m_Str.data(), entry.m_Size);
+}
+
 /*static*/const UNORD_STRING_MAP Logger::m_stringToEnumMap =
 {
     { "ERR",        LOG_TYPE::LOG_ERR           },
@@ -21,17 +51,8 @@ using namespace logger;
     { "DEFAULT",    LOG_TYPE::LOG_DEFAULT       }
 };
 
-/*static*/const UNORD_LOG_TYPE_MAP Logger::m_EnumToStringMap =
-{
-    { LOG_TYPE::LOG_ERR,        "ERR"           },
-    { LOG_TYPE::LOG_INFO,       "INF"           },
-    { LOG_TYPE::LOG_WARN,       "WARN"          },
-    { LOG_TYPE::LOG_DBG,        "DBG"           },
-    { LOG_TYPE::LOG_FATAL,      "FATAL"         },
-    { LOG_TYPE::LOG_IMP,        "IMP"           },
-    { LOG_TYPE::LOG_ASSERT,     "ASRT"          },
-    { LOG_TYPE::LOG_DEFAULT,    "DEFAULT"       }
-};
+
+/*static*/std::atomic_bool Logger::m_isDeferredFormatting(false);
 
 /*static*/LOG_TYPE Logger::convertStringToLogTypeEnum(const std::string_view type) noexcept
 {
@@ -47,79 +68,238 @@ using namespace logger;
 
 /*static*/std::string Logger::covertLogTypeEnumToString(const LOG_TYPE& type) noexcept
 {
+    return std::string(logTypeName(type));
+}
 
-    auto itr = m_EnumToStringMap.find(type);
-    if (itr != m_EnumToStringMap.end())
-        return itr->second;
-    else
-        return m_EnumToStringMap.cend()->second;
+/**
+ * @brief What the LoggingOps object of the LOG_* macros is made of, kept for the reloads
+ */
+struct BuiltLoggingOps
+{
+    std::shared_ptr<LoggingOps> m_pOps;
+    // The ones doing the batching, i.e. m_pOps itself or the sinks of the fan out
+    std::vector<std::shared_ptr<LoggingOps>> m_Sinks;
+    std::shared_ptr<FanOutOps> m_pFanOutOps;
+    std::shared_ptr<ConsoleOps> m_pConsoleSink;
+
+    std::mutex m_ReloadMtx;
+    std::filesystem::path m_ConfigFile;
+    std::filesystem::file_time_type m_ConfigWriteTime;
+
+    std::mutex m_WatcherMtx;
+    std::condition_variable m_WatcherCv;
+    std::atomic<int64_t> m_ReloadIntervalSec{0};
+    bool m_isStopping = false;
+    std::thread m_ConfigWatcher;
+
+    ~BuiltLoggingOps()
+    {
+        // Stopped before the rest is gone
+        {
+            std::scoped_lock<std::mutex> watcherLock(m_WatcherMtx);
+            m_isStopping = true;
+        }
+        m_WatcherCv.notify_all();
+        if (m_ConfigWatcher.joinable())
+            m_ConfigWatcher.join();
+    }
+};
+
+static BuiltLoggingOps& builtLoggingOps()
+{
+    static BuiltLoggingOps built;
+    return built;
+}
+
+/**
+ * @brief Keep the modification time of the config file loaded, and start looking
+ * at it for changes if it is asked for. The reload mutex must be held.
+ */
+static void watchConfigFile(BuiltLoggingOps& built, const LogConfig& config)
+{
+    std::error_code ec;
+    built.m_ConfigFile = config.configFile;
+    built.m_ConfigWriteTime = config.configFile.empty() ? std::filesystem::file_time_type() : std::filesystem::last_write_time(config.configFile, ec);
+    {
+        std::scoped_lock<std::mutex> watcherLock(built.m_WatcherMtx);
+        built.m_ReloadIntervalSec.store(config.reloadInterval.count());
+    }
+    built.m_WatcherCv.notify_all();
+    if (config.reloadInterval.count() <= 0 || built.m_ConfigWatcher.joinable())
+        return;
+
+    built.m_ConfigWatcher = std::thread([&built]()
+    {
+        std::unique_lock<std::mutex> watcherLock(built.m_WatcherMtx);
+        while (!built.m_isStopping)
+        {
+            auto interval = std::chrono::seconds(built.m_ReloadIntervalSec.load());
+            if (interval.count() <= 0)
+            {
+                built.m_WatcherCv.wait(watcherLock, [&built]{ return built.m_isStopping || built.m_ReloadIntervalSec.load() > 0; });
+                continue;
+            }
+            // Woken up early for the stop, or for a new interval
+            if (built.m_WatcherCv.wait_for(watcherLock, interval, [&built, interval]
+                {
+                    return built.m_isStopping || built.m_ReloadIntervalSec.load() != interval.count();
+                }))
+            {
+                continue;
+            }
+
+            watcherLock.unlock();
+            auto isChanged = false;
+            {
+                std::scoped_lock<std::mutex> reloadLock(built.m_ReloadMtx);
+                std::error_code ec;
+                auto writeTime = std::filesystem::last_write_time(built.m_ConfigFile, ec);
+                isChanged = !built.m_ConfigFile.empty() && !ec && writeTime != built.m_ConfigWriteTime;
+            }
+            if (isChanged)
+                Logger::reloadConfig();
+            watcherLock.lock();
+        }
+    });
+}
+
+static void addConfigProblems(LoggingOps& ops, const std::vector<std::string>& problems)
+{
+    for (const auto& problem : problems)
+        ops.addRaisedException(std::make_exception_ptr(std::invalid_argument(problem)));
 }
 
 /*static*/ LoggingOps& Logger::buildLoggingOpsObject() noexcept
 {
-    static std::unique_ptr<LoggingOps> pLoggingOps;
-    static auto initialize = true;  // First time TRUE and then always FALSE
-    while (initialize)
+    auto& built = builtLoggingOps();
+    static std::once_flag buildOnce;
+    std::call_once(buildOnce, [&built]()
     {
-#if defined(FILE_LOGGING) // Is it going to be a file logging ops?
-        std::ostringstream parser;
-        uintmax_t fileSize = 1024 * 1000;   // Default max log file size is 1 MB
-        std::string fileName;
-        std::string fileExtn;
-        std::string filePath;
-#ifdef LOG_FILE_NAME
-        parser << LOG_FILE_NAME;
-        fileName = parser.str();
-        // Break out then and there if file logging is requested
-        // but none provided. We are not assuming
-        // any log file name on our own in any case
-        if (fileName.empty())
-            break;
-#endif  // LOG_FILE_NAME
-#ifdef FILE_SIZE    // Is the max log file size provided?
-        fileSize = FILE_SIZE;
-#endif // FILE_SIZE
-#ifdef LOG_FILE_EXTN    // IS there a separate file extn also available from user?
-        std::ostringstream().swap(parser);
-        parser << LOG_FILE_EXTN;
-        fileExtn = parser.str();
-#endif  // LOG_FILE_EXTN
-#ifdef LOG_FILE_PATH
-        std::ostringstream().swap(parser);
-        parser << LOG_FILE_PATH;
-        filePath = parser.str();
-        std::filesystem::path path(filePath);
-        if (!std::filesystem::exists(path) && std::filesystem::is_directory(path))
-            break;  // Invalid file path not allowed
-#endif // LOG_FILE_PATH
-        pLoggingOps.reset(new FileOps(fileSize, fileName, filePath, fileExtn));
-#else   // Plain console logging it is
-        pLoggingOps.reset(new ConsoleOps());
-#endif  // FILE_LOGGING
-        initialize = false; // By this time initialization is completed
+        std::scoped_lock<std::mutex> reloadLock(built.m_ReloadMtx);
+        std::vector<std::string> problems;
+        auto config = LogConfig::load(problems);
+
+        std::shared_ptr<FileOps> pFileOps;
+        if (config.fileLogging)
+        {
+            // We are not assuming any log file name on our own in any case,
+            // nor creating a log file path which is not there
+            if (config.fileName.empty())
+                problems.push_back("File logging requested without a log file name, logging to the console");
+            else if (!config.filePath.empty() && !std::filesystem::is_directory(config.filePath))
+                problems.push_back(std::format("The log file path {} is not a directory, logging to the console", config.filePath));
+            else
+                pFileOps = std::make_shared<FileOps>(config.fileSize, config.fileName, config.filePath, config.fileExtn, config.ringCapacity);
+        }
+
+        // The encoder goes to the sinks before they are added to FanOutOps, see FanOutOps::addSink()
+        auto pEncoder = RecordEncoder::create(config.recordEncoding);
+        if (pFileOps)
+        {
+            pFileOps->setRecordEncoder(pEncoder);
+            if (config.rotationInterval.count() > 0)
+                pFileOps->setRotationInterval(config.rotationInterval);
+            if (config.retentionPolicy.maxFiles || config.retentionPolicy.maxTotalBytes)
+                pFileOps->setRetentionPolicy(config.retentionPolicy);
+        }
+
+        if (pFileOps && config.consoleLogLevel)    // Are the more severe ones to be on the console as well?
+        {
+            built.m_pFanOutOps = std::make_shared<FanOutOps>();
+            built.m_pConsoleSink = std::make_shared<ConsoleOps>(config.ringCapacity);
+            built.m_pConsoleSink->setRecordEncoder(pEncoder);
+            // The console must not hold back the file, it drops instead
+            built.m_pConsoleSink->setOverflowPolicy(OverflowPolicy::DROP_NEWEST);
+            built.m_pFanOutOps->addSink(pFileOps, LOG_TYPE::LOG_DBG)
+                               .addSink(built.m_pConsoleSink, *config.consoleLogLevel);
+            built.m_pOps = built.m_pFanOutOps;
+            built.m_Sinks = {pFileOps, built.m_pConsoleSink};
+        }
+        else if (pFileOps)
+        {
+            built.m_pOps = pFileOps;
+            built.m_Sinks = {pFileOps};
+        }
+        else    // Plain console logging it is
+        {
+            built.m_pOps = std::make_shared<ConsoleOps>(config.ringCapacity);
+            built.m_pOps->setRecordEncoder(pEncoder);
+            built.m_Sinks = {built.m_pOps};
+        }
+
+        if (config.networkSink)     // Shipped to a collector as well, along with the rest
+        {
+            auto pNetworkOps = std::make_shared<NetworkOps>(config.networkSink->host, config.networkSink->port,
+                                                            config.networkSink->protocol, config.ringCapacity);
+            pNetworkOps->setRecordEncoder(pEncoder);
+            // The network must not hold back the local sinks, it drops instead
+            pNetworkOps->setOverflowPolicy(OverflowPolicy::DROP_NEWEST);
+            if (!built.m_pFanOutOps)
+            {
+                built.m_pFanOutOps = std::make_shared<FanOutOps>();
+                built.m_pFanOutOps->addSink(built.m_pOps, LOG_TYPE::LOG_DBG);
+                built.m_pOps = built.m_pFanOutOps;
+            }
+            built.m_pFanOutOps->addSink(pNetworkOps, LOG_TYPE::LOG_DBG);
+            built.m_Sinks.push_back(pNetworkOps);
+        }
+
+        for (const auto& pSink : built.m_Sinks)
+        {
+            if (config.stagingMode != StagingMode::SHARED)
+                pSink->setStagingMode(config.stagingMode);
+            if (config.writerCpu && !pSink->setWriterAffinity(*config.writerCpu))
+                problems.push_back(std::format("Couldn't pin the writer thread of {} to CPU {}", pSink->getClassId(), *config.writerCpu));
+            config.applyReloadable(*pSink);
+        }
+        addConfigProblems(*built.m_pOps, problems);
+        watchConfigFile(built, config);
+    });
+    return *built.m_pOps;
+}
+
+/*static*/ bool Logger::reloadConfig() noexcept
+{
+    auto& ops = buildLoggingOpsObject();
+    auto& built = builtLoggingOps();
+    std::vector<std::string> problems;
+    try
+    {
+        std::scoped_lock<std::mutex> reloadLock(built.m_ReloadMtx);
+        auto config = LogConfig::load(problems);
+        for (const auto& pSink : built.m_Sinks)
+            config.applyReloadable(*pSink);
+        if (built.m_pConsoleSink && config.consoleLogLevel)
+            built.m_pFanOutOps->setSinkLevel(built.m_pConsoleSink, *config.consoleLogLevel);
+        watchConfigFile(built, config);
     }
-    return *pLoggingOps;
+    catch (...)
+    {
+        ops.addRaisedException(std::current_exception());
+        return false;
+    }
+    addConfigProblems(ops, problems);
+    return problems.empty();
 }
 
 Logger::Logger(const std::string_view timeFormat)
     : m_threadID()
     , m_clock(timeFormat)
     , m_lineNo(0)
-{}
-
-Logger& Logger::setFileName(const std::string_view val) noexcept
 {
-    if (!val.empty())
-        m_fileName = val.data();
-
-    return *this;
+    m_logRecord.reserve(initialRecordCapacity);
 }
 
-Logger& Logger::setFunctionName(const std::string_view val) noexcept
+Logger& Logger::setCallSite(const CallSite& site) noexcept
 {
-    if (!val.empty())
-        m_funcName = val.data();
-
+    m_pCallSite = &site;
+    m_fileName = site.fileName();
+    m_className = site.className();
+    m_funcName = site.functionName();
+    m_isLambda = site.isLambda();
+    m_lineNo = site.line();
+    m_logType = site.type();
+    m_logMarker = site.marker();
     return *this;
 }
 
@@ -162,46 +342,29 @@ Logger& Logger::setAssertCondition(const std::string_view cond) noexcept
 
 void Logger::populatePrerequisitFileds()
 {
-    // Clear the log stream before populating it with new log message
-    std::stringstream().swap(m_logStream);
+    // Clear the log record before populating it with new log message,
+    // the buffer keeps its memory
+    m_logRecord.clear();
     constructLogMsgPrefix();
-    std::string funcName;
-    std::string className;
-    /* if (std::string::npos != m_funcName.find(":"))
-    {
-        className = m_funcName.substr(0, (m_funcName.find_first_of(":") - 1));
-        funcName = m_funcName.substr(m_funcName.find_first_of(":") + 2);
-    }
-    else
-    {
-        funcName = m_funcName;
-    }
-    funcName = funcName.substr(0, funcName.find_first_of("(")); */
-
-    extractClassAndFuncName(className, funcName);
-
-    m_logStream << LEFT_SQUARE_BRACE
-                << className
-                << ONE_SPACE
-                << COLONE_SEP
-                << ONE_SPACE
-                << funcName
-                << RIGHT_SQUARE_BRACE
-                << ONE_SPACE;
+    m_logRecord.append(LEFT_SQUARE_BRACE)
+               .append(m_className)
+               .append(ONE_SPACE)
+               .append(COLONE_SEP)
+               .append(ONE_SPACE)
+               .append(m_funcName);
+    if (m_isLambda)
+        m_logRecord.append("::<lambda>");
+    m_logRecord.append(RIGHT_SQUARE_BRACE)
+               .append(ONE_SPACE);
 
     // Check if the log message is due to an assertion failure. If so,
     // then log the condition details along with file and line no details
     if (!m_assertCond.empty())
     {
-        auto assertionCond = m_assertCond;
+        std::format_to(std::back_inserter(m_logRecord),
+                       "ASSERTION FAILURE in {} at LN:{}, for [CONDITION: {}] evaluating to FALSE. ",
+                       m_fileName, m_lineNo, m_assertCond);
         m_assertCond.clear(); // Clear the condition for next log msg
-        m_logStream << "ASSERTION FAILURE in "
-                    << m_fileName
-                    << " at LN:"
-                    << m_lineNo
-                    << ", for [CONDITION: "
-                    << assertionCond << "]"
-                    << " evaluating to FALSE. ";
     }
 }
 
@@ -213,146 +376,41 @@ void Logger::constructLogMsgPrefix()
 
 void Logger::constructLogMsgPrefixFirstPart()
 {
-    m_logStream << FIELD_SEPARATOR << m_clock.getLocalTimeStr();
-    m_logStream << FIELD_SEPARATOR << ONE_SPACE;
+    std::array<char, 96> timeStr;
+    auto len = m_clock.formatLocalTime(m_timeStamp, timeStr.data(), timeStr.size());
+    m_logRecord.append(FIELD_SEPARATOR)
+               .append(timeStr.data(), len)
+               .append(FIELD_SEPARATOR)
+               .append(ONE_SPACE);
 }
 
 void Logger::constructLogMsgPrefixSecondPart()
 {
-    m_logStream << std::right
-                << std::setw(10) //Assuming a thread ID in decimal can be of max 10 digits
-                << m_threadID
-                << FIELD_SEPARATOR
-                << ONE_SPACE;
-
-    m_logStream << std::left
-                << std::setw(20) // Assuming a file name consists max 20 char
-                << m_fileName 
-                << FIELD_SEPARATOR
-                << ONE_SPACE;
-
-    m_logStream << std::right
-                << std::setw(4)     //Assuming a file may contain max 9,999 no of lines
-                << m_lineNo
-                << FIELD_SEPARATOR
-                << std::right
-                << covertLogTypeEnumToString(m_logType)
-                << m_logMarker
-                << std::left;
+    // Assuming a thread ID in decimal can be of max 10 digits, a file name
+    // consists max 20 char and a file may contain max 9,999 no of lines
+    auto logType = logTypeName(m_logType);
+    std::format_to(std::back_inserter(m_logRecord), "{:>10}| {:<20}| {:>4}|{}{}",
+                   threadIdStr(m_threadID), m_fileName, m_lineNo, logType, m_logMarker);
 
     // Beutify the pre requisits fields by aligning them properly (optional)
-    auto maxLogTypeSize = covertLogTypeEnumToString(LOG_TYPE::LOG_ASSERT).size();
-    auto currLogTypeSize = covertLogTypeEnumToString(m_logType).size();
-    auto currMarkerSize = m_logMarker.size();
-    while ((currLogTypeSize + currMarkerSize) < (maxLogTypeSize + 1))
-    {
-        m_logStream << ONE_SPACE;
-        ++currMarkerSize;
-    }
-    m_logStream << ONE_SPACE;   // Last space before next part begins
+    auto maxLogTypeSize = logTypeName(LOG_TYPE::LOG_ASSERT).size();
+    auto currSize = logType.size() + m_logMarker.size();
+    if (currSize < (maxLogTypeSize + 1))
+        m_logRecord.append(maxLogTypeSize + 1 - currSize, ONE_SPACE.front());
+    m_logRecord.append(ONE_SPACE);   // Last space before next part begins
 }
 
 void Logger::vlog(const std::string_view formatStr, std::format_args args)
 {
+    m_timeStamp = std::chrono::system_clock::now();
     populatePrerequisitFileds();
-    auto logMsg = std::vformat(formatStr, args);
-    // Remove any "\"" from the formed string, might have been left, due to
-    // MACRO expression expansion
-    if (logMsg.find(DOUBLE_QUOTES) != std::string::npos)
-    {
-        logMsg = logMsg.substr(logMsg.find_first_of(DOUBLE_QUOTES) + 1, 
-                    logMsg.find_last_of(DOUBLE_QUOTES) - 1);
-        // Recheck once again to be sure
-        if (logMsg.find(DOUBLE_QUOTES) != std::string::npos)
-            logMsg = logMsg.substr(logMsg.find_first_of(DOUBLE_QUOTES) + 1, 
-                    logMsg.find_last_of(DOUBLE_QUOTES) - 1);
-    }
-    m_logStream << logMsg;
+    // The stringified format strings (LOG_ENTRY/LOG_EXIT) come with quotes
+    std::vformat_to(std::back_inserter(m_logRecord), stripQuotes(formatStr), args);
 }
 
-void Logger::extractClassAndFuncName(std::string& className, std::string& funcName) noexcept
+void Logger::logFormatted(const std::chrono::system_clock::time_point& timeStamp, const std::string_view msg)
 {
-    className.clear();
-    funcName.clear();
-    if (m_funcName.empty())
-        return;
-
-    /**
-     * @brief m_funcName, if it is in the format "ClassName::FunctionName"
-     * If it is not in that format, then just use the function name
-     * as it is, without any class name.
-     * This is useful for logging purposes, to identify which class
-     * and function the log message is coming from.
-     * For example, if the function name is "Logger::log", then
-     * the class name will be "Logger" and the function name will be "log".
-     * If the function name is "log", then the class name will be empty
-     * and the function name will be "log".
-     * If the function name is "Logger::log()", then the class name will be "Logger"
-     * and the function name will be "log".
-     * If the function name is "Logger::log(const std::string&)", then the
-     * class name will be "Logger" and the function name will be "log".
-     * 
-     * In case of lamda functions on clang/gcc
-     * the pretty function name comes as
-     * "auto LoggerTest_testDiffFuncSignatures_Test::TestBody()::(anonymous class)::operator()"
-     * In this case the targeted aim is class : operator()
-     */
-    static const std::string scopeOptr = "::";
-    static const std::string whiteSpace = " ";
-
-    funcName = m_funcName.substr(0, m_funcName.rfind("("));
-    auto scopeOptrPos = funcName.find_last_of("::");
-    if (std::string::npos != scopeOptrPos)
-    {
-        className = funcName.substr(0, (scopeOptrPos - 1));
-        funcName = funcName.substr(scopeOptrPos + 1);
-
-        //Now remove any preceeding scope resolution operator
-        //it may have.
-        scopeOptrPos = className.rfind(scopeOptr);
-        if (std::string::npos != scopeOptrPos)
-        {
-            className = className.substr((scopeOptrPos + 2)); //+2 because we have two ":"
-        }
-
-        // Now look for any special chars in class name and remove them
-        std::regex specials("[{(<&*#->:;>)}]");
-        if (std::regex_search(className, specials)) //It has special characters
-        {
-            std::string specials = "[{(<&*#->:;>)}]";
-            auto trimFrmlead = true;
-            //Keep looping till each of them trimmed
-            while (className.find_first_of(specials) != std::string::npos)
-            {
-                if (trimFrmlead)    //If there are leading special chars
-                {
-                    className = className.substr(className.find_first_of(specials) + 1);
-                    auto nextSpecial = className.find_first_of(specials);
-                    if (nextSpecial != std::string::npos)
-                        trimFrmlead = false;
-                }
-                else    // Special chars are at trailing positions
-                {
-                    className = className.substr(0, className.find_last_not_of(specials) + 1);
-                }
-            }
-            //Finally remove any leading white space it may have
-            auto whiteSpacePos = className.find_last_of(whiteSpace);
-            while (std::string::npos != whiteSpacePos)
-            {
-                className = className.substr(whiteSpacePos + 1);
-                whiteSpacePos = className.find_last_of(whiteSpace);
-            }
-        }
-        else    //Otherwise remove any leading white space
-        {
-            auto whiteSpacePos = className.find_last_of(whiteSpace);
-            while (std::string::npos != whiteSpacePos)
-            {
-                className = className.substr(whiteSpacePos + 1);
-                whiteSpacePos = className.find_last_of(whiteSpace);
-            }
-        }
-    }
+    m_timeStamp = timeStamp;
+    populatePrerequisitFileds();
+    m_logRecord.append(msg);
 }
-
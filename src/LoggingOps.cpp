@@ -27,17 +27,299 @@
  */
 
 #include "LoggingOps.hpp"
+#include "Logger.hpp"
+#include "DeferredRecord.hpp"
+#include "RecordEncoder.hpp"
+#include "RateLimiter.hpp"
 #include "Clock.hpp"
 
+#include <array>
+#include <cerrno>
+#include <charconv>
 #include <sstream>
-#include <bitset>
+#include <cstring>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+
 using namespace logger;
 
 static std::mutex m_excpFileMtx;
 
+/**
+ * @brief Get the slot of the calling thread, the threads get theirs round robin
+ * the first time they ask for it
+ */
+static size_t threadSlot() noexcept
+{
+    static std::atomic<size_t> nextSlot(0);
+    thread_local size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+// Beyond any machine there is, just to keep a broken CPU list from taking all of the memory
+static constexpr size_t maxCpusCnt = 4096;
+
+/**
+ * @brief Parse a CPU list of the sysfs, e.g. 0-3,8-11, into the node of every CPU
+ */
+static void parseCpuList(const std::string_view cpuList, const uint16_t node, std::vector<uint16_t>& cpuNodes)
+{
+    auto rest = cpuList;
+    while (!rest.empty())
+    {
+        auto range = rest.substr(0, rest.find(','));
+        rest.remove_prefix(std::min(rest.size(), range.size() + 1));
+        size_t first = 0;
+        auto [pEnd, ec] = std::from_chars(range.data(), range.data() + range.size(), first);
+        if (ec != std::errc())
+            continue;
+        size_t last = first;
+        if (pEnd != range.data() + range.size() && *pEnd == '-' &&
+            std::from_chars(pEnd + 1, range.data() + range.size(), last).ec != std::errc())
+        {
+            continue;
+        }
+        for (auto cpu = first; cpu <= last && cpu < maxCpusCnt; ++cpu)
+        {
+            if (cpuNodes.size() <= cpu)
+                cpuNodes.resize(cpu + 1, 0);
+            cpuNodes[cpu] = node;
+        }
+    }
+}
+
+/**
+ * @brief Get the NUMA node of every CPU, as the sysfs tells it. It is read once,
+ * and it is empty where there is no sysfs (i.e. every CPU is on node 0).
+ */
+static const std::vector<uint16_t>& cpuNodes()
+{
+    static const std::vector<uint16_t> nodes = []()
+    {
+        std::vector<uint16_t> cpuNodes;
+        std::error_code errCode;
+        std::filesystem::directory_iterator itr("/sys/devices/system/node", errCode);
+        for (; !errCode && itr != std::filesystem::directory_iterator(); itr.increment(errCode))
+        {
+            auto name = itr->path().filename().string();
+            if (!name.starts_with("node"))
+                continue;
+            uint16_t node = 0;
+            auto [pEnd, ec] = std::from_chars(name.data() + 4, name.data() + name.size(), node);
+            if (ec != std::errc() || pEnd != name.data() + name.size())
+                continue;
+            std::ifstream cpuListFile(itr->path() / "cpulist");
+            std::string cpuList;
+            if (std::getline(cpuListFile, cpuList))
+                parseCpuList(cpuList, node, cpuNodes);
+        }
+        return cpuNodes;
+    }();
+    return nodes;
+}
+
+/**
+ * @brief Get the staging ring key of the calling thread, i.e. its CPU or its node
+ */
+static size_t stagingKey(const StagingMode mode)
+{
+#if defined(__linux__)
+    if (auto cpu = ::sched_getcpu(); cpu >= 0)
+    {
+        if (StagingMode::PER_CPU == mode)
+            return static_cast<size_t>(cpu);
+        const auto& nodes = cpuNodes();
+        return static_cast<size_t>(cpu) < nodes.size() ? nodes[static_cast<size_t>(cpu)] : 0;
+    }
+#endif
+    // The CPU is not known, so the threads are spread round robin instead
+    return (StagingMode::PER_CPU == mode) ? threadSlot() : 0;
+}
+
+// The bits and the hex digits of every byte value, so that a value is rendered a byte at a time
+static constexpr auto bitsTable = []()
+{
+    std::array<std::array<char, 8>, 256> table{};
+    for (size_t val = 0; val < table.size(); ++val)
+    {
+        for (size_t bit = 0; bit < 8; ++bit)
+            table[val][bit] = (val & (0x80u >> bit)) ? '1' : '0';
+    }
+    return table;
+}();
+
+static constexpr auto hexTable = []()
+{
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::array<std::array<char, 2>, 256> table{};
+    for (size_t val = 0; val < table.size(); ++val)
+        table[val] = { digits[val >> 4], digits[val & 0x0F] };
+    return table;
+}();
+
+/**
+ * @brief Render a value into its bits or hex digits, the most significant first
+ *
+ * @param [in] data The value
+ * @param [out] pOut Where it is rendered to, 8 (bits) or 2 (hex) chars per byte
+ * @return char* The end of the rendered value
+ */
+template<typename DataType>
+static char* renderValue(const DataType data, const bool isHex, char* pOut) noexcept
+{
+    for (int shift = static_cast<int>(sizeof(DataType) * 8) - 8; shift >= 0; shift -= 8)
+    {
+        auto byte = static_cast<size_t>((data >> shift) & 0xFF);
+        if (isHex)
+            pOut = std::copy(hexTable[byte].begin(), hexTable[byte].end(), pOut);
+        else
+            pOut = std::copy(bitsTable[byte].begin(), bitsTable[byte].end(), pOut);
+    }
+    return pOut;
+}
+
+/**
+ * @brief Render a binary data stream into records of whole lines
+ *
+ * @param [in] binaryStream The binary data stream
+ * @param [in] encoding BITS or HEX
+ * @param [in] emit Called for every record rendered
+ */
+template<typename DataType, typename Emit>
+static void renderBinaryStream(const std::vector<DataType>& binaryStream, const BinaryEncoding encoding, Emit&& emit)
+{
+    const auto isHex = (BinaryEncoding::HEX == encoding);
+    const size_t valueSize = sizeof(DataType) * (isHex ? 2 : 8);
+    const size_t valuesPerLine = isHex ? std::max<size_t>(32 / sizeof(DataType), 1) : 1;
+
+    thread_local std::string record;
+    record.clear();
+    record.reserve(std::min(LoggingOps::maxBinaryRecordSize, binaryStream.size() * (valueSize + 1)));
+    for (size_t first = 0; first < binaryStream.size(); first += valuesPerLine)
+    {
+        auto valuesCnt = std::min(valuesPerLine, binaryStream.size() - first);
+        auto lineSize = valuesCnt * (valueSize + 1) - 1;
+        if (!record.empty() && record.size() + 1 + lineSize > LoggingOps::maxBinaryRecordSize)
+        {
+            emit(std::string_view(record));
+            record.clear();
+        }
+        auto pos = record.size();
+        record.resize(pos + (pos ? 1 : 0) + lineSize);
+        auto pOut = record.data() + pos;
+        if (pos)
+            *pOut++ = '\n';
+        for (size_t idx = first; idx < first + valuesCnt; ++idx)
+        {
+            if (idx != first)
+                *pOut++ = ' ';
+            pOut = renderValue(binaryStream[idx], isHex, pOut);
+        }
+    }
+    if (!record.empty())
+        emit(std::string_view(record));
+}
+
+/**
+ * @brief The kind of the records the calling thread is pushing. The write
+ * functions set it around writeDataTo(), so the derived classes stay unaware of it.
+ */
+static thread_local RecordKind pushRecordKind = RecordKind::TEXT;
+
+/**
+ * @brief The log type of the text record the calling thread is pushing,
+ * set by write(data, type) the same way.
+ */
+static thread_local LOG_TYPE pushRecordType = LOG_TYPE::LOG_DEFAULT;
+
+/**
+ * @brief Set the kind and the log type of the record being pushed for the
+ * scope, and restore the ones before. A sink of a FanOutOps is written to
+ * while the record of the FanOutOps itself is still being pushed.
+ */
+class PushedRecordScope
+{
+    public:
+        PushedRecordScope(const RecordKind kind, const LOG_TYPE type) noexcept
+            : m_PrevKind(pushRecordKind)
+            , m_PrevType(pushRecordType)
+        {
+            pushRecordKind = kind;
+            pushRecordType = type;
+        }
+
+        ~PushedRecordScope()
+        {
+            pushRecordKind = m_PrevKind;
+            pushRecordType = m_PrevType;
+        }
+
+        PushedRecordScope(const PushedRecordScope& rhs) = delete;
+        PushedRecordScope& operator=(const PushedRecordScope& rhs) = delete;
+
+    private:
+        RecordKind m_PrevKind;
+        LOG_TYPE m_PrevType;
+};
+
+/**
+ * @brief Format the deferred records of a batch, if there are any
+ *
+ * @param [in] dataArena The batch drained from the ring
+ * @param [out] renderedArena The arena the formatted batch is built in
+ * @return const RecordArena& The batch to be written, dataArena itself
+ *         if none of its records is deferred
+ */
+static const RecordArena& renderDeferredRecords(const RecordArena& dataArena, RecordArena& renderedArena)
+{
+    auto itr = dataArena.begin();
+    while (itr != dataArena.end() && RecordKind::TEXT == itr.kind())
+        ++itr;
+    if (itr == dataArena.end())
+        return dataArena;
+
+    thread_local std::string line;
+    renderedArena.clear();
+    for (itr = dataArena.begin(); itr != dataArena.end(); ++itr)
+    {
+        if (RecordKind::DEFERRED == itr.kind())
+        {
+            DeferredRecord::render(*itr, line);
+            renderedArena.append(line);
+        }
+        else
+        {
+            renderedArena.append(*itr);
+        }
+    }
+    return renderedArena;
+}
+
+/**
+ * @brief Encode the records of a batch with a record encoder
+ *
+ * @param [in] dataArena The batch drained from the ring
+ * @param [out] encodedArena The arena the encoded batch is built in
+ * @param [in] encoder The record encoder
+ * @return const RecordArena& The encoded batch
+ */
+static const RecordArena& encodeRecords(const RecordArena& dataArena, RecordArena& encodedArena, const RecordEncoder& encoder)
+{
+    thread_local std::string line;
+    encodedArena.clear();
+    for (auto itr = dataArena.begin(); itr != dataArena.end(); ++itr)
+    {
+        encoder.encode(*itr, itr.kind(), line);
+        encodedArena.append(line);
+    }
+    return encodedArena;
+}
+
 /*friend*/ void logger::operator<<(LoggingOps& obj, const std::ostringstream& oss)
 {
     if (oss.good())
@@ -68,29 +350,79 @@ static std::mutex m_excpFileMtx;
         obj.write(dataList);
 }
 
-LoggingOps::LoggingOps()
-    : m_DataRecords()
+LoggingOps::LoggingOps(const size_t ringCapacity, const OverflowPolicy policy)
+    : m_DataRecords(ringCapacity, policy)
+    , m_StagingMode(StagingMode::SHARED)
+    , m_StagingRingCapacity(defaultStagingRingCapacity)
+    , m_Rings()
+    , m_StagingRings()
+    , m_RingsCnt(1)
     , m_dataReady(false)
     , m_shutAndExit(false)
+    , m_BatchMaxRecords(BatchPolicy().maxRecords)
+    , m_BatchMaxBytes(BatchPolicy().maxBytes)
+    , m_BatchMaxLingerUs(BatchPolicy().maxLinger.count())
+    , m_isWatcherIdle(false)
+    , m_keepsDeferredRecords(false)
+    , m_RecordEncoderMtx()
+    , m_pRecordEncoder()
+    , m_hasRecordEncoder(false)
+    , m_isWatcherStopped(false)
+    , m_RingsProgress()
     , m_excpPtrVec(0)
+    , m_ProducerCounters()
+    , m_WrittenRecords(0)
+    , m_WrittenBytes(0)
+    , m_BatchesCnt(0)
+    , m_WriterBusyNs(0)
+    , m_HighWaterBytes(0)
+    , m_RotationsCnt(0)
+    , m_StatsIntervalSec(0)
+    , m_LastStatsTime(std::chrono::steady_clock::now())
+    , m_ExcpMtx()
+    , m_ExceptionsCnt(0)
 {
+    m_Rings[0].store(&m_DataRecords);
 }
 
 /*virtual*/LoggingOps::~LoggingOps()
 {
-    // Wait for any ongoing data operations to finish
-    std::unique_lock<std::mutex> dataLock(m_DataRecordsMtx);
-    // Set the flag to true to indicate that we are shutting down
-    m_shutAndExit = true;
+    // The derived classes are supposed to stop the watcher
+    // thread already, it is just to be on the safe side
+    stopWatcher();
+
+    collectAndPrintExceptions();
+}
+
+void LoggingOps::stopWatcher()
+{
+    {
+        // Wait for any ongoing data operations to finish
+        std::scoped_lock<std::mutex> dataLock(m_DataRecordsMtx);
+        // Set the flag to true to indicate that we are shutting down
+        m_shutAndExit = true;
+    }
     // Notify the watcher thread to wake up and complete
     // any pending operations before exiting
-    dataLock.unlock();
     m_DataRecordsCv.notify_one();
 
     if (m_watcher.joinable())
         m_watcher.join();
+}
 
-    collectAndPrintExceptions();
+void LoggingOps::notifyWatcher()
+{
+    // Only the first producer after the watcher went to sleep
+    // gets here with m_dataReady false. The lock is taken just to
+    // order the flag with the wait of the watcher, so that the
+    // notification can not get lost in between.
+    if (!m_dataReady.exchange(true))
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_DataRecordsMtx);
+        }
+        m_DataRecordsCv.notify_one();
+    }
 }
 
 void LoggingOps::push(const std::string_view data)
@@ -98,108 +430,508 @@ void LoggingOps::push(const std::string_view data)
     if (data.empty())
         return;
 
-    auto push = [this](std::array<char, bufferSize>& dataRecord, const std::string_view data)
+    // If the ring is full and the policy is to block
+    // then make sure the watcher thread is awake to free it up.
+    // The clock is only read once the producer has to wait.
+    std::chrono::steady_clock::time_point blockedSince;
+    auto backoff = [this, &blockedSince]()
     {
-        std::copy(data.begin(), data.end(), dataRecord.begin());
-        if (data.size() < dataRecord.size())
-        {
-            auto dataSize = data.size();
-            std::fill(dataRecord.begin() + dataSize, dataRecord.end(), '\0');
-        }
-        m_DataRecords.push(dataRecord);
+        if (blockedSince == std::chrono::steady_clock::time_point())
+            blockedSince = std::chrono::steady_clock::now();
+        notifyWatcher();
+        std::this_thread::yield();
     };
-    
+
+    auto remaining = data;
+    auto kind = pushRecordKind;
+    auto& ring = stagingRing();
+    const auto maxRecordSize = ring.maxRecordSize();
+    std::string line;
+    if (RecordKind::DEFERRED == kind && remaining.size() > maxRecordSize)
     {
-        std::array<char, bufferSize> dataRecord; // One extra byte for null termination
-        std::scoped_lock<std::mutex> lock(m_DataRecordsMtx);
-        if (data.size() > dataRecord.size())
-        {
-            std::string dataCopy = data.data();
-            while (dataCopy.size() > dataRecord.size()) // Split the data into 1024 byte chunks
-            {
-                push(dataRecord, dataCopy.substr(0, dataRecord.size() - 1));
-                dataRecord.fill('\0');
-                dataCopy = dataCopy.substr(dataRecord.size());
-            }
-            if (!dataCopy.empty())
-            {
-                push(dataRecord, dataCopy);
-            }
-        }
-        else
+        // A deferred record can't be split, so it is formatted right away
+        DeferredRecord::render(remaining, line);
+        remaining = line;
+        kind = RecordKind::TEXT;
+    }
+    auto& counters = producerCounters();
+    uint64_t pushedCnt = 0;
+    uint64_t pushedBytes = 0;
+    while (remaining.size() > maxRecordSize)
+    {
+        if (ring.push(remaining.substr(0, maxRecordSize), backoff))
         {
-            push(dataRecord, data);
+            ++pushedCnt;
+            pushedBytes += maxRecordSize;
         }
+        remaining.remove_prefix(maxRecordSize);
+    }
+    if (ring.push(remaining, backoff, kind))
+    {
+        ++pushedCnt;
+        pushedBytes += remaining.size();
+    }
+    counters.m_PushedRecords.fetch_add(pushedCnt, std::memory_order_relaxed);
+    counters.m_PushedBytes.fetch_add(pushedBytes, std::memory_order_relaxed);
+    if (blockedSince != std::chrono::steady_clock::time_point())
+    {
+        auto blockedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - blockedSince);
+        counters.m_BlockedNs.fetch_add(static_cast<uint64_t>(blockedNs.count()), std::memory_order_relaxed);
     }
-    // If the data queue contains at least 256 elements
+
+    // If the ring is filled up to any of the batch limits
     // then notify the watcher thread that data is available
     // and it can start writing to the outstream object
-    if (m_DataRecords.size() == 256)
+    if (ring.pendingRecords() >= m_BatchMaxRecords.load(std::memory_order_relaxed) ||
+        ring.pendingBytes() >= m_BatchMaxBytes.load(std::memory_order_relaxed))
     {
-        m_dataReady = true;
+        notifyWatcher();
+    }
+    // If the watcher thread went to sleep on an empty ring then wake it
+    // up, so that it starts counting the linger time for this record
+    else if (m_isWatcherIdle.load(std::memory_order_seq_cst) && m_isWatcherIdle.exchange(false))
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_DataRecordsMtx);
+        }
         m_DataRecordsCv.notify_one();
     }
 }
 
-bool LoggingOps::pop(BufferQ& data)
+void LoggingOps::setBatchPolicy(const BatchPolicy& policy) noexcept
+{
+    m_BatchMaxRecords.store(std::max<size_t>(policy.maxRecords, 1), std::memory_order_relaxed);
+    m_BatchMaxBytes.store(std::max<size_t>(policy.maxBytes, 1), std::memory_order_relaxed);
+    m_BatchMaxLingerUs.store(std::max<int64_t>(policy.maxLinger.count(), 0), std::memory_order_relaxed);
+}
+
+RecordRing& LoggingOps::stagingRing()
+{
+    auto mode = m_StagingMode.load(std::memory_order_relaxed);
+    if (StagingMode::SHARED == mode) [[likely]]
+        return m_DataRecords;
+
+    auto idx = 1 + stagingKey(mode) % maxStagingRings;
+    auto pRing = m_Rings[idx].load(std::memory_order_acquire);
+    if (!pRing) [[unlikely]]
+        pRing = createStagingRing(idx);
+    return *pRing;
+}
+
+RecordRing* LoggingOps::createStagingRing(const size_t idx)
+{
+    // Created (i.e. its memory first touched) by a producer on the CPU or node it is for
+    auto pRing = std::make_unique<RecordRing>(m_StagingRingCapacity.load(std::memory_order_relaxed), m_DataRecords.getPolicy(), true);
+    RecordRing* pExpected = nullptr;
+    if (!m_Rings[idx].compare_exchange_strong(pExpected, pRing.get()))
+        return pExpected;   // Another producer was faster
+
+    m_StagingRings[idx] = std::move(pRing);
+    // The count is raised before the first record is pushed, so the watcher
+    // thread going idle and a flush() after the push both see the ring
+    auto ringsCnt = m_RingsCnt.load();
+    while (ringsCnt <= idx && !m_RingsCnt.compare_exchange_weak(ringsCnt, idx + 1));
+    return m_Rings[idx].load(std::memory_order_relaxed);
+}
+
+bool LoggingOps::areRingsEmpty() const noexcept
+{
+    auto isEmpty = true;
+    forEachRing([&isEmpty](const size_t /*idx*/, const RecordRing& ring){ isEmpty = isEmpty && ring.empty(); });
+    return isEmpty;
+}
+
+void LoggingOps::setStagingMode(const StagingMode mode, const size_t ringCapacity) noexcept
 {
-    if (m_DataRecords.empty())
+    m_StagingRingCapacity.store(ringCapacity, std::memory_order_relaxed);
+    m_StagingMode.store(mode, std::memory_order_relaxed);
+}
+
+size_t LoggingOps::getStagingRingsCount() const noexcept
+{
+    size_t cnt = 0;
+    forEachRing([&cnt](const size_t idx, const RecordRing& /*ring*/){ cnt += (idx > 0); });
+    return cnt;
+}
+
+void LoggingOps::setOverflowPolicy(const OverflowPolicy policy) noexcept
+{
+    forEachRing([policy](const size_t /*idx*/, RecordRing& ring){ ring.setPolicy(policy); });
+}
+
+uint64_t LoggingOps::getDroppedRecordsCount() const noexcept
+{
+    uint64_t cnt = 0;
+    forEachRing([&cnt](const size_t /*idx*/, const RecordRing& ring){ cnt += ring.droppedCount(); });
+    return cnt;
+}
+
+bool LoggingOps::setWriterAffinity(const int cpu) noexcept
+{
+#if defined(__linux__)
+    if (!m_watcher.joinable() || cpu < 0 || cpu >= CPU_SETSIZE)
         return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(static_cast<size_t>(cpu), &cpuSet);
+    return ::pthread_setaffinity_np(m_watcher.native_handle(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    // There is no way to pin a thread, macOS only takes affinity tags as a hint
+    static_cast<void>(cpu);
+    return false;
+#endif
+}
 
+void LoggingOps::setRecordEncoder(std::shared_ptr<const RecordEncoder> encoder)
+{
+    std::scoped_lock<std::mutex> encoderLock(m_RecordEncoderMtx);
+    m_hasRecordEncoder = (nullptr != encoder);
+    m_pRecordEncoder = std::move(encoder);
+}
+
+std::shared_ptr<const RecordEncoder> LoggingOps::getRecordEncoder() const
+{
+    std::scoped_lock<std::mutex> encoderLock(m_RecordEncoderMtx);
+    return m_pRecordEncoder;
+}
+
+BatchPolicy LoggingOps::getBatchPolicy() const noexcept
+{
+    BatchPolicy policy;
+    policy.maxRecords = m_BatchMaxRecords.load(std::memory_order_relaxed);
+    policy.maxBytes = m_BatchMaxBytes.load(std::memory_order_relaxed);
+    policy.maxLinger = std::chrono::microseconds(m_BatchMaxLingerUs.load(std::memory_order_relaxed));
+    return policy;
+}
+
+bool LoggingOps::pop(RecordArena& data)
+{
     // Clear the outgoing data buffer
-    BufferQ().swap(data);
-    data.swap(m_DataRecords);
-    m_dataReady = false;
+    data.clear();
+    // Only the watcher thread drains, so the rings hold the most
+    // they held since the last batch right before draining them
+    size_t pendingBytes = 0;
+    forEachRing([&pendingBytes](const size_t /*idx*/, const RecordRing& ring){ pendingBytes += ring.pendingBytes(); });
+    if (pendingBytes > m_HighWaterBytes.load(std::memory_order_relaxed))
+        m_HighWaterBytes.store(pendingBytes, std::memory_order_relaxed);
+    // The records in the shared ring were pushed before any staging ring
+    // took over, or along with them while switching, so they go first
+    m_DataRecords.drain(data);
+    if (m_RingsCnt.load(std::memory_order_acquire) > 1)
+    {
+        drainStagingRings(data);
+        // Only the records stamped while draining are left, not to be
+        // taken for an empty ring (e.g. while shutting down)
+        if (data.empty() && !areRingsEmpty())
+            drainStagingRings(data);
+    }
+
+    return !data.empty();
+}
+
+void LoggingOps::drainStagingRings(RecordArena& data)
+{
+    struct Cursor
+    {
+        RecordArena::const_iterator m_Itr;
+        RecordArena::const_iterator m_End;
+        const uint64_t* m_pStamp;
+    };
+    // A thread moving to another CPU pushes to another ring. Its record pushed
+    // after the ring of its previous one was drained is stamped after the
+    // drain started, so it waits for the next batch instead of overtaking it
+    const auto maxStamp = RecordRing::stampNow();
+    std::array<Cursor, maxStagingRings> cursors{};
+    size_t cursorsCnt = 0;
+    m_StagedBatches.resize(maxStagingRings + 1);
+    forEachRing([this, &cursors, &cursorsCnt, maxStamp](const size_t idx, RecordRing& ring)
+    {
+        if (idx == 0)
+            return;
+        auto& batch = m_StagedBatches[idx];
+        batch.m_Records.clear();
+        batch.m_Stamps.clear();
+        if (!ring.drain(batch.m_Records, batch.m_Stamps, maxStamp))
+            return;
+        // A producer taken off its CPU right before stamping its record stamps it
+        // late, behind the ones after it in the ring. The ring order is kept as
+        // it is, with the stamps in front of it lowered to the lowest behind them.
+        auto& stamps = batch.m_Stamps;
+        for (auto pos = stamps.size() - 1; pos > 0; --pos)
+            stamps[pos - 1] = std::min(stamps[pos - 1], stamps[pos]);
+        cursors[cursorsCnt++] = {batch.m_Records.begin(), batch.m_Records.end(), stamps.data()};
+    });
 
-    return true;
+    // Few of the rings have records at once, so the merge just looks
+    // for the oldest record among the ones at the front of each of them
+
+    while (cursorsCnt)
+    {
+        size_t oldest = 0;
+        for (size_t idx = 1; idx < cursorsCnt; ++idx)
+        {
+            if (*cursors[idx].m_pStamp < *cursors[oldest].m_pStamp)
+                oldest = idx;
+        }
+        auto& cursor = cursors[oldest];
+        data.append(*cursor.m_Itr, cursor.m_Itr.kind());
+        ++cursor.m_pStamp;
+        if (++cursor.m_Itr == cursor.m_End)
+            cursor = cursors[--cursorsCnt];
+    }
 }
 
 void LoggingOps::keepWatchAndPull()
 {
-    BufferQ dataq;
+    // The arena is reused for all the batches, so once it has grown
+    // to the size of a typical batch, draining doesn't allocate anymore
+    RecordArena dataArena;
+    RecordArena renderedArena;
     // It is an infinite loop, but it will break out of the loop
     // when the m_shutAndExit flag is set to true
     do
     {
         std::unique_lock<std::mutex> dataLock(m_DataRecordsMtx);
-        m_DataRecordsCv.wait(dataLock, [this]{ return m_dataReady || m_shutAndExit.load(); });
-
-        auto success = pop(dataq);
-        dataLock.unlock();
-        m_DataRecordsCv.notify_one();
-        // Spawn a thread to write to the file
-        // and pass the data queue to it so that
-        // the data records queue can be free for
-        // other threads to push data to it
-        // and the file can be written to in parallel
-        // The thread will be joined after the file is written
-        std::thread writerThread;
-        std::exception_ptr excpPtr = nullptr;
-        if (success)
+        auto mustWriteNow = [this]{ return m_dataReady || m_shutAndExit.load() || isFlushPending(); };
+        // Nothing to be written, so sleep without a time out. The flag is set
+        // before looking at the ring once more; a producer either sees it set
+        // and wakes the watcher up, or its record is seen here
+        if (!mustWriteNow())
         {
-            writerThread = std::thread([this, &dataq, &excpPtr](){ writeToOutStreamObject(std::move(dataq), excpPtr); });
+            m_isWatcherIdle.store(true, std::memory_order_seq_cst);
+            if (areRingsEmpty())
+                m_DataRecordsCv.wait(dataLock, [this, &mustWriteNow]{ return mustWriteNow() || !m_isWatcherIdle; });
+            m_isWatcherIdle = false;
         }
-        if (writerThread.joinable())
+        // There are records pending, give them the linger
+        // time to form a batch, unless a limit is hit before
+        m_DataRecordsCv.wait_for(dataLock,
+                                 std::chrono::microseconds(m_BatchMaxLingerUs.load(std::memory_order_relaxed)),
+                                 mustWriteNow);
+        // Reset the flag before draining, so any record pushed
+        // from now on wakes the watcher thread up again
+        m_dataReady = false;
+        bool shutAndExit = m_shutAndExit;
+        dataLock.unlock();
+
+        // The watcher thread writes the batch to the out stream object
+        // itself. While shutting down it keeps on draining till the ring
+        // is empty, so nothing pushed before the shut down gets lost
+        auto written = false;
+        while (pop(dataArena))
         {
+            std::exception_ptr excpPtr = nullptr;
+            auto start = std::chrono::steady_clock::now();
+            auto pEncoder = m_hasRecordEncoder ? getRecordEncoder() : nullptr;
+            if (keepsDeferredRecords())
+                writeToOutStreamObject(dataArena, excpPtr);
+            else if (pEncoder)
+                writeToOutStreamObject(encodeRecords(dataArena, renderedArena, *pEncoder), excpPtr);
+            else
+                writeToOutStreamObject(renderDeferredRecords(dataArena, renderedArena), excpPtr);
+            countBatch(dataArena, std::chrono::steady_clock::now() - start);
             if (excpPtr)
-                m_excpPtrVec.emplace_back(excpPtr);
-            writerThread.join();
+                addRaisedException(excpPtr);
+            written = true;
+
+            if (!shutAndExit)
+                break;
         }
+        // The stats line goes along with the batch, before a flush waiting for it returns
+        if (written)
+            writeStatsLineIfDue(dataArena);
+        // Everything before the read positions of the rings is either
+        // written now or was dropped, either way it is done with
+        markWritten();
 
-        if (m_shutAndExit)
+        // A flush is waiting for a record which is reserved, but not yet
+        // published by its producer. It is a matter of a memcpy, so just
+        // give the producer a chance instead of going to sleep
+        if (!written && isFlushPending())
+            std::this_thread::yield();
+
+        if (shutAndExit)
             break;
     } while (true);
+
+    {
+        std::scoped_lock<std::mutex> flushLock(m_FlushMtx);
+        m_isWatcherStopped = true;
+    }
+    m_FlushCv.notify_all();
+}
+
+void LoggingOps::markWritten()
+{
+    std::unique_lock<std::mutex> flushLock(m_FlushMtx, std::defer_lock);
+    forEachRing([this, &flushLock](const size_t idx, const RecordRing& ring)
+    {
+        auto pos = ring.readPosition();
+        auto& writtenPos = m_RingsProgress[idx].m_WrittenPos;
+        if (pos == writtenPos.load(std::memory_order_relaxed))
+            return;
+        if (!flushLock.owns_lock())
+            flushLock.lock();
+        writtenPos.store(pos, std::memory_order_release);
+    });
+    if (!flushLock.owns_lock())
+        return;
+    flushLock.unlock();
+    m_FlushCv.notify_all();
+}
+
+bool LoggingOps::isFlushPending() const noexcept
+{
+    auto isPending = false;
+    forEachRing([this, &isPending](const size_t idx, const RecordRing& /*ring*/)
+    {
+        const auto& progress = m_RingsProgress[idx];
+        isPending = isPending || progress.m_FlushTarget.load(std::memory_order_acquire) > progress.m_WrittenPos.load(std::memory_order_acquire);
+    });
+    return isPending;
 }
 
-void LoggingOps::flush()
+void LoggingOps::flush(const FlushLevel level)
 {
-    if (!m_DataRecords.empty())
+    // The watcher thread can't wait for itself, e.g. for a LOG_FATAL from within a sink
+    if (std::this_thread::get_id() == m_watcher.get_id())
+        return;
+
+    // Every record pushed before this call has its space reserved
+    // below the current write position of its ring. So those are the
+    // points the watcher thread has to be done with.
+    std::array<uint64_t, maxStagingRings + 1> targets{};
+    forEachRing([&targets](const size_t idx, const RecordRing& ring){ targets[idx] = ring.writePosition(); });
+    auto isReached = [this, &targets](std::atomic<uint64_t> RingProgress::* pDonePos)
+    {
+        for (size_t idx = 0; idx < targets.size(); ++idx)
+        {
+            if ((m_RingsProgress[idx].*pDonePos).load(std::memory_order_acquire) < targets[idx])
+                return false;
+        }
+        return true;
+    };
+    if (isReached((level == FlushLevel::WRITTEN) ? &RingProgress::m_WrittenPos : &RingProgress::m_SyncedPos))
+        return;     // Nothing new since the last flush
+
+    if (!isReached(&RingProgress::m_WrittenPos))
     {
-        m_dataReady = true;
+        // Raise the flush targets (if not already higher) for the watcher thread
+        for (size_t idx = 0; idx < targets.size(); ++idx)
+        {
+            auto& flushTarget = m_RingsProgress[idx].m_FlushTarget;
+            auto currTarget = flushTarget.load(std::memory_order_relaxed);
+            while (currTarget < targets[idx] && !flushTarget.compare_exchange_weak(currTarget, targets[idx], std::memory_order_acq_rel));
+        }
+
+        std::unique_lock<std::mutex> flushLock(m_FlushMtx);
+        // Wake the watcher thread up, unless it is awake already
+        {
+            std::scoped_lock<std::mutex> dataLock(m_DataRecordsMtx);
+        }
         m_DataRecordsCv.notify_one();
-        // Give it sometime to get flashed
-        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        m_FlushCv.wait(flushLock, [this, &isReached]{ return isReached(&RingProgress::m_WrittenPos) || m_isWatcherStopped; });
+    }
+
+    if (level != FlushLevel::WRITTEN)
+    {
+        std::exception_ptr excpPtr = nullptr;
+        syncOutStreamObject(level, excpPtr);
+        if (excpPtr)
+        {
+            addRaisedException(excpPtr);
+            return;
+        }
+        for (size_t idx = 0; idx < targets.size(); ++idx)
+        {
+            auto& syncedPos = m_RingsProgress[idx].m_SyncedPos;
+            auto currSynced = syncedPos.load(std::memory_order_relaxed);
+            while (currSynced < targets[idx] && !syncedPos.compare_exchange_weak(currSynced, targets[idx], std::memory_order_acq_rel));
+        }
+    }
+}
+
+/**
+ * @brief Write all of the data with write(), which is async signal safe
+ *
+ * @param [in] fd The file descriptor
+ * @param [in] data The data
+ */
+static void writeFully(const int fd, std::string_view data) noexcept
+{
+    while (!data.empty())
+    {
+        auto written = ::write(fd, data.data(), data.size());
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return;
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+/*virtual*/ int LoggingOps::emergencyFd() const noexcept
+{
+    return STDERR_FILENO;
+}
+
+/*virtual*/ size_t LoggingOps::emergencyDrain() noexcept
+{
+    const auto fd = emergencyFd();
+    if (fd < 0)
+        return 0;
+
+    auto writeNumber = [fd](const uint64_t num)
+    {
+        std::array<char, 24> digits;
+        auto [pEnd, ec] = std::to_chars(digits.data(), digits.data() + digits.size(), num);
+        writeFully(fd, std::string_view(digits.data(), (ec == std::errc()) ? static_cast<size_t>(pEnd - digits.data()) : 0));
+    };
+    auto writeCallSite = [fd, &writeNumber](const CallSite& site)
+    {
+        writeFully(fd, FIELD_SEPARATOR);
+        writeFully(fd, site.fileName());
+        writeFully(fd, FIELD_SEPARATOR);
+        writeNumber(site.line());
+        writeFully(fd, FIELD_SEPARATOR);
+        writeFully(fd, Logger::logTypeName(site.type()));
+        writeFully(fd, "> ");
+    };
+    auto writeRecord = [fd, &writeCallSite](const std::string_view record, const RecordKind kind)
+    {
+        if (RecordKind::TEXT == kind)
+        {
+            writeFully(fd, record);
+        }
+        else
+        {
+            // Enough to find the statement, formatting it would allocate
+            auto fields = DeferredRecord::decode(record);
+            writeCallSite(*fields.m_pCallSite);
+            writeFully(fd, "[NOT FORMATTED] ");
+            writeFully(fd, fields.m_FormatStr);
+        }
+        writeFully(fd, ONE_LINE_BREAK);
+    };
+    // The rings are gone through one after the other, merging them is
+    // not worth the risk of anything more in a signal handler
+    size_t cnt = 0;
+    for (const auto& ring : m_Rings)
+    {
+        if (auto pRing = ring.load(std::memory_order_acquire); pRing)
+            cnt += pRing->emergencyDrain(writeRecord);
     }
+
+    // Followed by the records the rate limited statements dropped, pending their
+    // summary. Taken by the first sink of a fan out only.
+    cnt += RateLimiter::sweep(true, [fd, &writeNumber, &writeCallSite](const CallSite& site, const uint64_t suppressedCnt)
+    {
+        writeCallSite(site);
+        writeNumber(suppressedCnt);
+        writeFully(fd, " more records of this statement were suppressed");
+        writeFully(fd, ONE_LINE_BREAK);
+    });
+    return cnt;
 }
 
 void LoggingOps::write(const std::string_view data)
@@ -207,9 +939,38 @@ void LoggingOps::write(const std::string_view data)
     if (data.empty())
         return;
 
+    PushedRecordScope scope(RecordKind::TEXT, LOG_TYPE::LOG_DEFAULT);
+    writeDataTo(data);
+}
+
+void LoggingOps::write(const std::string_view data, const LOG_TYPE type)
+{
+    if (data.empty())
+        return;
+
+    PushedRecordScope scope(RecordKind::TEXT, type);
     writeDataTo(data);
 }
 
+void LoggingOps::writeDeferred(const std::string_view record)
+{
+    if (record.empty())
+        return;
+
+    PushedRecordScope scope(RecordKind::DEFERRED, LOG_TYPE::LOG_DEFAULT);
+    writeDataTo(record);
+}
+
+/*static*/RecordKind LoggingOps::pushedRecordKind() noexcept
+{
+    return pushRecordKind;
+}
+
+/*static*/LOG_TYPE LoggingOps::pushedRecordType() noexcept
+{
+    return pushRecordType;
+}
+
 void LoggingOps::write(const std::vector<std::string_view>& dataVec) noexcept
 {
     if (!dataVec.empty())
@@ -248,22 +1009,26 @@ void LoggingOps::write(const std::list<std::string>& dataList) noexcept
 
 void LoggingOps::write(const uint8_t data)
 {
-    write(std::bitset<8>(data).to_string());
+    std::array<char, 8> bits;
+    write(std::string_view(bits.data(), static_cast<size_t>(renderValue(data, false, bits.data()) - bits.data())));
 }
 
 void LoggingOps::write(const uint16_t data)
 {
-    write(std::bitset<16>(data).to_string());
+    std::array<char, 16> bits;
+    write(std::string_view(bits.data(), static_cast<size_t>(renderValue(data, false, bits.data()) - bits.data())));
 }
 
 void LoggingOps::write(const uint32_t data)
 {
-    write(std::bitset<32>(data).to_string());
+    std::array<char, 32> bits;
+    write(std::string_view(bits.data(), static_cast<size_t>(renderValue(data, false, bits.data()) - bits.data())));
 }
 
 void LoggingOps::write(const uint64_t data)
 {
-    write(std::bitset<64>(data).to_string());
+    std::array<char, 64> bits;
+    write(std::string_view(bits.data(), static_cast<size_t>(renderValue(data, false, bits.data()) - bits.data())));
 }
 
 void LoggingOps::append(const std::string_view data)
@@ -273,94 +1038,187 @@ void LoggingOps::append(const std::string_view data)
 
 void LoggingOps::append(const uint8_t data)
 {
-    write(std::bitset<8>(data).to_string());
+    write(data);
 }
 
 void LoggingOps::append(const uint16_t data)
 {
-    write(std::bitset<16>(data).to_string());
+    write(data);
 }
 
 void LoggingOps::append(const uint32_t data)
 {
-    write(std::bitset<32>(data).to_string());
+    write(data);
 }
 
 void LoggingOps::append(const uint64_t data)
 {
-    write(std::bitset<64>(data).to_string());
+    write(data);
 }
 
 void LoggingOps::append(const std::vector<uint8_t>& binaryStream)
 {
-    if (!binaryStream.empty())
-    {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
-    }
+    writeBinary(binaryStream, BinaryEncoding::BITS);
 }
 
 void LoggingOps::append(const std::vector<uint16_t>& binaryStream)
 {
-    if (!binaryStream.empty())
-    {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
-    }
+    writeBinary(binaryStream, BinaryEncoding::BITS);
 }
 
 void LoggingOps::append(const std::vector<uint32_t>& binaryStream)
 {
-    if (!binaryStream.empty())
-    {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
-    }
+    writeBinary(binaryStream, BinaryEncoding::BITS);
 }
 
 void LoggingOps::append(const std::vector<uint64_t>& binaryStream)
 {
-    if (!binaryStream.empty())
+    writeBinary(binaryStream, BinaryEncoding::BITS);
+}
+
+void LoggingOps::write(const std::vector<uint8_t>& binaryStream)
+{
+    writeBinary(binaryStream, BinaryEncoding::BITS);
+}
+
+void LoggingOps::write(const std::vector<uint16_t>& binaryStream)
+{
+    writeBinary(binaryStream, BinaryEncoding::BITS);
+}
+
+void LoggingOps::write(const std::vector<uint32_t>& binaryStream)
+{
+    writeBinary(binaryStream, BinaryEncoding::BITS);
+}
+
+void LoggingOps::write(const std::vector<uint64_t>& binaryStream)
+{
+    writeBinary(binaryStream, BinaryEncoding::BITS);
+}
+
+void LoggingOps::writeBinary(const std::vector<uint8_t>& binaryStream, const BinaryEncoding encoding)
+{
+    if (binaryStream.empty())
+        return;
+    if (BinaryEncoding::RAW == encoding)
     {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
+        write(std::string_view(reinterpret_cast<const char*>(binaryStream.data()), binaryStream.size() * sizeof(uint8_t)));
+        return;
     }
+    renderBinaryStream(binaryStream, encoding, [this](const std::string_view record) { write(record); });
 }
 
-void LoggingOps::write(const std::vector<uint8_t>& binaryStream)
+void LoggingOps::writeBinary(const std::vector<uint16_t>& binaryStream, const BinaryEncoding encoding)
 {
-    if (!binaryStream.empty())
+    if (binaryStream.empty())
+        return;
+    if (BinaryEncoding::RAW == encoding)
     {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
+        write(std::string_view(reinterpret_cast<const char*>(binaryStream.data()), binaryStream.size() * sizeof(uint16_t)));
+        return;
     }
+    renderBinaryStream(binaryStream, encoding, [this](const std::string_view record) { write(record); });
 }
 
-void LoggingOps::write(const std::vector<uint16_t>& binaryStream)
+void LoggingOps::writeBinary(const std::vector<uint32_t>& binaryStream, const BinaryEncoding encoding)
 {
-    if (!binaryStream.empty())
+    if (binaryStream.empty())
+        return;
+    if (BinaryEncoding::RAW == encoding)
     {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
+        write(std::string_view(reinterpret_cast<const char*>(binaryStream.data()), binaryStream.size() * sizeof(uint32_t)));
+        return;
     }
+    renderBinaryStream(binaryStream, encoding, [this](const std::string_view record) { write(record); });
 }
 
-void LoggingOps::write(const std::vector<uint32_t>& binaryStream)
+void LoggingOps::writeBinary(const std::vector<uint64_t>& binaryStream, const BinaryEncoding encoding)
 {
-    if (!binaryStream.empty())
+    if (binaryStream.empty())
+        return;
+    if (BinaryEncoding::RAW == encoding)
     {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
+        write(std::string_view(reinterpret_cast<const char*>(binaryStream.data()), binaryStream.size() * sizeof(uint64_t)));
+        return;
     }
+    renderBinaryStream(binaryStream, encoding, [this](const std::string_view record) { write(record); });
 }
 
-void LoggingOps::write(const std::vector<uint64_t>& binaryStream)
+void LoggingOps::addRaisedException(const std::exception_ptr& excpPtr) noexcept
+{
+    m_ExceptionsCnt.fetch_add(1, std::memory_order_relaxed);
+    std::scoped_lock<std::mutex> excpLock(m_ExcpMtx);
+    if (m_excpPtrVec.size() < maxKeptExceptions)
+        m_excpPtrVec.emplace_back(excpPtr);
+}
+
+LoggingOps::ProducerCounters& LoggingOps::producerCounters() noexcept
+{
+    return m_ProducerCounters[threadSlot() % producerSlotsCnt];
+}
+
+void LoggingOps::countBatch(const RecordArena& dataArena, const std::chrono::nanoseconds busyTime) noexcept
+{
+    m_WrittenRecords.fetch_add(dataArena.size(), std::memory_order_relaxed);
+    m_WrittenBytes.fetch_add(dataArena.dataBytes(), std::memory_order_relaxed);
+    m_BatchesCnt.fetch_add(1, std::memory_order_relaxed);
+    m_WriterBusyNs.fetch_add(static_cast<uint64_t>(busyTime.count()), std::memory_order_relaxed);
+}
+
+LoggingStats LoggingOps::getStats() const noexcept
 {
-    if (!binaryStream.empty())
+    LoggingStats stats;
+    uint64_t blockedNs = 0;
+    for (const auto& counters : m_ProducerCounters)
     {
-        for (const auto& bindata : binaryStream)
-            write(bindata);
+        stats.pushedRecords += counters.m_PushedRecords.load(std::memory_order_relaxed);
+        stats.pushedBytes += counters.m_PushedBytes.load(std::memory_order_relaxed);
+        blockedNs += counters.m_BlockedNs.load(std::memory_order_relaxed);
     }
+    forEachRing([&stats](const size_t /*idx*/, const RecordRing& ring)
+    {
+        stats.queuedRecords += ring.pendingRecords();
+        stats.queuedBytes += ring.pendingBytes();
+        stats.droppedRecords += ring.droppedCount();
+    });
+    stats.highWaterBytes = std::max(m_HighWaterBytes.load(std::memory_order_relaxed), stats.queuedBytes);
+    stats.writtenRecords = m_WrittenRecords.load(std::memory_order_relaxed);
+    stats.writtenBytes = m_WrittenBytes.load(std::memory_order_relaxed);
+    stats.batches = m_BatchesCnt.load(std::memory_order_relaxed);
+    stats.blockedTime = std::chrono::nanoseconds(blockedNs);
+    stats.writerBusyTime = std::chrono::nanoseconds(m_WriterBusyNs.load(std::memory_order_relaxed));
+    stats.rotations = m_RotationsCnt.load(std::memory_order_relaxed);
+    stats.exceptions = m_ExceptionsCnt.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LoggingOps::writeStatsLineIfDue(RecordArena& dataArena)
+{
+    auto interval = std::chrono::seconds(m_StatsIntervalSec.load(std::memory_order_relaxed));
+    auto now = std::chrono::steady_clock::now();
+    if (!interval.count() || now - m_LastStatsTime < interval)
+        return;
+    m_LastStatsTime = now;
+
+    // It goes straight to the sink, so it is neither queued nor counted
+    dataArena.clear();
+    dataArena.append(getStats().toString());
+    std::exception_ptr excpPtr = nullptr;
+    writeToOutStreamObject(dataArena, excpPtr);
+    if (excpPtr)
+        addRaisedException(excpPtr);
+}
+
+std::string LoggingStats::toString() const
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    return std::format("LoggingStats: queued={}/{}B high_water={}B pushed={}/{}B written={}/{}B batches={} "
+                       "avg_batch={:.1f} dropped={} blocked={}us writer_busy={}us rotations={} exceptions={}",
+                       queuedRecords, queuedBytes, highWaterBytes, pushedRecords, pushedBytes,
+                       writtenRecords, writtenBytes, batches, averageBatchSize(), droppedRecords,
+                       duration_cast<microseconds>(blockedTime).count(),
+                       duration_cast<microseconds>(writerBusyTime).count(), rotations, exceptions);
 }
 
 void LoggingOps::collectAndPrintExceptions()
@@ -0,0 +1,529 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * File: NetworkOps.cpp
+ * Description: Implementation of the NetworkOps class.
+ * See NetworkOps.hpp for class definition and documentation.
+ */
+
+#include "NetworkOps.hpp"
+#include "FileOps.hpp"
+#include "DeferredRecord.hpp"
+#include "RecordEncoder.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+using namespace logger;
+
+// A text record is pushed with the syslog severity of its log type in front,
+// as the marker and a digit. The marker is not a character of a log line
+static constexpr char severityMarker = '\x1f';
+static constexpr uint8_t defaultSeverity = 6;   // Informational
+
+#if defined(MSG_NOSIGNAL)
+static constexpr int sendFlags = MSG_NOSIGNAL;  // A collector gone must not kill the program
+#else
+static constexpr int sendFlags = 0;             // SO_NOSIGPIPE is set instead
+#endif
+
+/**
+ * @brief Get the syslog severity of a log type (RFC 5424, 6.2.1)
+ */
+static constexpr uint8_t severityOf(const LOG_TYPE type) noexcept
+{
+    switch (type)
+    {
+        case LOG_TYPE::LOG_FATAL:
+        case LOG_TYPE::LOG_ASSERT:  return 2;   // Critical
+        case LOG_TYPE::LOG_ERR:     return 3;   // Error
+        case LOG_TYPE::LOG_WARN:    return 4;   // Warning
+        case LOG_TYPE::LOG_IMP:     return 5;   // Notice
+        case LOG_TYPE::LOG_DBG:     return 7;   // Debug
+        case LOG_TYPE::LOG_INFO:
+        case LOG_TYPE::LOG_DEFAULT:
+        default:                    return defaultSeverity;
+    }
+}
+
+/**
+ * @brief Connect a socket, waiting ioTimeout at most. The socket is left
+ * blocking, with ioTimeout as its send time out.
+ *
+ * @return true If it is connected, otherwise (errno tells why)
+ * @return false
+ */
+static bool connectWithTimeout(const int fd, const addrinfo& addr) noexcept
+{
+    using namespace std::chrono;
+    timeval timeOut{};
+    timeOut.tv_sec = static_cast<decltype(timeOut.tv_sec)>(duration_cast<seconds>(NetworkOps::ioTimeout).count());
+    timeOut.tv_usec = static_cast<decltype(timeOut.tv_usec)>((NetworkOps::ioTimeout % seconds(1)).count() * 1000);
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeOut, sizeof(timeOut));
+#if defined(SO_NOSIGPIPE)
+    int noSigPipe = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    auto flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    auto rc = ::connect(fd, addr.ai_addr, addr.ai_addrlen);
+    if (rc < 0 && EINPROGRESS == errno)
+    {
+        pollfd pollFd{fd, POLLOUT, 0};
+        rc = ::poll(&pollFd, 1, static_cast<int>(NetworkOps::ioTimeout.count()));
+        if (0 == rc)
+        {
+            errno = ETIMEDOUT;
+            return false;
+        }
+        int soError = 0;
+        socklen_t len = sizeof(soError);
+        if (rc > 0 && 0 == ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &soError, &len) && soError)
+        {
+            errno = soError;
+            return false;
+        }
+        rc = rc > 0 ? 0 : -1;
+    }
+    if (rc < 0)
+        return false;
+    ::fcntl(fd, F_SETFL, flags);
+    return true;
+}
+
+static std::string defaultHostName()
+{
+    std::array<char, 256> name{};
+    if (::gethostname(name.data(), name.size() - 1) != 0)
+        return "";
+    return name.data();
+}
+
+static std::string defaultAppName()
+{
+#if defined(__linux__)
+    return program_invocation_short_name;
+#elif defined(__APPLE__)
+    return ::getprogname();
+#else
+    return "";
+#endif
+}
+
+/*static*/std::optional<NetworkTarget> NetworkTarget::parse(const std::string_view target)
+{
+    NetworkTarget parsed;
+    auto rest = target;
+    if (rest.starts_with("udp://"))
+        parsed.protocol = NetworkProtocol::UDP_SYSLOG;
+    else if (rest.starts_with("tcp://"))
+        parsed.protocol = NetworkProtocol::TCP_SYSLOG;
+    else
+        return std::nullopt;
+    rest.remove_prefix(std::string_view("udp://").size());
+
+    if (rest.starts_with('['))  // An IPv6 address
+    {
+        auto closePos = rest.find(']');
+        if (std::string_view::npos == closePos)
+            return std::nullopt;
+        parsed.host = rest.substr(1, closePos - 1);
+        rest.remove_prefix(closePos + 1);
+    }
+    else
+    {
+        auto colonPos = rest.rfind(':');
+        parsed.host = rest.substr(0, colonPos);
+        rest.remove_prefix(std::string_view::npos == colonPos ? rest.size() : colonPos);
+    }
+
+    if (!rest.empty())
+    {
+        if (rest.front() != ':')
+            return std::nullopt;
+        rest.remove_prefix(1);
+        auto [pEnd, ec] = std::from_chars(rest.data(), rest.data() + rest.size(), parsed.port);
+        if (ec != std::errc() || pEnd != rest.data() + rest.size() || 0 == parsed.port)
+            return std::nullopt;
+    }
+    if (parsed.host.empty())
+        return std::nullopt;
+    return parsed;
+}
+
+NetworkOps::NetworkOps(const std::string& host, const uint16_t port, const NetworkProtocol protocol, const size_t ringCapacity)
+    : LoggingOps(ringCapacity)
+    , m_Host(host)
+    , m_Port(port)
+    , m_Protocol(protocol)
+    , m_SettingsMtx()
+    , m_Settings()
+    , m_BatchSettings()
+    , m_SocketFd(-1)
+    , m_Backoff(0)
+    , m_NextConnectTime()
+    , m_isLossReported(false)
+    , m_LastErrno(0)
+    , m_SendBuffer()
+    , m_MsgBuffer()
+    , m_Frames()
+    , m_isConnected(false)
+    , m_SentCnt(0)
+    , m_SpilledCnt(0)
+    , m_LostCnt(0)
+    , m_ConnectsCnt(0)
+{
+    m_Settings.m_HostName = toHeaderField(defaultHostName(), 255);
+    m_Settings.m_AppName = toHeaderField(defaultAppName(), 48);
+
+    // The records are made syslog messages by the watcher thread, the
+    // deferred ones are needed as they are for their log type and time
+    m_keepsDeferredRecords = true;
+    m_watcher = std::thread([this]() { keepWatchAndPull(); });
+}
+
+NetworkOps::~NetworkOps()
+{
+    // Send whatever is left while the socket is still there
+    stopWatcher();
+    if (m_SocketFd >= 0)
+        ::close(m_SocketFd);
+}
+
+NetworkOps& NetworkOps::setSpillFile(const std::shared_ptr<FileOps>& spillFile)
+{
+    std::scoped_lock<std::mutex> settingsLock(m_SettingsMtx);
+    m_Settings.m_pSpillFile = spillFile;
+    return *this;
+}
+
+NetworkOps& NetworkOps::setReconnectBackoff(const std::chrono::milliseconds minBackoff, const std::chrono::milliseconds maxBackoff)
+{
+    std::scoped_lock<std::mutex> settingsLock(m_SettingsMtx);
+    m_Settings.m_MinBackoff = std::max(minBackoff, std::chrono::milliseconds(1));
+    m_Settings.m_MaxBackoff = std::max(maxBackoff, m_Settings.m_MinBackoff);
+    return *this;
+}
+
+NetworkOps& NetworkOps::setSyslogFacility(const uint8_t facility)
+{
+    std::scoped_lock<std::mutex> settingsLock(m_SettingsMtx);
+    m_Settings.m_Facility = std::min<uint8_t>(facility, 23);
+    return *this;
+}
+
+NetworkOps& NetworkOps::setHostName(const std::string_view hostName)
+{
+    std::scoped_lock<std::mutex> settingsLock(m_SettingsMtx);
+    m_Settings.m_HostName = toHeaderField(hostName, 255);
+    return *this;
+}
+
+NetworkOps& NetworkOps::setAppName(const std::string_view appName)
+{
+    std::scoped_lock<std::mutex> settingsLock(m_SettingsMtx);
+    m_Settings.m_AppName = toHeaderField(appName, 48);
+    return *this;
+}
+
+/*static*/std::string NetworkOps::toHeaderField(const std::string_view name, const size_t maxSize)
+{
+    // PRINTUSASCII, i.e. no spaces either, and the NILVALUE if there is nothing
+    std::string field(name.substr(0, maxSize));
+    std::replace_if(field.begin(), field.end(), [](const char ch){ return ch < 33 || ch > 126; }, '_');
+    return field.empty() ? std::string("-") : field;
+}
+
+void NetworkOps::writeDataTo(const std::string_view data)
+{
+    if (data.empty())
+        return;
+
+    if (RecordKind::DEFERRED == pushedRecordKind())
+    {
+        push(data);
+        return;
+    }
+    thread_local std::string record;
+    record.assign(1, severityMarker).push_back(static_cast<char>('0' + severityOf(pushedRecordType())));
+    record.append(data);
+    push(record);
+}
+
+void NetworkOps::frameBatch(const RecordArena& dataArena)
+{
+    auto pEncoder = getRecordEncoder();
+    const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto isTcp = NetworkProtocol::TCP_SYSLOG == m_Protocol;
+
+    // The part of the header which is the same for every message, " HOSTNAME APP-NAME PROCID MSGID SD "
+    std::string headerTail = std::format(" {} {} {} - - ", m_BatchSettings.m_HostName, m_BatchSettings.m_AppName, ::getpid());
+    std::string header;
+
+    m_SendBuffer.clear();
+    m_Frames.clear();
+    for (auto itr = dataArena.begin(); itr != dataArena.end(); ++itr)
+    {
+        auto record = *itr;
+        auto severity = defaultSeverity;
+        auto timeStampNs = now;
+        std::string_view msg;
+        if (RecordKind::DEFERRED == itr.kind())
+        {
+            auto fields = DeferredRecord::decode(record);
+            severity = severityOf(fields.m_pCallSite->type());
+            timeStampNs = fields.m_TimeStampNs;
+            if (pEncoder)
+                pEncoder->encode(record, RecordKind::DEFERRED, m_MsgBuffer);
+            else
+                DeferredRecord::render(record, m_MsgBuffer);
+            msg = m_MsgBuffer;
+        }
+        else
+        {
+            // The ones pushed by the watcher thread itself (e.g. the stats line) have no severity
+            if (record.size() >= 2 && severityMarker == record[0])
+            {
+                severity = static_cast<uint8_t>(record[1] - '0');
+                record.remove_prefix(2);
+            }
+            if (pEncoder)
+            {
+                pEncoder->encode(record, RecordKind::TEXT, m_MsgBuffer);
+                msg = m_MsgBuffer;
+            }
+            else
+            {
+                msg = record;
+            }
+        }
+
+        // <PRI>VERSION TIMESTAMP, the time stamp with microseconds at most
+        header.assign(1, '<').append(std::to_string(m_BatchSettings.m_Facility * 8 + severity)).append(">1 ");
+        RecordEncoder::appendTimeStamp(timeStampNs, header);
+        header.erase(header.size() - 4, 3);
+        header.append(headerTail);
+        if (!isTcp)
+            msg = msg.substr(0, maxDatagramSize - std::min(maxDatagramSize, header.size()));
+
+        Frame frame{m_SendBuffer.size(), 0, 0};
+        if (isTcp)
+            m_SendBuffer.append(std::to_string(header.size() + msg.size())).push_back(' ');
+        frame.m_MsgStart = m_SendBuffer.size();
+        m_SendBuffer.append(header).append(msg);
+        frame.m_End = m_SendBuffer.size();
+        m_Frames.push_back(frame);
+    }
+}
+
+bool NetworkOps::connectSocket()
+{
+    if (m_SocketFd >= 0)
+        return true;
+    if (std::chrono::steady_clock::now() < m_NextConnectTime)
+        return false;
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = NetworkProtocol::TCP_SYSLOG == m_Protocol ? SOCK_STREAM : SOCK_DGRAM;
+    addrinfo* pAddrs = nullptr;
+    auto port = std::to_string(m_Port);
+    if (auto rc = ::getaddrinfo(m_Host.c_str(), port.c_str(), &hints, &pAddrs); rc != 0)
+    {
+        closeSocket(EAI_SYSTEM == rc ? errno : EHOSTUNREACH);
+        return false;
+    }
+
+    // Every address of the host is tried, e.g. both the IPv6 and the IPv4 one
+    int err = EHOSTUNREACH;
+    for (auto pAddr = pAddrs; pAddr && m_SocketFd < 0; pAddr = pAddr->ai_next)
+    {
+        auto fd = ::socket(pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol);
+        if (fd < 0)
+        {
+            err = errno;
+            continue;
+        }
+        if (connectWithTimeout(fd, *pAddr))
+        {
+            m_SocketFd = fd;
+        }
+        else
+        {
+            err = errno;
+            ::close(fd);
+        }
+    }
+    ::freeaddrinfo(pAddrs);
+    if (m_SocketFd < 0)
+    {
+        closeSocket(err);
+        return false;
+    }
+
+    m_Backoff = std::chrono::milliseconds(0);
+    m_isLossReported = false;
+    m_isConnected.store(true, std::memory_order_relaxed);
+    m_ConnectsCnt.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void NetworkOps::closeSocket(const int err) noexcept
+{
+    if (m_SocketFd >= 0)
+        ::close(m_SocketFd);
+    m_SocketFd = -1;
+    m_LastErrno = err;
+    m_isConnected.store(false, std::memory_order_relaxed);
+
+    // Doubled with every failure, from the least backoff on
+    m_Backoff = std::clamp(m_Backoff * 2, m_BatchSettings.m_MinBackoff, m_BatchSettings.m_MaxBackoff);
+    m_NextConnectTime = std::chrono::steady_clock::now() + m_Backoff;
+}
+
+size_t NetworkOps::sendFrames()
+{
+    if (NetworkProtocol::TCP_SYSLOG == m_Protocol)
+    {
+        // The whole batch is a single stream of bytes, sent at once
+        size_t offset = 0;
+        while (offset < m_SendBuffer.size())
+        {
+            auto cnt = ::send(m_SocketFd, m_SendBuffer.data() + offset, m_SendBuffer.size() - offset, sendFlags);
+            if (cnt < 0)
+            {
+                if (EINTR == errno)
+                    continue;
+                closeSocket(errno);
+                break;
+            }
+            offset += static_cast<size_t>(cnt);
+        }
+        return static_cast<size_t>(std::count_if(m_Frames.begin(), m_Frames.end(), [offset](const Frame& frame){ return frame.m_End <= offset; }));
+    }
+
+    size_t sentCnt = 0;
+#if defined(__linux__)
+    // A datagram per message, as many of them as the kernel takes with a single call
+    thread_local std::vector<iovec> iovecs;
+    thread_local std::vector<mmsghdr> msgHdrs;
+    iovecs.resize(m_Frames.size());
+    msgHdrs.assign(m_Frames.size(), mmsghdr{});
+    for (size_t idx = 0; idx < m_Frames.size(); ++idx)
+    {
+        iovecs[idx].iov_base = m_SendBuffer.data() + m_Frames[idx].m_Start;
+        iovecs[idx].iov_len = m_Frames[idx].m_End - m_Frames[idx].m_Start;
+        msgHdrs[idx].msg_hdr.msg_iov = &iovecs[idx];
+        msgHdrs[idx].msg_hdr.msg_iovlen = 1;
+    }
+    while (sentCnt < m_Frames.size())
+    {
+        auto cnt = ::sendmmsg(m_SocketFd, msgHdrs.data() + sentCnt,
+                              static_cast<unsigned int>(std::min<size_t>(m_Frames.size() - sentCnt, UIO_MAXIOV)), sendFlags);
+        if (cnt < 0)
+        {
+            if (EINTR == errno)
+                continue;
+            closeSocket(errno);
+            break;
+        }
+        sentCnt += static_cast<size_t>(cnt);
+    }
+#else
+    for (const auto& frame : m_Frames)
+    {
+        auto cnt = ::send(m_SocketFd, m_SendBuffer.data() + frame.m_Start, frame.m_End - frame.m_Start, sendFlags);
+        if (cnt < 0 && EINTR == errno)
+            cnt = ::send(m_SocketFd, m_SendBuffer.data() + frame.m_Start, frame.m_End - frame.m_Start, sendFlags);
+        if (cnt < 0)
+        {
+            closeSocket(errno);
+            break;
+        }
+        ++sentCnt;
+    }
+#endif
+    return sentCnt;
+}
+
+void NetworkOps::writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& excpPtr)
+{
+    if (dataArena.empty())
+        return;
+
+    try
+    {
+        {
+            std::scoped_lock<std::mutex> settingsLock(m_SettingsMtx);
+            m_BatchSettings = m_Settings;
+        }
+        frameBatch(dataArena);
+
+        size_t sentCnt = 0;
+        if (connectSocket())
+            sentCnt = sendFrames();
+        m_SentCnt.fetch_add(sentCnt, std::memory_order_relaxed);
+        if (sentCnt == m_Frames.size())
+            return;
+
+        // The collector didn't take the rest, they are spilled (or lost)
+        // and the connection is tried again once the backoff is over
+        const auto unsentCnt = m_Frames.size() - sentCnt;
+        if (m_BatchSettings.m_pSpillFile)
+        {
+            std::string_view sendBuffer(m_SendBuffer);
+            for (auto itr = m_Frames.begin() + static_cast<std::ptrdiff_t>(sentCnt); itr != m_Frames.end(); ++itr)
+                m_BatchSettings.m_pSpillFile->write(sendBuffer.substr(itr->m_MsgStart, itr->m_End - itr->m_MsgStart));
+            m_SpilledCnt.fetch_add(unsentCnt, std::memory_order_relaxed);
+            return;
+        }
+
+        m_LostCnt.fetch_add(unsentCnt, std::memory_order_relaxed);
+        if (!m_isLossReported)  // Once per outage, not per batch
+        {
+            m_isLossReported = true;
+            throw std::runtime_error(std::format("NETWORK_ERROR : [{}:{}]: the collector can't be reached ({}), "
+                                                 "the records are lost till it is back", m_Host, m_Port, std::strerror(m_LastErrno)));
+        }
+    }
+    catch(...)
+    {
+        excpPtr = std::current_exception();
+    }
+}
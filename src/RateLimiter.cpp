@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: RateLimiter.cpp
+ * Description: Implementation of the RateLimiter class.
+ * See RateLimiter.hpp for class definition and documentation.
+ */
+
+#include "RateLimiter.hpp"
+#include "LogHelper.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace logger;
+
+// Constant initialized, so that logging from other static objects sees them
+/*static*/constinit std::atomic<uint32_t> RateLimiter::m_MaxRecords(0);
+/*static*/constinit std::atomic<uint64_t> RateLimiter::m_IntervalMs(RateLimiter::defaultInterval.count());
+/*static*/constinit std::atomic<RateLimiter*> RateLimiter::m_pListHead(nullptr);
+
+namespace
+{
+    /**
+     * @brief The thread logging the summary records of the log statements gone
+     * quiet after dropping some, once per interval, and of all the ones still
+     * pending when it is stopped at the exit.
+     *
+     * It is a thread of its own rather than the watcher thread of a sink, the
+     * summary records go through loggingOps like any other and the watcher
+     * thread must never wait for room in its own ring.
+     */
+    class Sweeper
+    {
+        public:
+            Sweeper()
+            {
+                // Built first, so that it is still there for the last summary records
+                Logger::buildLoggingOpsObject();
+                m_Thread = std::thread(&Sweeper::run, this);
+            }
+
+            ~Sweeper()
+            {
+                {
+                    std::scoped_lock<std::mutex> lock(m_Mtx);
+                    m_isStopping = true;
+                }
+                m_Cv.notify_all();
+                if (m_Thread.joinable())
+                    m_Thread.join();
+            }
+
+        private:
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(m_Mtx);
+                auto isStopping = false;
+                while (!isStopping)
+                {
+                    isStopping = m_Cv.wait_for(lock, RateLimiter::getInterval(), [this]{ return m_isStopping; });
+                    lock.unlock();
+                    RateLimiter::sweep(isStopping, [](const CallSite& site, const uint64_t suppressedCnt)
+                    {
+                        try
+                        {
+                            log_suppressed(site, suppressedCnt);
+                        }
+                        catch (...)
+                        {
+                            loggingOps.addRaisedException(std::current_exception());
+                        }
+                    });
+                    lock.lock();
+                }
+            }
+
+            std::mutex m_Mtx;
+            std::condition_variable m_Cv;
+            bool m_isStopping = false;
+            std::thread m_Thread;
+    };
+};
+
+/*static*/void RateLimiter::setLimit(const uint32_t maxRecords, const std::chrono::milliseconds interval) noexcept
+{
+    // The interval first, a record never divides by a zero one
+    m_IntervalMs.store(static_cast<uint64_t>(std::max<int64_t>(interval.count(), 1)), std::memory_order_relaxed);
+    m_MaxRecords.store(maxRecords, std::memory_order_relaxed);
+}
+
+void RateLimiter::enlistOnce(const CallSite& site) noexcept
+{
+    if (m_isListed.test_and_set(std::memory_order_relaxed))
+        return;
+
+    // Pushed to the front, the sweeper sees the call site along with it
+    m_pSite = &site;
+    auto pHead = m_pListHead.load(std::memory_order_relaxed);
+    do
+    {
+        m_pNext = pHead;
+    } while (!m_pListHead.compare_exchange_weak(pHead, this, std::memory_order_release, std::memory_order_relaxed));
+
+    try
+    {
+        // Started by the first one, and stopped at the exit
+        static Sweeper sweeper;
+    }
+    catch (...)
+    {
+        // Left to the next record of the statement to sum them up
+        loggingOps.addRaisedException(std::current_exception());
+    }
+}
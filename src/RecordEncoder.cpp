@@ -0,0 +1,332 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: RecordEncoder.cpp
+ * Description: Implementation of the RecordEncoder, JsonEncoder and LogfmtEncoder classes.
+ * See RecordEncoder.hpp for class definition and documentation.
+ */
+
+#include "RecordEncoder.hpp"
+#include "DeferredRecord.hpp"
+#include "CallSite.hpp"
+#include "Logger.hpp"
+
+#include <cmath>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <iterator>
+
+using namespace logger;
+
+static constexpr uint64_t lowBits = 0x0101010101010101ull;
+static constexpr uint64_t highBits = 0x8080808080808080ull;
+
+/**
+ * @brief Non zero if any byte of the word is less than the limit (up to 0x80).
+ * A borrow may flag a byte above the one which is less as well, so it only
+ * tells the word has one, the bytes are then looked at one by one.
+ */
+static constexpr uint64_t bytesLess(const uint64_t word, const uint8_t limit) noexcept
+{
+    return (word - lowBits * limit) & ~word & highBits;
+}
+
+static constexpr uint64_t bytesEqual(const uint64_t word, const uint8_t chr) noexcept
+{
+    return bytesLess(word ^ (lowBits * chr), 1);
+}
+
+static constexpr bool isSpecial(const char chr, const bool isLogfmt) noexcept
+{
+    auto uChr = static_cast<unsigned char>(chr);
+    return uChr < 0x20 || '"' == chr || '\\' == chr || (isLogfmt && (' ' == chr || '=' == chr));
+}
+
+template<typename T>
+static inline T load(const std::string_view bytes) noexcept
+{
+    T val{};
+    std::memcpy(&val, bytes.data(), std::min(sizeof(T), bytes.size()));
+    return val;
+}
+
+/**
+ * @brief The class and the function name of a call site, the way a C++ programmer reads it
+ */
+static std::string_view functionName(const CallSite& site)
+{
+    if (site.className().empty())
+        return site.functionName();
+    thread_local std::string name;
+    name.assign(site.className()).append("::").append(site.functionName());
+    return name;
+}
+
+/**
+ * @brief Append an integer, with no locale and no allocation
+ */
+template<typename T>
+static inline void appendInteger(const T val, std::string& out)
+{
+    std::array<char, 24> buf;
+    auto result = std::to_chars(buf.data(), buf.data() + buf.size(), val);
+    out.append(buf.data(), static_cast<size_t>(result.ptr - buf.data()));
+}
+
+static void appendJsonValue(const ArgType type, const std::string_view bytes, std::string& out)
+{
+    auto isFinite = true;
+    switch (type)
+    {
+        case ArgType::STRING:       RecordEncoder::appendJsonString(bytes, out);                return;
+        case ArgType::CHAR:         RecordEncoder::appendJsonString(bytes.substr(0, 1), out);   return;
+        case ArgType::FLOAT:        isFinite = std::isfinite(load<float>(bytes));               break;
+        case ArgType::DOUBLE:       isFinite = std::isfinite(load<double>(bytes));              break;
+        case ArgType::LONG_DOUBLE:  isFinite = std::isfinite(load<long double>(bytes));         break;
+        default:                                                                                break;
+    }
+    // JSON has no infinity and no NaN
+    if (isFinite)
+        DeferredRecord::appendValue(type, bytes, out);
+    else
+        out.append("null");
+}
+
+/*static*/void RecordEncoder::appendLogfmtValue(const ArgType type, const std::string_view bytes, std::string& out)
+{
+    if (ArgType::STRING == type || ArgType::CHAR == type)
+        RecordEncoder::appendLogfmtString(bytes.substr(0, (ArgType::CHAR == type) ? 1 : bytes.size()), out);
+    else
+        DeferredRecord::appendValue(type, bytes, out);
+}
+
+/*static*/std::shared_ptr<const RecordEncoder> RecordEncoder::create(const RecordEncoding encoding)
+{
+    switch (encoding)
+    {
+        case RecordEncoding::JSON:      return std::make_shared<JsonEncoder>();
+        case RecordEncoding::LOGFMT:    return std::make_shared<LogfmtEncoder>();
+        case RecordEncoding::TEXT:
+        default:                        return nullptr;
+    }
+}
+
+/*static*/size_t RecordEncoder::findSpecial(const std::string_view str, const bool isLogfmt) noexcept
+{
+    // A word at a time, as long as none of its bytes is special at all
+    size_t pos = 0;
+    for (; pos + sizeof(uint64_t) <= str.size(); pos += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, str.data() + pos, sizeof(uint64_t));
+        auto mask = bytesLess(word, isLogfmt ? 0x21 : 0x20) | bytesEqual(word, '"') | bytesEqual(word, '\\');
+        if (isLogfmt)
+            mask |= bytesEqual(word, '=');
+        if (mask)
+            break;
+    }
+    for (; pos < str.size(); ++pos)
+    {
+        if (isSpecial(str[pos], isLogfmt))
+            return pos;
+    }
+    return str.size();
+}
+
+/*static*/void RecordEncoder::appendEscaped(std::string_view str, std::string& out)
+{
+    static constexpr std::string_view hexDigits = "0123456789abcdef";
+    while (!str.empty())
+    {
+        auto pos = findSpecial(str, false);
+        out.append(str.substr(0, pos));
+        if (pos == str.size())
+            break;
+
+        auto chr = str[pos];
+        switch (chr)
+        {
+            case '"':   out.append("\\\"");     break;
+            case '\\':  out.append("\\\\");     break;
+            case '\n':  out.append("\\n");      break;
+            case '\r':  out.append("\\r");      break;
+            case '\t':  out.append("\\t");      break;
+            case '\b':  out.append("\\b");      break;
+            case '\f':  out.append("\\f");      break;
+            default:
+            {
+                auto uChr = static_cast<unsigned char>(chr);
+                out.append("\\u00");
+                out.push_back(hexDigits[uChr >> 4]);
+                out.push_back(hexDigits[uChr & 0x0F]);
+                break;
+            }
+        }
+        str.remove_prefix(pos + 1);
+    }
+}
+
+/*static*/void RecordEncoder::appendJsonString(const std::string_view str, std::string& out)
+{
+    out.push_back('"');
+    appendEscaped(str, out);
+    out.push_back('"');
+}
+
+/*static*/void RecordEncoder::appendLogfmtString(const std::string_view str, std::string& out)
+{
+    if (!str.empty() && findSpecial(str, true) == str.size())
+    {
+        out.append(str);
+        return;
+    }
+    out.push_back('"');
+    appendEscaped(str, out);
+    out.push_back('"');
+}
+
+/*static*/void RecordEncoder::appendTimeStamp(const int64_t timeStampNs, std::string& out)
+{
+    using namespace std::chrono;
+    // The date and the time of day only change once a second, the
+    // records of the same second reuse them along with the thread
+    thread_local int64_t cachedSecond = 0;
+    thread_local std::array<char, 32> cachedStr{};
+    thread_local size_t cachedSize = 0;
+
+    auto timeStamp = sys_time<nanoseconds>(nanoseconds(timeStampNs));
+    auto second = floor<seconds>(timeStamp);
+    if (!cachedSize || cachedSecond != second.time_since_epoch().count())
+    {
+        auto day = floor<days>(second);
+        year_month_day date(day);
+        hh_mm_ss<seconds> time(second - day);
+        auto result = std::format_to_n(cachedStr.data(), cachedStr.size(), "{:04}-{:02}-{:02}T{:02}:{:02}:{:02}",
+                                       static_cast<int>(date.year()), static_cast<unsigned>(date.month()),
+                                       static_cast<unsigned>(date.day()), time.hours().count(),
+                                       time.minutes().count(), time.seconds().count());
+        cachedSize = std::min(static_cast<size_t>(result.size), cachedStr.size());
+        cachedSecond = second.time_since_epoch().count();
+    }
+    out.append(cachedStr.data(), cachedSize).push_back('.');
+
+    // The nanoseconds, zero padded to 9 digits
+    std::array<char, 9> fraction;
+    auto nanos = static_cast<uint64_t>((timeStamp - second).count());
+    for (auto itr = fraction.rbegin(); itr != fraction.rend(); ++itr, nanos /= 10)
+        *itr = static_cast<char>('0' + nanos % 10);
+    out.append(fraction.data(), fraction.size()).push_back('Z');
+}
+
+void JsonEncoder::encode(const std::string_view record, const RecordKind kind, std::string& line) const
+{
+    if (RecordKind::TEXT == kind)
+    {
+        line.assign("{\"msg\":");
+        appendJsonString(record, line);
+        line.push_back('}');
+        return;
+    }
+
+    auto fields = DeferredRecord::decode(record);
+    const auto& site = *fields.m_pCallSite;
+    line.assign("{\"ts\":\"");
+    appendTimeStamp(fields.m_TimeStampNs, line);
+    line.append("\",\"level\":");
+    appendJsonString(Logger::logTypeName(site.type()), line);
+    line.append(",\"thread\":");
+    appendJsonString(Logger::threadIdStr(fields.m_ThreadId), line);
+    line.append(",\"file\":");
+    appendJsonString(site.fileName(), line);
+    line.append(",\"line\":");
+    appendInteger(site.line(), line);
+    line.append(",\"function\":");
+    appendJsonString(functionName(site), line);
+    line.append(",\"msg\":");
+    if (!fields.m_isStructured)
+    {
+        thread_local std::string msg;
+        DeferredRecord::formatMessage(record, msg);
+        appendJsonString(msg, line);
+        line.push_back('}');
+        return;
+    }
+
+    appendJsonString(fields.m_FormatStr, line);
+    auto args = fields.m_Args;
+    for (uint32_t idx = 0; idx + 1 < fields.m_ArgsCnt; idx += 2)
+    {
+        line.push_back(',');
+        appendJsonString(DeferredRecord::nextArg(fields.m_pArgTypes[idx], args), line);
+        line.push_back(':');
+        auto type = fields.m_pArgTypes[idx + 1];
+        appendJsonValue(type, DeferredRecord::nextArg(type, args), line);
+    }
+    line.push_back('}');
+}
+
+void LogfmtEncoder::encode(const std::string_view record, const RecordKind kind, std::string& line) const
+{
+    if (RecordKind::TEXT == kind)
+    {
+        line.assign("msg=");
+        appendLogfmtString(record, line);
+        return;
+    }
+
+    auto fields = DeferredRecord::decode(record);
+    const auto& site = *fields.m_pCallSite;
+    line.assign("ts=");
+    appendTimeStamp(fields.m_TimeStampNs, line);
+    line.append(" level=");
+    appendLogfmtString(Logger::logTypeName(site.type()), line);
+    line.append(" thread=");
+    appendLogfmtString(Logger::threadIdStr(fields.m_ThreadId), line);
+    line.append(" file=");
+    appendLogfmtString(site.fileName(), line);
+    line.append(" line=");
+    appendInteger(site.line(), line);
+    line.append(" function=");
+    appendLogfmtString(functionName(site), line);
+    line.append(" msg=");
+    if (!fields.m_isStructured)
+    {
+        thread_local std::string msg;
+        DeferredRecord::formatMessage(record, msg);
+        appendLogfmtString(msg, line);
+        return;
+    }
+
+    appendLogfmtString(fields.m_FormatStr, line);
+    auto args = fields.m_Args;
+    for (uint32_t idx = 0; idx + 1 < fields.m_ArgsCnt; idx += 2)
+    {
+        line.push_back(' ');
+        line.append(DeferredRecord::nextArg(fields.m_pArgTypes[idx], args)).push_back('=');
+        auto type = fields.m_pArgTypes[idx + 1];
+        appendLogfmtValue(type, DeferredRecord::nextArg(type, args), line);
+    }
+}
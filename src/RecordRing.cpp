@@ -0,0 +1,269 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: RecordRing.cpp
+ * Description: Implementation of the RecordRing and RecordArena classes.
+ * See RecordRing.hpp for class definition and documentation.
+ */
+
+#include "RecordRing.hpp"
+
+#include <chrono>
+#include <cstring>
+
+using namespace logger;
+
+static constexpr size_t minRingCapacity = 4096;
+
+static size_t roundUpToPowerOfTwo(const size_t val) noexcept
+{
+    size_t capacity = minRingCapacity;
+    while (capacity < val)
+        capacity <<= 1;
+    return capacity;
+}
+
+static constexpr uint32_t alignToSlot(const size_t size) noexcept
+{
+    return static_cast<uint32_t>((size + 7) & ~static_cast<size_t>(7));
+}
+
+std::string_view RecordArena::const_iterator::operator*() const noexcept
+{
+    LengthType len = 0;
+    std::memcpy(&len, m_Pos, sizeof(LengthType));
+    return std::string_view(m_Pos + sizeof(LengthType), len & ~deferredRecordFlag);
+}
+
+RecordKind RecordArena::const_iterator::kind() const noexcept
+{
+    LengthType len = 0;
+    std::memcpy(&len, m_Pos, sizeof(LengthType));
+    return (len & deferredRecordFlag) ? RecordKind::DEFERRED : RecordKind::TEXT;
+}
+
+RecordArena::const_iterator& RecordArena::const_iterator::operator++() noexcept
+{
+    LengthType len = 0;
+    std::memcpy(&len, m_Pos, sizeof(LengthType));
+    m_Pos += sizeof(LengthType) + (len & ~deferredRecordFlag);
+    return *this;
+}
+
+void RecordArena::append(const std::string_view record, const RecordKind kind)
+{
+    auto len = static_cast<LengthType>(record.size());
+    auto offset = m_Buffer.size();
+    m_Buffer.resize(offset + sizeof(LengthType) + len);
+    if (RecordKind::DEFERRED == kind)
+        len |= deferredRecordFlag;
+    std::memcpy(m_Buffer.data() + offset, &len, sizeof(LengthType));
+    std::memcpy(m_Buffer.data() + offset + sizeof(LengthType), record.data(), record.size());
+    ++m_RecordsCnt;
+}
+
+RecordRing::RecordRing(const size_t capacity, const OverflowPolicy policy, const bool isStamped)
+    : m_Capacity(roundUpToPowerOfTwo(capacity))
+    , m_Mask(m_Capacity - 1)
+    , m_PayloadOffset(sizeof(RecordHeader) + (isStamped ? sizeof(uint64_t) : 0))
+    , m_Buffer(std::make_unique<char[]>(m_Capacity))  // Zero initialized, i.e. nothing published
+    , m_Policy(policy)
+    , m_DroppedCnt(0)
+    , m_ReadLock()
+    , m_WritePos(0)
+    , m_PushedCnt(0)
+    , m_ReadPos(0)
+    , m_ReleasedCnt(0)
+{
+}
+
+void RecordRing::publish(RecordHeader* pHeader, const uint32_t slotSize) noexcept
+{
+    std::atomic_ref<uint32_t>(pHeader->m_SlotSize).store(slotSize, std::memory_order_release);
+}
+
+uint32_t RecordRing::publishedSlotSize(RecordHeader* pHeader) const noexcept
+{
+    return std::atomic_ref<uint32_t>(pHeader->m_SlotSize).load(std::memory_order_acquire);
+}
+
+void RecordRing::release(RecordHeader* pHeader, const uint32_t slotSize, const uint64_t nextPos) noexcept
+{
+    // The released slot is zeroed, so that a header reserved later on
+    // anywhere inside of it reads as not yet published
+    std::memset(static_cast<void*>(pHeader), 0, slotSize);
+    m_ReadPos.store(nextPos, std::memory_order_release);
+}
+
+bool RecordRing::tryPush(const std::string_view record, const RecordKind kind)
+{
+    const auto slotSize = alignToSlot(m_PayloadOffset + record.size());
+    auto pos = m_WritePos.load(std::memory_order_relaxed);
+    uint64_t padSize = 0;
+    while (true)
+    {
+        // A record never wraps around, the rest of the ring is
+        // filled up with a padding slot if the record doesn't fit
+        auto offset = pos & m_Mask;
+        padSize = (offset + slotSize > m_Capacity) ? m_Capacity - offset : 0;
+        auto readPos = m_ReadPos.load(std::memory_order_acquire);
+        if (pos + padSize + slotSize - readPos > m_Capacity)
+            return false;   // Full
+        // Sequentially consistent, so that a consumer going idle either sees
+        // the record or is seen as idle by the producer (see LoggingOps::push)
+        if (m_WritePos.compare_exchange_weak(pos, pos + padSize + slotSize, std::memory_order_seq_cst, std::memory_order_relaxed))
+            break;
+    }
+
+    if (padSize)
+        publish(headerAt(pos), static_cast<uint32_t>(padSize) | m_PaddingFlag);
+
+    auto pHeader = headerAt(pos + padSize);
+    pHeader->m_DataSize = static_cast<uint32_t>(record.size()) | ((RecordKind::DEFERRED == kind) ? deferredRecordFlag : 0);
+    if (isStamped())
+    {
+        auto stamp = stampNow();
+        std::memcpy(reinterpret_cast<char*>(pHeader) + sizeof(RecordHeader), &stamp, sizeof(stamp));
+    }
+    std::memcpy(reinterpret_cast<char*>(pHeader) + m_PayloadOffset, record.data(), record.size());
+    m_PushedCnt.fetch_add(1, std::memory_order_relaxed);
+    publish(pHeader, slotSize);
+    return true;
+}
+
+size_t RecordRing::drain(RecordArena& arena)
+{
+    return drainTo([&arena](const std::string_view record, const RecordKind kind, const char* /*pStamp*/)
+    {
+        arena.append(record, kind);
+        return true;
+    });
+}
+
+size_t RecordRing::drain(RecordArena& arena, std::vector<uint64_t>& stamps, const uint64_t maxStamp)
+{
+    const auto stamped = isStamped();
+    return drainTo([&arena, &stamps, stamped, maxStamp](const std::string_view record, const RecordKind kind, const char* pStamp)
+    {
+        uint64_t stamp = 0;
+        if (stamped)
+            std::memcpy(&stamp, pStamp, sizeof(stamp));
+        if (stamp > maxStamp)
+            return false;
+        arena.append(record, kind);
+        stamps.push_back(stamp);
+        return true;
+    });
+}
+
+/*static*/ uint64_t RecordRing::stampNow() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void RecordRing::lockRead() noexcept
+{
+    while (m_ReadLock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+}
+
+template<typename Append>
+size_t RecordRing::drainTo(Append&& append)
+{
+    // The lock is taken for a single slot at a time, not for the whole drain, so
+    // a producer discarding the oldest record waits for one record copy at most.
+    // The read position is looked at again every time, the producer may have
+    // moved it in the mean time
+    size_t cnt = 0;
+    auto isDone = false;
+    while (!isDone)
+    {
+        lockRead();
+        auto pos = m_ReadPos.load(std::memory_order_relaxed);
+        auto pHeader = headerAt(pos);
+        auto slotSize = publishedSlotSize(pHeader);
+        isDone = (slotSize == 0);   // Empty, or the next record is still being written
+        if (!isDone)
+        {
+            auto isPadding = slotSize & m_PaddingFlag;
+            slotSize &= ~m_PaddingFlag;
+            if (!isPadding)
+            {
+                auto dataSize = pHeader->m_DataSize;
+                isDone = !append(std::string_view(reinterpret_cast<char*>(pHeader) + m_PayloadOffset, dataSize & ~deferredRecordFlag),
+                                 (dataSize & deferredRecordFlag) ? RecordKind::DEFERRED : RecordKind::TEXT,
+                                 reinterpret_cast<const char*>(pHeader) + sizeof(RecordHeader));
+                if (!isDone)    // Otherwise left for the next drain
+                {
+                    m_ReleasedCnt.store(m_ReleasedCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    ++cnt;
+                }
+            }
+            if (!isDone)
+                release(pHeader, slotSize, pos + slotSize);
+        }
+        m_ReadLock.clear(std::memory_order_release);
+    }
+    return cnt;
+}
+
+bool RecordRing::discardOldest()
+{
+    lockRead();
+
+    bool discarded = false;
+    auto pos = m_ReadPos.load(std::memory_order_relaxed);
+    while (!discarded)
+    {
+        auto pHeader = headerAt(pos);
+        auto slotSize = publishedSlotSize(pHeader);
+        if (slotSize == 0)
+            break;
+
+        discarded = !(slotSize & m_PaddingFlag);
+        slotSize &= ~m_PaddingFlag;
+        pos += slotSize;
+        release(pHeader, slotSize, pos);
+    }
+
+    if (discarded)
+        m_ReleasedCnt.store(m_ReleasedCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_ReadLock.clear(std::memory_order_release);
+    if (discarded)
+        m_DroppedCnt.fetch_add(1, std::memory_order_relaxed);
+    return discarded;
+}
+
+size_t RecordRing::pendingBytes() const noexcept
+{
+    auto readPos = m_ReadPos.load(std::memory_order_seq_cst);
+    auto writePos = m_WritePos.load(std::memory_order_seq_cst);
+    return writePos > readPos ? static_cast<size_t>(writePos - readPos) : 0;
+}
+
+size_t RecordRing::pendingRecords() const noexcept
+{
+    auto releasedCnt = m_ReleasedCnt.load(std::memory_order_relaxed);
+    auto pushedCnt = m_PushedCnt.load(std::memory_order_relaxed);
+    return pushedCnt > releasedCnt ? static_cast<size_t>(pushedCnt - releasedCnt) : 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: TraceSpan.cpp
+ * Description: Implementation of the TraceSpan class.
+ * See TraceSpan.hpp for class definition and documentation.
+ */
+
+#include "TraceSpan.hpp"
+#include "LogHelper.hpp"
+
+#include <algorithm>
+
+using namespace logger;
+
+// Constant initialized, so that the spans of other static objects see them
+/*static*/constinit std::atomic<uint32_t> TraceSpan::m_SampleEvery(1);
+/*static*/constinit std::atomic<int64_t> TraceSpan::m_MinDurationNs(0);
+
+/*static*/void TraceSpan::setSampling(const uint32_t everyNth) noexcept
+{
+    m_SampleEvery.store(std::max<uint32_t>(everyNth, 1), std::memory_order_relaxed);
+}
+
+/*static*/void TraceSpan::setMinDuration(const std::chrono::nanoseconds minDuration) noexcept
+{
+    m_MinDurationNs.store(std::max<int64_t>(minDuration.count(), 0), std::memory_order_relaxed);
+}
+
+void TraceSpan::finish() noexcept
+{
+    const int64_t durationNs = nowNs() - m_StartNs;
+    if (durationNs < m_MinDurationNs.load(std::memory_order_relaxed))
+        return;
+
+    try
+    {
+        const auto everyNth = getSampling();
+        if (everyNth > 1)
+            log_fields(*m_pSite, m_Name, kv("duration_ns", durationNs), kv("sample_every", everyNth));
+        else
+            log_fields(*m_pSite, m_Name, kv("duration_ns", durationNs));
+    }
+    catch (...)
+    {
+        // A destructor must not throw, it is reported along with the others
+        loggingOps.addRaisedException(std::current_exception());
+    }
+}
@@ -0,0 +1,283 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file BinaryLogTest.cpp
+ * @brief Unit tests for the binary log format.
+ *
+ * This file contains tests that verify a binary log renders back to exactly
+ * the lines the deferred records render to, that the string table entries are
+ * written only once, that corrupt data is reported and that FileOps writes,
+ * rotates and reads back the binary log files.
+ */
+
+#include "BinaryLog.hpp"
+#include "DeferredRecord.hpp"
+#include "FileOps.hpp"
+#include "CommonFunc.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class BinaryLogTest : public CommonTestDataGenerator
+{
+    protected:
+        static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_WARN, FORWARD_ANGLE};
+        static constexpr CallSite otherSite{__FILE__, "int main()", 42, LOG_TYPE::LOG_INFO, ""};
+
+        /**
+         * @brief Encode a deferred record and render it the way the watcher thread would
+         */
+        template<typename ...Args>
+        static std::string encodeDeferred(std::string& rendered, const CallSite& callSite,
+                                          const std::string_view formatStr, const Args&... args)
+        {
+            std::string record;
+            DeferredRecord::encode(record, callSite, std::this_thread::get_id(), std::chrono::system_clock::now(), formatStr, args...);
+            DeferredRecord::render(record, rendered);
+            return record;
+        }
+};
+
+TEST_F(BinaryLogTest, testRenderMatchesDeferredRecords)
+{
+    std::vector<std::string> records;
+    std::vector<std::string> expected;
+    std::string rendered;
+    const char* nullStr = nullptr;
+    int8_t small = -8;
+    uint16_t word = 65535;
+
+    records.push_back(encodeDeferred(rendered, site, "No arguments at all"));
+    expected.push_back(rendered);
+    records.push_back(encodeDeferred(rendered, site, "{} {:#08x} {:.3f} {} {} {}", -42, 255u, 3.14159, true, 'c', 1.5f));
+    expected.push_back(rendered);
+    records.push_back(encodeDeferred(rendered, otherSite, "{}, {}, {}, [{}]", std::string("std::string"), std::string_view("view"), "literal", nullStr));
+    expected.push_back(rendered);
+    records.push_back(encodeDeferred(rendered, otherSite, "{:>10}|{:<5}|{:^7}|", std::string("right"), 7LL, small));
+    expected.push_back(rendered);
+    records.push_back(encodeDeferred(rendered, site, "{{escaped}} {1} {0} {1:+}", word, -1234567890123LL));
+    expected.push_back(rendered);
+    records.push_back(encodeDeferred(rendered, site, "{:e} {:g} {:c}", 1.25L, 0.1, 65));
+    expected.push_back(rendered);
+
+    // A structured record renders the same way as the live one, the fields in logfmt
+    records.emplace_back();
+    DeferredRecord::encodeFields(records.back(), otherSite, std::this_thread::get_id(), std::chrono::system_clock::now(),
+                                 "Request served", kv("path", std::string("/index.html")), kv("status", word),
+                                 kv("ok", true), kv("note", "two words"), kv("ratio", 0.25f), kv("sign", '='), kv("delta", small));
+    DeferredRecord::render(records.back(), rendered);
+    EXPECT_TRUE(rendered.ends_with(" Request served path=/index.html status=65535 ok=true note=\"two words\""
+                                   " ratio=0.25 sign=\"=\" delta=-8")) << rendered;
+    expected.push_back(rendered);
+
+    BinaryLogWriter writer;
+    std::string data;
+    BinaryLogWriter::appendFileHeader(data);
+    for (const auto& record : records)
+        writer.append(record, RecordKind::DEFERRED, data);
+    writer.append("Plain text record", RecordKind::TEXT, data);
+    expected.push_back("Plain text record");
+
+    ASSERT_TRUE(BinaryLogReader::isBinaryLog(data));
+    BinaryLogReader reader(data);
+    std::string line;
+    for (const auto& expectedLine : expected)
+    {
+        ASSERT_TRUE(reader.next(line));
+        EXPECT_EQ(expectedLine, line);
+    }
+    EXPECT_FALSE(reader.next(line));
+
+    std::string text;
+    BinaryLogReader::decode(data, text);
+    std::string expectedText;
+    for (const auto& expectedLine : expected)
+        expectedText.append(expectedLine).push_back('\n');
+    EXPECT_EQ(expectedText, text);
+}
+
+TEST_F(BinaryLogTest, testFormatErrorIsNotLost)
+{
+    std::string rendered;
+    auto record = encodeDeferred(rendered, site, "Missing argument {} {}", 1);
+
+    BinaryLogWriter writer;
+    std::string data;
+    BinaryLogWriter::appendFileHeader(data);
+    writer.append(record, RecordKind::DEFERRED, data);
+
+    BinaryLogReader reader(data);
+    std::string line;
+    ASSERT_TRUE(reader.next(line));
+    EXPECT_NE(std::string::npos, line.find("Missing argument {} {}")) << line;
+    EXPECT_NE(std::string::npos, line.find("FORMAT ERROR")) << line;
+}
+
+TEST_F(BinaryLogTest, testTablesAreWrittenOnce)
+{
+    std::string rendered;
+    auto record = encodeDeferred(rendered, site, "Request {} took {} us from {}", 7, 250, std::string("client"));
+
+    BinaryLogWriter writer;
+    std::string data;
+    writer.append(record, RecordKind::DEFERRED, data);
+    auto firstSize = data.size();
+    data.clear();
+    writer.append(record, RecordKind::DEFERRED, data);
+    auto nextSize = data.size();
+
+    // Only the IDs, the time stamp delta and the packed arguments are left
+    EXPECT_LT(nextSize, firstSize);
+    EXPECT_LT(nextSize, 32u);
+    EXPECT_LT(nextSize * 4, rendered.size());
+
+    // A new session writes the tables once more
+    writer.reset();
+    data.clear();
+    writer.append(record, RecordKind::DEFERRED, data);
+    EXPECT_EQ(firstSize, data.size());
+}
+
+TEST_F(BinaryLogTest, testCorruptDataIsReported)
+{
+    EXPECT_FALSE(BinaryLogReader::isBinaryLog("Plain text"));
+    EXPECT_THROW(BinaryLogReader("Plain text"), std::runtime_error);
+
+    std::string rendered;
+    auto record = encodeDeferred(rendered, site, "Value {}", 12345);
+    BinaryLogWriter writer;
+    std::string data;
+    BinaryLogWriter::appendFileHeader(data);
+    writer.append(record, RecordKind::DEFERRED, data);
+    data.pop_back();
+
+    BinaryLogReader reader(data);
+    std::string line;
+    EXPECT_THROW(reader.next(line), std::runtime_error);
+}
+
+TEST_F(BinaryLogTest, testFileOpsBinaryFormat)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName("bin_", ".blog");
+    FileOps file(maxFileSize, fileName);
+    file.setFileFormat(FileFormat::BINARY);
+    EXPECT_EQ(FileFormat::BINARY, file.getFileFormat());
+    EXPECT_TRUE(file.keepsDeferredRecords());
+
+    std::vector<std::string> expected;
+    std::string rendered;
+    for (auto cnt = 0; cnt < 100; ++cnt)
+    {
+        file.writeDeferred(encodeDeferred(rendered, site, "Record {} of {}", cnt, std::string("the test")));
+        expected.push_back(rendered);
+    }
+    file.write("Text record");
+    expected.push_back("Text record");
+    file.flush();
+
+    std::ifstream rawFile(file.getFilePathObj(), std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(rawFile)), std::istreambuf_iterator<char>());
+    EXPECT_TRUE(BinaryLogReader::isBinaryLog(data));
+
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 2, 100, lines));
+    EXPECT_EQ(std::vector<std::string>(expected.begin() + 1, expected.begin() + 100), lines);
+
+    file.readFile();
+    auto fileContents = file.getFileContent();
+    ASSERT_EQ(expected.size(), fileContents.size());
+    EXPECT_EQ(expected.front(), fileContents.front());
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(BinaryLogTest, testMappedBinaryFileReopened)
+{
+    // The last byte of the record is a zero, which is no sign of a crash
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName("binmmap_", ".blog");
+    removeRotatedFiles(fileName);
+    std::vector<std::string> expected;
+    std::string rendered;
+    std::filesystem::path markerPath;
+    for (auto cnt = 0; cnt < 2; ++cnt)
+    {
+        FileOps file(maxFileSize, fileName);
+        file.setFileFormat(FileFormat::BINARY);
+        file.setFileIoMode(FileIoMode::MMAP);
+        file.writeDeferred(encodeDeferred(rendered, site, "count {}", 0));
+        expected.push_back(rendered);
+        file.flush();
+        markerPath = file.getFilePathObj().parent_path() / ("." + fileName + ".mapped");
+        EXPECT_TRUE(std::filesystem::exists(markerPath));
+        EXPECT_TRUE(file.getAllExceptions().empty());
+    }
+    EXPECT_FALSE(std::filesystem::exists(markerPath));
+
+    // Appended to rather than rotated away
+    auto files = rotatedFiles(baseNameOf(fileName));
+    ASSERT_EQ(1u, files.size());
+    std::ifstream rawFile(files.front().path(), std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(rawFile)), std::istreambuf_iterator<char>());
+    EXPECT_EQ('\0', data.back());
+    std::string text;
+    ASSERT_NO_THROW(BinaryLogReader::decode(data, text));
+    EXPECT_EQ(expected[0] + "\n" + expected[1] + "\n", text);
+}
+
+TEST_F(BinaryLogTest, testBinaryRotation)
+{
+    std::uintmax_t maxFileSize = 4096;
+    auto fileName = generateRandomFileName("binrot_", ".blog");
+    removeRotatedFiles(fileName);
+    std::vector<std::string> expected;
+    {
+        FileOps file(maxFileSize, fileName);
+        file.setFileFormat(FileFormat::BINARY);
+        std::string rendered;
+        for (auto cnt = 0; cnt < 2000; ++cnt)
+        {
+            file.writeDeferred(encodeDeferred(rendered, (cnt % 2) ? site : otherSite, "Record {} {}", cnt, 0.5 * cnt));
+            expected.push_back(rendered);
+        }
+        file.flush();
+    }
+
+    // Every file comes with its own tables, so each of them decodes on its own
+    size_t linesCnt = 0;
+    auto files = rotatedFiles(baseNameOf(fileName));
+    for (const auto& entry : files)
+    {
+        EXPECT_LE(entry.file_size(), maxFileSize);
+        std::ifstream rawFile(entry.path(), std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(rawFile)), std::istreambuf_iterator<char>());
+        std::string text;
+        ASSERT_NO_THROW(BinaryLogReader::decode(data, text));
+        linesCnt += static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    }
+    EXPECT_GT(files.size(), 1u);
+    EXPECT_EQ(expected.size(), linesCnt);
+}
@@ -0,0 +1,261 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file BlockCompressionTest.cpp
+ * @brief Unit tests for the BlockCompression class and the compressed log files.
+ *
+ * This file contains tests that verify the blocks decompress to exactly the
+ * data compressed, that the file layout is the same byte for byte on every
+ * host, that a truncated last block doesn't take the blocks before
+ * it along, and that FileOps writes, rotates and reads back compressed files
+ * transparently for both the text and the binary format.
+ */
+
+#include "BlockCompression.hpp"
+#include "DeferredRecord.hpp"
+#include "FileOps.hpp"
+#include "CommonFunc.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class BlockCompressionTest : public CommonTestDataGenerator
+{
+    protected:
+        static std::string roundTrip(const std::string_view raw)
+        {
+            std::string data;
+            BlockCompression::appendFileHeader(data);
+            BlockCompression::appendBlock(raw, data);
+            std::string decompressed;
+            EXPECT_TRUE(BlockCompression::decompress(data, decompressed));
+            return decompressed;
+        }
+
+        static std::string readRaw(const std::filesystem::path& file)
+        {
+            std::ifstream rawFile(file, std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(rawFile)), std::istreambuf_iterator<char>());
+        }
+};
+
+TEST_F(BlockCompressionTest, testRoundTrip)
+{
+    EXPECT_EQ("", roundTrip(""));
+    EXPECT_EQ("abc", roundTrip("abc"));
+    EXPECT_EQ(std::string(100000, 'a'), roundTrip(std::string(100000, 'a')));   // Overlapping matches
+
+    std::string random = generateRandomText(300000);
+    EXPECT_EQ(random, roundTrip(random));
+
+    std::string lines;
+    for (size_t cnt = 0; cnt < 5000; ++cnt)
+        lines.append(logLine(cnt)).push_back('\n');
+    EXPECT_EQ(lines, roundTrip(lines));
+
+    // The log lines repeat a lot, so they compress well
+    std::string data;
+    BlockCompression::appendBlock(lines, data);
+    EXPECT_LT(data.size() * 5, lines.size());
+}
+
+TEST_F(BlockCompressionTest, testFileLayout)
+{
+    // A block compressed, the sizes little endian, and one stored as is
+    using namespace std::string_literals;
+    const auto expected = "\x7FLGZ\x01"s
+                          "\x0B\x00\x00\x00" "\x20\x00\x00\x00"
+                          "\x1F" "a" "\x01\x00" "\x07" "\x50" "aaaaa"s
+                          "\x03\x00\x00\x80" "\x03\x00\x00\x00" "abc"s;
+    std::string data;
+    BlockCompression::appendFileHeader(data);
+    BlockCompression::appendBlock(std::string(32, 'a'), data);
+    BlockCompression::appendBlock("abc", data);
+    EXPECT_EQ(expected, data);
+
+    std::string decompressed;
+    EXPECT_TRUE(BlockCompression::decompress(expected, decompressed));
+    EXPECT_EQ(std::string(32, 'a') + "abc", decompressed);
+}
+
+TEST_F(BlockCompressionTest, testTruncatedLastBlock)
+{
+    std::string first = logLine(1) + "\n" + logLine(2) + "\n";
+    std::string data;
+    BlockCompression::appendFileHeader(data);
+    BlockCompression::appendBlock(first, data);
+    BlockCompression::appendBlock(logLine(3), data);
+    data.resize(data.size() - 3);
+
+    std::string decompressed;
+    EXPECT_FALSE(BlockCompression::decompress(data, decompressed));
+    EXPECT_EQ(first, decompressed);
+
+    EXPECT_FALSE(BlockCompression::isCompressed("Plain text"));
+    EXPECT_THROW(BlockCompression::decompress("Plain text", decompressed), std::runtime_error);
+}
+
+TEST_F(BlockCompressionTest, testCorruptBlockIsReported)
+{
+    std::string lines;
+    for (size_t cnt = 0; cnt < 100; ++cnt)
+        lines.append(logLine(cnt)).push_back('\n');
+    std::string data;
+    BlockCompression::appendFileHeader(data);
+    BlockCompression::appendBlock(lines, data);
+    // Make the raw size of the block wrong
+    data[compressedLogMagic.size() + 1 + sizeof(uint32_t)] ^= 0x01;
+
+    std::string decompressed;
+    EXPECT_THROW(BlockCompression::decompress(data, decompressed), std::runtime_error);
+}
+
+TEST_F(BlockCompressionTest, testCompressedTextFile)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName("lz4_");
+    FileOps file(maxFileSize, fileName);
+    file.setFileCompression(FileCompression::LZ4);
+    EXPECT_EQ(FileCompression::LZ4, file.getFileCompression());
+
+    std::vector<std::string> expected;
+    std::string expectedContent;
+    for (size_t cnt = 0; cnt < 2000; ++cnt)
+    {
+        expected.push_back(logLine(cnt));
+        expectedContent.append(expected.back()).push_back('\n');
+        file.write(expected.back());
+        if (cnt % 500 == 0)
+            file.flush();   // More than a single block
+    }
+    file.flush();
+
+    auto raw = readRaw(file.getFilePathObj());
+    EXPECT_TRUE(BlockCompression::isCompressed(raw));
+    EXPECT_LT(raw.size() * 5, expectedContent.size());
+
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 11, 20, lines));
+    EXPECT_EQ(std::vector<std::string>(expected.begin() + 10, expected.begin() + 20), lines);
+
+    std::vector<char> bytes;
+    ASSERT_TRUE(FileOps::readFileByteRange(file, 0, static_cast<std::streamoff>(expectedContent.size()), bytes));
+    EXPECT_EQ(expectedContent, std::string(bytes.begin(), bytes.end()));
+
+    file.readFile();
+    EXPECT_EQ(expected.size(), file.getFileContent().size());
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(BlockCompressionTest, testCompressedBinaryFile)
+{
+    static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_INFO, ""};
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName("lz4bin_", ".blog");
+    FileOps file(maxFileSize, fileName);
+    file.setFileFormat(FileFormat::BINARY)
+        .setFileCompression(FileCompression::LZ4);
+
+    std::vector<std::string> expected;
+    std::string record;
+    std::string rendered;
+    for (auto cnt = 0; cnt < 500; ++cnt)
+    {
+        DeferredRecord::encode(record, site, std::this_thread::get_id(), std::chrono::system_clock::now(),
+                               "Record {} of {}", cnt, std::string("the test"));
+        DeferredRecord::render(record, rendered);
+        file.writeDeferred(record);
+        expected.push_back(rendered);
+    }
+    file.flush();
+
+    EXPECT_TRUE(BlockCompression::isCompressed(readRaw(file.getFilePathObj())));
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1, 499, lines));
+    EXPECT_EQ(std::vector<std::string>(expected.begin(), expected.begin() + 499), lines);
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(BlockCompressionTest, testCompressedRotation)
+{
+    std::uintmax_t maxFileSize = 4096;
+    auto fileName = generateRandomFileName("lz4rot_");
+    removeRotatedFiles(fileName);
+    size_t recordsCnt = 20000;
+    {
+        FileOps file(maxFileSize, fileName);
+        file.setFileCompression(FileCompression::LZ4);
+        for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+            file.write(logLine(cnt));
+        file.flush();
+    }
+
+    // Every file is compressed on its own, so each of them decompresses on its own
+    size_t linesCnt = 0;
+    auto files = rotatedFiles(baseNameOf(fileName));
+    for (const auto& entry : files)
+    {
+        std::string content;
+        EXPECT_TRUE(BlockCompression::decompress(readRaw(entry.path()), content));
+        linesCnt += static_cast<size_t>(std::count(content.begin(), content.end(), '\n'));
+    }
+    EXPECT_GT(files.size(), 1u);
+    EXPECT_EQ(recordsCnt, linesCnt);
+}
+
+TEST_F(BlockCompressionTest, testCompressedMappedFile)
+{
+    static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_INFO, ""};
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName("lz4mmap_", ".blog");
+    FileOps file(maxFileSize, fileName);
+    file.setFileFormat(FileFormat::BINARY)
+        .setFileCompression(FileCompression::LZ4)
+        .setFileIoMode(FileIoMode::MMAP);
+
+    std::vector<std::string> expected;
+    std::string record;
+    std::string rendered;
+    for (auto cnt = 0; cnt < 500; ++cnt)
+    {
+        DeferredRecord::encode(record, site, std::this_thread::get_id(), std::chrono::system_clock::now(),
+                               "Record {} of {}", cnt, std::string("the mapped file"));
+        DeferredRecord::render(record, rendered);
+        file.writeDeferred(record);
+        expected.push_back(rendered);
+    }
+    file.flush();
+
+    // The zeroes past the last block, still to be written to, are no record
+    auto raw = readRaw(file.getFilePathObj());
+    EXPECT_EQ(maxFileSize, raw.size());
+    std::string content;
+    EXPECT_TRUE(BlockCompression::decompress(raw, content));
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1, 499, lines));
+    EXPECT_EQ(std::vector<std::string>(expected.begin(), expected.begin() + 499), lines);
+    ASSERT_TRUE(file.deleteFile());
+}
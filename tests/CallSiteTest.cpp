@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file CallSiteTest.cpp
+ * @brief Unit tests for the CallSite class.
+ *
+ * This file contains tests that verify the extraction of the file base name,
+ * the class name and the function name out of __FILE__ and __PRETTY_FUNCTION__
+ * for free functions, member functions, operators, templates and lambdas,
+ * and that the LOG_* statements carry the descriptor of their own call site.
+ */
+
+#include "Logger.hpp"
+#include "LOGGER_MACROS.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace logger;
+
+namespace
+{
+    constexpr CallSite makeSite(const std::string_view prettyFunc)
+    {
+        return CallSite("/home/user/src/Some/Dir/Source.cpp", prettyFunc, 42, LOG_TYPE::LOG_INFO, FORWARD_ANGLE);
+    }
+
+    // Everything is computed by the compiler
+    static_assert(makeSite("int main()").fileName() == "Source.cpp");
+    static_assert(makeSite("int main()").className().empty());
+    static_assert(makeSite("int main()").functionName() == "main");
+    static_assert(makeSite("int main()").line() == 42);
+    static_assert(makeSite("int main()").type() == LOG_TYPE::LOG_INFO);
+    static_assert(makeSite("int main()").marker() == FORWARD_ANGLE);
+
+    struct SiteOfMember
+    {
+        const CallSite& member() const
+        {
+            static constexpr CallSite site(__FILE__, __PRETTY_FUNCTION__, __LINE__, LOG_TYPE::LOG_ERR, FORWARD_ANGLE);
+            return site;
+        }
+    };
+}
+
+TEST(CallSiteTest, testClassAndFunctionNames)
+{
+    struct Expected
+    {
+        std::string_view prettyFunc;
+        std::string_view className;
+        std::string_view funcName;
+        bool isLambda;
+    };
+    const Expected expected[] =
+    {
+        { "void freeFunc(int)",                                                 "",             "freeFunc",         false },
+        { "virtual void LoggerTest_testLogInfo_Test::TestBody()",               "LoggerTest_testLogInfo_Test",  "TestBody", false },
+        { "static std::unique_ptr<std::__cxx11::basic_string<char> > LoggerTest::funcReturnUniquePtr()",
+                                                                                "LoggerTest",   "funcReturnUniquePtr", false },
+        { "int* logger::Ns::Vec<X>::at(int, int) const [with X = int]",         "Vec",          "at",               false },
+        { "bool Foo::operator<(const Foo&) const",                              "Foo",          "operator<",        false },
+        { "Foo::operator bool() const",                                         "Foo",          "operator bool",    false },
+        { "void Foo::bar<int>(int)::<lambda(const string&)>",                   "Foo",          "bar",              true  },
+        { "auto Foo::bar()::(anonymous class)::operator()(const std::string &) const",
+                                                                                "Foo",          "bar",              true  },
+        { "auto Foo::bar()::(lambda at Source.cpp:10:5)::operator()() const",   "Foo",          "bar",              true  },
+    };
+
+    for (const auto& exp : expected)
+    {
+        CallSite site("Source.cpp", exp.prettyFunc, 1, LOG_TYPE::LOG_INFO, FORWARD_ANGLE);
+        EXPECT_EQ(exp.className, site.className()) << exp.prettyFunc;
+        EXPECT_EQ(exp.funcName, site.functionName()) << exp.prettyFunc;
+        EXPECT_EQ(exp.isLambda, site.isLambda()) << exp.prettyFunc;
+    }
+}
+
+TEST(CallSiteTest, testSiteOfTheCompiler)
+{
+    const auto& site = SiteOfMember().member();
+    EXPECT_EQ("CallSiteTest.cpp", site.fileName());
+    EXPECT_EQ("SiteOfMember", site.className());
+    EXPECT_EQ("member", site.functionName());
+    EXPECT_EQ(LOG_TYPE::LOG_ERR, site.type());
+
+    auto lambda = []()
+    {
+        static constexpr CallSite site(__FILE__, __PRETTY_FUNCTION__, __LINE__, LOG_TYPE::LOG_INFO, FORWARD_ANGLE);
+        return site.isLambda();
+    };
+    EXPECT_TRUE(lambda());
+}
+
+TEST(CallSiteTest, testLogStatementUsesItsCallSite)
+{
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LOG_WARN("Logged from line {}", __LINE__);
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    auto record = loggerObj.getLogRecord();
+    EXPECT_NE(std::string::npos, record.find("CallSiteTest.cpp")) << record;
+    EXPECT_NE(std::string::npos, record.find("[CallSiteTest_testLogStatementUsesItsCallSite_Test : TestBody]")) << record;
+    EXPECT_NE(std::string::npos, record.find(Logger::covertLogTypeEnumToString(LOG_TYPE::LOG_WARN))) << record;
+}
@@ -103,6 +103,46 @@ TEST_F(ClockTests, testGetLocalTimeStr)
     }
 }
 
+TEST_F(ClockTests, testFormatLocalTime)
+{
+    auto formattedLocalTime = [](const std::string_view format)
+    {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::array<char, 80> buffer;
+        std::strftime(buffer.data(), sizeof(buffer), format.data(), std::localtime(&now));
+        return std::string(buffer.data());
+    };
+
+    std::array<char, 80> buffer;
+    {
+        // Same as the uncached path, also when served from the cache
+        for (int i = 0; i < 2; ++i)
+        {
+            auto len = clock.formatLocalTime(buffer.data(), buffer.size());
+            auto expLocalTimeStr = formattedLocalTime("%d/%m/%Y %H:%M:%S");
+            EXPECT_EQ(len, expLocalTimeStr.size());
+            EXPECT_STREQ(buffer.data(), expLocalTimeStr.c_str());
+        }
+    }
+    {
+        Clock fmtClock("%Y%m%d_%H%M%S");
+        auto len = fmtClock.formatLocalTime(buffer.data(), buffer.size(), 3);
+        auto expLocalTimeStr = formattedLocalTime("%Y%m%d_%H%M%S");
+        ASSERT_EQ(len, expLocalTimeStr.size() + 4);
+        EXPECT_EQ(std::string_view(buffer.data(), expLocalTimeStr.size()), expLocalTimeStr);
+        EXPECT_EQ(buffer[expLocalTimeStr.size()], '.');
+        for (auto pos = expLocalTimeStr.size() + 1; pos < len; ++pos)
+            EXPECT_TRUE(std::isdigit(buffer[pos]));
+
+        // More than nanoseconds are not available
+        EXPECT_EQ(fmtClock.formatLocalTime(buffer.data(), buffer.size(), 12), expLocalTimeStr.size() + 10);
+    }
+    {
+        // Too small buffer
+        EXPECT_EQ(clock.formatLocalTime(buffer.data(), 8), 0u);
+    }
+}
+
 TEST_F(ClockTests, testGetGmtTimeStr)
 {
     auto formattedGmtTime = [](const std::string_view format, const time_t* time)
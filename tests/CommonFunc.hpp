@@ -39,6 +39,7 @@
 #include <string>
 #include <vector>
 #include <random>
+#include <filesystem>
 
 #include <gtest/gtest.h>
 
@@ -195,6 +196,64 @@ class CommonTestDataGenerator : public ::testing::Test
             std::string randomPart = generateRandomText(8);  // 8-char random string
             return prefix + randomPart + extension;
         }
+        /**
+         * @brief Generate a log line the way the logger formats one, numbered by its count
+         */
+        static std::string logLine(const size_t cnt)
+        {
+            return std::format("|20250822_022103| 0x16b8cb000| ProducerConsumer.cpp|   28|INF>  "
+                               "[Producer : produce] Producer[{}] produces data[{}]", cnt % 16, cnt);
+        }
+        /**
+         * @brief Get the files of a log file in the current directory
+         * * The log file and the ones rotated away from it are all named after its base name,
+         * * i.e. the part of its name up to the first dot.
+         *
+         * @param baseName The base name, or any other start of the file names
+         * @return std::vector<std::filesystem::directory_entry> The regular files found
+         */
+        static std::vector<std::filesystem::directory_entry> rotatedFiles(const std::string_view baseName)
+        {
+            std::vector<std::filesystem::directory_entry> files;
+            for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::current_path()))
+            {
+                if (entry.is_regular_file() && entry.path().filename().string().starts_with(baseName))
+                    files.push_back(entry);
+            }
+            return files;
+        }
+        /**
+         * @brief Get the base name of a file name, i.e. the part of it up to the first dot
+         */
+        static std::string baseNameOf(const std::string& fileName)
+        {
+            return fileName.substr(0, fileName.find('.'));
+        }
+        /**
+         * @brief Have the files of a log file removed once the test is over, see rotatedFiles()
+         *
+         * @param fileName The name of the log file
+         */
+        void removeRotatedFiles(const std::string& fileName)
+        {
+            m_RotatedBaseNames.push_back(baseNameOf(fileName));
+        }
+
+    protected:
+        void TearDown() override
+        {
+            for (const auto& baseName : m_RotatedBaseNames)
+            {
+                for (const auto& entry : rotatedFiles(baseName))
+                {
+                    std::error_code ec;
+                    EXPECT_TRUE(std::filesystem::remove(entry.path(), ec)) << entry.path() << ": " << ec.message();
+                }
+            }
+        }
+
+    private:
+        std::vector<std::string> m_RotatedBaseNames;
 };
 
 class RandomHexGenerator
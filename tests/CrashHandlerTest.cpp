@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file CrashHandlerTest.cpp
+ * @brief Unit tests for the emergency drain and the CrashHandler class.
+ *
+ * This file contains tests that verify the records still queued, i.e. not yet
+ * picked up by the watcher thread, are written straight to the log file by
+ * LoggingOps::emergencyDrain(), and that a crashing process writes them too
+ * once the CrashHandler is installed.
+ */
+
+#include "CrashHandler.hpp"
+#include "DeferredRecord.hpp"
+#include "FileOps.hpp"
+#include "CommonFunc.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class CrashHandlerTest : public CommonTestDataGenerator
+{
+    protected:
+        static constexpr CallSite site{"CrashHandlerTest.cpp", "void Handler::handle(int)", 123, LOG_TYPE::LOG_ERR, ""};
+
+        /**
+         * @brief Get the records queued in the file, the watcher thread
+         * waits for a batch far bigger than the records written
+         */
+        static void queueRecords(FileOps& file, const size_t recordsCnt)
+        {
+            // The file is opened by the first batch
+            file.write("Written by the watcher thread");
+            file.flush();
+            file.setBatchPolicy({100000, 1 << 24, std::chrono::seconds(30)});
+            for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+                file.write(std::format("Queued record {}", cnt));
+
+            std::string record;
+            DeferredRecord::encode(record, site, std::this_thread::get_id(), std::chrono::system_clock::now(),
+                                   "Deferred record {}", 42);
+            file.writeDeferred(record);
+        }
+
+        static std::vector<std::string> expectedLines(const size_t recordsCnt)
+        {
+            std::vector<std::string> expected{"Written by the watcher thread"};
+            for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+                expected.push_back(std::format("Queued record {}", cnt));
+            expected.push_back("|CrashHandlerTest.cpp|123|ERR> [NOT FORMATTED] Deferred record {}");
+            return expected;
+        }
+
+        static std::vector<std::string> readLines(const std::filesystem::path& file)
+        {
+            std::ifstream inFile(file);
+            std::vector<std::string> lines;
+            for (std::string line; std::getline(inFile, line);)
+                lines.push_back(line);
+            return lines;
+        }
+};
+
+TEST_F(CrashHandlerTest, testEmergencyDrain)
+{
+    const size_t recordsCnt = 100;
+    auto fileName = generateRandomFileName("crash_");
+    FileOps file(1024 * 1000, fileName);
+    queueRecords(file, recordsCnt);
+
+    EXPECT_EQ(recordsCnt + 1, file.emergencyDrain());
+    EXPECT_EQ(expectedLines(recordsCnt), readLines(file.getFilePathObj()));
+
+    // They are released, so nothing is written twice
+    EXPECT_EQ(0u, file.emergencyDrain());
+    file.flush();
+    EXPECT_EQ(recordsCnt + 2, readLines(file.getFilePathObj()).size());
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(CrashHandlerTest, testInstallAndUninstall)
+{
+    FileOps file(1024 * 1000, generateRandomFileName("crash_"));
+    EXPECT_FALSE(CrashHandler::isInstalled());
+    ASSERT_TRUE(CrashHandler::install(file));
+    EXPECT_TRUE(CrashHandler::isInstalled());
+
+    struct sigaction action;
+    ASSERT_EQ(0, sigaction(SIGSEGV, nullptr, &action));
+    EXPECT_TRUE(action.sa_flags & SA_SIGINFO);
+
+    CrashHandler::uninstall();
+    EXPECT_FALSE(CrashHandler::isInstalled());
+    ASSERT_EQ(0, sigaction(SIGSEGV, nullptr, &action));
+    EXPECT_FALSE(action.sa_flags & SA_SIGINFO);
+}
+
+TEST_F(CrashHandlerTest, testCrashWritesQueuedRecords)
+{
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    const size_t recordsCnt = 100;
+    // The child process runs the test once more from the start, so the name can't be random
+    const std::string fileName = "crash_handler_test.txt";
+    FileOps::removeFile(std::filesystem::current_path() / fileName);
+    EXPECT_EXIT(
+    {
+        FileOps file(1024 * 1000, fileName);
+        queueRecords(file, recordsCnt);
+        CrashHandler::install(file);
+        raise(SIGSEGV);
+    }, testing::KilledBySignal(SIGSEGV), "Caught signal");
+
+    FileOps file(1024 * 1000, fileName);
+    EXPECT_EQ(expectedLines(recordsCnt), readLines(file.getFilePathObj()));
+    ASSERT_TRUE(file.deleteFile());
+}
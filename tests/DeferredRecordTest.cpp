@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file DeferredRecordTest.cpp
+ * @brief Unit tests for the DeferredRecord class and the deferred formatting.
+ *
+ * This file contains tests that verify which argument types can be deferred,
+ * that a deferred record renders to exactly the line the calling thread would
+ * have formatted, and that the watcher thread of LoggingOps formats the
+ * deferred records before writing them.
+ */
+
+#include "DeferredRecord.hpp"
+#include "ConsoleOps.hpp"
+#include "LOGGER_MACROS.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+static_assert(DeferredRecord::isDeferrable<>);
+static_assert(DeferredRecord::isDeferrable<int, const double&, bool, char, unsigned long long>);
+static_assert(DeferredRecord::isDeferrable<std::string, const std::string_view&, const char*, const char (&)[6]>);
+static_assert(!DeferredRecord::isDeferrable<int, std::vector<int>>);
+static_assert(!DeferredRecord::isDeferrable<const void*>);
+
+class DeferredConsoleOps : public ConsoleOps
+{
+    public:
+        DeferredConsoleOps() : ConsoleOps() { m_testing = true; }
+        inline const std::ostringstream& getTestStringStream() const { return m_testStringStream; }
+};
+
+class DeferredRecordTest : public ::testing::Test
+{
+    protected:
+        static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_WARN, FORWARD_ANGLE};
+
+        void TearDown() override
+        {
+            Logger::setDeferredFormatting(false);
+        }
+
+        template<typename ...Args>
+        static std::string renderDeferred(const std::chrono::system_clock::time_point& timeStamp,
+                                          const std::string_view formatStr, const Args&... args)
+        {
+            std::string record;
+            DeferredRecord::encode(record, site, std::this_thread::get_id(), timeStamp, formatStr, args...);
+            std::string line;
+            DeferredRecord::render(record, line);
+            return line;
+        }
+
+        static std::string renderNow(const std::chrono::system_clock::time_point& timeStamp, const std::string_view msg)
+        {
+            Logger logger(DEFAULT_TIME_FORMAT);
+            logger.setCallSite(site).setThreadId(std::this_thread::get_id());
+            logger.logFormatted(timeStamp, msg);
+            return std::string(logger.getLogRecord());
+        }
+};
+
+TEST_F(DeferredRecordTest, testRenderMatchesImmediateFormatting)
+{
+    auto now = std::chrono::system_clock::now();
+    std::string str = "std::string";
+    std::string_view strView = "std::string_view";
+    const char* nullStr = nullptr;
+
+    EXPECT_EQ(renderNow(now, "No arguments at all"), renderDeferred(now, "No arguments at all"));
+    EXPECT_EQ(renderNow(now, std::format("{} {:#08x} {:.3f} {} {} {}", -42, 255u, 3.14159, true, 'c', 1.5f)),
+              renderDeferred(now, "{} {:#08x} {:.3f} {} {} {}", -42, 255u, 3.14159, true, 'c', 1.5f));
+    EXPECT_EQ(renderNow(now, "std::string, std::string_view, literal, []"),
+              renderDeferred(now, "{}, {}, {}, [{}]", str, strView, "literal", nullStr));
+    EXPECT_EQ(renderNow(now, std::format("{:>10}|{:<5}|", std::string("right"), 7LL)),
+              renderDeferred(now, "{:>10}|{:<5}|", std::string("right"), 7LL));
+}
+
+TEST_F(DeferredRecordTest, testFormatErrorIsNotLost)
+{
+    auto line = renderDeferred(std::chrono::system_clock::now(), "Missing argument {} {}", 1);
+    EXPECT_NE(std::string::npos, line.find("Missing argument {} {}")) << line;
+    EXPECT_NE(std::string::npos, line.find("FORMAT ERROR")) << line;
+}
+
+TEST_F(DeferredRecordTest, testWatcherFormatsDeferredRecords)
+{
+    DeferredConsoleOps consoleOps;
+    std::string record;
+    DeferredRecord::encode(record, site, std::this_thread::get_id(), std::chrono::system_clock::now(),
+                           "Request {} took {} us", 7, 250);
+    consoleOps << "Plain text record";
+    consoleOps.writeDeferred(record);
+    consoleOps.flush();
+
+    auto output = consoleOps.getTestStringStream().str();
+    auto textPos = output.find("Plain text record");
+    auto deferredPos = output.find("Request 7 took 250 us");
+    ASSERT_NE(std::string::npos, textPos) << output;
+    ASSERT_NE(std::string::npos, deferredPos) << output;
+    EXPECT_LT(textPos, deferredPos);
+    EXPECT_NE(std::string::npos, output.find("[Handler : handle]")) << output;
+    EXPECT_NE(std::string::npos, output.find("DeferredRecordTest.cpp")) << output;
+}
+
+TEST_F(DeferredRecordTest, testDeferredLogStatements)
+{
+    Logger::setDeferredFormatting(true);
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LOG_INFO("Deferred {} of {} with {}", 1, 2, std::string("a string"));
+    LOG_ENTRY("Deferred entry {}", 3.5);
+    LOG_FIELDS(LOG_INFO, "Structured", kv("answer", 42), kv("unit", "none"));
+    // Pointers are not deferrable, formatted right away
+    int val = 4;
+    LOG_INFO("Immediate {}", static_cast<const void*>(&val));
+    loggingOps.flush();
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_NE(std::string::npos, loggerObj.getLogRecord().find("Immediate 0x"));
+}
@@ -0,0 +1,215 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file FanOutOpsTest.cpp
+ * @brief Unit tests for the FanOutOps class.
+ *
+ * This file contains tests that verify every sink gets the records its level
+ * lets through, that a deferred record is formatted once only, whatever the
+ * number of sinks, and that a slow sink doesn't hold back the others.
+ */
+
+#include "FanOutOps.hpp"
+#include "DeferredRecord.hpp"
+#include "CommonFunc.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+/**
+ * @brief A sink keeping the records in memory, optionally taking its time
+ * to write a batch and optionally keeping the deferred records as they are
+ */
+class MemorySink : public LoggingOps
+{
+    public:
+        explicit MemorySink(const bool keepsDeferred = false,
+                            const std::chrono::milliseconds writeDelay = std::chrono::milliseconds(0),
+                            const size_t ringCapacity = defaultRingCapacity)
+            : LoggingOps(ringCapacity)
+            , m_WriteDelay(writeDelay)
+            , m_DeferredCnt(0)
+        {
+            m_keepsDeferredRecords = keepsDeferred;
+            m_watcher = std::thread([this]() { keepWatchAndPull(); });
+        }
+
+        ~MemorySink()
+        {
+            stopWatcher();
+        }
+
+        std::vector<std::string> getRecords()
+        {
+            std::scoped_lock<std::mutex> lock(m_RecordsMtx);
+            return m_Records;
+        }
+
+        inline size_t getDeferredCount() const noexcept     { return m_DeferredCnt; }
+
+        inline const std::string getClassId() const override { return "MemorySink"; }
+
+    protected:
+        void writeDataTo(const std::string_view data) override
+        {
+            if (RecordKind::DEFERRED == pushedRecordKind())
+                ++m_DeferredCnt;
+            push(data);
+        }
+
+        void writeToOutStreamObject(const RecordArena& dataArena, std::exception_ptr& /*excpPtr*/) override
+        {
+            if (m_WriteDelay.count())
+                std::this_thread::sleep_for(m_WriteDelay);
+            std::string line;
+            std::scoped_lock<std::mutex> lock(m_RecordsMtx);
+            for (auto itr = dataArena.begin(); itr != dataArena.end(); ++itr)
+            {
+                if (RecordKind::DEFERRED == itr.kind())
+                {
+                    DeferredRecord::render(*itr, line);
+                    m_Records.push_back(line);
+                }
+                else
+                {
+                    m_Records.emplace_back(*itr);
+                }
+            }
+        }
+
+    private:
+        std::chrono::milliseconds m_WriteDelay;
+        std::atomic<size_t> m_DeferredCnt;
+        std::mutex m_RecordsMtx;
+        std::vector<std::string> m_Records;
+};
+
+class FanOutOpsTest : public CommonTestDataGenerator
+{
+    protected:
+        static constexpr CallSite warnSite{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_WARN, ""};
+        static constexpr CallSite dbgSite{__FILE__, "int main()", 42, LOG_TYPE::LOG_DBG, ""};
+
+        static std::string encodeDeferred(const CallSite& site, const int val)
+        {
+            std::string record;
+            DeferredRecord::encode(record, site, std::this_thread::get_id(), std::chrono::system_clock::now(), "Value {}", val);
+            return record;
+        }
+};
+
+TEST_F(FanOutOpsTest, testSinkLevels)
+{
+    auto console = std::make_shared<MemorySink>();
+    auto file = std::make_shared<MemorySink>();
+    FanOutOps fanOut;
+    fanOut.addSink(console, LOG_TYPE::LOG_WARN)
+          .addSink(file, LOG_TYPE::LOG_DBG);
+    EXPECT_EQ(2u, fanOut.getSinksCount());
+
+    fanOut.write("Debug", LOG_TYPE::LOG_DBG);
+    fanOut.write("Info", LOG_TYPE::LOG_INFO);
+    fanOut.write("Warning", LOG_TYPE::LOG_WARN);
+    fanOut.write("Error", LOG_TYPE::LOG_ERR);
+    fanOut.write("Fatal", LOG_TYPE::LOG_FATAL);
+    fanOut.write("No type at all");
+    fanOut.flush();
+
+    EXPECT_EQ(std::vector<std::string>({"Warning", "Error", "Fatal", "No type at all"}), console->getRecords());
+    EXPECT_EQ(std::vector<std::string>({"Debug", "Info", "Warning", "Error", "Fatal", "No type at all"}), file->getRecords());
+
+    // The level can be changed later on, and a removed sink gets nothing more
+    ASSERT_TRUE(fanOut.setSinkLevel(console, LOG_TYPE::LOG_ERR));
+    ASSERT_TRUE(fanOut.removeSink(file));
+    EXPECT_FALSE(fanOut.removeSink(file));
+    fanOut.write("Warning", LOG_TYPE::LOG_WARN);
+    fanOut.write("Error", LOG_TYPE::LOG_ERR);
+    fanOut.flush();
+    file->flush();
+    EXPECT_EQ(5u, console->getRecords().size());
+    EXPECT_EQ(6u, file->getRecords().size());
+}
+
+TEST_F(FanOutOpsTest, testDeferredRecordsAreFormattedOnce)
+{
+    auto first = std::make_shared<MemorySink>();
+    auto second = std::make_shared<MemorySink>();
+    auto keeper = std::make_shared<MemorySink>(true);
+    FanOutOps fanOut;
+    EXPECT_FALSE(fanOut.keepsDeferredRecords());
+    fanOut.addSink(first, LOG_TYPE::LOG_DBG)
+          .addSink(keeper, LOG_TYPE::LOG_DBG);
+    EXPECT_TRUE(fanOut.keepsDeferredRecords());
+
+    // A single sink formatting the record formats it on its own watcher thread
+    auto record = encodeDeferred(warnSite, 1);
+    std::string expected;
+    DeferredRecord::render(record, expected);
+    fanOut.writeDeferred(record);
+    fanOut.flush();
+    EXPECT_EQ(1u, first->getDeferredCount());
+    EXPECT_EQ(1u, keeper->getDeferredCount());
+
+    // More than one, so it is formatted once and they get the text
+    fanOut.addSink(second, LOG_TYPE::LOG_WARN);
+    fanOut.writeDeferred(record);
+    fanOut.writeDeferred(encodeDeferred(dbgSite, 2));     // Filtered out for the second one
+    fanOut.flush();
+    EXPECT_EQ(2u, first->getDeferredCount());
+    EXPECT_EQ(0u, second->getDeferredCount());
+    EXPECT_EQ(3u, keeper->getDeferredCount());
+
+    auto firstRecords = first->getRecords();
+    ASSERT_EQ(3u, firstRecords.size());
+    EXPECT_EQ(expected, firstRecords[0]);
+    EXPECT_EQ(expected, firstRecords[1]);
+    EXPECT_EQ(std::vector<std::string>({expected}), second->getRecords());
+    EXPECT_EQ(firstRecords, keeper->getRecords());
+}
+
+TEST_F(FanOutOpsTest, testSlowSinkDoesNotStallTheFastOne)
+{
+    auto slow = std::make_shared<MemorySink>(false, std::chrono::milliseconds(50), 4096);
+    slow->setOverflowPolicy(OverflowPolicy::DROP_NEWEST);
+    auto fast = std::make_shared<MemorySink>();
+    FanOutOps fanOut;
+    fanOut.addSink(slow, LOG_TYPE::LOG_DBG)
+          .addSink(fast, LOG_TYPE::LOG_DBG);
+
+    const size_t recordsCnt = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+        fanOut.write(std::format("Record {}", cnt), LOG_TYPE::LOG_INFO);
+    fast->flush();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // The slow sink got a few batches at most, while the fast one got all of it
+    EXPECT_EQ(recordsCnt, fast->getRecords().size());
+    EXPECT_GT(slow->getDroppedRecordsCount(), 0u);
+    EXPECT_LT(elapsed, std::chrono::seconds(5));
+    fanOut.flush();
+    EXPECT_EQ(recordsCnt, slow->getRecords().size() + slow->getDroppedRecordsCount());
+}
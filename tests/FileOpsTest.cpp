@@ -36,6 +36,11 @@
 #include "CommonFunc.hpp"
 
 #include <bitset>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include <sched.h>
 
 using namespace logger;
 
@@ -508,6 +513,64 @@ TEST_F(FileOpsTests, testWriteFileWith_8_Bytes_Hex_DataStream)
     testBinaryDataAndStream<uint64_t>(64, true, hexData);
 }
 
+TEST_F(FileOpsTests, testWriteBinaryEncodings)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName();
+    FileOps file(maxFileSize, fileName);
+
+    std::vector<uint8_t> bytes(40);
+    for (size_t idx = 0; idx < bytes.size(); ++idx)
+        bytes[idx] = static_cast<uint8_t>(idx * 7);
+    file.writeBinary(bytes);
+    file.writeBinary(std::vector<uint16_t>({0x0102, 0xabcd}));
+    file.writeBinary(std::vector<uint64_t>({0x0123456789abcdefULL}), BinaryEncoding::HEX);
+    file.writeBinary(std::vector<uint32_t>({0x80000001u, 5u}), BinaryEncoding::BITS);
+    file.writeBinary(std::vector<uint8_t>({'R', 'a', 'w'}), BinaryEncoding::RAW);
+    file.writeBinary(std::vector<uint8_t>());       // Nothing at all
+    file.flush();
+
+    // 32 bytes per line for the hex, a value per line for the bits
+    std::string firstLine;
+    for (size_t idx = 0; idx < 32; ++idx)
+        firstLine += std::format("{}{:02x}", idx ? " " : "", bytes[idx]);
+    std::string secondLine;
+    for (size_t idx = 32; idx < bytes.size(); ++idx)
+        secondLine += std::format("{}{:02x}", (idx != 32) ? " " : "", bytes[idx]);
+
+    file.readFile();
+    auto fileContents = file.getFileContent();
+    std::vector<std::string> lines;
+    for (; !fileContents.empty(); fileContents.pop())
+        lines.push_back(fileContents.front());
+    EXPECT_EQ(std::vector<std::string>({firstLine, secondLine, "0102 abcd", "0123456789abcdef",
+                                        "10000000000000000000000000000001", "00000000000000000000000000000101",
+                                        "Raw"}), lines);
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(FileOpsTests, testWriteBinaryLargeStream)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000 * 4;
+    auto fileName = generateRandomFileName();
+    FileOps file(maxFileSize, fileName);
+
+    // Rendered to more than a single record, none of the lines is split between them
+    auto bindata = generateRandomBinary_2_Bytes_Data(20000);
+    file.writeBinary(bindata, BinaryEncoding::BITS);
+    file.flush();
+
+    file.readFile();
+    auto fileContents = file.getFileContent();
+    ASSERT_EQ(bindata.size(), fileContents.size());
+    for (const auto& data : bindata)
+    {
+        EXPECT_EQ(std::bitset<16>(data).to_string(), fileContents.front());
+        fileContents.pop();
+    }
+    ASSERT_TRUE(file.deleteFile());
+}
+
 TEST_F(FileOpsTests, testWriteLargeDataChunk)
 {
     std::uintmax_t maxFileSize = 4096 * 1000;
@@ -763,6 +826,8 @@ TEST_F(FileOpsTests, testFileLimitExceed)
         file.append(text);
         dataQueue.push_back(text);
     }
+    // The rotation happens on the writer side, let it catch up
+    file.flush();
     size_t cnt = 0;
     for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::current_path()))
     {
@@ -784,3 +849,529 @@ TEST_F(FileOpsTests, testFileLimitExceed)
     }
     EXPECT_EQ(cnt, newCnt);
 }
+
+TEST_F(FileOpsTests, testWriteAfterDeleteAndRename)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    std::uintmax_t maxTextSize = 255;
+    auto fileName = generateRandomFileName();
+    auto expFilePath = std::filesystem::current_path().string() + getPathSeperator();
+    FileOps file(maxFileSize, fileName);
+
+    auto firstText = generateRandomText(maxTextSize);
+    file.write(firstText);
+    file.readFile();
+    ASSERT_EQ(file.getFileContent().size(), 1);
+
+    // The file descriptor of the deleted file must not be used anymore
+    ASSERT_TRUE(file.deleteFile());
+    auto secondText = generateRandomText(maxTextSize);
+    file.write(secondText);
+    file.readFile();
+    ASSERT_EQ(file.getFileContent().size(), 1);
+    EXPECT_EQ(file.getFileContent().front(), secondText);
+
+    // Nor the one of the renamed file
+    auto renamedFileName = "Renamed_" + fileName;
+    ASSERT_TRUE(file.renameFile(renamedFileName));
+    auto thirdText = generateRandomText(maxTextSize);
+    file.write(thirdText);
+    file.readFile();
+    ASSERT_EQ(file.getFileContent().size(), 1);
+    EXPECT_EQ(file.getFileContent().front(), thirdText);
+
+    std::filesystem::path renamedFilePathObj(expFilePath + renamedFileName);
+    std::ifstream renamedFile(renamedFilePathObj);
+    std::string line;
+    ASSERT_TRUE(std::getline(renamedFile, line));
+    EXPECT_EQ(line, secondText);
+    EXPECT_FALSE(std::getline(renamedFile, line));
+
+    ASSERT_TRUE(FileOps::removeFile(renamedFilePathObj));
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(FileOpsTests, testRotationOnTrackedFileSize)
+{
+    std::uintmax_t maxFileSize = 4096;
+    std::uintmax_t maxTextSize = 99;    // 100 bytes along with the new line
+    auto fileName = generateRandomFileName("rot_");
+    removeRotatedFiles(fileName);
+    FileOps file(maxFileSize, fileName);
+    std::vector<std::string> dataQueue;
+    for (auto cnt = 0; cnt < 2000; ++cnt)
+    {
+        auto text = generateRandomText(maxTextSize);
+        file.append(text);
+        dataQueue.push_back(text);
+    }
+    file.flush();
+
+    // None of the files may exceed the max size and no record may be lost
+    std::uintmax_t totalSize = 0;
+    auto files = rotatedFiles(baseNameOf(fileName));
+    for (const auto& entry : files)
+    {
+        EXPECT_LE(entry.file_size(), maxFileSize);
+        totalSize += entry.file_size();
+    }
+    EXPECT_GE(files.size(), dataQueue.size() * (maxTextSize + 1) / maxFileSize);
+    EXPECT_EQ(totalSize, dataQueue.size() * (maxTextSize + 1));
+}
+
+TEST_F(FileOpsTests, testFlushBarrier)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    std::uintmax_t maxTextSize = 63;
+    auto fileName = generateRandomFileName();
+    FileOps file(maxFileSize, fileName);
+
+    std::vector<std::thread> writers;
+    for (auto thNo = 0; thNo < 4; ++thNo)
+    {
+        writers.emplace_back([&file, maxTextSize]()
+        {
+            for (auto cnt = 0; cnt < 250; ++cnt)
+                file.append(generateRandomText(maxTextSize));
+            // Everything this thread has written must be in the file once flush returns
+            file.flush();
+            EXPECT_GE(std::filesystem::file_size(file.getFilePathObj()), 250 * (maxTextSize + 1));
+        });
+    }
+    for (auto& writer : writers)
+        writer.join();
+
+    // Not going through FileOps on purpose, as it would flush by itself
+    EXPECT_EQ(std::filesystem::file_size(file.getFilePathObj()), 1000 * (maxTextSize + 1));
+
+    // Nothing new to be written, so both of them return right away
+    file.flush();
+    file.flush(FlushLevel::DATA_SYNC);
+    file.append(generateRandomText(maxTextSize));
+    file.flush(FlushLevel::FULL_SYNC);
+    EXPECT_EQ(std::filesystem::file_size(file.getFilePathObj()), 1001 * (maxTextSize + 1));
+    EXPECT_TRUE(file.getAllExceptions().empty());
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(FileOpsTests, testBatchPolicy)
+{
+    using namespace std::chrono_literals;
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    std::uintmax_t maxTextSize = 63;
+    auto fileName = generateRandomFileName();
+    FileOps file(maxFileSize, fileName);
+    auto writtenSize = [&file]()
+    {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file.getFilePathObj(), ec);
+        return ec ? 0 : size;
+    };
+
+    // A lonely record goes out once the linger time is over
+    file.setBatchPolicy({ 256, 64 * 1024, 20ms });
+    file.append(generateRandomText(maxTextSize));
+    for (auto cnt = 0; cnt < 100 && writtenSize() == 0; ++cnt)
+        std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(writtenSize(), maxTextSize + 1);
+
+    // With a long linger time only the record limit triggers the write
+    file.setBatchPolicy({ 10, 64 * 1024, 3600s });
+    auto policy = file.getBatchPolicy();
+    EXPECT_EQ(policy.maxRecords, 10);
+    EXPECT_EQ(policy.maxLinger, std::chrono::microseconds(3600s));
+    for (auto cnt = 0; cnt < 9; ++cnt)
+        file.append(generateRandomText(maxTextSize));
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(writtenSize(), maxTextSize + 1);
+    file.append(generateRandomText(maxTextSize));
+    for (auto cnt = 0; cnt < 100 && writtenSize() == maxTextSize + 1; ++cnt)
+        std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(writtenSize(), 11 * (maxTextSize + 1));
+
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(FileOpsTests, testMappedWrite)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    std::uintmax_t maxTextSize = 63;
+    auto fileName = generateRandomFileName("mmap_");
+    std::vector<std::string> expected;
+    {
+        FileOps file(maxFileSize, fileName);
+        file.setFileIoMode(FileIoMode::MMAP);
+        EXPECT_EQ(FileIoMode::MMAP, file.getFileIoMode());
+        for (auto cnt = 0; cnt < 1000; ++cnt)
+        {
+            expected.push_back(generateRandomText(maxTextSize));
+            file.write(expected.back());
+        }
+        file.flush(FlushLevel::DATA_SYNC);
+
+        // The file is preallocated, yet only the logged part of it counts
+        EXPECT_EQ(std::filesystem::file_size(file.getFilePathObj()), maxFileSize);
+        EXPECT_EQ(file.getFileSize(), 1000 * (maxTextSize + 1));
+        EXPECT_FALSE(file.isEmpty());
+        std::vector<std::string> lines;
+        ASSERT_TRUE(FileOps::readFileLineRange(file, 990, 999, lines));
+        EXPECT_EQ(std::vector<std::string>(expected.end() - 11, expected.end() - 1), lines);
+        ASSERT_TRUE(FileOps::readFileLineRange(file, 1000, 1000, lines));
+        EXPECT_EQ(std::vector<std::string>({expected.back()}), lines);
+        file.readFile();
+        EXPECT_EQ(expected.size(), file.getFileContent().size());
+        EXPECT_TRUE(file.getAllExceptions().empty());
+
+        // The preallocated space past the logged lines is no line of its own
+        EXPECT_FALSE(FileOps::readFileLineRange(file, 1000, 1001, lines));
+    }
+
+    // Cut down to the logged size once closed, and appended to when reopened
+    EXPECT_EQ(std::filesystem::file_size(fileName), 1000 * (maxTextSize + 1));
+    FileOps file(maxFileSize, fileName);
+    file.setFileIoMode(FileIoMode::MMAP);
+    file.write(std::string("One more"));
+    file.write(std::string("And the last one"));
+    file.flush();
+    EXPECT_EQ(file.getFileSize(), 1000 * (maxTextSize + 1) + 9 + 17);
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1000, 1001, lines));
+    EXPECT_EQ(std::vector<std::string>({expected.back(), "One more"}), lines);
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(FileOpsTests, testMappedRotation)
+{
+    std::uintmax_t maxFileSize = 4096;
+    std::uintmax_t maxTextSize = 99;    // 100 bytes along with the new line
+    auto fileName = generateRandomFileName("mmaprot_");
+    removeRotatedFiles(fileName);
+    size_t recordsCnt = 2000;
+    {
+        FileOps file(maxFileSize, fileName);
+        file.setFileIoMode(FileIoMode::MMAP);
+        for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+            file.append(generateRandomText(maxTextSize));
+        file.flush();
+    }
+
+    // Every rotated file is cut down to its records, and the next segment is gone
+    std::uintmax_t totalSize = 0;
+    auto baseName = baseNameOf(fileName);
+    EXPECT_TRUE(rotatedFiles("." + baseName).empty());
+    auto files = rotatedFiles(baseName);
+    for (const auto& entry : files)
+    {
+        EXPECT_LE(entry.file_size(), maxFileSize);
+        EXPECT_EQ(entry.file_size() % (maxTextSize + 1), 0u);
+        totalSize += entry.file_size();
+    }
+    EXPECT_GE(files.size(), recordsCnt * (maxTextSize + 1) / maxFileSize);
+    EXPECT_EQ(totalSize, recordsCnt * (maxTextSize + 1));
+}
+
+TEST_F(FileOpsTests, testMappedFileLeftByCrash)
+{
+    std::uintmax_t maxFileSize = 4096;
+    auto fileName = generateRandomFileName("mmapcrash_");
+    removeRotatedFiles(fileName);
+    {
+        // What a crash leaves behind, the preallocated part never written to and the marker
+        std::ofstream crashed(fileName, std::ios::binary);
+        std::string content = "Last words\n";
+        content.resize(maxFileSize, '\0');
+        crashed.write(content.data(), static_cast<std::streamsize>(content.size()));
+        std::ofstream marker("." + fileName + ".mapped");
+    }
+
+    FileOps file(maxFileSize, fileName);
+    file.setFileIoMode(FileIoMode::MMAP);
+    file.write(std::string("First words"));
+    file.write(std::string("Second words"));
+    file.flush();
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1, 1, lines));
+    EXPECT_EQ(std::vector<std::string>({"First words"}), lines);
+
+    // The file left behind is rotated away as it is
+    size_t rotatedCnt = 0;
+    for (const auto& entry : rotatedFiles(baseNameOf(fileName)))
+    {
+        if (entry.path() != file.getFilePathObj())
+        {
+            EXPECT_EQ(entry.file_size(), maxFileSize);
+            ++rotatedCnt;
+        }
+    }
+    EXPECT_EQ(1u, rotatedCnt);
+}
+
+TEST_F(FileOpsTests, testNextFileIsPreparedAhead)
+{
+    std::uintmax_t maxFileSize = 4096;
+    std::uintmax_t maxTextSize = 99;    // 100 bytes along with the new line
+    auto fileName = generateRandomFileName("next_");
+    removeRotatedFiles(fileName);
+    std::filesystem::path nextPath;
+    {
+        FileOps file(maxFileSize, fileName);
+        nextPath = file.getFilePathObj().parent_path() / ("." + fileName + ".next");
+        for (auto cnt = 0; cnt < 10; ++cnt)
+            file.append(generateRandomText(maxTextSize));
+        file.flush();
+        EXPECT_FALSE(std::filesystem::exists(nextPath));
+
+        // Half full, so the next file is there before the rotation needs it
+        for (auto cnt = 0; cnt < 15; ++cnt)
+            file.append(generateRandomText(maxTextSize));
+        file.flush();
+        EXPECT_TRUE(std::filesystem::exists(nextPath));
+        for (auto cnt = 0; cnt < 20; ++cnt)
+            file.append(generateRandomText(maxTextSize));
+        file.flush();
+        EXPECT_EQ(file.getFileSize(), 5 * (maxTextSize + 1));
+        EXPECT_TRUE(file.getAllExceptions().empty());
+    }
+    EXPECT_FALSE(std::filesystem::exists(nextPath));
+    EXPECT_EQ(2u, rotatedFiles(baseNameOf(fileName)).size());
+}
+
+TEST_F(FileOpsTests, testRotationInterval)
+{
+    using namespace std::chrono_literals;
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName("timerot_");
+    removeRotatedFiles(fileName);
+    FileOps file(maxFileSize, fileName);
+    EXPECT_EQ(0s, file.getRotationInterval());
+    file.setRotationInterval(1s);
+    EXPECT_EQ(1s, file.getRotationInterval());
+
+    file.write(std::string("Before the rotation"));
+    file.flush();
+    std::this_thread::sleep_for(1100ms);
+    file.write(std::string("After the rotation"));
+    file.flush();
+
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1, 1, lines));
+    EXPECT_EQ(std::vector<std::string>({"After the rotation"}), lines);
+
+    size_t rotatedCnt = 0;
+    for (const auto& entry : rotatedFiles(baseNameOf(fileName)))
+    {
+        if (entry.path() != file.getFilePathObj())
+        {
+            EXPECT_EQ(entry.file_size(), std::string("Before the rotation\n").size());
+            ++rotatedCnt;
+        }
+    }
+    EXPECT_EQ(1u, rotatedCnt);
+    EXPECT_TRUE(file.getAllExceptions().empty());
+}
+
+TEST_F(FileOpsTests, testRetentionPolicy)
+{
+    std::uintmax_t maxFileSize = 4096;
+    std::uintmax_t maxTextSize = 99;    // 100 bytes along with the new line
+    for (auto policy : {RetentionPolicy{3, 0}, RetentionPolicy{0, 5 * 4096}})
+    {
+        auto fileName = generateRandomFileName("keep_");
+        removeRotatedFiles(fileName);
+        {
+            FileOps file(maxFileSize, fileName);
+            file.setRetentionPolicy(policy);
+            EXPECT_EQ(policy.maxFiles, file.getRetentionPolicy().maxFiles);
+            for (auto cnt = 0; cnt < 2000; ++cnt)
+                file.append(generateRandomText(maxTextSize));
+            file.flush();
+        }
+
+        // The newest ones are kept, i.e. the ones logged last
+        std::vector<std::filesystem::directory_entry> files;
+        for (const auto& entry : rotatedFiles(baseNameOf(fileName)))
+        {
+            if (entry.path().filename() != fileName)
+                files.push_back(entry);
+        }
+        std::uintmax_t totalSize = 0;
+        for (const auto& entry : files)
+            totalSize += entry.file_size();
+        if (policy.maxFiles)
+        {
+            EXPECT_EQ(policy.maxFiles, files.size());
+        }
+        else
+        {
+            EXPECT_LE(totalSize, policy.maxTotalBytes);
+        }
+        EXPECT_GE(totalSize, 3 * (maxFileSize - maxTextSize - 1));
+    }
+}
+
+TEST_F(FileOpsTests, testRetentionKeepsOtherLogs)
+{
+    std::uintmax_t maxFileSize = 4096;
+    auto fileName = generateRandomFileName("other_");
+    removeRotatedFiles(fileName);
+    // The logs of other loggers sharing the base name aren't rotated away from this one
+    const auto baseName = baseNameOf(fileName);
+    const std::vector<std::string> otherFiles{baseName + "_2.txt", baseName + "_01012025_000000_old.txt"};
+    for (const auto& otherFile : otherFiles)
+        std::ofstream(otherFile) << "not rotated";
+    {
+        FileOps file(maxFileSize, fileName);
+        file.setRetentionPolicy(RetentionPolicy{1, 0});
+        for (auto cnt = 0; cnt < 500; ++cnt)
+            file.append(generateRandomText(99));
+        file.flush();
+    }
+
+    for (const auto& otherFile : otherFiles)
+        EXPECT_TRUE(std::filesystem::exists(otherFile)) << otherFile;
+    // The active file, the other ones and the one kept rotated file
+    EXPECT_EQ(2 + otherFiles.size(), rotatedFiles(baseName).size());
+}
+
+TEST_F(FileOpsTests, testStats)
+{
+    std::uintmax_t maxFileSize = 4096;
+    auto fileName = generateRandomFileName("stats_");
+    removeRotatedFiles(fileName);
+    const size_t recordsCnt = 500;
+    const std::string record(100, 'x');
+    {
+        FileOps file(maxFileSize, fileName);
+        auto stats = file.getStats();
+        EXPECT_EQ(0u, stats.pushedRecords);
+        EXPECT_EQ(0u, stats.batches);
+        EXPECT_EQ(0.0, stats.averageBatchSize());
+
+        std::vector<std::thread> producers;
+        for (auto cnt = 0; cnt < 4; ++cnt)
+        {
+            producers.emplace_back([&file, &record, recordsCnt]()
+            {
+                for (size_t idx = 0; idx < recordsCnt; ++idx)
+                    file.write(record);
+            });
+        }
+        for (auto& producer : producers)
+            producer.join();
+        file.flush();
+
+        stats = file.getStats();
+        EXPECT_EQ(4 * recordsCnt, stats.pushedRecords);
+        EXPECT_EQ(4 * recordsCnt * record.size(), stats.pushedBytes);
+        EXPECT_EQ(4 * recordsCnt, stats.writtenRecords);
+        EXPECT_EQ(4 * recordsCnt * record.size(), stats.writtenBytes);
+        EXPECT_EQ(0u, stats.queuedRecords);
+        EXPECT_EQ(0u, stats.queuedBytes);
+        EXPECT_GT(stats.highWaterBytes, record.size());
+        EXPECT_GE(stats.batches, 1u);
+        EXPECT_EQ(static_cast<double>(stats.writtenRecords) / static_cast<double>(stats.batches), stats.averageBatchSize());
+        EXPECT_EQ(0u, stats.droppedRecords);
+        EXPECT_GT(stats.writerBusyTime.count(), 0);
+        // Every file takes 40 records at most
+        EXPECT_GE(stats.rotations, 4 * recordsCnt / 40 - 1);
+        EXPECT_EQ(0u, stats.exceptions);
+        EXPECT_NE(std::string::npos, stats.toString().find(std::format("written={}/{}B", stats.writtenRecords, stats.writtenBytes)));
+    }
+}
+
+TEST_F(FileOpsTests, testStagingRings)
+{
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName();
+    FileOps file(maxFileSize, fileName);
+    EXPECT_EQ(StagingMode::SHARED, file.getStagingMode());
+    EXPECT_EQ(0u, file.getStagingRingsCount());
+    file.write(std::string("Before the staging rings"));
+
+    // Small rings, so that the producers wait for the watcher thread every now and then
+    file.setStagingMode(StagingMode::PER_CPU, 4096);
+    EXPECT_EQ(StagingMode::PER_CPU, file.getStagingMode());
+    const size_t threadsCnt = 4;
+    const size_t recordsCnt = 2000;
+    std::vector<std::thread> writers;
+    for (size_t thNo = 0; thNo < threadsCnt; ++thNo)
+    {
+        writers.emplace_back([&file, thNo, recordsCnt]()
+        {
+            for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+            {
+                file.write(std::format("Thread {} record {}", thNo, cnt));
+                if (cnt % 500 == 0)
+                    std::this_thread::yield();  // A chance to move to another CPU
+            }
+            file.flush();
+        });
+    }
+    for (auto& writer : writers)
+        writer.join();
+    EXPECT_GE(file.getStagingRingsCount(), 1u);
+    EXPECT_LE(file.getStagingRingsCount(), LoggingOps::maxStagingRings);
+
+    // Everything is there, and the records of every thread are in the order written
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1, 1 + threadsCnt * recordsCnt, lines));
+    ASSERT_EQ(1 + threadsCnt * recordsCnt, lines.size());
+    EXPECT_EQ("Before the staging rings", lines[0]);
+    std::vector<size_t> nextRecord(threadsCnt, 0);
+    for (size_t idx = 1; idx < lines.size(); ++idx)
+    {
+        size_t thNo = 0;
+        size_t cnt = 0;
+        ASSERT_EQ(2, std::sscanf(lines[idx].c_str(), "Thread %zu record %zu", &thNo, &cnt)) << lines[idx];
+        ASSERT_LT(thNo, threadsCnt);
+        EXPECT_EQ(nextRecord[thNo]++, cnt) << lines[idx];
+    }
+
+    auto stats = file.getStats();
+    EXPECT_EQ(1 + threadsCnt * recordsCnt, stats.writtenRecords);
+    EXPECT_EQ(0u, stats.queuedRecords);
+    EXPECT_EQ(0u, stats.droppedRecords);
+
+    // Back to the shared ring, the staging rings stay but get nothing more
+    file.setStagingMode(StagingMode::SHARED);
+    file.write(std::string("After the staging rings"));
+    file.flush(FlushLevel::DATA_SYNC);
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 2 + threadsCnt * recordsCnt, 2 + threadsCnt * recordsCnt, lines));
+    EXPECT_EQ(std::vector<std::string>({"After the staging rings"}), lines);
+
+#if defined(__linux__)
+    // A CPU the test may run on, whatever the cpuset of the machine is
+    EXPECT_TRUE(file.setWriterAffinity(::sched_getcpu()));
+#endif
+    EXPECT_FALSE(file.setWriterAffinity(-1));
+    EXPECT_TRUE(file.getAllExceptions().empty());
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(FileOpsTests, testStatsLine)
+{
+    using namespace std::chrono_literals;
+    std::uintmax_t maxFileSize = 1024 * 1000;
+    auto fileName = generateRandomFileName();
+    FileOps file(maxFileSize, fileName);
+    EXPECT_EQ(0s, file.getStatsInterval());
+    file.setStatsInterval(1s);
+    EXPECT_EQ(1s, file.getStatsInterval());
+
+    file.write(std::string("Before the interval is over"));
+    file.flush();
+    std::this_thread::sleep_for(1100ms);
+    file.write(std::string("After the interval is over"));
+    file.flush();
+
+    // The stats line follows the first batch after the interval, it is not a record of its own
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 1, 3, lines));
+    ASSERT_EQ(3u, lines.size());
+    EXPECT_EQ("Before the interval is over", lines[0]);
+    EXPECT_EQ("After the interval is over", lines[1]);
+    EXPECT_TRUE(lines[2].starts_with("LoggingStats: ")) << lines[2];
+    EXPECT_NE(std::string::npos, lines[2].find("written=2/")) << lines[2];
+    EXPECT_EQ(2u, file.getStats().writtenRecords);
+    ASSERT_TRUE(file.deleteFile());
+}
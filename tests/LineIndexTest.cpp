@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LineIndexTest.cpp
+ * @brief Unit tests for the LineIndex class and the indexed reads of FileOps.
+ *
+ * This file contains tests that verify the index points at the right lines,
+ * follows a file growing between the reads, starts afresh for a replaced file,
+ * and that the line and time range reads of FileOps get the same lines as a
+ * read from the start of the file would.
+ */
+
+#include "LineIndex.hpp"
+#include "FileOps.hpp"
+#include "CommonFunc.hpp"
+
+#include <sstream>
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class LineIndexTest : public CommonTestDataGenerator
+{
+    protected:
+        // 1000 lines logged every second, starting at 00:00:00
+        static std::string logLine(const size_t cnt)
+        {
+            auto secs = cnt / 1000;
+            return std::format("|20250822_{:02}{:02}{:02}| 0x16b8cb000| ProducerConsumer.cpp|   28|INF>  Record {}",
+                               secs / 3600, (secs / 60) % 60, secs % 60, cnt);
+        }
+
+        static std::chrono::system_clock::time_point timeOf(const int hour, const int min, const int sec)
+        {
+            std::tm localTime{};
+            localTime.tm_year = 2025 - 1900;
+            localTime.tm_mon = 7;
+            localTime.tm_mday = 22;
+            localTime.tm_hour = hour;
+            localTime.tm_min = min;
+            localTime.tm_sec = sec;
+            localTime.tm_isdst = -1;
+            return std::chrono::system_clock::from_time_t(std::mktime(&localTime));
+        }
+};
+
+TEST_F(LineIndexTest, testSeekLine)
+{
+    std::string content;
+    std::vector<std::uintmax_t> offsets;
+    for (size_t cnt = 0; cnt < 10000; ++cnt)
+    {
+        offsets.push_back(content.size());
+        content.append(logLine(cnt)).push_back('\n');
+    }
+    std::istringstream in(content);
+    LineIndex index(100);
+    index.update(in, content.size(), 1);
+    EXPECT_EQ(10000u, index.getLinesCount());
+
+    auto entry = index.seekLine(5050);
+    EXPECT_EQ(5001u, entry.m_LineNo);
+    EXPECT_EQ(offsets[5000], entry.m_Offset);
+    EXPECT_EQ(1u, index.seekLine(1).m_LineNo);
+    EXPECT_EQ(0u, index.seekLine(0).m_Offset);
+    EXPECT_EQ(10001u, index.seekLine(20000).m_LineNo);
+
+    // The stream can be read right from the offset
+    in.seekg(static_cast<std::streamoff>(entry.m_Offset));
+    std::string line;
+    ASSERT_TRUE(std::getline(in, line));
+    EXPECT_EQ(logLine(5000), line);
+}
+
+TEST_F(LineIndexTest, testGrowingAndReplacedFile)
+{
+    std::string content;
+    for (size_t cnt = 0; cnt < 250; ++cnt)
+        content.append(logLine(cnt)).push_back('\n');
+    content.append("A line still being written");
+
+    LineIndex index(100);
+    std::istringstream first(content);
+    index.update(first, content.size(), 1);
+    EXPECT_EQ(250u, index.getLinesCount());
+    EXPECT_EQ(201u, index.seekLine(260).m_LineNo);
+
+    // Only what got appended is read, the unfinished line along with it
+    content.append(" and done now\n");
+    for (size_t cnt = 250; cnt < 500; ++cnt)
+        content.append(logLine(cnt)).push_back('\n');
+    std::istringstream second(content);
+    index.update(second, content.size(), 1);
+    EXPECT_EQ(501u, index.getLinesCount());
+    auto entry = index.seekLine(350);
+    second.seekg(static_cast<std::streamoff>(entry.m_Offset));
+    std::string line;
+    ASSERT_TRUE(std::getline(second, line));
+    EXPECT_EQ(logLine(299), line);  // Line 301, after the one written in two goes
+
+    // Another file, even if bigger than the one indexed before
+    content.append(content);
+    std::istringstream third(content);
+    index.update(third, content.size(), 2);
+    EXPECT_EQ(1002u, index.getLinesCount());
+    index.reset();
+    EXPECT_EQ(0u, index.getLinesCount());
+}
+
+TEST_F(LineIndexTest, testSeekTime)
+{
+    EXPECT_EQ("20250822_000003", LineIndex::timeOf(logLine(3000)));
+    EXPECT_EQ("", LineIndex::timeOf("A line without a prefix"));
+    EXPECT_EQ("", LineIndex::timeOf("|Not a timestamp|"));
+
+    std::string content;
+    std::vector<std::uintmax_t> offsets;
+    for (size_t cnt = 0; cnt < 10000; ++cnt)
+    {
+        offsets.push_back(content.size());
+        content.append(logLine(cnt)).push_back('\n');
+    }
+    std::istringstream in(content);
+    LineIndex index(256);
+    index.update(in, content.size(), 1);
+
+    // Every line before the entry is older than the time looked for
+    auto entry = index.seekTime("20250822_000005");
+    EXPECT_LE(entry.m_Offset, offsets[5000]);
+    EXPECT_GT(entry.m_Offset + 256 * (logLine(5000).size() + 1), offsets[5000]);
+
+    // The read stops a stride after the first newer line
+    auto stopAt = index.stopOffset("20250822_000005");
+    EXPECT_GT(stopAt, offsets[5999]);
+    EXPECT_LT(stopAt, offsets[5999] + 2 * 256 * (logLine(5999).size() + 1));
+    EXPECT_EQ(UINTMAX_MAX, index.stopOffset("20250822_000009"));
+}
+
+TEST_F(LineIndexTest, testFileOpsIndexedReads)
+{
+    std::uintmax_t maxFileSize = 20 * 1024 * 1024;
+    auto fileName = generateRandomFileName("idx_");
+    FileOps file(maxFileSize, fileName);
+    std::vector<std::string> expected;
+    for (size_t cnt = 0; cnt < 20000; ++cnt)
+    {
+        expected.push_back(logLine(cnt));
+        file.write(expected.back());
+        if (cnt % 1000 == 999)
+            expected.push_back("The rest of the record");    // A line of a multi line record
+        if (cnt % 1000 == 999)
+            file.write(expected.back());
+    }
+    file.flush();
+
+    std::vector<std::string> lines;
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 15001, 15100, lines));
+    EXPECT_EQ(std::vector<std::string>(expected.begin() + 15000, expected.begin() + 15100), lines);
+    ASSERT_TRUE(FileOps::readFileLineRange(file, expected.size() - 9, expected.size(), lines));
+    EXPECT_EQ(std::vector<std::string>(expected.end() - 10, expected.end()), lines);
+    EXPECT_FALSE(FileOps::readFileLineRange(file, expected.size(), expected.size() + 1, lines));
+
+    // A second reads 1000 records along with the rest of the last one
+    ASSERT_TRUE(FileOps::readFileTimeRange(file, timeOf(0, 0, 7), timeOf(0, 0, 8), lines));
+    ASSERT_EQ(2002u, lines.size());
+    EXPECT_EQ(logLine(7000), lines.front());
+    EXPECT_EQ("The rest of the record", lines.back());
+    EXPECT_EQ(logLine(8999), lines[lines.size() - 2]);
+
+    ASSERT_TRUE(FileOps::readFileTimeRange(file, timeOf(1, 0, 0), timeOf(2, 0, 0), lines));
+    EXPECT_TRUE(lines.empty());
+    EXPECT_FALSE(FileOps::readFileTimeRange(file, timeOf(0, 0, 8), timeOf(0, 0, 7), lines));
+
+    // Cleared, so the index starts afresh
+    ASSERT_TRUE(file.clearFile());
+    file.write(logLine(42));
+    file.write(logLine(43));
+    file.flush();
+    ASSERT_TRUE(FileOps::readFileLineRange(file, 2, 2, lines));
+    EXPECT_EQ(std::vector<std::string>({logLine(43)}), lines);
+    ASSERT_TRUE(file.deleteFile());
+}
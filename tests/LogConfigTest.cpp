@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LogConfigTest.cpp
+ * @brief Unit tests for the LogConfig struct and the config reloads.
+ *
+ * This file contains tests that verify the settings are parsed from the config
+ * file and the environment variables, the environment overriding the file, that
+ * the invalid ones are reported and that a reload (on demand or on a change of
+ * the config file) applies the log level and the batching policy.
+ */
+
+#include "LogConfig.hpp"
+#include "LogFilter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <cstdlib>
+
+using namespace logger;
+
+class LogConfigTest : public ::testing::Test
+{
+    protected:
+        void TearDown() override
+        {
+            unsetenv(LogConfig::configFileEnvVar.data());
+            unsetenv("LOGGER_LOG_LEVEL");
+            unsetenv("LOGGER_BATCH_MAX_RECORDS");
+            Logger::reloadConfig();     // Stops looking at the config file as well
+            LogFilter::reset();
+            Logger::buildLoggingOpsObject().setBatchPolicy(BatchPolicy());
+            std::filesystem::remove(m_ConfigFile);
+        }
+
+        void writeConfigFile(const std::string_view content)
+        {
+            std::ofstream outFile(m_ConfigFile, std::ios::trunc);
+            outFile << content;
+        }
+
+        const std::filesystem::path m_ConfigFile = std::filesystem::temp_directory_path() / "LogConfigTest.conf";
+};
+
+TEST_F(LogConfigTest, testParsing)
+{
+    EXPECT_EQ(4096u, LogConfig::parseSize("4096"));
+    EXPECT_EQ(64u * 1024, LogConfig::parseSize("64KB"));
+    EXPECT_EQ(10u * 1024 * 1024, LogConfig::parseSize("10m"));
+    EXPECT_EQ(2ull * 1024 * 1024 * 1024, LogConfig::parseSize("2 GB"));
+    EXPECT_FALSE(LogConfig::parseSize("10TB"));
+    EXPECT_FALSE(LogConfig::parseSize("MB"));
+    EXPECT_FALSE(LogConfig::parseSize("18446744073709551615K"));
+    EXPECT_FALSE(LogConfig::parseSize("17179869184G"));
+    EXPECT_EQ(17179869183ull * 1024 * 1024 * 1024, LogConfig::parseSize("17179869183G"));
+
+    EXPECT_EQ(std::chrono::microseconds(200), LogConfig::parseDuration("200us"));
+    EXPECT_EQ(std::chrono::milliseconds(5), LogConfig::parseDuration("5ms"));
+    EXPECT_EQ(std::chrono::seconds(60), LogConfig::parseDuration("60"));
+    EXPECT_EQ(std::chrono::minutes(10), LogConfig::parseDuration("10m"));
+    EXPECT_EQ(std::chrono::hours(1), LogConfig::parseDuration("1H"));
+    EXPECT_FALSE(LogConfig::parseDuration("1 day"));
+    EXPECT_FALSE(LogConfig::parseDuration("3000000000h"));
+    EXPECT_FALSE(LogConfig::parseDuration("9223372036854775808us"));
+    EXPECT_FALSE(LogConfig::parseDuration("18446744073709551615s"));
+    EXPECT_EQ(std::chrono::microseconds(INT64_MAX), LogConfig::parseDuration("9223372036854775807us"));
+    EXPECT_EQ(std::chrono::hours(2562047788), LogConfig::parseDuration("2562047788h"));
+
+    EXPECT_EQ(LOG_TYPE::LOG_WARN, LogConfig::parseLogLevel("warn"));
+    EXPECT_EQ(LOG_TYPE::LOG_INFO, LogConfig::parseLogLevel("INF"));
+    EXPECT_EQ(LOG_TYPE::LOG_ERR, LogConfig::parseLogLevel("Error"));
+    EXPECT_FALSE(LogConfig::parseLogLevel("fatal"));
+}
+
+TEST_F(LogConfigTest, testConfigFile)
+{
+    writeConfigFile("# The deployment settings\n"
+                    "\n"
+                    "FILE_LOGGING = yes\n"
+                    "LOG_FILE_NAME = \"Service\"\n"
+                    "log_file_extn = log\n"
+                    "FILE_SIZE = 10MB\n"
+                    "ROTATION_INTERVAL = 1h\n"
+                    "RETENTION_MAX_FILES = 5\n"
+                    "RING_CAPACITY = 4M\n"
+                    "STAGING_MODE = per_numa_node\n"
+                    "WRITER_CPU = 2\n"
+                    "RECORD_ENCODING = logfmt\n"
+                    "NETWORK_SINK = tcp://[::1]:6514\n"
+                    "LOG_LEVEL = warn\n"
+                    "CONSOLE_LOG_LEVEL = err\n"
+                    "BATCH_MAX_LINGER = 2ms\n"
+                    "FILE_SIZE = huge\n"
+                    "NO_SUCH_SETTING = 1\n"
+                    "Just some text\n");
+
+    LogConfig config;
+    std::vector<std::string> problems;
+    ASSERT_TRUE(config.readFile(m_ConfigFile, problems));
+    EXPECT_TRUE(config.fileLogging);
+    EXPECT_EQ("Service", config.fileName);
+    EXPECT_EQ(".log", config.fileExtn);
+    EXPECT_EQ(10u * 1024 * 1024, config.fileSize);
+    EXPECT_EQ(std::chrono::hours(1), config.rotationInterval);
+    EXPECT_EQ(5u, config.retentionPolicy.maxFiles);
+    EXPECT_EQ(4u * 1024 * 1024, config.ringCapacity);
+    EXPECT_EQ(StagingMode::PER_NUMA_NODE, config.stagingMode);
+    EXPECT_EQ(2, config.writerCpu);
+    EXPECT_EQ(RecordEncoding::LOGFMT, config.recordEncoding);
+    ASSERT_TRUE(config.networkSink);
+    EXPECT_EQ("::1", config.networkSink->host);
+    EXPECT_EQ(6514u, config.networkSink->port);
+    EXPECT_EQ(NetworkProtocol::TCP_SYSLOG, config.networkSink->protocol);
+    EXPECT_EQ(LOG_TYPE::LOG_WARN, config.logLevel);
+    EXPECT_EQ(LOG_TYPE::LOG_ERR, config.consoleLogLevel);
+    ASSERT_TRUE(config.batchPolicy);
+    EXPECT_EQ(std::chrono::milliseconds(2), config.batchPolicy->maxLinger);
+    EXPECT_EQ(BatchPolicy().maxRecords, config.batchPolicy->maxRecords);
+    EXPECT_FALSE(config.statsInterval);
+    EXPECT_EQ(m_ConfigFile, config.configFile);
+
+    // The invalid lines are reported along with their line numbers, the rest is taken
+    ASSERT_EQ(3u, problems.size());
+    EXPECT_NE(std::string::npos, problems[0].find(":17: Invalid value 'huge' for FILE_SIZE"));
+    EXPECT_NE(std::string::npos, problems[1].find(":18: Unknown setting NO_SUCH_SETTING"));
+    EXPECT_NE(std::string::npos, problems[2].find(":19: KEY = value expected"));
+
+    EXPECT_FALSE(config.readFile(m_ConfigFile.string() + ".missing", problems));
+}
+
+TEST_F(LogConfigTest, testSubSecondIntervalsAreRejected)
+{
+    // Kept in seconds, so they would be switched off rather than be short
+    LogConfig config;
+    std::string problem;
+    for (auto key : {"ROTATION_INTERVAL", "STATS_INTERVAL", "RELOAD_INTERVAL"})
+    {
+        EXPECT_FALSE(config.set(key, "500ms", problem)) << key;
+        EXPECT_NE(std::string::npos, problem.find("at least 1s expected")) << problem;
+        EXPECT_TRUE(config.set(key, "0", problem)) << key;
+        EXPECT_TRUE(config.set(key, "1500ms", problem)) << key;
+    }
+    EXPECT_EQ(std::chrono::seconds(1), config.rotationInterval);
+    EXPECT_EQ(std::chrono::seconds(1), config.statsInterval);
+    EXPECT_EQ(std::chrono::seconds(1), config.reloadInterval);
+
+    // The others take any duration
+    EXPECT_TRUE(config.set("RATE_LIMIT_INTERVAL", "500ms", problem));
+    EXPECT_EQ(std::chrono::milliseconds(500), config.rateLimitInterval);
+}
+
+TEST_F(LogConfigTest, testEnvironmentOverridesConfigFile)
+{
+    writeConfigFile("LOG_LEVEL = warn\nBATCH_MAX_RECORDS = 16\n");
+    setenv(LogConfig::configFileEnvVar.data(), m_ConfigFile.c_str(), 1);
+    setenv("LOGGER_LOG_LEVEL", "err", 1);
+
+    std::vector<std::string> problems;
+    auto config = LogConfig::load(problems);
+    EXPECT_TRUE(problems.empty());
+    EXPECT_EQ(LOG_TYPE::LOG_ERR, config.logLevel);
+    ASSERT_TRUE(config.batchPolicy);
+    EXPECT_EQ(16u, config.batchPolicy->maxRecords);
+
+    setenv("LOGGER_BATCH_MAX_RECORDS", "many", 1);
+    config = LogConfig::load(problems);
+    ASSERT_EQ(1u, problems.size());
+    EXPECT_NE(std::string::npos, problems[0].find("LOGGER_BATCH_MAX_RECORDS: Invalid value 'many'"));
+    EXPECT_EQ(16u, config.batchPolicy->maxRecords);
+}
+
+TEST_F(LogConfigTest, testReload)
+{
+    auto& ops = Logger::buildLoggingOpsObject();
+    writeConfigFile("LOG_LEVEL = err\nBATCH_MAX_RECORDS = 7\nBATCH_MAX_LINGER = 1ms\n");
+    setenv(LogConfig::configFileEnvVar.data(), m_ConfigFile.c_str(), 1);
+
+    ASSERT_TRUE(Logger::reloadConfig());
+    EXPECT_EQ(LOG_TYPE::LOG_ERR, LogFilter::getLogLevel());
+    EXPECT_EQ(7u, ops.getBatchPolicy().maxRecords);
+    EXPECT_EQ(std::chrono::milliseconds(1), ops.getBatchPolicy().maxLinger);
+
+    // A setting left out is left as it is
+    LogFilter::setLogLevel(LOG_TYPE::LOG_IMP);
+    writeConfigFile("BATCH_MAX_RECORDS = 9\n");
+    ASSERT_TRUE(Logger::reloadConfig());
+    EXPECT_EQ(LOG_TYPE::LOG_IMP, LogFilter::getLogLevel());
+    EXPECT_EQ(9u, ops.getBatchPolicy().maxRecords);
+
+    writeConfigFile("LOG_LEVEL = loud\n");
+    EXPECT_FALSE(Logger::reloadConfig());
+    EXPECT_EQ(LOG_TYPE::LOG_IMP, LogFilter::getLogLevel());
+}
+
+TEST_F(LogConfigTest, testReloadOnConfigFileChange)
+{
+    writeConfigFile("LOG_LEVEL = err\nRELOAD_INTERVAL = 1s\n");
+    setenv(LogConfig::configFileEnvVar.data(), m_ConfigFile.c_str(), 1);
+    ASSERT_TRUE(Logger::reloadConfig());
+    EXPECT_EQ(LOG_TYPE::LOG_ERR, LogFilter::getLogLevel());
+
+    // The modification time has to differ, whatever the resolution of the file system
+    writeConfigFile("LOG_LEVEL = warn\nRELOAD_INTERVAL = 1s\n");
+    std::filesystem::last_write_time(m_ConfigFile, std::filesystem::last_write_time(m_ConfigFile) + std::chrono::seconds(2));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (LogFilter::getLogLevel() != LOG_TYPE::LOG_WARN && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(LOG_TYPE::LOG_WARN, LogFilter::getLogLevel());
+}
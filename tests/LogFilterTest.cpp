@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LogFilterTest.cpp
+ * @brief Unit tests for the LogFilter class.
+ *
+ * This file contains tests that verify the global log level, the severity
+ * order of the log types, the per file overrides, that the decision a log
+ * statement keeps follows every change of the levels and that a filtered out
+ * LOG_* statement doesn't even evaluate its arguments.
+ */
+
+#include "LogFilter.hpp"
+#include "LOGGER_MACROS.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class LogFilterTest : public ::testing::Test
+{
+    protected:
+        void TearDown() override
+        {
+            LogFilter::reset();
+        }
+
+        static int countedArg(int& cnt)
+        {
+            return ++cnt;
+        }
+
+        static uint64_t pushedRecords()
+        {
+            return loggingOps.getStats().pushedRecords;
+        }
+};
+
+TEST_F(LogFilterTest, testDefaultLogLevel)
+{
+    EXPECT_EQ(LogFilter::defaultLogLevel, LogFilter::getLogLevel());
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_INFO));
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_ERR));
+#if defined (DEBUG) || defined (__DEBUG__)
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_DBG));
+#else
+    EXPECT_FALSE(LogFilter::isEnabled(LOG_TYPE::LOG_DBG));
+#endif
+}
+
+TEST_F(LogFilterTest, testSeverityOrder)
+{
+    LogFilter::setLogLevel(LOG_TYPE::LOG_WARN);
+    EXPECT_EQ(LOG_TYPE::LOG_WARN, LogFilter::getLogLevel());
+    EXPECT_FALSE(LogFilter::isEnabled(LOG_TYPE::LOG_DBG));
+    EXPECT_FALSE(LogFilter::isEnabled(LOG_TYPE::LOG_INFO));
+    EXPECT_FALSE(LogFilter::isEnabled(LOG_TYPE::LOG_IMP));
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_WARN));
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_ERR));
+
+    // Assertion failures and fatal errors are never filtered out
+    LogFilter::setLogLevel(LOG_TYPE::LOG_FATAL);
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_ERR));
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_ASSERT));
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_FATAL));
+    EXPECT_FALSE(LogFilter::isEnabled(LOG_TYPE::LOG_WARN));
+
+    LogFilter::setLogLevel(LOG_TYPE::LOG_DBG);
+    EXPECT_TRUE(LogFilter::isEnabled(LOG_TYPE::LOG_DBG));
+}
+
+TEST_F(LogFilterTest, testArgumentsNotEvaluatedWhenFiltered)
+{
+    int cnt = 0;
+    LogFilter::setLogLevel(LOG_TYPE::LOG_ERR);
+    LOG_INFO("Must not be logged {}", countedArg(cnt));
+    LOG_WARN("Must not be logged {}", countedArg(cnt));
+    EXPECT_EQ(0, cnt);
+
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LOG_ERR("Must be logged {}", countedArg(cnt));
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(1, cnt);
+}
+
+TEST_F(LogFilterTest, testPerFileOverride)
+{
+    int cnt = 0;
+    LogFilter::setLogLevel(LOG_TYPE::LOG_ERR);
+    LogFilter::setLogLevel("LogFilterTest.cpp", LOG_TYPE::LOG_DBG);
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LOG_INFO("Logged due to the file override {}", countedArg(cnt));
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(1, cnt);
+    // Other files still follow the global level
+    EXPECT_FALSE(LogFilter::isEnabled(LOG_TYPE::LOG_INFO));
+
+    LogFilter::setLogLevel("SomeOtherFile.cpp", LOG_TYPE::LOG_INFO);
+    LogFilter::clearLogLevel("LogFilterTest.cpp");
+    LOG_INFO("Must not be logged {}", countedArg(cnt));
+    EXPECT_EQ(1, cnt);
+
+    LogFilter::clearLogLevel("SomeOtherFile.cpp");
+    LogFilter::setLogLevel(LOG_TYPE::LOG_INFO);
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LOG_INFO("Logged again {}", countedArg(cnt));
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(2, cnt);
+}
+
+TEST_F(LogFilterTest, testDebugEnabledAtRuntime)
+{
+    // The debug statements are in every build, the log level alone decides
+    int cnt = 0;
+    LogFilter::setLogLevel(LOG_TYPE::LOG_INFO);
+    auto before = pushedRecords();
+    LOG_DBG("Must not be logged {}", countedArg(cnt));
+    LOG_ENTRY_DBG("Must not be logged {}", countedArg(cnt));
+    LOG_EXIT_DBG("Must not be logged {}", countedArg(cnt));
+    EXPECT_EQ(0, cnt);
+    EXPECT_EQ(before, pushedRecords());
+
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LogFilter::setLogLevel("LogFilterTest.cpp", LOG_TYPE::LOG_DBG);
+    LOG_DBG("Logged due to the file override {}", countedArg(cnt));
+    LOG_ENTRY_DBG("Logged due to the file override {}", countedArg(cnt));
+    LOG_EXIT_DBG("Logged due to the file override {}", countedArg(cnt));
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(3, cnt);
+    EXPECT_EQ(before + 3, pushedRecords());
+
+    // The entry and exit statements are debug statements as well, not informational ones
+    LogFilter::setLogLevel("LogFilterTest.cpp", LOG_TYPE::LOG_INFO);
+    LOG_ENTRY_DBG("Must not be logged {}", countedArg(cnt));
+    LOG_EXIT_DBG("Must not be logged {}", countedArg(cnt));
+    EXPECT_EQ(3, cnt);
+    EXPECT_EQ(before + 3, pushedRecords());
+}
+
+TEST_F(LogFilterTest, testCachedDecisionFollowsLevels)
+{
+    // The same statement every time, so it is its kept decision being looked at
+    int cnt = 0;
+    auto logDbg = [&cnt]()
+    {
+        LOG_DBG("Logged while DBG is on for the file {}", countedArg(cnt));
+    };
+    LogFilter::setLogLevel(LOG_TYPE::LOG_INFO);
+    LogFilter::setLogLevel("SomeOtherFile.cpp", LOG_TYPE::LOG_DBG);
+    logDbg();
+    logDbg();
+    EXPECT_EQ(0, cnt);
+
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    LogFilter::setLogLevel("LogFilterTest.cpp", LOG_TYPE::LOG_DBG);
+    logDbg();
+    logDbg();
+    EXPECT_EQ(2, cnt);
+
+    // The global level counts again for a file without an override of its own
+    LogFilter::clearLogLevel("LogFilterTest.cpp");
+    logDbg();
+    EXPECT_EQ(2, cnt);
+    LogFilter::setLogLevel(LOG_TYPE::LOG_DBG);
+    logDbg();
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(3, cnt);
+}
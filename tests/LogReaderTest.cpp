@@ -0,0 +1,228 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file LogReaderTest.cpp
+ * @brief Unit tests for the LogReader class and FileOps::readFile(lineHandler).
+ *
+ * This file contains tests that verify the lines are read back the same for
+ * the plain text, compressed and binary log files, that a file still being
+ * written to (a mapped one too) is followed as it grows, that a zero byte is
+ * the end of the file so far in the preallocated space of a mapped file only,
+ * and that a line or block still being written is held back until it is complete.
+ */
+
+#include "LogReader.hpp"
+#include "BlockCompression.hpp"
+#include "DeferredRecord.hpp"
+#include "FileOps.hpp"
+#include "CommonFunc.hpp"
+
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class LogReaderTest : public CommonTestDataGenerator
+{
+    protected:
+        static void appendRaw(const std::string& fileName, const std::string_view data)
+        {
+            std::ofstream file(fileName, std::ios::binary | std::ios::app);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        static std::vector<std::string> readAll(LogReader& reader)
+        {
+            std::vector<std::string> lines;
+            std::string_view line;
+            while (reader.next(line))
+                lines.emplace_back(line);
+            return lines;
+        }
+};
+
+TEST_F(LogReaderTest, testFollowPlainTextFile)
+{
+    auto fileName = generateRandomFileName("rd_");
+    std::vector<std::string> expected;
+    std::string content;
+    for (size_t cnt = 0; cnt < 5000; ++cnt)
+    {
+        expected.push_back(logLine(cnt));
+        content.append(expected.back()).push_back('\n');
+    }
+    // Longer than a chunk, so the buffer has to grow for it
+    expected.push_back(std::string(3 * LogReader::chunkSize, 'x'));
+    content.append(expected.back()).push_back('\n');
+    appendRaw(fileName, content);
+
+    LogReader reader(fileName);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_EQ(expected, readAll(reader));
+
+    // A line being written is held back until its new line is there
+    appendRaw(fileName, "A line written in ");
+    EXPECT_TRUE(readAll(reader).empty());
+    appendRaw(fileName, "two goes\nAnd another one\n");
+    EXPECT_EQ(std::vector<std::string>({"A line written in two goes", "And another one"}), readAll(reader));
+    EXPECT_EQ(expected.size() + 2, reader.getLinesCount());
+
+    EXPECT_FALSE(LogReader("no_such_file.txt").isOpen());
+    ASSERT_TRUE(FileOps::removeFile(fileName));
+}
+
+TEST_F(LogReaderTest, testFollowCompressedFile)
+{
+    auto fileName = generateRandomFileName("rdlz4_");
+    std::string first = logLine(1) + "\n" + logLine(2) + "\n";
+    std::string second = logLine(3) + "\n";
+    std::string data;
+    BlockCompression::appendFileHeader(data);
+    BlockCompression::appendBlock(first, data);
+    BlockCompression::appendBlock(second, data);
+
+    // Nothing to be read until the first block is complete
+    auto firstBlockEnd = BlockCompression::fileHeaderSize + BlockCompression::blockSizeOf(std::string_view(data).substr(BlockCompression::fileHeaderSize));
+    appendRaw(fileName, std::string_view(data).substr(0, firstBlockEnd - 2));
+    LogReader reader(fileName);
+    EXPECT_TRUE(readAll(reader).empty());
+    appendRaw(fileName, std::string_view(data).substr(firstBlockEnd - 2, 5));
+    EXPECT_EQ(std::vector<std::string>({logLine(1), logLine(2)}), readAll(reader));
+    appendRaw(fileName, std::string_view(data).substr(firstBlockEnd + 3));
+    EXPECT_EQ(std::vector<std::string>({logLine(3)}), readAll(reader));
+    ASSERT_TRUE(FileOps::removeFile(fileName));
+}
+
+TEST_F(LogReaderTest, testBinaryFile)
+{
+    static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_INFO, ""};
+    for (auto compression : {FileCompression::NONE, FileCompression::LZ4})
+    {
+        auto fileName = generateRandomFileName("rdbin_", ".blog");
+        std::vector<std::string> expected;
+        {
+            FileOps file(1024 * 1000, fileName);
+            file.setFileFormat(FileFormat::BINARY)
+                .setFileCompression(compression);
+            std::string record;
+            std::string rendered;
+            for (auto cnt = 0; cnt < 300; ++cnt)
+            {
+                DeferredRecord::encode(record, site, std::this_thread::get_id(), std::chrono::system_clock::now(),
+                                       "Record {} of {}", cnt, std::string("the test"));
+                DeferredRecord::render(record, rendered);
+                file.writeDeferred(record);
+                expected.push_back(rendered);
+            }
+            file.write(std::string("A text record\nof two lines"));
+            expected.push_back("A text record");
+            expected.push_back("of two lines");
+        }
+        LogReader reader(fileName);
+        EXPECT_EQ(expected, readAll(reader));
+        ASSERT_TRUE(FileOps::removeFile(fileName));
+    }
+}
+
+TEST_F(LogReaderTest, testFollowMappedFile)
+{
+    auto fileName = generateRandomFileName("rdmmap_");
+    FileOps file(1024 * 1000, fileName);
+    file.setFileIoMode(FileIoMode::MMAP);
+    for (size_t cnt = 0; cnt < 100; ++cnt)
+        file.write(logLine(cnt));
+    file.flush();
+
+    // The preallocated space is no line, and is read afresh once written to
+    LogReader reader(fileName);
+    EXPECT_EQ(100u, readAll(reader).size());
+    for (size_t cnt = 100; cnt < 150; ++cnt)
+        file.write(logLine(cnt));
+    file.flush();
+    auto lines = readAll(reader);
+    ASSERT_EQ(50u, lines.size());
+    EXPECT_EQ(logLine(100), lines.front());
+    EXPECT_EQ(logLine(149), lines.back());
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(LogReaderTest, testZeroByteInRecord)
+{
+    // Written as it is, the file isn't mapped, so the zero byte is a part of the record
+    using namespace std::string_literals;
+    auto fileName = generateRandomFileName("rdnul_");
+    const std::vector<std::string> expected = {"line one", "has\0nul"s, "line three"};
+    {
+        FileOps file(1024 * 1000, fileName);
+        for (const auto& record : expected)
+            file.write(record);
+        file.flush();
+    }
+
+    LogReader reader(fileName);
+    EXPECT_EQ(expected, readAll(reader));
+    FileOps file(1024 * 1000, fileName);
+    file.readFile();
+    EXPECT_EQ(expected.size(), file.getFileContent().size());
+    std::vector<std::string> lines;
+    EXPECT_EQ(expected.size(), file.readFile([&lines](const std::string_view line)
+    {
+        lines.emplace_back(line);
+        return true;
+    }));
+    EXPECT_EQ(expected, lines);
+    ASSERT_TRUE(file.deleteFile());
+}
+
+TEST_F(LogReaderTest, testFileOpsLineHandler)
+{
+    auto fileName = generateRandomFileName("rdops_");
+    FileOps file(10 * 1024 * 1024, fileName);
+    for (size_t cnt = 0; cnt < 20000; ++cnt)
+        file.write(logLine(cnt));
+
+    size_t linesCnt = 0;
+    size_t totalSize = 0;
+    EXPECT_EQ(20000u, file.readFile([&linesCnt, &totalSize](const std::string_view line)
+    {
+        ++linesCnt;
+        totalSize += line.size() + 1;
+        return true;
+    }));
+    EXPECT_EQ(20000u, linesCnt);
+    EXPECT_EQ(file.getFileSize(), totalSize);
+
+    // The handler stops the read whenever it likes
+    std::string found;
+    EXPECT_EQ(43u, file.readFile([&found](const std::string_view line)
+    {
+        if (!line.ends_with("data[42]"))
+            return true;
+        found = line;
+        return false;
+    }));
+    EXPECT_EQ(logLine(42), found);
+    ASSERT_TRUE(file.deleteFile());
+}
@@ -8,6 +8,7 @@
 #include "FileOps.hpp"
 #include "ConsoleOps.hpp"
 
+#include <iomanip>
 #include <type_traits>
 
 using namespace logger;
@@ -45,29 +46,30 @@ class LoggerTest : public CommonTestDataGenerator
             const std::string_view marker,
             const std::string_view logMsg = "") noexcept
         {
-            auto& logStream = loggerObj.getLogStream();
+            auto logRecord = loggerObj.getLogRecord();
             std::ostringstream oss;
             oss << std::this_thread::get_id();
-            EXPECT_TRUE(logStream.str().find(oss.str()) != std::string::npos)
-                << "oss.str() = " << oss.str() << ", " << "logStream.str() = " << logStream.str();
-            std::ostringstream().swap(oss);
-            oss << __FILE__;
-            EXPECT_TRUE(logStream.str().find(oss.str()) != std::string::npos)
-                << "oss.str() = " << oss.str() << ", " << "logStream.str() = " << logStream.str();
-
-            EXPECT_TRUE(logStream.str().find(Logger::covertLogTypeEnumToString(expLogType)) != std::string::npos);
+            EXPECT_TRUE(logRecord.find(oss.str()) != std::string::npos)
+                << "oss.str() = " << oss.str() << ", " << "logRecord = " << logRecord;
+            // Only the base name of the file is logged
+            auto fileName = std::string_view(__FILE__);
+            fileName = fileName.substr(fileName.find_last_of("/") + 1);
+            EXPECT_TRUE(logRecord.find(fileName) != std::string::npos)
+                << "fileName = " << fileName << ", " << "logRecord = " << logRecord;
+
+            EXPECT_TRUE(logRecord.find(Logger::covertLogTypeEnumToString(expLogType)) != std::string::npos);
             ASSERT_TRUE(std::string::npos != prettyFuncName.find(":"));
             auto className = prettyFuncName.substr(0, prettyFuncName.find_first_of(":"));
             className = className.substr(className.rfind(" ") + 1);
             auto funcNameWithoutClassName = prettyFuncName.substr(prettyFuncName.find_last_of(":") + 1);
             funcNameWithoutClassName = funcNameWithoutClassName.substr(0, funcNameWithoutClassName.find_first_of("("));
 
-            EXPECT_TRUE(logStream.str().find(className) != std::string::npos) << "className = " << className << std::endl;
-            EXPECT_TRUE(logStream.str().find(funcNameWithoutClassName) != std::string::npos) << "funcNameWithoutClassName = " << funcNameWithoutClassName;
-            EXPECT_TRUE(logStream.str().find(marker) != std::string::npos);
+            EXPECT_TRUE(logRecord.find(className) != std::string::npos) << "className = " << className << std::endl;
+            EXPECT_TRUE(logRecord.find(funcNameWithoutClassName) != std::string::npos) << "funcNameWithoutClassName = " << funcNameWithoutClassName;
+            EXPECT_TRUE(logRecord.find(marker) != std::string::npos);
 
             if (!logMsg.empty())
-                EXPECT_TRUE(logStream.str().find(logMsg) != std::string::npos);
+                EXPECT_TRUE(logRecord.find(logMsg) != std::string::npos);
         }
         static int* funcReturningPointer(const int val1, const int val2) noexcept
         {
@@ -110,6 +112,36 @@ TEST_F(LoggerTest, testLogTypeEnumToString)
         EXPECT_EQ(Logger::covertLogTypeEnumToString(logTypeVec[idx]), logTypeStringVec[idx]);
 }
 
+TEST_F(LoggerTest, testLogTypeName)
+{
+    static_assert(Logger::logTypeName(LOG_TYPE::LOG_ASSERT) == "ASRT");
+    for (size_t idx = 0; idx < logTypeVec.size(); ++idx)
+        EXPECT_EQ(logTypeStringVec[idx], Logger::logTypeName(logTypeVec[idx]));
+    EXPECT_EQ("DEFAULT", Logger::logTypeName(static_cast<LOG_TYPE>(0x42)));
+}
+
+TEST_F(LoggerTest, testLogRecordLayout)
+{
+    static constexpr CallSite site{"/src/Handler.cpp", "void Handler::handle(int)", 42, LOG_TYPE::LOG_WARN, FORWARD_ANGLE};
+    Logger logger(DEFAULT_TIME_FORMAT);
+    logger.setCallSite(site).setThreadId(std::this_thread::get_id());
+    auto timeStamp = std::chrono::system_clock::now();
+    logger.logFormatted(timeStamp, "The message");
+
+    std::ostringstream oss;
+    oss << std::setw(10) << std::this_thread::get_id();
+    std::array<char, 96> timeStr;
+    auto len = Clock(DEFAULT_TIME_FORMAT).formatLocalTime(timeStamp, timeStr.data(), timeStr.size());
+    auto expected = std::format("|{}| {}| Handler.cpp         |   42|WARN> [Handler : handle] The message",
+                                std::string_view(timeStr.data(), len), oss.str());
+    EXPECT_EQ(expected, logger.getLogRecord());
+
+    // The buffer is reused, the next record doesn't take any new memory
+    auto pRecord = logger.getLogRecord().data();
+    logger.setCallSite(site).logFormatted(timeStamp, "Another message");
+    EXPECT_EQ(pRecord, logger.getLogRecord().data());
+}
+
 TEST_F(LoggerTest, testLogList)
 {
     std::uintmax_t maxTextSize = 10;
@@ -175,12 +207,12 @@ TEST_F(LoggerTest, testLogEntryExitDebug)
 #endif
     LOG_ENTRY_DBG();
 #if defined (DEBUG) || defined (__DEBUG__)
-    testLoggedData(LOG_TYPE::LOG_INFO, __PRETTY_FUNCTION__, FORWARD_ANGLES);
+    testLoggedData(LOG_TYPE::LOG_DBG, __PRETTY_FUNCTION__, FORWARD_ANGLES);
 #endif
     LOG_EXIT_DBG();
 #if defined (DEBUG) || defined (__DEBUG__)
     std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
-    testLoggedData(LOG_TYPE::LOG_INFO, __PRETTY_FUNCTION__, BACKWARD_ANGLES);
+    testLoggedData(LOG_TYPE::LOG_DBG, __PRETTY_FUNCTION__, BACKWARD_ANGLES);
 #endif
 }
 
@@ -207,14 +239,14 @@ TEST_F(LoggerTest, testLogEntryExitWithMsgDebugMode)
     LOG_ENTRY_DBG("Entering now {} with LOG_TYPE as {:#08x} and log marker as {}",
         std::string("testLogEntryExitWithMsg"), logType, FORWARD_ANGLES);
 #if defined (DEBUG) || defined (__DEBUG__)
-    testLoggedData(LOG_TYPE::LOG_INFO, __PRETTY_FUNCTION__, FORWARD_ANGLES);
+    testLoggedData(LOG_TYPE::LOG_DBG, __PRETTY_FUNCTION__, FORWARD_ANGLES);
 #endif
 
     LOG_EXIT_DBG("Exiting {} with LOG_TYPE as {:#08x} and log marker as {}",
         std::string("testLogEntryExitWithMsg"), logType, BACKWARD_ANGLES);
 #if defined (DEBUG) || defined (__DEBUG__)
     std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
-    testLoggedData(LOG_TYPE::LOG_INFO, __PRETTY_FUNCTION__, BACKWARD_ANGLES);
+    testLoggedData(LOG_TYPE::LOG_DBG, __PRETTY_FUNCTION__, BACKWARD_ANGLES);
 #endif
 }
 
@@ -303,3 +335,33 @@ TEST_F(LoggerTest, testDiffFuncSignatures)
         EXPECT_EQ(0, lamdaFunc("Testing ", "function signature"));
     }
 }
+
+TEST_F(LoggerTest, testPerThreadLogRecord)
+{
+    constexpr size_t noOfThreads = 8;
+    std::vector<std::thread> threads;
+    std::vector<std::string> records(noOfThreads);
+    std::vector<std::string> threadIds(noOfThreads);
+    for (size_t idx = 0; idx < noOfThreads; ++idx)
+    {
+        threads.emplace_back([idx, &records, &threadIds]()
+        {
+            std::ostringstream oss;
+            oss << std::this_thread::get_id();
+            threadIds[idx] = oss.str();
+            for (auto cnt = 0; cnt < 50; ++cnt)
+                LOG_INFO("Thread no {} logging msg no {}", idx, cnt);
+            // Each thread must see only its own last record in its own logger object
+            records[idx] = loggerObj.getLogRecord();
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (size_t idx = 0; idx < noOfThreads; ++idx)
+    {
+        EXPECT_NE(std::string::npos, records[idx].find(threadIds[idx])) << records[idx];
+        EXPECT_NE(std::string::npos, records[idx].find("Thread no " + std::to_string(idx) + " logging msg no 49"))
+            << records[idx];
+    }
+}
@@ -0,0 +1,283 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @file NetworkOpsTest.cpp
+ * @brief Unit tests for the NetworkOps class.
+ *
+ * This file contains tests that verify the records reach a collector on the
+ * loopback as syslog messages, a datagram each over UDP and octet counted over
+ * TCP, and that they go to the spill file while the collector is not there,
+ * the connection being made again once it is back.
+ */
+
+#include "NetworkOps.hpp"
+#include "FileOps.hpp"
+#include "DeferredRecord.hpp"
+#include "RecordEncoder.hpp"
+#include "CommonFunc.hpp"
+
+#include <regex>
+
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class NetworkOpsTest : public CommonTestDataGenerator
+{
+    protected:
+        static constexpr CallSite infoSite{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_INFO, ""};
+
+        void TearDown() override
+        {
+            for (auto fd : m_Fds)
+                ::close(fd);
+        }
+
+        /**
+         * @brief Open a socket bound to the loopback, on the given port or any free one
+         */
+        int openSocket(const int type, uint16_t& port)
+        {
+            auto fd = ::socket(AF_INET, type, 0);
+            EXPECT_GE(fd, 0);
+            int reuse = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            timeval timeOut{5, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeOut, sizeof(timeOut));
+
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            EXPECT_EQ(0, ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+            socklen_t len = sizeof(addr);
+            ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+            port = ntohs(addr.sin_port);
+            if (SOCK_STREAM == type)
+            {
+                EXPECT_EQ(0, ::listen(fd, 4));
+            }
+            m_Fds.push_back(fd);
+            return fd;
+        }
+
+        /**
+         * @brief Read the octet counted messages of a TCP stream till there are the given number of them
+         */
+        static std::vector<std::string> readFrames(const int listenFd, const size_t framesCnt)
+        {
+            std::vector<std::string> frames;
+            auto fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd < 0)
+                return frames;
+            timeval timeOut{5, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeOut, sizeof(timeOut));
+
+            std::string stream;
+            std::array<char, 64 * 1024> buf;
+            while (frames.size() < framesCnt)
+            {
+                auto cnt = ::recv(fd, buf.data(), buf.size(), 0);
+                if (cnt <= 0)
+                    break;
+                stream.append(buf.data(), static_cast<size_t>(cnt));
+                for (auto spacePos = stream.find(' '); spacePos != std::string::npos; spacePos = stream.find(' '))
+                {
+                    auto len = std::stoul(stream.substr(0, spacePos));
+                    if (stream.size() < spacePos + 1 + len)
+                        break;
+                    frames.push_back(stream.substr(spacePos + 1, len));
+                    stream.erase(0, spacePos + 1 + len);
+                }
+            }
+            ::close(fd);
+            return frames;
+        }
+
+        std::vector<int> m_Fds;
+};
+
+TEST_F(NetworkOpsTest, testParseTarget)
+{
+    auto target = NetworkTarget::parse("udp://collector.example.com:1514");
+    ASSERT_TRUE(target);
+    EXPECT_EQ("collector.example.com", target->host);
+    EXPECT_EQ(1514u, target->port);
+    EXPECT_EQ(NetworkProtocol::UDP_SYSLOG, target->protocol);
+
+    target = NetworkTarget::parse("tcp://[fe80::1]");
+    ASSERT_TRUE(target);
+    EXPECT_EQ("fe80::1", target->host);
+    EXPECT_EQ(514u, target->port);
+    EXPECT_EQ(NetworkProtocol::TCP_SYSLOG, target->protocol);
+
+    EXPECT_FALSE(NetworkTarget::parse("collector:514"));
+    EXPECT_FALSE(NetworkTarget::parse("http://collector:514"));
+    EXPECT_FALSE(NetworkTarget::parse("udp://:514"));
+    EXPECT_FALSE(NetworkTarget::parse("udp://collector:port"));
+    EXPECT_FALSE(NetworkTarget::parse("udp://collector:70000"));
+    EXPECT_FALSE(NetworkTarget::parse("tcp://[::1"));
+}
+
+TEST_F(NetworkOpsTest, testUdpSyslog)
+{
+    uint16_t port = 0;
+    auto collectorFd = openSocket(SOCK_DGRAM, port);
+
+    std::string record;
+    DeferredRecord::encode(record, infoSite, std::this_thread::get_id(), std::chrono::system_clock::now(), "Request {} served", 42);
+    std::string rendered;
+    DeferredRecord::render(record, rendered);
+    {
+        NetworkOps network("127.0.0.1", port);
+        network.setSyslogFacility(16)     // local0
+               .setHostName("web-01")
+               .setAppName("order service");
+        network.write("Disk almost full", LOG_TYPE::LOG_WARN);
+        network.write("No type at all");
+        network.writeDeferred(record);
+        network.flush();
+        EXPECT_TRUE(network.isConnected());
+        EXPECT_EQ(3u, network.getSentRecordsCount());
+        EXPECT_EQ(0u, network.getLostRecordsCount());
+    }
+
+    std::vector<std::string> datagrams;
+    std::array<char, 64 * 1024> buf;
+    for (auto cnt = 0; cnt < 3; ++cnt)
+    {
+        auto len = ::recv(collectorFd, buf.data(), buf.size(), 0);
+        ASSERT_GT(len, 0);
+        datagrams.emplace_back(buf.data(), static_cast<size_t>(len));
+    }
+
+    // <PRI> is the facility * 8 + the severity, the time stamp in UTC with microseconds
+    auto pid = std::to_string(::getpid());
+    std::string header = R"(1 \d{4}-\d\d-\d\dT\d\d:\d\d:\d\d\.\d{6}Z web-01 order_service )" + pid + " - - ";
+    EXPECT_TRUE(std::regex_match(datagrams[0], std::regex("<132>" + header + "Disk almost full"))) << datagrams[0];
+    EXPECT_TRUE(std::regex_match(datagrams[1], std::regex("<134>" + header + "No type at all"))) << datagrams[1];
+    EXPECT_TRUE(datagrams[2].starts_with("<134>1 ")) << datagrams[2];
+    EXPECT_TRUE(datagrams[2].ends_with(" - - " + rendered)) << datagrams[2];
+}
+
+TEST_F(NetworkOpsTest, testTcpOctetCounting)
+{
+    uint16_t port = 0;
+    auto listenFd = openSocket(SOCK_STREAM, port);
+    const size_t recordsCnt = 5000;
+    std::vector<std::string> frames;
+    std::thread collector([&frames, listenFd]() { frames = readFrames(listenFd, recordsCnt + 1); });
+
+    std::string record;
+    DeferredRecord::encode(record, infoSite, std::this_thread::get_id(), std::chrono::system_clock::now(), "Request {} served", 42);
+    {
+        NetworkOps network("127.0.0.1", port, NetworkProtocol::TCP_SYSLOG);
+        network.setRecordEncoder(RecordEncoder::create(RecordEncoding::JSON));
+        for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+            network.write(std::format("Error {}", cnt), LOG_TYPE::LOG_ERR);
+        network.writeDeferred(record);
+        network.flush();
+        EXPECT_EQ(recordsCnt + 1, network.getSentRecordsCount());
+        EXPECT_EQ(1u, network.getConnectsCount());
+    }
+    collector.join();
+
+    // Every message in full, in the order written
+    ASSERT_EQ(recordsCnt + 1, frames.size());
+    for (size_t cnt = 0; cnt < recordsCnt; ++cnt)
+    {
+        EXPECT_TRUE(frames[cnt].starts_with("<11>1 ")) << frames[cnt];
+        EXPECT_TRUE(frames[cnt].ends_with(std::format(" - - {{\"msg\":\"Error {}\"}}", cnt))) << frames[cnt];
+    }
+    EXPECT_TRUE(frames.back().starts_with("<14>1 ")) << frames.back();
+    EXPECT_NE(std::string::npos, frames.back().find(" - - {\"ts\":\"")) << frames.back();
+    EXPECT_NE(std::string::npos, frames.back().find("\"msg\":\"Request 42 served\"")) << frames.back();
+}
+
+TEST_F(NetworkOpsTest, testSpillAndReconnect)
+{
+    // A free port nobody listens on, till later on
+    uint16_t port = 0;
+    ::close(openSocket(SOCK_STREAM, port));
+    m_Fds.clear();
+
+    auto spillFile = std::make_shared<FileOps>(1024 * 1000, generateRandomFileName("spill_"));
+    NetworkOps network("127.0.0.1", port, NetworkProtocol::TCP_SYSLOG);
+    network.setSpillFile(spillFile)
+           .setReconnectBackoff(std::chrono::milliseconds(1), std::chrono::milliseconds(5));
+    for (auto cnt = 0; cnt < 10; ++cnt)
+        network.write(std::format("Spilled {}", cnt), LOG_TYPE::LOG_INFO);
+    network.flush();
+    EXPECT_FALSE(network.isConnected());
+    EXPECT_EQ(0u, network.getSentRecordsCount());
+    EXPECT_EQ(10u, network.getSpilledRecordsCount());
+    EXPECT_EQ(0u, network.getLostRecordsCount());
+
+    // The spilled records are the syslog messages they would have been sent as
+    spillFile->flush();
+    spillFile->readFile();
+    const auto& spilled = spillFile->getFileContent();
+    ASSERT_EQ(10u, spilled.size());
+    EXPECT_TRUE(spilled.front().starts_with("<14>1 ")) << spilled.front();
+    EXPECT_TRUE(spilled.back().ends_with(" - - Spilled 9")) << spilled.back();
+
+    // The collector is back, the connection is made again after the backoff
+    auto listenFd = openSocket(SOCK_STREAM, port);
+    std::vector<std::string> frames;
+    std::thread collector([&frames, listenFd]() { frames = readFrames(listenFd, 1); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    network.write("Sent", LOG_TYPE::LOG_INFO);
+    network.flush();
+    collector.join();
+    EXPECT_TRUE(network.isConnected());
+    EXPECT_EQ(1u, network.getConnectsCount());
+    EXPECT_EQ(1u, network.getSentRecordsCount());
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_TRUE(frames[0].ends_with(" - - Sent")) << frames[0];
+    ASSERT_TRUE(spillFile->deleteFile());
+}
+
+TEST_F(NetworkOpsTest, testLostWithoutSpillFile)
+{
+    uint16_t port = 0;
+    ::close(openSocket(SOCK_STREAM, port));
+    m_Fds.clear();
+
+    NetworkOps network("127.0.0.1", port, NetworkProtocol::TCP_SYSLOG);
+    network.setReconnectBackoff(std::chrono::milliseconds(1), std::chrono::milliseconds(5));
+    network.write("Lost", LOG_TYPE::LOG_ERR);
+    network.flush();
+    network.write("Lost too", LOG_TYPE::LOG_ERR);
+    network.flush();
+    EXPECT_EQ(2u, network.getLostRecordsCount());
+    EXPECT_FALSE(network.isConnected());
+}
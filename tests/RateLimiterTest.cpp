@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file RateLimiterTest.cpp
+ * @brief Unit tests for the RateLimiter class.
+ *
+ * This file contains tests that verify a log statement gets at most the given
+ * number of records per interval, whatever the number of threads logging, that
+ * the dropped ones are summed up once the interval is over, even for a statement
+ * gone quiet, and that a dropped LOG_* statement doesn't even evaluate its arguments.
+ */
+
+#include "RateLimiter.hpp"
+#include "LOGGER_MACROS.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace logger;
+
+class RateLimiterTest : public ::testing::Test
+{
+    protected:
+        void TearDown() override
+        {
+            RateLimiter::setLimit(0);
+        }
+
+        static int countedArg(int& cnt)
+        {
+            return ++cnt;
+        }
+};
+
+TEST_F(RateLimiterTest, testNoLimitByDefault)
+{
+    EXPECT_EQ(0u, RateLimiter::getMaxRecords());
+    RateLimiter limiter;
+    uint64_t suppressedCnt = 0;
+    for (auto cnt = 0; cnt < 1000; ++cnt)
+        EXPECT_TRUE(limiter.allow(suppressedCnt));
+    EXPECT_EQ(0u, suppressedCnt);
+}
+
+TEST_F(RateLimiterTest, testLimitPerInterval)
+{
+    RateLimiter::setLimit(3, std::chrono::milliseconds(200));
+    EXPECT_EQ(3u, RateLimiter::getMaxRecords());
+    EXPECT_EQ(std::chrono::milliseconds(200), RateLimiter::getInterval());
+
+    // Starting right at an interval, so that all of them fall into the same one
+    auto intervalStart = [](){ return std::chrono::steady_clock::now().time_since_epoch() % std::chrono::milliseconds(200); };
+    while (intervalStart() > std::chrono::milliseconds(20))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    RateLimiter limiter;
+    uint64_t suppressedCnt = 0;
+    size_t allowedCnt = 0;
+    for (auto cnt = 0; cnt < 10; ++cnt)
+        allowedCnt += limiter.allow(suppressedCnt);
+    EXPECT_EQ(3u, allowedCnt);
+    EXPECT_EQ(0u, suppressedCnt);
+
+    // The first one of the next interval gets the number of the dropped ones
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    EXPECT_TRUE(limiter.allow(suppressedCnt));
+    EXPECT_EQ(7u, suppressedCnt);
+    suppressedCnt = 0;
+    EXPECT_TRUE(limiter.allow(suppressedCnt));
+    EXPECT_EQ(0u, suppressedCnt);
+}
+
+TEST_F(RateLimiterTest, testLimitAcrossThreads)
+{
+    RateLimiter::setLimit(100, std::chrono::seconds(3600));
+    RateLimiter limiter;
+    std::atomic<size_t> allowedCnt = 0;
+    std::vector<std::thread> threads;
+    for (auto idx = 0; idx < 8; ++idx)
+    {
+        threads.emplace_back([&limiter, &allowedCnt]()
+        {
+            uint64_t suppressedCnt = 0;
+            for (auto cnt = 0; cnt < 10000; ++cnt)
+                allowedCnt += limiter.allow(suppressedCnt);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(100u, allowedCnt);
+}
+
+TEST_F(RateLimiterTest, testLogStatementIsLimited)
+{
+    RateLimiter::setLimit(5, std::chrono::milliseconds(300));
+    while (std::chrono::steady_clock::now().time_since_epoch() % std::chrono::milliseconds(300) > std::chrono::milliseconds(30))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    int cnt = 0;
+    auto pushedCnt = loggingOps.getStats().pushedRecords;
+    auto logInLoop = [&cnt](const int times)
+    {
+        for (auto idx = 0; idx < times; ++idx)
+            LOG_ERR("A dependency is down, retrying {}", countedArg(cnt));
+    };
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    logInLoop(1000);
+    EXPECT_EQ(5, cnt);
+    EXPECT_EQ(pushedCnt + 5, loggingOps.getStats().pushedRecords);
+
+    // The summary goes first, at the same call site
+    std::this_thread::sleep_for(std::chrono::milliseconds(350));
+    logInLoop(1);
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(6, cnt);
+    EXPECT_EQ(pushedCnt + 7, loggingOps.getStats().pushedRecords);
+}
+
+TEST_F(RateLimiterTest, testQuietStatementIsSummedUp)
+{
+    RateLimiter::setLimit(5, std::chrono::milliseconds(100));
+    while (std::chrono::steady_clock::now().time_since_epoch() % std::chrono::milliseconds(100) > std::chrono::milliseconds(10))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto pushedCnt = loggingOps.getStats().pushedRecords;
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    for (auto idx = 0; idx < 100; ++idx)
+        LOG_WARN("A burst which stops, {}", idx);
+    EXPECT_EQ(pushedCnt + 5, loggingOps.getStats().pushedRecords);
+
+    // Never logged again, the summary comes from the sweeper
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (loggingOps.getStats().pushedRecords < pushedCnt + 6 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::cout << std::endl; // Put a line break so that the printed log msg can be seen clearly
+    EXPECT_EQ(pushedCnt + 6, loggingOps.getStats().pushedRecords);
+}
@@ -0,0 +1,220 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file RecordEncoderTest.cpp
+ * @brief Unit tests for the structured records and the JSON and logfmt encoders.
+ *
+ * This file contains tests that verify the strings are escaped and quoted right
+ * wherever the special characters are, that the structured records come out of
+ * the encoders with their typed fields and as logfmt text without an encoder,
+ * and that the watcher thread of LoggingOps writes the records with its encoder.
+ */
+
+#include "RecordEncoder.hpp"
+#include "DeferredRecord.hpp"
+#include "ConsoleOps.hpp"
+#include "Logger.hpp"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace logger;
+
+class EncodingConsoleOps : public ConsoleOps
+{
+    public:
+        EncodingConsoleOps() : ConsoleOps() { m_testing = true; }
+        inline const std::ostringstream& getTestStringStream() const { return m_testStringStream; }
+};
+
+class RecordEncoderTest : public ::testing::Test
+{
+    protected:
+        static constexpr CallSite site{__FILE__, "void Server::serve(int)", 42, LOG_TYPE::LOG_INFO, FORWARD_ANGLE};
+        static constexpr int64_t timeStampNs = 1755829263123456789;
+
+        static std::chrono::system_clock::time_point timeStamp()
+        {
+            return std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timeStampNs)));
+        }
+
+        static std::string jsonString(const std::string_view str)
+        {
+            std::string out;
+            RecordEncoder::appendJsonString(str, out);
+            return out;
+        }
+
+        static std::string logfmtString(const std::string_view str)
+        {
+            std::string out;
+            RecordEncoder::appendLogfmtString(str, out);
+            return out;
+        }
+
+        static std::string structuredRecord()
+        {
+            std::string record;
+            std::string path = "/index.html";
+            DeferredRecord::encodeFields(record, site, std::this_thread::get_id(), timeStamp(), "Request served",
+                                         kv("path", path), kv("status", 200), kv("ok", true),
+                                         kv("note", "two \"words\""), kv("ratio", 0.5));
+            return record;
+        }
+
+        static std::string threadId()
+        {
+            return std::string(Logger::threadIdStr(std::this_thread::get_id()));
+        }
+};
+
+TEST_F(RecordEncoderTest, testEscaping)
+{
+    EXPECT_EQ("\"\"", jsonString(""));
+    EXPECT_EQ("\"plain\"", jsonString("plain"));
+    EXPECT_EQ("\"a \\\"quoted\\\" \\\\ path\\n\\ttab\\u0001\"", jsonString("a \"quoted\" \\ path\n\ttab\x01"));
+
+    // Wherever the special character is, in the words scanned at once or in the tail
+    std::string longStr(37, 'x');
+    for (size_t pos = 0; pos < longStr.size(); ++pos)
+    {
+        auto str = longStr;
+        str[pos] = '"';
+        auto expected = "\"" + longStr.substr(0, pos) + "\\\"" + longStr.substr(pos + 1) + "\"";
+        EXPECT_EQ(expected, jsonString(str)) << pos;
+        str[pos] = ' ';
+        EXPECT_EQ("\"" + str + "\"", logfmtString(str)) << pos;
+    }
+    EXPECT_EQ(longStr, logfmtString(longStr));
+
+    // The bytes above 0x7F (UTF-8) are copied as they are
+    EXPECT_EQ("\"gr\xC3\xBC\xC3\x9F\"", jsonString("gr\xC3\xBC\xC3\x9F"));
+    EXPECT_EQ("gr\xC3\xBC\xC3\x9F", logfmtString("gr\xC3\xBC\xC3\x9F"));
+
+    EXPECT_EQ("\"\"", logfmtString(""));
+    EXPECT_EQ("\"a=b\"", logfmtString("a=b"));
+    EXPECT_EQ("\"line\\nbreak\"", logfmtString("line\nbreak"));
+}
+
+TEST_F(RecordEncoderTest, testTimeStamp)
+{
+    std::string out;
+    RecordEncoder::appendTimeStamp(timeStampNs, out);
+    EXPECT_EQ("2025-08-22T02:21:03.123456789Z", out);
+    out.clear();
+    RecordEncoder::appendTimeStamp(1, out);
+    EXPECT_EQ("1970-01-01T00:00:00.000000001Z", out);
+    out.clear();
+    RecordEncoder::appendTimeStamp(-1, out);
+    EXPECT_EQ("1969-12-31T23:59:59.999999999Z", out);
+}
+
+TEST_F(RecordEncoderTest, testStructuredRecord)
+{
+    auto record = structuredRecord();
+    auto fields = DeferredRecord::decode(record);
+    EXPECT_TRUE(fields.m_isStructured);
+    EXPECT_EQ("Request served", fields.m_FormatStr);
+    EXPECT_EQ(10u, fields.m_ArgsCnt);
+
+    // Without an encoder, the fields follow the message in logfmt
+    std::string msg;
+    DeferredRecord::formatMessage(record, msg);
+    EXPECT_EQ("Request served path=/index.html status=200 ok=true note=\"two \\\"words\\\"\" ratio=0.5", msg);
+    std::string line;
+    DeferredRecord::render(record, line);
+    EXPECT_TRUE(line.ends_with(" " + msg)) << line;
+
+    std::string plain;
+    DeferredRecord::encode(plain, site, std::this_thread::get_id(), timeStamp(), "Value {}", 7);
+    EXPECT_FALSE(DeferredRecord::decode(plain).m_isStructured);
+}
+
+TEST_F(RecordEncoderTest, testJsonEncoder)
+{
+    JsonEncoder encoder;
+    std::string line;
+    encoder.encode(structuredRecord(), RecordKind::DEFERRED, line);
+    auto prefix = "{\"ts\":\"2025-08-22T02:21:03.123456789Z\",\"level\":\"INF\",\"thread\":\"" + threadId() +
+                  "\",\"file\":\"RecordEncoderTest.cpp\",\"line\":42,\"function\":\"Server::serve\",";
+    EXPECT_EQ(prefix + "\"msg\":\"Request served\",\"path\":\"/index.html\",\"status\":200,\"ok\":true,"
+                       "\"note\":\"two \\\"words\\\"\",\"ratio\":0.5}", line);
+
+    // A plain deferred record has its formatted message, a text record only the msg field
+    std::string record;
+    DeferredRecord::encode(record, site, std::this_thread::get_id(), timeStamp(), "Took {} us", 250);
+    encoder.encode(record, RecordKind::DEFERRED, line);
+    EXPECT_EQ(prefix + "\"msg\":\"Took 250 us\"}", line);
+    encoder.encode("Plain \"text\"", RecordKind::TEXT, line);
+    EXPECT_EQ("{\"msg\":\"Plain \\\"text\\\"\"}", line);
+
+    // JSON has no NaN and no infinity
+    DeferredRecord::encodeFields(record, site, std::this_thread::get_id(), timeStamp(), "Odd",
+                                 kv("nan", std::numeric_limits<double>::quiet_NaN()),
+                                 kv("inf", std::numeric_limits<float>::infinity()), kv("min", int64_t(-9223372036854775807 - 1)));
+    encoder.encode(record, RecordKind::DEFERRED, line);
+    EXPECT_EQ(prefix + "\"msg\":\"Odd\",\"nan\":null,\"inf\":null,\"min\":-9223372036854775808}", line);
+}
+
+TEST_F(RecordEncoderTest, testLogfmtEncoder)
+{
+    LogfmtEncoder encoder;
+    std::string line;
+    encoder.encode(structuredRecord(), RecordKind::DEFERRED, line);
+    EXPECT_EQ("ts=2025-08-22T02:21:03.123456789Z level=INF thread=" + threadId() +
+              " file=RecordEncoderTest.cpp line=42 function=Server::serve msg=\"Request served\""
+              " path=/index.html status=200 ok=true note=\"two \\\"words\\\"\" ratio=0.5", line);
+    encoder.encode("Plain text", RecordKind::TEXT, line);
+    EXPECT_EQ("msg=\"Plain text\"", line);
+}
+
+TEST_F(RecordEncoderTest, testWatcherEncodesRecords)
+{
+    EncodingConsoleOps consoleOps;
+    EXPECT_FALSE(consoleOps.wantsDeferredRecords());
+    consoleOps.setRecordEncoder(RecordEncoder::create(RecordEncoding::JSON));
+    EXPECT_TRUE(consoleOps.wantsDeferredRecords());
+    EXPECT_FALSE(consoleOps.keepsDeferredRecords());
+    ASSERT_TRUE(consoleOps.getRecordEncoder());
+    EXPECT_EQ("JsonEncoder", consoleOps.getRecordEncoder()->getClassId());
+
+    consoleOps << "Plain text record";
+    consoleOps.writeDeferred(structuredRecord());
+    consoleOps.flush();
+    auto output = consoleOps.getTestStringStream().str();
+    EXPECT_NE(std::string::npos, output.find("{\"msg\":\"Plain text record\"}")) << output;
+    EXPECT_NE(std::string::npos, output.find("\"msg\":\"Request served\",\"path\":\"/index.html\",\"status\":200")) << output;
+
+    // Back to the text layout
+    consoleOps.setRecordEncoder(nullptr);
+    EXPECT_FALSE(consoleOps.wantsDeferredRecords());
+    consoleOps.writeDeferred(structuredRecord());
+    consoleOps.flush();
+    output = consoleOps.getTestStringStream().str();
+    EXPECT_NE(std::string::npos, output.find("] Request served path=/index.html status=200 ok=true")) << output;
+    EXPECT_FALSE(RecordEncoder::create(RecordEncoding::TEXT));
+}
@@ -0,0 +1,301 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file RecordRingTest.cpp
+ * @brief Unit tests for the RecordRing and RecordArena classes.
+ *
+ * This file contains tests that verify the ordering, the wrap around, the
+ * overflow policies (block, drop newest and overwrite oldest), the drop
+ * counter and the behaviour of the RecordRing class with several producers
+ * in parallel, along with the RecordArena the records are drained into.
+ */
+
+#include "RecordRing.hpp"
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <thread>
+
+using namespace logger;
+
+static std::vector<std::string> drainAll(RecordRing& ring)
+{
+    RecordArena arena;
+    ring.drain(arena);
+    std::vector<std::string> records;
+    for (const auto record : arena)
+        records.emplace_back(record);
+    return records;
+}
+
+TEST(RecordRingTest, testArenaAppendAndIterate)
+{
+    RecordArena arena;
+    ASSERT_TRUE(arena.empty());
+    arena.append("first");
+    arena.append("");
+    arena.append("third record");
+    EXPECT_EQ(arena.size(), 3);
+
+    std::vector<std::string_view> records(arena.begin(), arena.end());
+    EXPECT_EQ(records, std::vector<std::string_view>({"first", "", "third record"}));
+
+    arena.clear();
+    EXPECT_TRUE(arena.empty());
+    EXPECT_EQ(arena.bytes(), 0);
+    EXPECT_EQ(arena.begin(), arena.end());
+}
+
+TEST(RecordRingTest, testRecordKindSurvivesDrain)
+{
+    RecordRing ring(4096);
+    ASSERT_TRUE(ring.tryPush("text"));
+    ASSERT_TRUE(ring.tryPush("deferred", RecordKind::DEFERRED));
+    ASSERT_TRUE(ring.push("text again", [](){}, RecordKind::TEXT));
+
+    RecordArena arena;
+    EXPECT_EQ(ring.drain(arena), 3);
+    std::vector<std::pair<std::string_view, RecordKind>> records;
+    for (auto itr = arena.begin(); itr != arena.end(); ++itr)
+        records.emplace_back(*itr, itr.kind());
+    EXPECT_EQ(records, (std::vector<std::pair<std::string_view, RecordKind>>({
+                            { "text",       RecordKind::TEXT        },
+                            { "deferred",   RecordKind::DEFERRED    },
+                            { "text again", RecordKind::TEXT        } })));
+}
+
+TEST(RecordRingTest, testCapacityRoundedUpToPowerOfTwo)
+{
+    RecordRing ring(5000);
+    EXPECT_EQ(ring.capacity(), 8192);
+    RecordRing ringMin(0);
+    EXPECT_EQ(ringMin.capacity(), 4096);
+    EXPECT_LT(ringMin.maxRecordSize(), ringMin.capacity() / 2);
+}
+
+TEST(RecordRingTest, testRecordsTakeOnlyTheirOwnSize)
+{
+    RecordRing ring(4096);
+    std::string record(120, 'x');
+    ASSERT_TRUE(ring.tryPush(record));
+    // 8 bytes of header + 120 bytes of data
+    EXPECT_EQ(ring.pendingBytes(), 128);
+    ASSERT_TRUE(ring.tryPush("abc"));
+    EXPECT_EQ(ring.pendingBytes(), 128 + 16);
+
+    EXPECT_EQ(drainAll(ring), std::vector<std::string>({record, "abc"}));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RecordRingTest, testStampedRecords)
+{
+    RecordRing ring(4096, OverflowPolicy::BLOCK, true);
+    EXPECT_TRUE(ring.isStamped());
+    EXPECT_FALSE(RecordRing(4096).isStamped());
+    EXPECT_EQ(ring.maxRecordSize(), RecordRing(4096).maxRecordSize() - sizeof(uint64_t));
+
+    // 8 bytes of header + 8 bytes of stamp + 120 bytes of data
+    auto before = RecordRing::stampNow();
+    ASSERT_TRUE(ring.tryPush(std::string(120, 'x')));
+    EXPECT_EQ(ring.pendingBytes(), 136);
+    ASSERT_TRUE(ring.tryPush("abc", RecordKind::DEFERRED));
+    auto after = RecordRing::stampNow();
+    ASSERT_TRUE(ring.tryPush("later"));
+
+    // The ones stamped after the given time stay in the ring
+    RecordArena arena;
+    std::vector<uint64_t> stamps;
+    EXPECT_EQ(ring.drain(arena, stamps, after), 2u);
+    ASSERT_EQ(stamps.size(), 2u);
+    EXPECT_LE(before, stamps[0]);
+    EXPECT_LE(stamps[0], stamps[1]);
+    EXPECT_LE(stamps[1], after);
+    auto itr = arena.begin();
+    EXPECT_EQ(*itr, std::string(120, 'x'));
+    EXPECT_EQ((++itr).kind(), RecordKind::DEFERRED);
+    EXPECT_EQ(*itr, "abc");
+    EXPECT_EQ(ring.pendingRecords(), 1u);
+
+    EXPECT_EQ(ring.drain(arena, stamps, RecordRing::stampNow()), 1u);
+    EXPECT_LT(after, stamps.back());
+    EXPECT_TRUE(ring.empty());
+
+    // Not stamped, so there is nothing to leave in the ring
+    RecordRing plainRing(4096);
+    ASSERT_TRUE(plainRing.tryPush("plain"));
+    stamps.clear();
+    EXPECT_EQ(plainRing.drain(arena, stamps, 0), 1u);
+    EXPECT_EQ(stamps, std::vector<uint64_t>({0}));
+}
+
+TEST(RecordRingTest, testPushDrainInOrderWithWrapAround)
+{
+    RecordRing ring(4096);
+    int nextPush = 0;
+    int nextDrain = 0;
+    // Records of odd sizes, so that the ring wraps around at
+    // all sorts of offsets and needs padding at the end
+    for (int round = 0; round < 200; ++round)
+    {
+        while (ring.tryPush(std::string(1 + (nextPush * 37) % 300, static_cast<char>('a' + nextPush % 26))))
+            ++nextPush;
+        for (const auto& record : drainAll(ring))
+        {
+            ASSERT_EQ(record, std::string(1 + (nextDrain * 37) % 300, static_cast<char>('a' + nextDrain % 26)));
+            ++nextDrain;
+        }
+    }
+    EXPECT_EQ(nextPush, nextDrain);
+    EXPECT_EQ(ring.droppedCount(), 0);
+}
+
+TEST(RecordRingTest, testDropNewestPolicy)
+{
+    RecordRing ring(4096, OverflowPolicy::DROP_NEWEST);
+    std::string record(1016, 'd');  // 1KB slot including the header
+    for (int idx = 0; idx < 10; ++idx)
+        ring.push(record);
+    EXPECT_EQ(ring.droppedCount(), 6);
+    EXPECT_EQ(drainAll(ring).size(), 4);
+}
+
+TEST(RecordRingTest, testOverwriteOldestPolicy)
+{
+    RecordRing ring(4096, OverflowPolicy::OVERWRITE_OLDEST);
+    for (int idx = 0; idx < 10; ++idx)
+        EXPECT_TRUE(ring.push(std::string(1015, 'o') + std::to_string(idx)));
+    EXPECT_EQ(ring.droppedCount(), 6);
+
+    auto records = drainAll(ring);
+    ASSERT_EQ(records.size(), 4);
+    for (size_t idx = 0; idx < records.size(); ++idx)
+        EXPECT_EQ(records[idx].back(), static_cast<char>('6' + idx));
+}
+
+TEST(RecordRingTest, testBlockPolicyWithMultipleProducers)
+{
+    constexpr int producersCnt = 8;
+    constexpr int recordsCnt = 10000;
+    RecordRing ring(8192, OverflowPolicy::BLOCK);
+
+    std::vector<std::thread> producers;
+    for (int thNo = 0; thNo < producersCnt; ++thNo)
+    {
+        producers.emplace_back([&ring, thNo]()
+        {
+            for (int idx = 0; idx < recordsCnt; ++idx)
+                ring.push(std::to_string(thNo) + ":" + std::to_string(idx));
+        });
+    }
+
+    // Single consumer, the records of each of the producers must come in order
+    std::vector<int> lastSeen(producersCnt, -1);
+    int drainedCnt = 0;
+    RecordArena arena;
+    while (drainedCnt < producersCnt * recordsCnt)
+    {
+        arena.clear();
+        if (ring.drain(arena) == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (const auto record : arena)
+        {
+            auto sep = record.find(':');
+            auto thNo = std::stoi(std::string(record.substr(0, sep)));
+            auto idx = std::stoi(std::string(record.substr(sep + 1)));
+            ASSERT_LT(lastSeen[thNo], idx);
+            lastSeen[thNo] = idx;
+            ++drainedCnt;
+        }
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(ring.droppedCount(), 0);
+    for (const auto& last : lastSeen)
+        EXPECT_EQ(last, recordsCnt - 1);
+}
+
+TEST(RecordRingTest, testOverwriteOldestWhileDraining)
+{
+    constexpr int producersCnt = 4;
+    constexpr int recordsCnt = 20000;
+    RecordRing ring(8192, OverflowPolicy::OVERWRITE_OLDEST);
+
+    // The producers discard the oldest records in between the ones the consumer
+    // drains, every record drained must still be whole and in order
+    std::atomic<int> doneCnt = 0;
+    std::vector<std::thread> producers;
+    for (int thNo = 0; thNo < producersCnt; ++thNo)
+    {
+        producers.emplace_back([&ring, &doneCnt, thNo]()
+        {
+            for (int idx = 0; idx < recordsCnt; ++idx)
+            {
+                auto record = std::to_string(thNo) + ":" + std::to_string(idx) + ":";
+                record.append(static_cast<size_t>(idx % 200), static_cast<char>('a' + idx % 26));
+                EXPECT_TRUE(ring.push(record));
+            }
+            ++doneCnt;
+        });
+    }
+
+    std::vector<int> lastSeen(producersCnt, -1);
+    size_t drainedCnt = 0;
+    RecordArena arena;
+    auto checkDrained = [&]()
+    {
+        for (const auto record : arena)
+        {
+            auto sep = record.find(':');
+            auto sep2 = record.find(':', sep + 1);
+            auto thNo = std::stoi(std::string(record.substr(0, sep)));
+            auto idx = std::stoi(std::string(record.substr(sep + 1, sep2 - sep - 1)));
+            ASSERT_LT(lastSeen[thNo], idx);
+            lastSeen[thNo] = idx;
+            EXPECT_EQ(std::string(static_cast<size_t>(idx % 200), static_cast<char>('a' + idx % 26)), record.substr(sep2 + 1));
+            ++drainedCnt;
+        }
+    };
+    while (doneCnt < producersCnt)
+    {
+        arena.clear();
+        ring.drain(arena);
+        checkDrained();
+    }
+    for (auto& producer : producers)
+        producer.join();
+    arena.clear();
+    ring.drain(arena);
+    checkDrained();
+
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(static_cast<uint64_t>(producersCnt * recordsCnt), drainedCnt + ring.droppedCount());
+}
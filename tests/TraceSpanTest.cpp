@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file TraceSpanTest.cpp
+ * @brief Unit tests for the TraceSpan class and the LOG_SPAN statement.
+ *
+ * This file contains tests that verify a span logs a single structured record
+ * with its duration, that only every Nth span of a statement is timed, that
+ * the spans shorter than the minimum duration are left out, and that the
+ * spans of a disabled log type are not even timed.
+ */
+
+#include "TraceSpan.hpp"
+#include "LOGGER_MACROS.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cinttypes>
+
+using namespace logger;
+
+class TraceSpanTest : public ::testing::Test
+{
+    protected:
+        void TearDown() override
+        {
+            TraceSpan::setSampling(1);
+            TraceSpan::setMinDuration(std::chrono::nanoseconds(0));
+            LogFilter::reset();
+            loggingOps.flush();
+        }
+
+        static uint64_t pushedRecords()
+        {
+            return loggingOps.getStats().pushedRecords;
+        }
+
+        static void work(const std::chrono::microseconds duration = std::chrono::microseconds(0))
+        {
+            LOG_SPAN("work");
+            if (duration.count())
+                std::this_thread::sleep_for(duration);
+        }
+
+        /**
+         * @brief The message of the last record logged by the calling thread
+         */
+        static std::string lastMessage()
+        {
+            std::string msg;
+            DeferredRecord::formatMessage(deferredRecordBuf, msg);
+            return msg;
+        }
+};
+
+TEST_F(TraceSpanTest, testSpanRecord)
+{
+    auto before = pushedRecords();
+    work(std::chrono::microseconds(200));
+    EXPECT_EQ(before + 1, pushedRecords());
+
+    auto fields = DeferredRecord::decode(deferredRecordBuf);
+    ASSERT_TRUE(fields.m_isStructured);
+    EXPECT_EQ("work", fields.m_FormatStr);
+    EXPECT_EQ(SPAN_ANGLES, fields.m_pCallSite->marker());
+    EXPECT_EQ(LOG_TYPE::LOG_INFO, fields.m_pCallSite->type());
+    EXPECT_EQ("work", fields.m_pCallSite->functionName());
+
+    // The duration is the time the scope took, the sleep at least
+    int64_t durationNs = 0;
+    auto msg = lastMessage();
+    ASSERT_EQ(1, std::sscanf(msg.c_str(), "work duration_ns=%" SCNd64, &durationNs)) << msg;
+    EXPECT_GE(durationNs, 200000);
+    EXPECT_LT(durationNs, 10000000000);
+}
+
+TEST_F(TraceSpanTest, testSampling)
+{
+    TraceSpan::setSampling(4);
+    EXPECT_EQ(4u, TraceSpan::getSampling());
+    auto before = pushedRecords();
+    for (auto cnt = 0; cnt < 100; ++cnt)
+        work();
+    EXPECT_EQ(before + 25, pushedRecords());
+    EXPECT_NE(std::string::npos, lastMessage().find(" sample_every=4")) << lastMessage();
+
+    uint32_t sampleCnt = 0;
+    static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_INFO, SPAN_ANGLES};
+    EXPECT_FALSE(TraceSpan(site, "handle", sampleCnt).isTimed());
+    EXPECT_FALSE(TraceSpan(site, "handle", sampleCnt).isTimed());
+    EXPECT_FALSE(TraceSpan(site, "handle", sampleCnt).isTimed());
+    EXPECT_TRUE(TraceSpan(site, "handle", sampleCnt).isTimed());
+
+    TraceSpan::setSampling(0);
+    EXPECT_EQ(1u, TraceSpan::getSampling());
+    EXPECT_TRUE(TraceSpan(site, "handle", sampleCnt).isTimed());
+}
+
+TEST_F(TraceSpanTest, testMinDuration)
+{
+    TraceSpan::setMinDuration(std::chrono::milliseconds(50));
+    auto before = pushedRecords();
+    for (auto cnt = 0; cnt < 100; ++cnt)
+        work();
+    EXPECT_EQ(before, pushedRecords());
+    work(std::chrono::milliseconds(60));
+    EXPECT_EQ(before + 1, pushedRecords());
+}
+
+TEST_F(TraceSpanTest, testDisabledSpansAreNotTimed)
+{
+    LogFilter::setLogLevel(LOG_TYPE::LOG_WARN);
+    static constexpr CallSite site{__FILE__, "void Handler::handle(int)", 123, LOG_TYPE::LOG_INFO, SPAN_ANGLES};
+    uint32_t sampleCnt = 0;
+    EXPECT_FALSE(TraceSpan(site, "handle", sampleCnt).isTimed());
+
+    auto before = pushedRecords();
+    work();
+    EXPECT_EQ(before, pushedRecords());
+}
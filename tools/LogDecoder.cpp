@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Swarnendu RC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * File: LogDecoder.cpp
+ * Description: Command line tool rendering binary log files (see BinaryLog.hpp)
+ * back to the text layout. Compressed log files (see BlockCompression.hpp) are
+ * decompressed first, so it prints a compressed text log as well.
+ *
+ * Usage: LogDecoder <log file> [<output file>]
+ * The text goes to the standard output if no output file is given.
+ */
+
+#include "BinaryLog.hpp"
+#include "BlockCompression.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+using namespace logger;
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <log file> [<output file>]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream inFile(argv[1], std::ios::binary);
+    if (!inFile)
+    {
+        std::cerr << "Can't open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::string data((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+    std::ofstream outFile;
+    if (argc == 3)
+    {
+        outFile.open(argv[2], std::ios::out | std::ios::trunc);
+        if (!outFile)
+        {
+            std::cerr << "Can't open " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = (argc == 3) ? static_cast<std::ostream&>(outFile) : std::cout;
+
+    try
+    {
+        if (BlockCompression::isCompressed(data))
+        {
+            std::string raw;
+            if (!BlockCompression::decompress(data, raw))
+                std::cerr << argv[1] << ": The last block is truncated" << std::endl;
+            data.swap(raw);
+        }
+        if (!BinaryLogReader::isBinaryLog(data))
+        {
+            out << data;
+            return 0;
+        }
+
+        BinaryLogReader reader(data);
+        std::string line;
+        while (reader.next(line))
+            out << line << '\n';
+    }
+    catch (const std::exception& excp)
+    {
+        out.flush();
+        std::cerr << argv[1] << ": " << excp.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}